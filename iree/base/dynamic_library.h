@@ -15,6 +15,7 @@
 #ifndef IREE_BASE_DYNAMIC_LIBRARY_H_
 #define IREE_BASE_DYNAMIC_LIBRARY_H_
 
+#include <cstdint>
 #include <memory>
 #include <string>
 
@@ -53,6 +54,17 @@ class DynamicLibrary {
   static StatusOr<std::unique_ptr<DynamicLibrary>> Load(
       absl::Span<const char* const> search_file_names);
 
+  // Loads the library from the in-memory shared object |buffer| without
+  // writing it to the file system. |identifier| is used as the name of the
+  // library for debugging and profiling and need not be unique.
+  // The buffer contents are copied and need not outlive the library.
+  //
+  // Returns UNIMPLEMENTED on platforms that cannot load libraries from memory
+  // (or UNAVAILABLE if the platform support is missing at runtime) and callers
+  // are expected to fall back to writing a file and using |Load|.
+  static StatusOr<std::unique_ptr<DynamicLibrary>> LoadFromMemory(
+      const char* identifier, absl::Span<const uint8_t> buffer);
+
   // Gets the name of the library file that is loaded.
   const std::string& file_name() const { return file_name_; }
 
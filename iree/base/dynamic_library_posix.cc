@@ -21,6 +21,23 @@
     defined(IREE_PLATFORM_LINUX)
 
 #include <dlfcn.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <cstdio>
+
+#if defined(IREE_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#if defined(SYS_memfd_create)
+// memfd_create was only added to glibc in 2.27 so we issue the syscall
+// directly; the kernel has supported it since 3.17.
+#define IREE_HAVE_DYNAMIC_LIBRARY_MEMFD_SUPPORT 1
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif  // MFD_CLOEXEC
+#endif  // SYS_memfd_create
+#endif  // IREE_PLATFORM_LINUX
 
 namespace iree {
 
@@ -31,6 +48,7 @@ class DynamicLibraryPosix : public DynamicLibrary {
     //   Sometimes closing the library can prevent proper symbolization on
     //   crashes or in sampling profilers.
     ::dlclose(library_);
+    if (fd_ != -1) ::close(fd_);
   }
 
   static StatusOr<std::unique_ptr<DynamicLibrary>> Load(
@@ -48,15 +66,61 @@ class DynamicLibraryPosix : public DynamicLibrary {
            << "Unable to open dynamic library:'" << dlerror() << "'";
   }
 
+#if defined(IREE_HAVE_DYNAMIC_LIBRARY_MEMFD_SUPPORT)
+  // Loads the library from an anonymous memory-backed file. The dynamic linker
+  // only deals in paths so we route it through /proc/self/fd/ and keep the fd
+  // open for the lifetime of the library: glibc deduplicates loaded libraries
+  // by path and reusing the fd number while the library is loaded would cause
+  // a subsequent load to return the wrong library.
+  static StatusOr<std::unique_ptr<DynamicLibrary>> LoadFromMemory(
+      const char* identifier, absl::Span<const uint8_t> buffer) {
+    IREE_TRACE_SCOPE0("DynamicLibraryPosix::LoadFromMemory");
+
+    int fd = static_cast<int>(::syscall(SYS_memfd_create, identifier,
+                                        static_cast<unsigned>(MFD_CLOEXEC)));
+    if (fd == -1) {
+      return UnavailableErrorBuilder(IREE_LOC)
+             << "Unable to create in-memory file: " << ::strerror(errno);
+    }
+
+    size_t offset = 0;
+    while (offset < buffer.size()) {
+      ssize_t written =
+          ::write(fd, buffer.data() + offset, buffer.size() - offset);
+      if (written < 0) {
+        if (errno == EINTR) continue;
+        int error = errno;
+        ::close(fd);
+        return UnavailableErrorBuilder(IREE_LOC)
+               << "Unable to write in-memory file: " << ::strerror(error);
+      }
+      offset += static_cast<size_t>(written);
+    }
+
+    char fd_path[32];
+    std::snprintf(fd_path, sizeof(fd_path), "/proc/self/fd/%d", fd);
+    void* library = ::dlopen(fd_path, RTLD_LAZY | RTLD_LOCAL);
+    if (!library) {
+      ::close(fd);
+      return UnavailableErrorBuilder(IREE_LOC)
+             << "Unable to open in-memory dynamic library:'" << dlerror()
+             << "'";
+    }
+    return absl::WrapUnique(new DynamicLibraryPosix(fd_path, library, fd));
+  }
+#endif  // IREE_HAVE_DYNAMIC_LIBRARY_MEMFD_SUPPORT
+
   void* GetSymbol(const char* symbol_name) const override {
     return ::dlsym(library_, symbol_name);
   }
 
  private:
-  DynamicLibraryPosix(std::string file_name, void* library)
-      : DynamicLibrary(file_name), library_(library) {}
+  DynamicLibraryPosix(std::string file_name, void* library, int fd = -1)
+      : DynamicLibrary(file_name), library_(library), fd_(fd) {}
 
   void* library_;
+  // Backing in-memory file when loaded from memory, otherwise -1.
+  int fd_;
 };
 
 // static
@@ -65,6 +129,17 @@ StatusOr<std::unique_ptr<DynamicLibrary>> DynamicLibrary::Load(
   return DynamicLibraryPosix::Load(search_file_names);
 }
 
+// static
+StatusOr<std::unique_ptr<DynamicLibrary>> DynamicLibrary::LoadFromMemory(
+    const char* identifier, absl::Span<const uint8_t> buffer) {
+#if defined(IREE_HAVE_DYNAMIC_LIBRARY_MEMFD_SUPPORT)
+  return DynamicLibraryPosix::LoadFromMemory(identifier, buffer);
+#else
+  return UnimplementedErrorBuilder(IREE_LOC)
+         << "Loading dynamic libraries from memory is not supported";
+#endif  // IREE_HAVE_DYNAMIC_LIBRARY_MEMFD_SUPPORT
+}
+
 }  // namespace iree
 
 #endif  // IREE_PLATFORM_*
@@ -152,6 +152,13 @@ StatusOr<std::unique_ptr<DynamicLibrary>> DynamicLibrary::Load(
   return DynamicLibraryWin::Load(search_file_names);
 }
 
+// static
+StatusOr<std::unique_ptr<DynamicLibrary>> DynamicLibrary::LoadFromMemory(
+    const char* identifier, absl::Span<const uint8_t> buffer) {
+  return UnimplementedErrorBuilder(IREE_LOC)
+         << "Loading dynamic libraries from memory is not supported";
+}
+
 }  // namespace iree
 
 #endif  // IREE_PLATFORM_*
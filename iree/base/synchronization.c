@@ -38,6 +38,10 @@
 
 #endif  // IREE_PLATFORM_*
 
+#if !defined(IREE_PLATFORM_WINDOWS)
+#include <sched.h>
+#endif  // !IREE_PLATFORM_WINDOWS
+
 #if defined(NDEBUG)
 #define SYNC_ASSERT(x) (void)(x)
 #else
@@ -146,6 +150,25 @@ static inline void iree_futex_wake(void* address, int32_t count) {
 
 #endif  // IREE_PLATFORM_*
 
+#if defined(IREE_PLATFORM_HAS_FUTEX_BITSET)
+
+// Waits like iree_futex_wait (with an infinite timeout) but only wakes on
+// iree_futex_wake_bitset calls that include a bit in |bitset|.
+static inline void iree_futex_wait_bitset(void* address,
+                                          uint32_t expected_value,
+                                          uint32_t bitset) {
+  syscall(SYS_futex, address, FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG,
+          expected_value, NULL, NULL, bitset);
+}
+
+// Wakes all threads waiting on |address| with a bit in |bitset|.
+static inline void iree_futex_wake_bitset(void* address, uint32_t bitset) {
+  syscall(SYS_futex, address, FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG,
+          IREE_ALL_WAITERS, NULL, NULL, bitset);
+}
+
+#endif  // IREE_PLATFORM_HAS_FUTEX_BITSET
+
 #endif  // IREE_PLATFORM_HAS_FUTEX
 
 //==============================================================================
@@ -537,6 +560,14 @@ void iree_notification_initialize(iree_notification_t* out_notification) {
 #endif  // IREE_PLATFORM_HAS_FUTEX
 }
 
+void iree_notification_initialize_in_group(
+    iree_notification_t* out_notification, iree_notification_group_t* group,
+    iree_host_size_t member_index) {
+  iree_notification_initialize(out_notification);
+  out_notification->group = group;
+  out_notification->group_bit = 1u << (member_index % 32);
+}
+
 void iree_notification_deinitialize(iree_notification_t* notification) {
   // Assert no more waiters (callers must tear down waiters first).
   SYNC_ASSERT(
@@ -554,6 +585,17 @@ void iree_notification_post(iree_notification_t* notification, int32_t count) {
       iree_memory_order_acq_rel);
   // Ensure we have at least one waiter; wake up to |count| of them.
   if (IREE_UNLIKELY(previous_value & IREE_NOTIFICATION_WAITER_MASK)) {
+#if defined(IREE_PLATFORM_HAS_FUTEX_BITSET)
+    if (notification->group) {
+      // Grouped waiters all block on the group sequence. We can't wake only
+      // |count| of our own waiters that way so wake them all; they'll recheck.
+      iree_notification_group_t* group = notification->group;
+      iree_atomic_fetch_add_int32(&group->sequence, 1,
+                                  iree_memory_order_release);
+      iree_futex_wake_bitset(&group->sequence, notification->group_bit);
+      return;
+    }
+#endif  // IREE_PLATFORM_HAS_FUTEX_BITSET
 #if defined(IREE_PLATFORM_HAS_FUTEX)
     iree_futex_wake(iree_notification_epoch_address(notification), count);
 #else
@@ -585,6 +627,24 @@ void iree_notification_commit_wait(iree_notification_t* notification,
   while ((iree_atomic_load_int64(&notification->value,
                                  iree_memory_order_acquire) >>
           IREE_NOTIFICATION_EPOCH_SHIFT) == wait_token) {
+#if defined(IREE_PLATFORM_HAS_FUTEX_BITSET)
+    if (notification->group) {
+      // Posters bump the epoch before the group sequence so if the epoch is
+      // still unchanged after we sample the sequence then any post we've missed
+      // will fail the futex compare and we'll loop around to recheck.
+      iree_notification_group_t* group = notification->group;
+      uint32_t sequence = (uint32_t)iree_atomic_load_int32(
+          &group->sequence, iree_memory_order_acquire);
+      if ((iree_atomic_load_int64(&notification->value,
+                                  iree_memory_order_acquire) >>
+           IREE_NOTIFICATION_EPOCH_SHIFT) != wait_token) {
+        break;
+      }
+      iree_futex_wait_bitset(&group->sequence, sequence,
+                             notification->group_bit);
+      continue;
+    }
+#endif  // IREE_PLATFORM_HAS_FUTEX_BITSET
 #if defined(IREE_PLATFORM_HAS_FUTEX)
     iree_status_ignore(
         iree_futex_wait(iree_notification_epoch_address(notification),
@@ -605,6 +665,61 @@ void iree_notification_commit_wait(iree_notification_t* notification,
   SYNC_ASSERT((previous_value & IREE_NOTIFICATION_WAITER_MASK) != 0);
 }
 
+// Hints to the processor that the calling thread is in a spin-wait loop.
+// This reduces power and frees execution resources for sibling hyperthreads.
+static inline void iree_processor_yield(void) {
+#if defined(IREE_COMPILER_MSVC)
+  YieldProcessor();
+#elif defined(IREE_ARCH_X86_32) || defined(IREE_ARCH_X86_64)
+  __builtin_ia32_pause();
+#elif defined(IREE_ARCH_ARM_32) || defined(IREE_ARCH_ARM_64)
+  __asm__ __volatile__("yield");
+#endif  // IREE_ARCH_*
+}
+
+// Yields the remainder of the calling thread's quantum to any other thread
+// ready to run on the same processor. Prevents spinners from starving the
+// threads they are waiting on when the system is oversubscribed.
+static inline void iree_thread_yield_quantum(void) {
+#if defined(IREE_PLATFORM_WINDOWS)
+  SwitchToThread();
+#elif !defined(IREE_PLATFORM_EMSCRIPTEN)
+  sched_yield();
+#endif  // IREE_PLATFORM_*
+}
+
+bool iree_notification_commit_wait_with_spin(iree_notification_t* notification,
+                                             iree_wait_token_t wait_token,
+                                             iree_duration_t spin_ns) {
+  if (spin_ns > 0) {
+    // Drop our waiter registration while spinning so that posters don't need
+    // to make the wake syscall. The epoch still advances on every post and
+    // we'll catch any that land between here and the blocking wait below as
+    // we keep comparing against the original |wait_token|.
+    iree_notification_cancel_wait(notification);
+    iree_time_t spin_deadline_ns = iree_time_now() + spin_ns;
+    do {
+      // Poll a handful of times between clock reads as iree_time_now is much
+      // more expensive than the atomic load.
+      for (int i = 0; i < 64; ++i) {
+        if ((iree_atomic_load_int64(&notification->value,
+                                    iree_memory_order_acquire) >>
+             IREE_NOTIFICATION_EPOCH_SHIFT) != wait_token) {
+          return true;
+        }
+        iree_processor_yield();
+      }
+      iree_thread_yield_quantum();
+    } while (iree_time_now() < spin_deadline_ns);
+
+    // Re-register as a waiter; the returned token is ignored as we need to
+    // observe any posts made since the original token was acquired.
+    iree_notification_prepare_wait(notification);
+  }
+  iree_notification_commit_wait(notification, wait_token);
+  return false;
+}
+
 void iree_notification_cancel_wait(iree_notification_t* notification) {
   // TODO(benvanik): benchmark under real workloads.
   // iree_memory_order_relaxed would suffice for correctness but the faster
@@ -634,3 +749,43 @@ void iree_notification_await(iree_notification_t* notification,
     }
   }
 }
+
+//==============================================================================
+// iree_notification_group_t
+//==============================================================================
+
+void iree_notification_group_initialize(
+    iree_notification_group_t* out_group) {
+  memset(out_group, 0, sizeof(*out_group));
+}
+
+void iree_notification_group_deinitialize(iree_notification_group_t* group) {}
+
+void iree_notification_group_post(iree_notification_group_t* group,
+                                  iree_notification_t* const* notifications,
+                                  iree_host_size_t notification_count) {
+#if defined(IREE_PLATFORM_HAS_FUTEX_BITSET)
+  // Advance all epochs first and accumulate the bits of those with waiters so
+  // that we can wake them all together.
+  uint32_t wake_bitset = 0;
+  for (iree_host_size_t i = 0; i < notification_count; ++i) {
+    iree_notification_t* notification = notifications[i];
+    SYNC_ASSERT(notification->group == group);
+    uint64_t previous_value = iree_atomic_fetch_add_int64(
+        &notification->value, IREE_NOTIFICATION_EPOCH_INC,
+        iree_memory_order_acq_rel);
+    if (previous_value & IREE_NOTIFICATION_WAITER_MASK) {
+      wake_bitset |= notification->group_bit;
+    }
+  }
+  if (wake_bitset) {
+    iree_atomic_fetch_add_int32(&group->sequence, 1,
+                                iree_memory_order_release);
+    iree_futex_wake_bitset(&group->sequence, wake_bitset);
+  }
+#else
+  for (iree_host_size_t i = 0; i < notification_count; ++i) {
+    iree_notification_post(notifications[i], IREE_ALL_WAITERS);
+  }
+#endif  // IREE_PLATFORM_HAS_FUTEX_BITSET
+}
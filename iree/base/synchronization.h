@@ -65,6 +65,14 @@
 #endif  // !IREE_SANITIZER_THREAD
 #endif  // IREE_PLATFORM_*
 
+// Linux futexes support waking a subset of the waiters on a single address
+// by way of FUTEX_WAIT_BITSET/FUTEX_WAKE_BITSET. Other platforms fall back to
+// waking each waiter individually.
+#if defined(IREE_PLATFORM_HAS_FUTEX) && \
+    (defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX))
+#define IREE_PLATFORM_HAS_FUTEX_BITSET 1
+#endif  // IREE_PLATFORM_HAS_FUTEX && IREE_PLATFORM_*
+
 #if defined(IREE_PLATFORM_APPLE)
 #include <os/lock.h>
 #endif  // IREE_PLATFORM_APPLE
@@ -286,11 +294,58 @@ typedef struct {
   pthread_cond_t cond;
 #endif  // IREE_PLATFORM_*
   iree_atomic_int64_t value;
+  // Optional group the notification belongs to (or NULL if standalone) and the
+  // bit identifying the notification within the group.
+  struct iree_notification_group_s* group;
+  uint32_t group_bit;
 } iree_notification_t;
 
+// A group of notifications sharing a single OS wait address such that any
+// subset of them can be posted with a single wake syscall.
+//
+// Posting N standalone notifications that have waiters takes N syscalls and the
+// last waiter isn't even asked to wake until all N-1 before it have been. When
+// notifications are in a group the waiters instead all block on the group
+// address with their own wake bit and iree_notification_group_post wakes every
+// requested waiter at once. Up to 32 distinct bits are available; larger groups
+// share bits and waiters may see spurious wakes (which they handle by
+// rechecking their own notification epoch and going back to sleep).
+//
+// On platforms without IREE_PLATFORM_HAS_FUTEX_BITSET the group is only used
+// for bookkeeping and notifications behave as if standalone.
+typedef struct iree_notification_group_s {
+  // Incremented for each post to any notification in the group that has
+  // waiters. Waiters use this as the futex value when blocking.
+  iree_atomic_int32_t sequence;
+} iree_notification_group_t;
+
+// Initializes a notification group with no members.
+void iree_notification_group_initialize(
+    iree_notification_group_t* out_group);
+
+// Deinitializes |group|. All member notifications must have been deinitialized.
+void iree_notification_group_deinitialize(iree_notification_group_t* group);
+
+// Posts all |notifications| (all of which must be members of |group|) and wakes
+// every waiter on them. On platforms supporting it this is done with at most
+// one syscall regardless of the number of notifications.
+//
+// Acts as (at least) a memory_order_release barrier.
+void iree_notification_group_post(iree_notification_group_t* group,
+                                  iree_notification_t* const* notifications,
+                                  iree_host_size_t notification_count);
+
 // Initializes a notification to no waiters and an initial epoch of 0.
 void iree_notification_initialize(iree_notification_t* out_notification);
 
+// Initializes a notification as a member of |group| identified by
+// |member_index|. The notification can be used exactly like a standalone one
+// and may additionally be posted in bulk with iree_notification_group_post.
+// The group must remain valid until the notification is deinitialized.
+void iree_notification_initialize_in_group(
+    iree_notification_t* out_notification, iree_notification_group_t* group,
+    iree_host_size_t member_index);
+
 // Deinitializes |notification| (after a prior call to
 // iree_notification_initialize). No threads may be waiting on the notification.
 void iree_notification_deinitialize(iree_notification_t* notification);
@@ -333,6 +388,21 @@ iree_wait_token_t iree_notification_prepare_wait(
 void iree_notification_commit_wait(iree_notification_t* notification,
                                    iree_wait_token_t wait_token);
 
+// Commits a pending wait operation like iree_notification_commit_wait but first
+// spins for up to |spin_ns| polling for a notification before blocking.
+// The caller is not registered as a waiter while spinning so that posts landing
+// during the spin avoid the syscall required to wake a blocked thread. Spinning
+// is a trade of CPU time for wake latency and should only be used when posts
+// are expected to arrive shortly after the wait begins.
+//
+// Returns true if a notification was observed while spinning and false if the
+// caller had to block.
+//
+// Acts as (at least) a memory_order_acquire barrier.
+bool iree_notification_commit_wait_with_spin(iree_notification_t* notification,
+                                             iree_wait_token_t wait_token,
+                                             iree_duration_t spin_ns);
+
 // Cancels a pending wait operation without blocking.
 //
 // Acts as (at least) a memory_order_relaxed barrier:
@@ -12,7 +12,11 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <atomic>
+#include <chrono>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include "benchmark/benchmark.h"
 #include "iree/base/synchronization.h"
@@ -256,8 +260,100 @@ BENCHMARK_TEMPLATE(BM_Contended, std::mutex)
 // iree_notification_t
 //==============================================================================
 
-// TODO(benvanik): benchmark this; it should in the worst case be as bad as
-// mutex/futex (as that's what is used), but at the moment we don't really
-// care beyond that.
+// Measures the latency of waking |state.range(0)| blocked waiters until all of
+// them have observed the post. This models the coordinator fanning a dispatch
+// out to a set of idle workers. Waiters either get posted one at a time
+// (kUseGroup=false; one syscall per waiter) or in bulk via
+// iree_notification_group_post (kUseGroup=true; one syscall total where
+// supported).
+template <bool kUseGroup>
+void BM_NotificationFanOut(benchmark::State& state) {
+  const int waiter_count = static_cast<int>(state.range(0));
+
+  iree_notification_group_t group;
+  iree_notification_group_initialize(&group);
+  std::vector<iree_notification_t> notifications(waiter_count);
+  std::vector<iree_notification_t*> notification_ptrs(waiter_count);
+  for (int i = 0; i < waiter_count; ++i) {
+    // The individual baseline uses plain notifications so that it measures the
+    // per-notification wake path and not that of grouped notifications.
+    if (kUseGroup) {
+      iree_notification_initialize_in_group(&notifications[i], &group, i);
+    } else {
+      iree_notification_initialize(&notifications[i]);
+    }
+    notification_ptrs[i] = &notifications[i];
+  }
+
+  // Each waiter blocks until the round advances and then acknowledges it.
+  std::atomic<int> round(0);
+  std::atomic<int> ack_count(0);
+  std::atomic<bool> exiting(false);
+  std::vector<std::thread> waiters;
+  for (int i = 0; i < waiter_count; ++i) {
+    waiters.emplace_back([&, i]() {
+      int seen_round = 0;
+      while (true) {
+        iree_wait_token_t wait_token =
+            iree_notification_prepare_wait(&notifications[i]);
+        if (round.load(std::memory_order_acquire) == seen_round &&
+            !exiting.load(std::memory_order_acquire)) {
+          iree_notification_commit_wait(&notifications[i], wait_token);
+          continue;
+        }
+        iree_notification_cancel_wait(&notifications[i]);
+        if (exiting.load(std::memory_order_acquire)) break;
+        seen_round = round.load(std::memory_order_acquire);
+        ack_count.fetch_add(1, std::memory_order_acq_rel);
+      }
+    });
+  }
+
+  for (auto _ : state) {
+    // Give the waiters a chance to block in the kernel so that we measure the
+    // actual wake and not a missed wait.
+    state.PauseTiming();
+    ack_count.store(0, std::memory_order_release);
+    std::this_thread::sleep_for(std::chrono::microseconds(100));
+    state.ResumeTiming();
+
+    round.fetch_add(1, std::memory_order_acq_rel);
+    if (kUseGroup) {
+      iree_notification_group_post(&group, notification_ptrs.data(),
+                                   notification_ptrs.size());
+    } else {
+      for (auto* notification : notification_ptrs) {
+        iree_notification_post(notification, IREE_ALL_WAITERS);
+      }
+    }
+    while (ack_count.load(std::memory_order_acquire) < waiter_count) {
+      std::this_thread::yield();
+    }
+  }
+
+  exiting.store(true, std::memory_order_release);
+  for (auto* notification : notification_ptrs) {
+    iree_notification_post(notification, IREE_ALL_WAITERS);
+  }
+  for (auto& waiter : waiters) waiter.join();
+  for (auto& notification : notifications) {
+    iree_notification_deinitialize(&notification);
+  }
+  iree_notification_group_deinitialize(&group);
+}
+
+BENCHMARK_TEMPLATE(BM_NotificationFanOut, false)
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(32);
+
+BENCHMARK_TEMPLATE(BM_NotificationFanOut, true)
+    ->UseRealTime()
+    ->Arg(1)
+    ->Arg(4)
+    ->Arg(16)
+    ->Arg(32);
 
 }  // namespace
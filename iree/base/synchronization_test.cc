@@ -16,6 +16,7 @@
 
 #include <chrono>
 #include <thread>
+#include <vector>
 
 #include "iree/testing/gtest.h"
 
@@ -184,4 +185,142 @@ TEST(SlimMutexTest, ExclusiveAccessTryLock) {
 
 // Tested implicitly in threading_test.cc.
 
+TEST(NotificationTest, CommitWaitWithSpinPosted) {
+  iree_notification_t notification;
+  iree_notification_initialize(&notification);
+  // A post landing before the wait is committed must be observed while
+  // spinning without ever blocking.
+  iree_wait_token_t wait_token = iree_notification_prepare_wait(&notification);
+  iree_notification_post(&notification, IREE_ALL_WAITERS);
+  EXPECT_TRUE(iree_notification_commit_wait_with_spin(
+      &notification, wait_token, /*spin_ns=*/1000000000ll));
+  iree_notification_deinitialize(&notification);
+}
+
+TEST(NotificationTest, CommitWaitWithSpinSpinning) {
+  iree_notification_t notification;
+  iree_notification_initialize(&notification);
+  // Post while the waiter is spinning; with a generous spin budget it should
+  // see the post before falling back to a blocking wait.
+  iree_wait_token_t wait_token = iree_notification_prepare_wait(&notification);
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    iree_notification_post(&notification, IREE_ALL_WAITERS);
+  });
+  iree_notification_commit_wait_with_spin(&notification, wait_token,
+                                          /*spin_ns=*/1000000000ll);
+  thread.join();
+  iree_notification_deinitialize(&notification);
+}
+
+TEST(NotificationTest, CommitWaitWithSpinPark) {
+  iree_notification_t notification;
+  iree_notification_initialize(&notification);
+  // Post after the spin budget has elapsed so that the waiter must block.
+  iree_atomic_int32_t posted;
+  iree_atomic_store_int32(&posted, 0, iree_memory_order_relaxed);
+  iree_wait_token_t wait_token = iree_notification_prepare_wait(&notification);
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    iree_atomic_store_int32(&posted, 1, iree_memory_order_release);
+    iree_notification_post(&notification, IREE_ALL_WAITERS);
+  });
+  EXPECT_FALSE(iree_notification_commit_wait_with_spin(
+      &notification, wait_token, /*spin_ns=*/1000));
+  EXPECT_EQ(1, iree_atomic_load_int32(&posted, iree_memory_order_acquire));
+  thread.join();
+  iree_notification_deinitialize(&notification);
+}
+
+//==============================================================================
+// iree_notification_group_t
+//==============================================================================
+
+// Tests that a grouped notification can be posted on its own like a standalone
+// notification.
+TEST(NotificationGroupTest, IndividualPost) {
+  iree_notification_group_t group;
+  iree_notification_group_initialize(&group);
+  iree_notification_t notification;
+  iree_notification_initialize_in_group(&notification, &group, 3);
+  iree_wait_token_t wait_token = iree_notification_prepare_wait(&notification);
+  std::thread thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    iree_notification_post(&notification, IREE_ALL_WAITERS);
+  });
+  iree_notification_commit_wait(&notification, wait_token);
+  thread.join();
+  iree_notification_deinitialize(&notification);
+  iree_notification_group_deinitialize(&group);
+}
+
+// Tests that a group post wakes every waiter, including more waiters than
+// there are distinct wake bits.
+TEST(NotificationGroupTest, PostAll) {
+  static constexpr int kMemberCount = 40;
+  iree_notification_group_t group;
+  iree_notification_group_initialize(&group);
+  std::vector<iree_notification_t> notifications(kMemberCount);
+  std::vector<iree_notification_t*> notification_ptrs(kMemberCount);
+  std::vector<iree_wait_token_t> wait_tokens(kMemberCount);
+  for (int i = 0; i < kMemberCount; ++i) {
+    iree_notification_initialize_in_group(&notifications[i], &group, i);
+    notification_ptrs[i] = &notifications[i];
+    wait_tokens[i] = iree_notification_prepare_wait(&notifications[i]);
+  }
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kMemberCount; ++i) {
+    threads.emplace_back([&, i]() {
+      iree_notification_commit_wait(&notifications[i], wait_tokens[i]);
+    });
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  iree_notification_group_post(&group, notification_ptrs.data(),
+                               notification_ptrs.size());
+  for (auto& thread : threads) thread.join();
+  for (auto& notification : notifications) {
+    iree_notification_deinitialize(&notification);
+  }
+  iree_notification_group_deinitialize(&group);
+}
+
+// Tests that posting a subset of the group only releases those waiters even
+// when other members share the same wake bit.
+TEST(NotificationGroupTest, PostSubset) {
+  iree_notification_group_t group;
+  iree_notification_group_initialize(&group);
+  iree_notification_t notification_a;
+  iree_notification_initialize_in_group(&notification_a, &group, 0);
+  iree_notification_t notification_b;
+  iree_notification_initialize_in_group(&notification_b, &group, 32);
+
+  iree_atomic_int32_t b_posted;
+  iree_atomic_store_int32(&b_posted, 0, iree_memory_order_relaxed);
+  iree_wait_token_t wait_token_a =
+      iree_notification_prepare_wait(&notification_a);
+  iree_wait_token_t wait_token_b =
+      iree_notification_prepare_wait(&notification_b);
+  std::thread thread_a([&]() {
+    iree_notification_commit_wait(&notification_a, wait_token_a);
+  });
+  std::thread thread_b([&]() {
+    iree_notification_commit_wait(&notification_b, wait_token_b);
+    EXPECT_EQ(1, iree_atomic_load_int32(&b_posted, iree_memory_order_acquire));
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  iree_notification_t* subset[1] = {&notification_a};
+  iree_notification_group_post(&group, subset, 1);
+  thread_a.join();
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  iree_atomic_store_int32(&b_posted, 1, iree_memory_order_release);
+  iree_notification_post(&notification_b, IREE_ALL_WAITERS);
+  thread_b.join();
+
+  iree_notification_deinitialize(&notification_a);
+  iree_notification_deinitialize(&notification_b);
+  iree_notification_group_deinitialize(&group);
+}
+
 }  // namespace
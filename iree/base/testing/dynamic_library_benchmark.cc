@@ -0,0 +1,79 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <string>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/dynamic_library.h"
+#include "iree/base/file_io.h"
+#include "iree/base/status.h"
+#include "iree/base/target_platform.h"
+#include "iree/base/testing/dynamic_library_test_library_embed.h"
+
+namespace {
+
+// Measures the startup cost of loading an embedded library the way the legacy
+// dylib executable loader did: by extracting it to a temp file first.
+void BM_LoadFromTempFile(benchmark::State& state) {
+  const auto* file_toc = iree::dynamic_library_test_library_create();
+  absl::string_view file_data(reinterpret_cast<const char*>(file_toc->data),
+                              file_toc->size);
+  for (auto _ : state) {
+    auto temp_path_or = iree::file_io::GetTempFile("dynamic_library_benchmark");
+    if (!temp_path_or.ok()) {
+      state.SkipWithError("unable to get temp file path");
+      break;
+    }
+    std::string temp_path = std::move(temp_path_or).value();
+#if defined(IREE_PLATFORM_WINDOWS)
+    temp_path += ".dll";
+#else
+    temp_path += ".so";
+#endif  // IREE_PLATFORM_WINDOWS
+    if (!iree::file_io::SetFileContents(temp_path, file_data).ok()) {
+      state.SkipWithError("unable to write temp file");
+      break;
+    }
+    {
+      auto library_or = iree::DynamicLibrary::Load(temp_path.c_str());
+      if (!library_or.ok()) {
+        state.SkipWithError("unable to load library");
+        break;
+      }
+      benchmark::DoNotOptimize(library_or.value()->GetSymbol("times_two"));
+    }
+    iree::file_io::DeleteFile(temp_path).IgnoreError();
+  }
+}
+BENCHMARK(BM_LoadFromTempFile);
+
+// Measures the startup cost of loading an embedded library directly from
+// memory without touching the file system.
+void BM_LoadFromMemory(benchmark::State& state) {
+  const auto* file_toc = iree::dynamic_library_test_library_create();
+  auto buffer = absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t*>(file_toc->data), file_toc->size);
+  for (auto _ : state) {
+    auto library_or = iree::DynamicLibrary::LoadFromMemory(
+        "dynamic_library_benchmark", buffer);
+    if (!library_or.ok()) {
+      state.SkipWithError("in-memory loading not supported");
+      break;
+    }
+    benchmark::DoNotOptimize(library_or.value()->GetSymbol("times_two"));
+  }
+}
+BENCHMARK(BM_LoadFromMemory);
+
+}  // namespace
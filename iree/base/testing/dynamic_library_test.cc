@@ -95,5 +95,39 @@ TEST_F(DynamicLibraryTest, GetSymbolFailure) {
   EXPECT_EQ(nullptr, unknown_fn);
 }
 
+TEST_F(DynamicLibraryTest, LoadLibraryFromMemory) {
+  const auto* file_toc = dynamic_library_test_library_create();
+  auto library_or = DynamicLibrary::LoadFromMemory(
+      "dynamic_library_test_library",
+      absl::MakeConstSpan(reinterpret_cast<const uint8_t*>(file_toc->data),
+                          file_toc->size));
+  if (IsUnimplemented(library_or.status())) {
+    GTEST_SKIP() << "in-memory loading not supported on this platform";
+  }
+  IREE_ASSERT_OK(library_or.status());
+  auto library = std::move(library_or).value();
+
+  auto times_two_fn = library->GetSymbol<int (*)(int)>("times_two");
+  ASSERT_NE(nullptr, times_two_fn);
+  EXPECT_EQ(246, times_two_fn(123));
+}
+
+// Each in-memory load must produce an independent library even when prior
+// loads are still open.
+TEST_F(DynamicLibraryTest, LoadLibraryFromMemoryTwice) {
+  const auto* file_toc = dynamic_library_test_library_create();
+  auto buffer = absl::MakeConstSpan(
+      reinterpret_cast<const uint8_t*>(file_toc->data), file_toc->size);
+  auto library1_or = DynamicLibrary::LoadFromMemory("library1", buffer);
+  if (IsUnimplemented(library1_or.status())) {
+    GTEST_SKIP() << "in-memory loading not supported on this platform";
+  }
+  IREE_ASSERT_OK(library1_or.status());
+  IREE_ASSERT_OK_AND_ASSIGN(auto library2,
+                            DynamicLibrary::LoadFromMemory("library2", buffer));
+  auto library1 = std::move(library1_or).value();
+  EXPECT_NE(library1->GetSymbol("times_two"), library2->GetSymbol("times_two"));
+}
+
 }  // namespace
 }  // namespace iree
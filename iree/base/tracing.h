@@ -433,6 +433,12 @@ enum {
 //
 // IREE_TRACE_ALLOC: records an malloc.
 // IREE_TRACE_FREE: records a free.
+// IREE_TRACE_ALLOC_NAMED: records an malloc in the named memory pool.
+// IREE_TRACE_FREE_NAMED: records a free in the named memory pool.
+//
+// Named pools are shown separately from the default pool in the Tracy UI and
+// allow tracking suballocations (such as HAL buffers) independently of the
+// host allocations backing them. |name_literal| must be a string literal.
 //
 // NOTE: realloc must be recorded as a FREE/ALLOC pair.
 
@@ -445,17 +451,29 @@ enum {
                                        IREE_TRACING_MAX_CALLSTACK_DEPTH, 0)
 #define IREE_TRACE_FREE(ptr) \
   ___tracy_emit_memory_free_callstack(ptr, IREE_TRACING_MAX_CALLSTACK_DEPTH, 0)
+#define IREE_TRACE_ALLOC_NAMED(name_literal, ptr, size) \
+  ___tracy_emit_memory_alloc_callstack_named(           \
+      ptr, size, IREE_TRACING_MAX_CALLSTACK_DEPTH, 0, name_literal)
+#define IREE_TRACE_FREE_NAMED(name_literal, ptr) \
+  ___tracy_emit_memory_free_callstack_named(   \
+      ptr, IREE_TRACING_MAX_CALLSTACK_DEPTH, 0, name_literal)
 
 #else
 
 #define IREE_TRACE_ALLOC(ptr, size) ___tracy_emit_memory_alloc(ptr, size, 0)
 #define IREE_TRACE_FREE(ptr) ___tracy_emit_memory_free(ptr, 0)
+#define IREE_TRACE_ALLOC_NAMED(name_literal, ptr, size) \
+  ___tracy_emit_memory_alloc_named(ptr, size, 0, name_literal)
+#define IREE_TRACE_FREE_NAMED(name_literal, ptr) \
+  ___tracy_emit_memory_free_named(ptr, 0, name_literal)
 
 #endif  // IREE_TRACING_FEATURE_ALLOCATION_CALLSTACKS
 
 #else
 #define IREE_TRACE_ALLOC(ptr, size)
 #define IREE_TRACE_FREE(ptr)
+#define IREE_TRACE_ALLOC_NAMED(name_literal, ptr, size)
+#define IREE_TRACE_FREE_NAMED(name_literal, ptr)
 #endif  // IREE_TRACING_FEATURE_ALLOCATION_TRACKING
 
 #if defined(__cplusplus) && \
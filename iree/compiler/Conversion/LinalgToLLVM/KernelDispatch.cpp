@@ -15,7 +15,13 @@
 
 #include "iree/compiler/Conversion/LinalgToLLVM/KernelDispatch.h"
 
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/ADT/Triple.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/Linalg/IR/LinalgOps.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/Operation.h"
@@ -31,6 +37,8 @@ static llvm::cl::list<unsigned> clLLVMTileSizes(
                    "LLVM code generation"),
     llvm::cl::ZeroOrMore, llvm::cl::MiscFlags::CommaSeparated);
 
+// When explicitly specified the following override the tile sizes derived from
+// the target CPU. The initial values are those derived for the generic CPU.
 static llvm::cl::opt<int> matmulWorkgroupTileSize(
     "iree-codegen-linalg-to-llvm-kernel-dispatch-matmul-workgroup-tile-size",
     llvm::cl::desc(
@@ -68,68 +76,555 @@ static llvm::cl::opt<int> batchMatmulL2TileSize(
         "linalg.matmul tile size for workgroups spliting of M, N dimension"),
     llvm::cl::init(4));
 
-struct TileOpParameters {
-  template <typename OpT, TilingLevel tilingLevel>
-  static llvm::SmallVector<int64_t, 4> getSizes(OpT op);
+static llvm::cl::list<std::string> clTileSizeOverrides(
+    "iree-codegen-linalg-to-llvm-kernel-dispatch-tile-size-override",
+    llvm::cl::desc("Tile sizes to use for ops with a specific static shape in "
+                   "the form of "
+                   "`<op name>:<loop ranges>=<workgroup>:<L1>:<L2>` such as "
+                   "`linalg.matmul:384x512x128=64x64:32x32x32:8x8x8`"),
+    llvm::cl::ZeroOrMore);
+
+static llvm::cl::opt<bool> clPrintTileSizes(
+    "iree-codegen-linalg-to-llvm-kernel-dispatch-print-tile-sizes",
+    llvm::cl::desc("Emits a remark with the tile sizes selected for each root "
+                   "operation; used to find the ops to tune"),
+    llvm::cl::init(false));
+
+// Returns the value of |option| if it was explicitly set on the command line
+// and otherwise |defaultValue|.
+static int64_t getOptionOrDefault(const llvm::cl::opt<int> &option,
+                                  int64_t defaultValue) {
+  return option.getNumOccurrences() ? option.getValue() : defaultValue;
+}
+
+//===----------------------------------------------------------------------===//
+// Target description
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+// Known CPUs along with the comma-separated vector ISA features they imply and
+// their per-core cache sizes.
+struct KnownCPU {
+  const char *name;
+  const char *features;
+  int64_t l1CacheSizeInKiB;
+  int64_t l2CacheSizeInKiB;
 };
 
-template <>
-llvm::SmallVector<int64_t, 4>
-TileOpParameters::getSizes<linalg::MatmulOp, TilingLevel::WorkGroupTiles>(
-    linalg::MatmulOp op) {
-  return {matmulWorkgroupTileSize, matmulWorkgroupTileSize};
+}  // namespace
+
+static const KnownCPU kKnownCPUs[] = {
+    {"haswell", "avx,avx2", 32, 256},
+    {"broadwell", "avx,avx2", 32, 256},
+    {"skylake", "avx,avx2", 32, 256},
+    {"skylake-avx512", "avx,avx2,avx512f", 32, 1024},
+    {"cascadelake", "avx,avx2,avx512f", 32, 1024},
+    {"cooperlake", "avx,avx2,avx512f", 32, 1024},
+    {"icelake-client", "avx,avx2,avx512f", 48, 512},
+    {"icelake-server", "avx,avx2,avx512f", 48, 1280},
+    {"tigerlake", "avx,avx2,avx512f", 48, 1280},
+    {"znver1", "avx,avx2", 32, 512},
+    {"znver2", "avx,avx2", 32, 512},
+    {"znver3", "avx,avx2", 32, 512},
+    {"cortex-a55", "neon", 32, 128},
+    {"cortex-a76", "neon", 64, 256},
+    {"cortex-a77", "neon", 64, 256},
+    {"neoverse-n1", "neon", 64, 1024},
+};
+
+CPUTargetInfo getCPUTargetInfo(StringRef targetTriple, StringRef targetCPU,
+                               StringRef targetCPUFeatures) {
+  CPUTargetInfo targetInfo;
+  if (!targetCPU.empty()) targetInfo.cpuName = targetCPU.str();
+  llvm::StringSet<> features;
+  llvm::Triple triple(targetTriple);
+  if (triple.getArch() == llvm::Triple::aarch64) features.insert("neon");
+
+  for (const auto &knownCPU : kKnownCPUs) {
+    if (targetCPU != knownCPU.name) continue;
+    SmallVector<StringRef, 4> impliedFeatures;
+    StringRef(knownCPU.features).split(impliedFeatures, ',');
+    for (auto feature : impliedFeatures) features.insert(feature);
+    targetInfo.l1CacheSizeInBytes = knownCPU.l1CacheSizeInKiB * 1024;
+    targetInfo.l2CacheSizeInBytes = knownCPU.l2CacheSizeInKiB * 1024;
+    break;
+  }
+
+  // Explicit features override those implied by the CPU.
+  SmallVector<StringRef, 16> featureList;
+  targetCPUFeatures.split(featureList, ',', /*MaxSplit=*/-1,
+                          /*KeepEmpty=*/false);
+  for (auto feature : featureList) {
+    feature = feature.trim();
+    if (feature.consume_front("+")) {
+      features.insert(feature);
+    } else if (feature.consume_front("-")) {
+      features.erase(feature);
+    }
+  }
+
+  if (features.count("avx512f")) {
+    targetInfo.vectorWidthInBytes = 64;
+    targetInfo.numVectorRegisters = 32;
+  } else if (features.count("avx2") || features.count("avx")) {
+    targetInfo.vectorWidthInBytes = 32;
+    targetInfo.numVectorRegisters = 16;
+  } else if (features.count("neon")) {
+    targetInfo.vectorWidthInBytes = 16;
+    targetInfo.numVectorRegisters = 32;
+  }
+  return targetInfo;
+}
+
+//===----------------------------------------------------------------------===//
+// Tile size overrides
+//===----------------------------------------------------------------------===//
+
+// Parses |str| as a list of `x`-separated integers no less than |minDim|.
+static Optional<SmallVector<int64_t, 4>> parseDims(StringRef str,
+                                                   int64_t minDim) {
+  SmallVector<int64_t, 4> dims;
+  if (str.empty()) return dims;
+  SmallVector<StringRef, 4> dimStrs;
+  str.split(dimStrs, 'x');
+  for (auto dimStr : dimStrs) {
+    int64_t dim = 0;
+    if (dimStr.getAsInteger(10, dim) || dim < minDim) return llvm::None;
+    dims.push_back(dim);
+  }
+  return dims;
+}
+
+Optional<TileSizeOverride> parseTileSizeOverride(StringRef str) {
+  StringRef keyStr, tileSizesStr;
+  std::tie(keyStr, tileSizesStr) = str.split('=');
+  StringRef opName, loopRangesStr;
+  std::tie(opName, loopRangesStr) = keyStr.split(':');
+  if (opName.empty() || loopRangesStr.empty() || tileSizesStr.empty()) {
+    return llvm::None;
+  }
+
+  TileSizeOverride tileSizeOverride;
+  tileSizeOverride.opName = opName.str();
+  auto loopRanges = parseDims(loopRangesStr, /*minDim=*/1);
+  if (!loopRanges) return llvm::None;
+  tileSizeOverride.loopRanges = std::move(*loopRanges);
+
+  SmallVector<StringRef, 3> levelStrs;
+  tileSizesStr.split(levelStrs, ':');
+  if (levelStrs.size() > static_cast<size_t>(TilingLevel::NumTileLevels)) {
+    return llvm::None;
+  }
+  for (auto levelStr : llvm::enumerate(levelStrs)) {
+    // A tile size of 0 leaves the dimension untiled.
+    auto tileSizes = parseDims(levelStr.value(), /*minDim=*/0);
+    if (!tileSizes) return llvm::None;
+    tileSizeOverride.tileSizes[levelStr.index()] = std::move(*tileSizes);
+  }
+  return tileSizeOverride;
 }
 
-template <>
-llvm::SmallVector<int64_t, 4>
-TileOpParameters::getSizes<linalg::MatmulOp, TilingLevel::Level1Tiles>(
-    linalg::MatmulOp op) {
-  return {matmulL1TileSize, matmulL1TileSize, matmulL1TileSize};
+std::string formatTileSizeOverride(const TileSizeOverride &tileSizeOverride) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  auto printDims = [&](ArrayRef<int64_t> dims) {
+    llvm::interleave(dims, os, "x");
+  };
+  os << tileSizeOverride.opName << ":";
+  printDims(tileSizeOverride.loopRanges);
+  os << "=";
+  llvm::interleave(tileSizeOverride.tileSizes, os, printDims, ":");
+  return os.str();
 }
 
-template <>
-llvm::SmallVector<int64_t, 4>
-TileOpParameters::getSizes<linalg::MatmulOp, TilingLevel::Level2Tiles>(
-    linalg::MatmulOp op) {
-  return {matmulL2TileSize, matmulL2TileSize, matmulL2TileSize};
+LogicalResult parseTileSizeDatabase(
+    StringRef contents, StringRef cpuName,
+    SmallVectorImpl<TileSizeOverride> &tileSizes, std::string *errorMessage) {
+  SmallVector<StringRef, 32> lines;
+  contents.split(lines, '\n');
+  for (auto line : llvm::enumerate(lines)) {
+    StringRef entry = line.value().split('#').first.trim();
+    if (entry.empty()) continue;
+    SmallVector<StringRef, 3> fields;
+    entry.split(fields, ' ', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+    Optional<TileSizeOverride> tileSizeOverride;
+    if (fields.size() == 3) tileSizeOverride = parseTileSizeOverride(fields[2]);
+    if (!tileSizeOverride) {
+      if (errorMessage) {
+        *errorMessage = "invalid tile size database entry on line " +
+                        std::to_string(line.index() + 1) + ": '" +
+                        entry.str() + "'";
+      }
+      return failure();
+    }
+    if (fields[0] != cpuName) continue;
+    tileSizeOverride->elementType = fields[1].str();
+    tileSizes.push_back(std::move(*tileSizeOverride));
+  }
+  return success();
 }
 
-template <>
-llvm::SmallVector<int64_t, 4>
-TileOpParameters::getSizes<linalg::BatchMatmulOp, TilingLevel::WorkGroupTiles>(
-    linalg::BatchMatmulOp op) {
-  return {1, batchMatmulWorkgroupTileSize, batchMatmulWorkgroupTileSize};
+LogicalResult loadTileSizeDatabase(StringRef path, CPUTargetInfo &targetInfo,
+                                   std::string *errorMessage) {
+  auto fileOrErr = llvm::MemoryBuffer::getFile(path);
+  if (!fileOrErr) {
+    if (errorMessage) {
+      *errorMessage = "cannot open tile size database '" + path.str() +
+                      "': " + fileOrErr.getError().message();
+    }
+    return failure();
+  }
+  return parseTileSizeDatabase((*fileOrErr)->getBuffer(), targetInfo.cpuName,
+                               targetInfo.tunedTileSizes, errorMessage);
 }
 
-template <>
-llvm::SmallVector<int64_t, 4>
-TileOpParameters::getSizes<linalg::BatchMatmulOp, TilingLevel::Level1Tiles>(
-    linalg::BatchMatmulOp op) {
-  return {1, batchMatmulL1TileSize, batchMatmulL1TileSize,
-          batchMatmulL1TileSize};
+namespace {
+
+// Tile size overrides parsed from the command line.
+struct CommandLineTileSizeOverrides {
+  SmallVector<TileSizeOverride, 4> tileSizeOverrides;
+  // Error for the first malformed override, if any. Malformed overrides are
+  // otherwise ignored.
+  std::string errorMessage;
+};
+
+}  // namespace
+
+static const CommandLineTileSizeOverrides &getCommandLineTileSizeOverrides() {
+  static CommandLineTileSizeOverrides overrides = [] {
+    CommandLineTileSizeOverrides overrides;
+    for (auto &str : clTileSizeOverrides) {
+      auto tileSizeOverride = parseTileSizeOverride(str);
+      if (!tileSizeOverride) {
+        if (overrides.errorMessage.empty()) {
+          overrides.errorMessage = "invalid tile size override '" + str + "'";
+        }
+        continue;
+      }
+      overrides.tileSizeOverrides.push_back(std::move(*tileSizeOverride));
+    }
+    return overrides;
+  }();
+  return overrides;
 }
 
-template <>
-llvm::SmallVector<int64_t, 4>
-TileOpParameters::getSizes<linalg::BatchMatmulOp, TilingLevel::Level2Tiles>(
-    linalg::BatchMatmulOp op) {
-  return {1, batchMatmulL2TileSize, batchMatmulL2TileSize,
-          batchMatmulL2TileSize};
+// Returns all valid tile size overrides specified on the command line.
+static ArrayRef<TileSizeOverride> getTileSizeOverrides() {
+  return getCommandLineTileSizeOverrides().tileSizeOverrides;
+}
+
+LogicalResult initTileSizes(StringRef tileSizeDatabase,
+                            CPUTargetInfo &targetInfo,
+                            std::string *errorMessage) {
+  std::string databasePath = tileSizeDatabase.empty()
+                                 ? targetInfo.tileSizeDatabase
+                                 : tileSizeDatabase.str();
+  if (!databasePath.empty() &&
+      failed(loadTileSizeDatabase(databasePath, targetInfo, errorMessage))) {
+    return failure();
+  }
+  auto &overrides = getCommandLineTileSizeOverrides();
+  if (!overrides.errorMessage.empty()) {
+    if (errorMessage) *errorMessage = overrides.errorMessage;
+    return failure();
+  }
+  return success();
+}
+
+// Returns the tile sizes in |tileSizeOverrides| for the op named |opName| with
+// |elementType| and the static |loopRanges| at |tilingLevel|, if any.
+static Optional<SmallVector<int64_t, 4>> lookupTileSizeOverride(
+    ArrayRef<TileSizeOverride> tileSizeOverrides, StringRef opName,
+    StringRef elementType, ArrayRef<int64_t> loopRanges,
+    TilingLevel tilingLevel) {
+  for (auto &tileSizeOverride : tileSizeOverrides) {
+    if (tileSizeOverride.opName != opName ||
+        (!tileSizeOverride.elementType.empty() &&
+         tileSizeOverride.elementType != elementType) ||
+        ArrayRef<int64_t>(tileSizeOverride.loopRanges) != loopRanges) {
+      continue;
+    }
+    auto &tileSizes =
+        tileSizeOverride.tileSizes[static_cast<unsigned>(tilingLevel)];
+    if (!tileSizes.empty()) return tileSizes;
+  }
+  return llvm::None;
+}
+
+//===----------------------------------------------------------------------===//
+// Tile size selection
+//===----------------------------------------------------------------------===//
+
+namespace {
+
+// Tile sizes of the M, N and K dimensions of a matmul for each tiling level.
+struct MatmulTileSizes {
+  int64_t workgroup = 1;
+  int64_t l1 = 1;
+  int64_t l1K = 1;
+  int64_t vector = 1;
+};
+
+}  // namespace
+
+// Returns the largest power of two multiple of |tileSize| whose square tiles
+// of the LHS, RHS and result with |elementByteWidth| fit in |budgetInBytes|.
+static int64_t growTileSizeToFit(int64_t tileSize, int64_t elementByteWidth,
+                                 int64_t budgetInBytes) {
+  while (3 * (2 * tileSize) * (2 * tileSize) * elementByteWidth <=
+         budgetInBytes) {
+    tileSize *= 2;
+  }
+  return tileSize;
+}
+
+// Clamps |tileSize| to the smallest power of two covering the static |dim|.
+static int64_t clampTileSizeToDim(int64_t tileSize, int64_t dim) {
+  if (ShapedType::isDynamic(dim)) return tileSize;
+  return std::min<int64_t>(tileSize, llvm::PowerOf2Ceil(dim));
+}
+
+// Derives matmul tile sizes from the target:
+//  - vector tiles fill one native vector per row while leaving registers for
+//    the LHS broadcast and RHS row alongside the accumulators.
+//  - L1 tiles are the largest whose LHS/RHS/result tiles fit in L1.
+//  - workgroup tiles are the largest whose tiles fit in a quarter of L2,
+//    leaving the rest for streaming in the K panels.
+// Tiles are clamped to the static problem size so that small ops don't pay
+// for padding or partial tiles.
+static MatmulTileSizes getMatmulTileSizes(const CPUTargetInfo &targetInfo,
+                                          Type elementType, int64_t M,
+                                          int64_t N, int64_t K) {
+  int64_t elementByteWidth =
+      elementType.isIntOrFloat()
+          ? std::max<int64_t>(1, elementType.getIntOrFloatBitWidth() / 8)
+          : 4;
+  MatmulTileSizes tileSizes;
+  tileSizes.vector =
+      std::max<int64_t>(1, targetInfo.vectorWidthInBytes / elementByteWidth);
+  while (tileSizes.vector > 1 &&
+         tileSizes.vector + 2 > targetInfo.numVectorRegisters) {
+    tileSizes.vector /= 2;
+  }
+  tileSizes.l1 = growTileSizeToFit(tileSizes.vector, elementByteWidth,
+                                   targetInfo.l1CacheSizeInBytes);
+  tileSizes.workgroup = growTileSizeToFit(tileSizes.l1, elementByteWidth,
+                                          targetInfo.l2CacheSizeInBytes / 4);
+
+  int64_t maxParallelDim = ShapedType::isDynamic(M) || ShapedType::isDynamic(N)
+                               ? ShapedType::kDynamicSize
+                               : std::max(M, N);
+  tileSizes.workgroup = clampTileSizeToDim(tileSizes.workgroup, maxParallelDim);
+  tileSizes.l1 = std::min(tileSizes.l1, tileSizes.workgroup);
+  tileSizes.l1K = clampTileSizeToDim(tileSizes.l1, K);
+  tileSizes.vector = std::min(tileSizes.vector, tileSizes.l1);
+  return tileSizes;
+}
+
+// Returns true if |op| is a 2-D convolution with an NHWC input and HWCF filter.
+static bool isConv2DOp(Operation *op) {
+  auto convOp = dyn_cast<linalg::ConvOp>(op);
+  return convOp && convOp.getNumSpatialDimensions() == 2;
+}
+
+// Returns the static loop ranges of |op| if it is a supported root op.
+static SmallVector<int64_t, 4> getLoopRanges(Operation *op) {
+  if (isConv2DOp(op)) {
+    auto convOp = cast<linalg::ConvOp>(op);
+    auto filterShape = convOp.filter().getType().cast<ShapedType>().getShape();
+    auto outputShape = convOp.output().getType().cast<ShapedType>().getShape();
+    // N, OH, OW, F, KH, KW, C
+    SmallVector<int64_t, 4> loopRanges(outputShape.begin(), outputShape.end());
+    loopRanges.append(filterShape.begin(), filterShape.end() - 1);
+    return loopRanges;
+  }
+  if (!isa<linalg::MatmulOp, linalg::BatchMatmulOp>(op)) return {};
+  auto lhsShape = op->getOperand(0).getType().cast<ShapedType>().getShape();
+  auto rhsShape = op->getOperand(1).getType().cast<ShapedType>().getShape();
+  // [B,] M, N, K
+  SmallVector<int64_t, 4> loopRanges(lhsShape.begin(), lhsShape.end() - 1);
+  loopRanges.push_back(rhsShape.back());
+  loopRanges.push_back(lhsShape.back());
+  return loopRanges;
+}
+
+static SmallVector<int64_t, 4> getMatmulTileSizesForLevel(
+    linalg::MatmulOp op, TilingLevel tilingLevel,
+    const CPUTargetInfo &targetInfo, ArrayRef<int64_t> loopRanges) {
+  auto elementType =
+      op.getOperand(0).getType().cast<ShapedType>().getElementType();
+  auto tileSizes = getMatmulTileSizes(targetInfo, elementType, loopRanges[0],
+                                      loopRanges[1], loopRanges[2]);
+  switch (tilingLevel) {
+    case TilingLevel::WorkGroupTiles: {
+      int64_t workgroup =
+          getOptionOrDefault(matmulWorkgroupTileSize, tileSizes.workgroup);
+      return {workgroup, workgroup};
+    }
+    case TilingLevel::Level1Tiles: {
+      if (matmulL1TileSize.getNumOccurrences()) {
+        return {matmulL1TileSize, matmulL1TileSize, matmulL1TileSize};
+      }
+      return {tileSizes.l1, tileSizes.l1, tileSizes.l1K};
+    }
+    case TilingLevel::Level2Tiles: {
+      int64_t vector = getOptionOrDefault(matmulL2TileSize, tileSizes.vector);
+      return {vector, vector, std::min(vector, tileSizes.l1K)};
+    }
+    default:
+      return {};
+  }
+}
+
+// Batch matmuls are additionally distributed over the batch dimension and use
+// half of the matmul workgroup and L1 tiles.
+static SmallVector<int64_t, 4> getBatchMatmulTileSizesForLevel(
+    linalg::BatchMatmulOp op, TilingLevel tilingLevel,
+    const CPUTargetInfo &targetInfo, ArrayRef<int64_t> loopRanges) {
+  auto elementType =
+      op.getOperand(0).getType().cast<ShapedType>().getElementType();
+  auto tileSizes = getMatmulTileSizes(targetInfo, elementType, loopRanges[1],
+                                      loopRanges[2], loopRanges[3]);
+  tileSizes.workgroup =
+      std::max(tileSizes.vector, std::max<int64_t>(1, tileSizes.workgroup / 2));
+  tileSizes.l1 =
+      std::max(tileSizes.vector, std::max<int64_t>(1, tileSizes.l1 / 2));
+  tileSizes.l1K = std::min(tileSizes.l1K, tileSizes.l1);
+  switch (tilingLevel) {
+    case TilingLevel::WorkGroupTiles: {
+      int64_t workgroup =
+          getOptionOrDefault(batchMatmulWorkgroupTileSize, tileSizes.workgroup);
+      return {1, workgroup, workgroup};
+    }
+    case TilingLevel::Level1Tiles: {
+      if (batchMatmulL1TileSize.getNumOccurrences()) {
+        return {1, batchMatmulL1TileSize, batchMatmulL1TileSize,
+                batchMatmulL1TileSize};
+      }
+      return {1, tileSizes.l1, tileSizes.l1, tileSizes.l1K};
+    }
+    case TilingLevel::Level2Tiles: {
+      int64_t vector =
+          getOptionOrDefault(batchMatmulL2TileSize, tileSizes.vector);
+      return {1, vector, vector, std::min(vector, tileSizes.l1K)};
+    }
+    default:
+      return {};
+  }
+}
+
+// Returns the element type of the first operand of |op| as printed in the IR,
+// such as `f32`.
+static std::string getElementTypeName(Operation *op) {
+  std::string str;
+  llvm::raw_string_ostream os(str);
+  os << op->getOperand(0).getType().cast<ShapedType>().getElementType();
+  return os.str();
+}
+
+// Returns the number of elements of the input window read to produce
+// |tileSize| outputs along a spatial dimension.
+static int64_t getConvInputWindowSize(int64_t tileSize, int64_t filterSize,
+                                      int64_t stride, int64_t dilation) {
+  return (tileSize - 1) * stride + (filterSize - 1) * dilation + 1;
+}
+
+// Derives the workgroup tiles of the OH, OW and F dimensions of a 2-D
+// convolution from the target. Output channels start at one native vector and
+// the output channel, width and height tiles are then doubled in turn while
+// the output tile, the input window it reads and the filter slice it uses fit
+// in a quarter of L2, mirroring the matmul workgroup tiles. The batch is not
+// tiled such that the remaining three parallel dimensions map to the workgroup
+// grid. Convolutions are converted to matmuls or vectorized after workgroup
+// tiling so no L1 or vector tiles are derived.
+static SmallVector<int64_t, 4> getConvTileSizesForLevel(
+    linalg::ConvOp op, TilingLevel tilingLevel,
+    const CPUTargetInfo &targetInfo, ArrayRef<int64_t> loopRanges) {
+  if (tilingLevel != TilingLevel::WorkGroupTiles) return {};
+  auto elementType = op.filter().getType().cast<ShapedType>().getElementType();
+  int64_t elementByteWidth =
+      elementType.isIntOrFloat()
+          ? std::max<int64_t>(1, elementType.getIntOrFloatBitWidth() / 8)
+          : 4;
+  int64_t OH = loopRanges[1], OW = loopRanges[2], F = loopRanges[3];
+  int64_t KH = loopRanges[4], KW = loopRanges[5], C = loopRanges[6];
+  int64_t tileH = 1, tileW = 1;
+  int64_t tileF = clampTileSizeToDim(
+      std::max<int64_t>(1, targetInfo.vectorWidthInBytes / elementByteWidth),
+      F);
+  // The working set is unknown with a dynamic filter so only the initial tiles
+  // are used.
+  if (llvm::any_of(ArrayRef<int64_t>{KH, KW, C}, ShapedType::isDynamic)) {
+    return {0, tileH, tileW, tileF};
+  }
+
+  auto fitsInBudget = [&](int64_t h, int64_t w, int64_t f) {
+    int64_t inputH = getConvInputWindowSize(h, KH, op.getStride(0),
+                                            op.getDilation(0));
+    int64_t inputW = getConvInputWindowSize(w, KW, op.getStride(1),
+                                            op.getDilation(1));
+    int64_t elementCount = h * w * f + inputH * inputW * C + KH * KW * C * f;
+    return elementCount * elementByteWidth <=
+           targetInfo.l2CacheSizeInBytes / 4;
+  };
+  bool madeChange = true;
+  while (madeChange) {
+    madeChange = false;
+    if (clampTileSizeToDim(2 * tileF, F) > tileF &&
+        fitsInBudget(tileH, tileW, 2 * tileF)) {
+      tileF *= 2;
+      madeChange = true;
+    }
+    if (clampTileSizeToDim(2 * tileW, OW) > tileW &&
+        fitsInBudget(tileH, 2 * tileW, tileF)) {
+      tileW *= 2;
+      madeChange = true;
+    }
+    if (clampTileSizeToDim(2 * tileH, OH) > tileH &&
+        fitsInBudget(2 * tileH, tileW, tileF)) {
+      tileH *= 2;
+      madeChange = true;
+    }
+  }
+  return {0, tileH, tileW, tileF};
+}
+
+static SmallVector<int64_t, 4> getOpTileSizes(Operation *op,
+                                              TilingLevel tilingLevel,
+                                              const CPUTargetInfo &targetInfo) {
+  auto loopRanges = getLoopRanges(op);
+  if (loopRanges.empty()) return {1, 1, 1};
+  // Overrides from the command line take precedence over tuned tile sizes.
+  StringRef opName = op->getName().getStringRef();
+  std::string elementType = getElementTypeName(op);
+  if (auto tileSizes =
+          lookupTileSizeOverride(getTileSizeOverrides(), opName, elementType,
+                                 loopRanges, tilingLevel)) {
+    return *tileSizes;
+  }
+  if (auto tileSizes =
+          lookupTileSizeOverride(targetInfo.tunedTileSizes, opName,
+                                 elementType, loopRanges, tilingLevel)) {
+    return *tileSizes;
+  }
+  if (auto matmulOp = dyn_cast<linalg::MatmulOp>(op)) {
+    return getMatmulTileSizesForLevel(matmulOp, tilingLevel, targetInfo,
+                                      loopRanges);
+  }
+  if (auto convOp = dyn_cast<linalg::ConvOp>(op)) {
+    return getConvTileSizesForLevel(convOp, tilingLevel, targetInfo,
+                                    loopRanges);
+  }
+  return getBatchMatmulTileSizesForLevel(cast<linalg::BatchMatmulOp>(op),
+                                         tilingLevel, targetInfo, loopRanges);
 }
 
 #define DEFINE_TILE_OP_GET_SIZES(TileLevel)                                 \
   template <>                                                               \
   llvm::SmallVector<int64_t, 4> CPUKernelDispatch::getTileSizes<TileLevel>( \
       Operation * op) const {                                               \
-    if (isa<linalg::MatmulOp>(op)) {                                        \
-      return TileOpParameters::getSizes<linalg::MatmulOp, TileLevel>(       \
-          dyn_cast<linalg::MatmulOp>(op));                                  \
-    }                                                                       \
-    if (isa<linalg::BatchMatmulOp>(op)) {                                   \
-      return TileOpParameters::getSizes<linalg::BatchMatmulOp, TileLevel>(  \
-          dyn_cast<linalg::BatchMatmulOp>(op));                             \
-    }                                                                       \
-    return {1, 1, 1};                                                       \
+    return getOpTileSizes(op, TileLevel, targetInfo);                       \
   }
 
 DEFINE_TILE_OP_GET_SIZES(TilingLevel::WorkGroupTiles)
@@ -140,7 +635,7 @@ DEFINE_TILE_OP_GET_SIZES(TilingLevel::Level2Tiles)
 #define DEFINE_TILE_SIZE_FN(TileLevel)                                     \
   template <>                                                              \
   SmallVector<Value, 4> TileSizeFn::get<TileLevel>(                        \
-      CPUKernelDispatch cpuKernelDispatch, OpBuilder & builder,            \
+      const CPUKernelDispatch &cpuKernelDispatch, OpBuilder & builder,     \
       Operation * operation) {                                             \
     auto tileSizes = cpuKernelDispatch.getTileSizes<TileLevel>(operation); \
     if (tileSizes.empty()) return {};                                      \
@@ -159,9 +654,30 @@ DEFINE_TILE_SIZE_FN(TilingLevel::Level2Tiles)
 
 #undef DEFINE_TILE_SIZE_FN
 
+// Emits a remark on |op| with the tile sizes selected for it at all levels in
+// the tile size override format. The tuning tooling uses this to find the root
+// ops and their shapes.
+static void emitTileSizesRemark(Operation *op,
+                                const CPUKernelDispatch &cpuKernelDispatch,
+                                const CPUTargetInfo &targetInfo) {
+  TileSizeOverride selected;
+  selected.opName = op->getName().getStringRef().str();
+  selected.loopRanges = getLoopRanges(op);
+  if (llvm::any_of(selected.loopRanges, ShapedType::isDynamic)) return;
+  selected.tileSizes[0] =
+      cpuKernelDispatch.getTileSizes<TilingLevel::WorkGroupTiles>(op);
+  selected.tileSizes[1] =
+      cpuKernelDispatch.getTileSizes<TilingLevel::Level1Tiles>(op);
+  selected.tileSizes[2] =
+      cpuKernelDispatch.getTileSizes<TilingLevel::Level2Tiles>(op);
+  op->emitRemark() << "selected tile sizes for '" << targetInfo.cpuName << "' "
+                   << getElementTypeName(op) << ": "
+                   << formatTileSizeOverride(selected);
+}
+
 Optional<LaunchConfig> initCPULaunchConfig(
     MLIRContext *context, const linalg::LinalgDependenceGraph &dependenceGraph,
-    ArrayRef<linalg::LinalgOp> linalgOps) {
+    ArrayRef<linalg::LinalgOp> linalgOps, const CPUTargetInfo &targetInfo) {
   LaunchConfig config;
   if (!clLLVMTileSizes.empty()) {
     SmallVector<int64_t, 3> tileSizes(clLLVMTileSizes.begin(),
@@ -172,6 +688,7 @@ Optional<LaunchConfig> initCPULaunchConfig(
     return config;
   }
 
+  CPUKernelDispatch cpuKernelDispatch(targetInfo);
   Optional<linalg::LinalgOp> rootOperation = llvm::None;
   for (auto linalgOp : linalgOps) {
 #define DISPATCH(opType)                                                     \
@@ -182,11 +699,17 @@ Optional<LaunchConfig> initCPULaunchConfig(
     }                                                                        \
     rootOperation = linalgOp;                                                \
     auto opTileSizes =                                                       \
-        TileOpParameters::getSizes<opType, TilingLevel::WorkGroupTiles>(op); \
+        cpuKernelDispatch.getTileSizes<TilingLevel::WorkGroupTiles>(op);     \
     config.setTileSizes(op, opTileSizes, 0);                                 \
+    if (clPrintTileSizes) {                                                  \
+      emitTileSizesRemark(op, cpuKernelDispatch, targetInfo);                \
+    }                                                                        \
     continue;                                                                \
   }
 
+    if (isConv2DOp(linalgOp.getOperation())) {
+      DISPATCH(linalg::ConvOp)
+    }
     DISPATCH(linalg::MatmulOp)
     DISPATCH(linalg::BatchMatmulOp)
 
@@ -12,13 +12,19 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#ifndef IREE_COMPILER_CONVERSION_LINALGTOLLVM_KERNELDISPATCH_H_
+#define IREE_COMPILER_CONVERSION_LINALGTOLLVM_KERNELDISPATCH_H_
+
 #include <cstdint>
+#include <string>
 
 #include "iree/compiler/Conversion/Common/LaunchConfig.h"
 #include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Operation.h"
 #include "mlir/IR/Value.h"
+#include "mlir/Support/LogicalResult.h"
 
 namespace mlir {
 namespace iree_compiler {
@@ -33,22 +39,106 @@ enum class TilingLevel {
   NumTileLevels = 3
 };
 
+// Tile sizes for an op with a specific static shape that take precedence over
+// those derived from the target.
+struct TileSizeOverride {
+  // Name of the op the override applies to, such as `linalg.matmul`.
+  std::string opName;
+  // Element type of the op the override applies to, such as `f32`. Applies to
+  // all element types when empty.
+  std::string elementType;
+  // Static loop ranges of the op, such as [M, N, K] for linalg.matmul or
+  // [N, OH, OW, F, KH, KW, C] for a 2-D linalg.conv.
+  llvm::SmallVector<int64_t, 4> loopRanges;
+  // Tile sizes for each TilingLevel. Empty levels use the derived tile sizes.
+  llvm::SmallVector<int64_t, 4>
+      tileSizes[static_cast<unsigned>(TilingLevel::NumTileLevels)];
+};
+
+// Parses a tile size override from |str| in the form of
+// `<op name>:<loop ranges>=<workgroup tiles>:<L1 tiles>:<L2 tiles>` with
+// dimensions separated by `x`, such as
+// `linalg.matmul:384x512x128=64x64:32x32x32:8x8x8`.
+Optional<TileSizeOverride> parseTileSizeOverride(StringRef str);
+
+// Formats |tileSizeOverride| in the form accepted by parseTileSizeOverride.
+std::string formatTileSizeOverride(const TileSizeOverride &tileSizeOverride);
+
+// Properties of the target CPU used to derive tile sizes.
+struct CPUTargetInfo {
+  // LLVM name of the CPU, such as `skylake-avx512`.
+  std::string cpuName = "generic";
+  // Width of the native vector registers in bytes.
+  int64_t vectorWidthInBytes = 16;
+  // Number of architectural vector registers.
+  int64_t numVectorRegisters = 16;
+  // Per-core data cache sizes in bytes.
+  int64_t l1CacheSizeInBytes = 32 * 1024;
+  int64_t l2CacheSizeInBytes = 256 * 1024;
+  // Tile sizes found by offline tuning on this CPU. These take precedence over
+  // the derived tile sizes but not over those specified on the command line.
+  llvm::SmallVector<TileSizeOverride, 4> tunedTileSizes;
+  // Path of a tile size database the tiling passes load the tuned tile sizes
+  // from, reporting any errors as pass failures.
+  std::string tileSizeDatabase;
+};
+
+// Returns the target info for the given LLVM target triple, CPU name (such as
+// `skylake-avx512`) and comma-separated CPU features (such as `+avx2,+fma`).
+// Unknown CPUs fall back to a conservative 128-bit SIMD target.
+CPUTargetInfo getCPUTargetInfo(StringRef targetTriple, StringRef targetCPU,
+                               StringRef targetCPUFeatures);
+
+// Parses a tile size database from |contents| and appends the entries for
+// |cpuName| to |tileSizes|. Each line of the database is of the form
+// `<cpu name> <element type> <tile size override>` and `#` starts a comment,
+// such as:
+//   skylake-avx512 f32 linalg.matmul:384x512x128=64x64:32x32x32:8x8x8  # 0.4ms
+// Returns failure and sets |errorMessage| if an entry is malformed.
+LogicalResult parseTileSizeDatabase(
+    StringRef contents, StringRef cpuName,
+    SmallVectorImpl<TileSizeOverride> &tileSizes, std::string *errorMessage);
+
+// Loads the tile size database at |path| into the tuned tile sizes of
+// |targetInfo|. Returns failure and sets |errorMessage| if the file cannot be
+// read or is malformed.
+LogicalResult loadTileSizeDatabase(StringRef path, CPUTargetInfo &targetInfo,
+                                   std::string *errorMessage);
+
+// Loads the tuned tile sizes of |targetInfo| from |tileSizeDatabase|, or from
+// its own database if empty, and verifies the tile size overrides specified on
+// the command line. Returns failure and sets |errorMessage| if either is
+// malformed.
+LogicalResult initTileSizes(StringRef tileSizeDatabase,
+                            CPUTargetInfo &targetInfo,
+                            std::string *errorMessage);
+
+// Selects tile sizes for ops based on |targetInfo|, which must outlive the
+// dispatcher.
 class CPUKernelDispatch {
  public:
+  explicit CPUKernelDispatch(const CPUTargetInfo &targetInfo)
+      : targetInfo(targetInfo) {}
+
   template <TilingLevel tilingLevel>
   llvm::SmallVector<int64_t, 4> getTileSizes(Operation *op) const;
+
+ private:
+  const CPUTargetInfo &targetInfo;
 };
 
 struct TileSizeFn {
   template <TilingLevel tilingLevel>
-  static llvm::SmallVector<Value, 4> get(CPUKernelDispatch cpuKernelDispatch,
-                                         OpBuilder &builder,
-                                         Operation *operation);
+  static llvm::SmallVector<Value, 4> get(
+      const CPUKernelDispatch &cpuKernelDispatch, OpBuilder &builder,
+      Operation *operation);
 };
 
 Optional<LaunchConfig> initCPULaunchConfig(
     MLIRContext *context, const linalg::LinalgDependenceGraph &dependenceGraph,
-    ArrayRef<linalg::LinalgOp> linalgOps);
+    ArrayRef<linalg::LinalgOp> linalgOps, const CPUTargetInfo &targetInfo);
 
 }  // namespace iree_compiler
 }  // namespace mlir
+
+#endif  // IREE_COMPILER_CONVERSION_LINALGTOLLVM_KERNELDISPATCH_H_
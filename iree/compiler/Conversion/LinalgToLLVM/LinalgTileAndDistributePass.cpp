@@ -40,9 +40,34 @@ struct LinalgTileAndDistributePass
     registry.insert<linalg::LinalgDialect, IREE::HAL::HALDialect, AffineDialect,
                     scf::SCFDialect>();
   }
-  LinalgTileAndDistributePass() = default;
-  LinalgTileAndDistributePass(const LinalgTileAndDistributePass &pass) {}
+  explicit LinalgTileAndDistributePass(const CPUTargetInfo &targetInfo)
+      : targetInfo(targetInfo) {}
+  LinalgTileAndDistributePass(const LinalgTileAndDistributePass &pass)
+      : targetInfo(pass.targetInfo) {}
   void runOnOperation() override;
+
+ private:
+  LogicalResult initPassTargetInfo(std::string *errorMessage);
+
+  CPUTargetInfo targetInfo;
+  // Target info with the tuned tile sizes loaded. Initialized on first use so
+  // that the tile size database is read once per pass instance rather than for
+  // every module the pass runs on.
+  Optional<CPUTargetInfo> passTargetInfo;
+
+  Option<std::string> targetTriple{
+      *this, "target-triple",
+      llvm::cl::desc("LLVM target triple used to derive tile sizes")};
+  Option<std::string> targetCPU{
+      *this, "target-cpu",
+      llvm::cl::desc("LLVM target CPU used to derive tile sizes")};
+  Option<std::string> targetCPUFeatures{
+      *this, "target-cpu-features",
+      llvm::cl::desc("LLVM target CPU features used to derive tile sizes")};
+  Option<std::string> tileSizeDatabase{
+      *this, "tile-size-database",
+      llvm::cl::desc("Tile size database with tuned tile sizes for the target "
+                     "CPU")};
 };
 }  // namespace
 
@@ -74,10 +99,32 @@ Optional<Value> allocateThreadLocalMemory(OpBuilder &b, SubViewOp subview,
   return buffer;
 }
 
+LogicalResult LinalgTileAndDistributePass::initPassTargetInfo(
+    std::string *errorMessage) {
+  if (passTargetInfo) return success();
+  // Target options specified on the pass take precedence over the target the
+  // pass was constructed with.
+  CPUTargetInfo newTargetInfo =
+      targetTriple.empty() && targetCPU.empty() && targetCPUFeatures.empty()
+          ? targetInfo
+          : getCPUTargetInfo(targetTriple, targetCPU, targetCPUFeatures);
+  if (failed(initTileSizes(tileSizeDatabase, newTargetInfo, errorMessage))) {
+    return failure();
+  }
+  passTargetInfo = std::move(newTargetInfo);
+  return success();
+}
+
 void LinalgTileAndDistributePass::runOnOperation() {
   MLIRContext *context = &getContext();
   ModuleOp module = getOperation();
 
+  std::string errorMessage;
+  if (failed(initPassTargetInfo(&errorMessage))) {
+    module.emitError(errorMessage);
+    return signalPassFailure();
+  }
+
   for (FuncOp funcOp : module.getOps<FuncOp>()) {
     if (!isEntryPoint(funcOp)) continue;
 
@@ -89,7 +136,8 @@ void LinalgTileAndDistributePass::runOnOperation() {
     linalg::Aliases aliases;
     linalg::LinalgDependenceGraph dependenceGraph(aliases, linalgOps);
     Optional<LaunchConfig> launchConfigOpt =
-        initCPULaunchConfig(context, dependenceGraph, linalgOps);
+        initCPULaunchConfig(context, dependenceGraph, linalgOps,
+                            *passTargetInfo);
     if (!launchConfigOpt) {
       funcOp.emitError("unable to find launch configuration");
       return signalPassFailure();
@@ -163,14 +211,16 @@ void LinalgTileAndDistributePass::runOnOperation() {
   }
 }
 
-std::unique_ptr<OperationPass<ModuleOp>> createLinalgTileAndDistributePass() {
-  return std::make_unique<LinalgTileAndDistributePass>();
+std::unique_ptr<OperationPass<ModuleOp>> createLinalgTileAndDistributePass(
+    const CPUTargetInfo &targetInfo) {
+  return std::make_unique<LinalgTileAndDistributePass>(targetInfo);
 }
 
 static PassRegistration<LinalgTileAndDistributePass> pass(
     "iree-codegen-llvm-linalg-tile-and-distribute",
-    "Tile and distribute Linalg operations on buffers",
-    [] { return std::make_unique<LinalgTileAndDistributePass>(); });
+    "Tile and distribute Linalg operations on buffers", [] {
+      return std::make_unique<LinalgTileAndDistributePass>(CPUTargetInfo());
+    });
 
 }  // namespace iree_compiler
 }  // namespace mlir
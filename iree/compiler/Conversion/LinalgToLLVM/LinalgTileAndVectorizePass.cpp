@@ -53,18 +53,65 @@ struct TileWorkgroups : public linalg::LinalgBaseTilingPattern {
 namespace {
 struct TileAndVectorizeWorkgroups
     : public PassWrapper<TileAndVectorizeWorkgroups, FunctionPass> {
+  explicit TileAndVectorizeWorkgroups(const CPUTargetInfo &targetInfo)
+      : targetInfo(targetInfo) {}
+  TileAndVectorizeWorkgroups(const TileAndVectorizeWorkgroups &pass)
+      : targetInfo(pass.targetInfo) {}
   void getDependentDialects(DialectRegistry &registry) const override {
     registry.insert<linalg::LinalgDialect, AffineDialect, scf::SCFDialect,
                     vector::VectorDialect>();
   }
   void runOnFunction() override;
+
+ private:
+  LogicalResult initPassTargetInfo(std::string *errorMessage);
+
+  CPUTargetInfo targetInfo;
+  // Target info with the tuned tile sizes loaded. Initialized on first use so
+  // that the tile size database is read once per pass instance.
+  Optional<CPUTargetInfo> passTargetInfo;
+
+  Option<std::string> targetTriple{
+      *this, "target-triple",
+      llvm::cl::desc("LLVM target triple used to derive tile sizes")};
+  Option<std::string> targetCPU{
+      *this, "target-cpu",
+      llvm::cl::desc("LLVM target CPU used to derive tile sizes")};
+  Option<std::string> targetCPUFeatures{
+      *this, "target-cpu-features",
+      llvm::cl::desc("LLVM target CPU features used to derive tile sizes")};
+  Option<std::string> tileSizeDatabase{
+      *this, "tile-size-database",
+      llvm::cl::desc("Tile size database with tuned tile sizes for the target "
+                     "CPU")};
 };
 }  // namespace
 
+LogicalResult TileAndVectorizeWorkgroups::initPassTargetInfo(
+    std::string *errorMessage) {
+  if (passTargetInfo) return success();
+  // Target options specified on the pass take precedence over the target the
+  // pass was constructed with.
+  CPUTargetInfo newTargetInfo =
+      targetTriple.empty() && targetCPU.empty() && targetCPUFeatures.empty()
+          ? targetInfo
+          : getCPUTargetInfo(targetTriple, targetCPU, targetCPUFeatures);
+  if (failed(initTileSizes(tileSizeDatabase, newTargetInfo, errorMessage))) {
+    return failure();
+  }
+  passTargetInfo = std::move(newTargetInfo);
+  return success();
+}
+
 void TileAndVectorizeWorkgroups::runOnFunction() {
   auto funcOp = getOperation();
   MLIRContext *context = &getContext();
-  CPUKernelDispatch cpuKernelDispatch;
+  std::string errorMessage;
+  if (failed(initPassTargetInfo(&errorMessage))) {
+    funcOp.emitError(errorMessage);
+    return signalPassFailure();
+  }
+  CPUKernelDispatch cpuKernelDispatch(*passTargetInfo);
 
   // Workgroup first level of tiling.
   {
@@ -161,14 +208,16 @@ void TileAndVectorizeWorkgroups::runOnFunction() {
   }
 }
 
-std::unique_ptr<FunctionPass> createLinalgTileAndVectorizeWorkgroupsPass() {
-  return std::make_unique<TileAndVectorizeWorkgroups>();
+std::unique_ptr<FunctionPass> createLinalgTileAndVectorizeWorkgroupsPass(
+    const CPUTargetInfo &targetInfo) {
+  return std::make_unique<TileAndVectorizeWorkgroups>(targetInfo);
 }
 
 static PassRegistration<TileAndVectorizeWorkgroups> pass(
     "iree-codegen-linalg-to-llvm-workgroups-vectorization-pass",
-    "Tile and vectorize llvm workgroups",
-    [] { return std::make_unique<TileAndVectorizeWorkgroups>(); });
+    "Tile and vectorize llvm workgroups", [] {
+      return std::make_unique<TileAndVectorizeWorkgroups>(CPUTargetInfo());
+    });
 
 }  // namespace iree_compiler
 }  // namespace mlir
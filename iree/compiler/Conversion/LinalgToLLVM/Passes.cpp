@@ -46,10 +46,11 @@ static llvm::cl::opt<bool> fastExpConversion(
                    "polynomial approximation."),
     llvm::cl::init(false));
 
-void addLinalgToLLVMPasses(OpPassManager &passManager) {
+void addLinalgToLLVMPasses(OpPassManager &passManager,
+                           const CPUTargetInfo &targetInfo) {
   // Distribute linalg op among a 3d grid of parallel threads. Tile each
   // workgroup thread memory then vectorize the linalg op.
-  passManager.addPass(createLinalgTileAndDistributePass());
+  passManager.addPass(createLinalgTileAndDistributePass(targetInfo));
   if (!clEnableLLVMLinalgOnTensors) {
     passManager.addPass(createLegalizeNumWorkgroupsFnPass());
   }
@@ -61,7 +62,7 @@ void addLinalgToLLVMPasses(OpPassManager &passManager) {
   }
 
   passManager.addNestedPass<FuncOp>(
-      createLinalgTileAndVectorizeWorkgroupsPass());
+      createLinalgTileAndVectorizeWorkgroupsPass(targetInfo));
   passManager.addNestedPass<FuncOp>(createPlanConvLoopOrderPass());
 
   // Linalg -> SCF
@@ -90,7 +91,8 @@ void addLinalgToLLVMPasses(OpPassManager &passManager) {
   }
 }
 
-void buildLLVMTransformPassPipeline(OpPassManager &passManager) {
+void buildLLVMTransformPassPipeline(OpPassManager &passManager,
+                                    const CPUTargetInfo &targetInfo) {
   if (!clEnableLLVMLinalgOnTensors)
     passManager.addPass(createDeclareNumWorkgroupsFnPass());
 
@@ -120,21 +122,21 @@ void buildLLVMTransformPassPipeline(OpPassManager &passManager) {
     addHLOToLinalgOnBuffersPasses(passManager);
   }
   // Linalg -> LLVM passes.
-  addLinalgToLLVMPasses(passManager);
+  addLinalgToLLVMPasses(passManager, targetInfo);
 }
 
 static PassPipelineRegistration<> linalgLLVMVPipeline(
     "iree-codegen-linalg-to-llvm-pipeline",
     "Runs the progressive lowering pipeline from Linalg to LLVM",
     [](OpPassManager &passManager) {
-      buildLLVMTransformPassPipeline(passManager);
+      buildLLVMTransformPassPipeline(passManager, CPUTargetInfo());
     });
 
 static PassPipelineRegistration<> hloToLinalgLLVMVPipeline(
     "iree-codegen-hlo-to-llvm-pipeline",
     "Runs the progressive lowering pipeline from XLA HLO to Linalg to LLVM",
     [](OpPassManager &passManager) {
-      buildLLVMTransformPassPipeline(passManager);
+      buildLLVMTransformPassPipeline(passManager, CPUTargetInfo());
     });
 
 }  // namespace iree_compiler
@@ -15,6 +15,7 @@
 #ifndef IREE_COMPILER_CONVERSION_LINALGTOLLVM_PASSES_H_
 #define IREE_COMPILER_CONVERSION_LINALGTOLLVM_PASSES_H_
 
+#include "iree/compiler/Conversion/LinalgToLLVM/KernelDispatch.h"
 #include "mlir/Pass/Pass.h"
 
 namespace mlir {
@@ -28,11 +29,15 @@ std::unique_ptr<FunctionPass> createConvImg2ColMatmulConversionPass();
 /// order.
 std::unique_ptr<FunctionPass> createPlanConvLoopOrderPass();
 
-/// Distributes linalg ops among hal.interface.workgroup logical threads.
-std::unique_ptr<OperationPass<ModuleOp>> createLinalgTileAndDistributePass();
+/// Distributes linalg ops among hal.interface.workgroup logical threads using
+/// workgroup tile sizes derived from |targetInfo|.
+std::unique_ptr<OperationPass<ModuleOp>> createLinalgTileAndDistributePass(
+    const CPUTargetInfo &targetInfo);
 
-/// Vectorizes linalg ops executed in the same hal.interface.workgroup.
-std::unique_ptr<FunctionPass> createLinalgTileAndVectorizeWorkgroupsPass();
+/// Vectorizes linalg ops executed in the same hal.interface.workgroup using
+/// tile sizes derived from |targetInfo|.
+std::unique_ptr<FunctionPass> createLinalgTileAndVectorizeWorkgroupsPass(
+    const CPUTargetInfo &targetInfo);
 
 std::unique_ptr<OperationPass<ModuleOp>>
 createFastExpApproximationConversionPass();
@@ -65,8 +70,10 @@ std::unique_ptr<OperationPass<FuncOp>> createLinalgLLVMBufferizePass();
 
 /// Populates passes needed to lower a XLA HLO op to LLVM dialect via the
 /// structured ops path. The pass manager `pm` in here should operate on the
-/// module within the IREE::HAL::ExecutableOp.
-void buildLLVMTransformPassPipeline(OpPassManager &passManager);
+/// module within the IREE::HAL::ExecutableOp. Codegen is specialized for the
+/// CPU described by |targetInfo|.
+void buildLLVMTransformPassPipeline(OpPassManager &passManager,
+                                    const CPUTargetInfo &targetInfo);
 
 }  // namespace iree_compiler
 }  // namespace mlir
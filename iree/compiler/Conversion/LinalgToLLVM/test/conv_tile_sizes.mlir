@@ -0,0 +1,18 @@
+// RUN: iree-opt -split-input-file -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=haswell" -iree-codegen-linalg-to-llvm-kernel-dispatch-print-tile-sizes -verify-diagnostics %s -o /dev/null
+
+// Convolution workgroup tiles grow the output channel, width and height tiles
+// until the working set fills a quarter of L2 and leave the batch untiled.
+func @conv_1x112x112x64(%filter: memref<3x3x32x64xf32>, %input: memref<1x114x114x32xf32>, %output: memref<1x112x112x64xf32>) {
+  // expected-remark @+1 {{selected tile sizes for 'haswell' f32: linalg.conv:1x112x112x64x3x3x32=0x8x8x32::}}
+  linalg.conv(%filter, %input, %output) : memref<3x3x32x64xf32>, memref<1x114x114x32xf32>, memref<1x112x112x64xf32>
+  return
+}
+
+// -----
+
+// Convolution workgroup tiles are clamped to small static problem sizes.
+func @conv_1x4x4x8(%filter: memref<3x3x4x8xf32>, %input: memref<1x6x6x4xf32>, %output: memref<1x4x4x8xf32>) {
+  // expected-remark @+1 {{selected tile sizes for 'haswell' f32: linalg.conv:1x4x4x8x3x3x4=0x4x4x8::}}
+  linalg.conv(%filter, %input, %output) : memref<3x3x4x8xf32>, memref<1x6x6x4xf32>, memref<1x4x4x8xf32>
+  return
+}
@@ -0,0 +1,76 @@
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass -split-input-file %s | IreeFileCheck %s --check-prefix=GENERIC
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=haswell" -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass="target-cpu=haswell" -split-input-file %s | IreeFileCheck %s --check-prefix=AVX2
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=skylake-avx512" -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass="target-cpu=skylake-avx512" -split-input-file %s | IreeFileCheck %s --check-prefix=AVX512
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=icelake-server" -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass="target-cpu=icelake-server" -split-input-file %s | IreeFileCheck %s --check-prefix=ICELAKE
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=skylake-avx512 target-cpu-features=-avx512f" -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass="target-cpu=skylake-avx512 target-cpu-features=-avx512f" -split-input-file %s | IreeFileCheck %s --check-prefix=NOAVX512
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-triple=aarch64-none-linux-android target-cpu=cortex-a76" -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass="target-triple=aarch64-none-linux-android target-cpu=cortex-a76" -split-input-file %s | IreeFileCheck %s --check-prefix=A76
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=haswell" -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass="target-cpu=haswell" -iree-codegen-linalg-to-llvm-kernel-dispatch-tile-size-override=linalg.matmul:512x512x512=128x128:64x64x64:16x16x16 -split-input-file %s | IreeFileCheck %s --check-prefix=OVERRIDE
+
+func @matmul_512x512x512(%arg0 : memref<512x512xf32>, %arg1: memref<512x512xf32>, %arg2: memref<512x512xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<512x512xf32>, memref<512x512xf32>) outs(%arg2 : memref<512x512xf32>)
+  return
+}
+// Workgroup tiles bound the L1 loops, L1 tiles bound the vector loops.
+// GENERIC-LABEL: func @matmul_512x512x512
+//       GENERIC:   scf.for {{.*}} = %c0 to %c64 step %c32 {
+//       GENERIC:     scf.for {{.*}} = %c0 to %c64 step %c32 {
+//       GENERIC:       scf.for {{.*}} = %c0 to %c512 step %c32 {
+//       GENERIC:         scf.for {{.*}} = %c0 to %c32 step %c4 {
+//       GENERIC:           scf.for {{.*}} = %c0 to %c32 step %c4 {
+
+// AVX2-LABEL: func @matmul_512x512x512
+//       AVX2:   scf.for {{.*}} = %c0 to %c64 step %c32 {
+//       AVX2:     scf.for {{.*}} = %c0 to %c64 step %c32 {
+//       AVX2:       scf.for {{.*}} = %c0 to %c512 step %c32 {
+//       AVX2:         scf.for {{.*}} = %c0 to %c32 step %c8 {
+//       AVX2:           scf.for {{.*}} = %c0 to %c32 step %c8 {
+
+// AVX512-LABEL: func @matmul_512x512x512
+//       AVX512:   scf.for {{.*}} = %c0 to %c128 step %c32 {
+//       AVX512:     scf.for {{.*}} = %c0 to %c128 step %c32 {
+//       AVX512:       scf.for {{.*}} = %c0 to %c512 step %c32 {
+//       AVX512:         scf.for {{.*}} = %c0 to %c32 step %c16 {
+//       AVX512:           scf.for {{.*}} = %c0 to %c32 step %c16 {
+
+// ICELAKE-LABEL: func @matmul_512x512x512
+//       ICELAKE:   scf.for {{.*}} = %c0 to %c128 step %c64 {
+//       ICELAKE:     scf.for {{.*}} = %c0 to %c128 step %c64 {
+//       ICELAKE:       scf.for {{.*}} = %c0 to %c512 step %c64 {
+//       ICELAKE:         scf.for {{.*}} = %c0 to %c64 step %c16 {
+//       ICELAKE:           scf.for {{.*}} = %c0 to %c64 step %c16 {
+
+// Disabling AVX-512 falls back to 256-bit vectors but keeps the cache sizes.
+// NOAVX512-LABEL: func @matmul_512x512x512
+//       NOAVX512:   scf.for {{.*}} = %c0 to %c128 step %c32 {
+//       NOAVX512:     scf.for {{.*}} = %c0 to %c128 step %c32 {
+//       NOAVX512:       scf.for {{.*}} = %c0 to %c512 step %c32 {
+//       NOAVX512:         scf.for {{.*}} = %c0 to %c32 step %c8 {
+//       NOAVX512:           scf.for {{.*}} = %c0 to %c32 step %c8 {
+
+// A76-LABEL: func @matmul_512x512x512
+//       A76:   scf.for {{.*}} = %c0 to %c64 step %c64 {
+//       A76:     scf.for {{.*}} = %c0 to %c64 step %c64 {
+//       A76:       scf.for {{.*}} = %c0 to %c512 step %c64 {
+//       A76:         scf.for {{.*}} = %c0 to %c64 step %c4 {
+//       A76:           scf.for {{.*}} = %c0 to %c64 step %c4 {
+
+// OVERRIDE-LABEL: func @matmul_512x512x512
+//       OVERRIDE:   scf.for {{.*}} = %c0 to %c128 step %c64 {
+//       OVERRIDE:     scf.for {{.*}} = %c0 to %c128 step %c64 {
+//       OVERRIDE:       scf.for {{.*}} = %c0 to %c512 step %c64 {
+//       OVERRIDE:         scf.for {{.*}} = %c0 to %c64 step %c16 {
+//       OVERRIDE:           scf.for {{.*}} = %c0 to %c64 step %c16 {
+
+// -----
+
+// Workgroup tiles are clamped to small static problem sizes.
+func @matmul_64x64x512(%arg0 : memref<64x512xf32>, %arg1: memref<512x64xf32>, %arg2: memref<64x64xf32>) {
+  linalg.matmul ins(%arg0, %arg1 : memref<64x512xf32>, memref<512x64xf32>) outs(%arg2 : memref<64x64xf32>)
+  return
+}
+// AVX512-LABEL: func @matmul_64x64x512
+//       AVX512:   scf.for {{.*}} = %c0 to %c64 step %c32 {
+//       AVX512:     scf.for {{.*}} = %c0 to %c64 step %c32 {
+//       AVX512:       scf.for {{.*}} = %c0 to %c512 step %c32 {
+//       AVX512:         scf.for {{.*}} = %c0 to %c32 step %c16 {
+//       AVX512:           scf.for {{.*}} = %c0 to %c32 step %c16 {
@@ -0,0 +1,19 @@
+// RUN: printf "# cpu element type tile size override\nhaswell i32 linalg.matmul:512x512x512=32x32:32x32x32:8x8x8\nhaswell f32 linalg.matmul:512x512x512=128x128:64x64x64:16x16x16  # 1.2 ms\nskylake f32 linalg.matmul:512x512x512=16x16:16x16x16:4x4x4\n" > %t && iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=haswell tile-size-database=%t" -iree-codegen-linalg-to-llvm-workgroups-vectorization-pass="target-cpu=haswell tile-size-database=%t" %s | IreeFileCheck %s
+// RUN: printf "haswell linalg.matmul:512x512x512=16x16:16x16x16:4x4x4\n" > %t && (iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=haswell tile-size-database=%t" %s -o /dev/null 2>&1 || true) | IreeFileCheck %s --check-prefix=INVALID
+// RUN: iree-opt -iree-codegen-llvm-linalg-tile-and-distribute="target-cpu=haswell" -iree-codegen-linalg-to-llvm-kernel-dispatch-print-tile-sizes -verify-diagnostics %s -o /dev/null
+
+// Tuned tile sizes for the target CPU and element type are used over the
+// derived ones, and entries for other CPUs or element types are ignored.
+// Malformed databases are reported as errors.
+// INVALID: invalid tile size database entry on line 1: 'haswell linalg.matmul:512x512x512=16x16:16x16x16:4x4x4'
+func @matmul_512x512x512(%arg0 : memref<512x512xf32>, %arg1: memref<512x512xf32>, %arg2: memref<512x512xf32>) {
+  // expected-remark @+1 {{selected tile sizes for 'haswell' f32: linalg.matmul:512x512x512=64x64:32x32x32:8x8x8}}
+  linalg.matmul ins(%arg0, %arg1 : memref<512x512xf32>, memref<512x512xf32>) outs(%arg2 : memref<512x512xf32>)
+  return
+}
+// CHECK-LABEL: func @matmul_512x512x512
+//       CHECK:   scf.for {{.*}} = %c0 to %c128 step %c64 {
+//       CHECK:     scf.for {{.*}} = %c0 to %c128 step %c64 {
+//       CHECK:       scf.for {{.*}} = %c0 to %c512 step %c64 {
+//       CHECK:         scf.for {{.*}} = %c0 to %c64 step %c16 {
+//       CHECK:           scf.for {{.*}} = %c0 to %c64 step %c16 {
@@ -67,9 +67,9 @@ inline void registerLinalgToLLVMPasses() {
     createConvImg2ColMatmulConversionPass();
     createLinalgLLVMBufferizePass();
     createLinalgRewriteDestructiveUpdatesPass();
-    createLinalgTileAndDistributePass();
+    createLinalgTileAndDistributePass(CPUTargetInfo());
     createLinalgTileAndDistributeOnTensorsPass();
-    createLinalgTileAndVectorizeWorkgroupsPass();
+    createLinalgTileAndVectorizeWorkgroupsPass(CPUTargetInfo());
     return true;
   }();
   (void)init_once;
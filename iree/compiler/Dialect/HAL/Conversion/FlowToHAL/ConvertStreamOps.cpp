@@ -23,6 +23,7 @@
 #include "iree/compiler/Dialect/IREE/IR/IREETypes.h"
 #include "iree/compiler/Dialect/Shape/IR/ShapeOps.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/StandardOps/IR/Ops.h"
 #include "mlir/IR/Attributes.h"
@@ -66,6 +67,64 @@ static bool isNoOp(Operation *op) { return isa<Shape::MakeRankedShapeOp>(op); }
 // identity.
 static bool isIdentityOp(Operation *op) { return isa<Shape::TieShapeOp>(op); }
 
+// Returns true if the buffer passed in to the stream for |streamArg| may be
+// clobbered by the stream. The external operand must be the result of a prior
+// stream (so that its buffer is not owned by a caller or variable) and the
+// stream must be its last use such that no later op can observe the change.
+static bool isStreamOperandDead(BlockArgument streamArg) {
+  auto streamOp = dyn_cast_or_null<IREE::Flow::ExStreamFragmentOp>(
+      streamArg.getOwner()->getParentOp());
+  if (!streamOp) return false;
+  Value externalValue = streamOp.getOperand(streamArg.getArgNumber());
+  if (!externalValue.getDefiningOp<IREE::Flow::ExStreamFragmentOp>()) {
+    return false;
+  }
+  for (auto &use : externalValue.getUses()) {
+    auto *user = use.getOwner();
+    if (user == streamOp.getOperation()) {
+      // Passing the same value in as multiple operands would alias them.
+      if (use.getOperandNumber() != streamArg.getArgNumber()) return false;
+      continue;
+    }
+    if (user->getBlock() != streamOp->getBlock() ||
+        !user->isBeforeInBlock(streamOp)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns true if |updateOp| can write its update directly into the buffer of
+// its target. This requires that the update is the only use of the target
+// (including through identity ops) such that no other op can observe the
+// target contents being clobbered. The target must either be produced within
+// the stream or be a stream operand whose external value dies at the stream.
+static bool isInPlaceUpdate(IREE::Flow::TensorUpdateOp updateOp) {
+  Value value = updateOp.target();
+  while (true) {
+    if (!value.hasOneUse()) return false;
+    if (auto streamArg = value.dyn_cast<BlockArgument>()) {
+      return isStreamOperandDead(streamArg);
+    }
+    auto *definingOp = value.getDefiningOp();
+    if (!definingOp || isNoOp(definingOp)) return false;
+    if (!isIdentityOp(definingOp)) break;
+    value = definingOp->getOperand(0);
+  }
+  return true;
+}
+
+// Returns the operand whose buffer the first result of |op| aliases, if any.
+// Identity ops alias their first operand and in-place updates alias their
+// target.
+static Value getAliasedOperand(Operation *op) {
+  if (isIdentityOp(op)) return op->getOperand(0);
+  if (auto updateOp = dyn_cast<IREE::Flow::TensorUpdateOp>(op)) {
+    if (isInPlaceUpdate(updateOp)) return updateOp.target();
+  }
+  return {};
+}
+
 // Allocates a buffer for the given stream output value.
 // |streamValue| is the Value used within the stream region and
 // |externalValue| is the returned value from the stream region in the parent
@@ -105,6 +164,22 @@ static Value allocateOutputBuffer(Value streamValue, Value externalValue,
   return buffer;
 }
 
+// Returns the buffer of the stream operand that |streamValue| was produced
+// from by in-place updates (and identity ops), if any.
+static Value findInPlaceOperandBuffer(Value streamValue,
+                                      const BufferSet &bufferSet) {
+  bool hasInPlaceUpdate = false;
+  Value value = streamValue;
+  while (auto *definingOp = value.getDefiningOp()) {
+    auto operand = getAliasedOperand(definingOp);
+    if (!operand) return {};
+    hasInPlaceUpdate |= isa<IREE::Flow::TensorUpdateOp>(definingOp);
+    value = operand;
+  }
+  if (!hasInPlaceUpdate) return {};
+  return bufferSet.rangeMap.lookup(value).buffer;
+}
+
 // Allocates all output buffers for the stream and populates the |bufferSet|
 // with the new mappings.
 static void allocateOutputBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
@@ -115,8 +190,13 @@ static void allocateOutputBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
   for (auto result : llvm::enumerate(streamOp.getResults())) {
     auto streamValue = returnOp.getOperand(result.index());
     auto externalValue = result.value();
-    auto buffer = allocateOutputBuffer(streamValue, externalValue,
-                                       bufferSet.allocator, rewriter);
+    // Outputs produced by in-place updates of stream operands reuse the
+    // operand buffer; otherwise a new buffer is allocated.
+    auto buffer = findInPlaceOperandBuffer(streamValue, bufferSet);
+    if (!buffer) {
+      buffer = allocateOutputBuffer(streamValue, externalValue,
+                                    bufferSet.allocator, rewriter);
+    }
     auto bufferRange = BufferRange{buffer};
     bufferSet.rangeMap[externalValue] = bufferRange;
     bufferSet.rangeMap[streamValue] = bufferRange;
@@ -124,16 +204,41 @@ static void allocateOutputBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
   }
 }
 
-// Allocates a transient buffer for use entirely within the command buffer.
-static Value allocateTransientBuffer(Value streamValue, Value allocator,
-                                     ConversionPatternRewriter &rewriter) {
-  Location loc = streamValue.getLoc();
+// A transient value produced and consumed entirely within a stream that has a
+// static size and can be packed into the shared transient slab.
+struct TransientValue {
+  Value value = nullptr;
+  // Inclusive range of op ordinals within the stream block over which the
+  // value must remain live.
+  int64_t liveStart = 0;
+  int64_t liveEnd = 0;
+  // Static byte size of the value storage.
+  uint64_t byteSize = 0;
+  // Byte offset of the value within the transient slab once packed.
+  uint64_t slabOffset = 0;
+};
+
+// Allocates transient storage of |allocationSize| bytes for use entirely within
+// the command buffer.
+static Value allocateTransientStorage(Location loc, Value allocator,
+                                      Value allocationSize,
+                                      ConversionPatternRewriter &rewriter) {
   // TODO(benvanik): compute from SSA use-def chain uses.
   IREE::HAL::MemoryTypeBitfield memoryTypes =
       IREE::HAL::MemoryTypeBitfield::DeviceLocal;
   IREE::HAL::BufferUsageBitfield bufferUsage =
       IREE::HAL::BufferUsageBitfield::Dispatch |
       IREE::HAL::BufferUsageBitfield::Transfer;
+  return rewriter
+      .create<IREE::HAL::AllocatorAllocateOp>(loc, allocator, memoryTypes,
+                                              bufferUsage, allocationSize)
+      .getResult();
+}
+
+// Allocates a transient buffer for use entirely within the command buffer.
+static Value allocateTransientBuffer(Value streamValue, Value allocator,
+                                     ConversionPatternRewriter &rewriter) {
+  Location loc = streamValue.getLoc();
 
   // Compute the allocation size for the value.
   auto elementType = IREE::HAL::getElementTypeValue(
@@ -150,13 +255,173 @@ static Value allocateTransientBuffer(Value streamValue, Value allocator,
                                 loc, allocator, *shape, elementType.getValue())
                             .getResult();
 
-  auto buffer =
-      rewriter
-          .create<IREE::HAL::AllocatorAllocateOp>(loc, allocator, memoryTypes,
-                                                  bufferUsage, allocationSize)
-          .getResult();
+  return allocateTransientStorage(loc, allocator, allocationSize, rewriter);
+}
 
-  return buffer;
+// Returns the byte size of |streamValue| if it can be computed statically.
+// This matches the size computed by hal.allocator.compute_size.
+static Optional<uint64_t> computeStaticByteSize(Value streamValue) {
+  auto shapedType = streamValue.getType().cast<ShapedType>();
+  if (!shapedType.hasStaticShape() ||
+      !IREE::HAL::getElementTypeValue(shapedType.getElementType())) {
+    return llvm::None;
+  }
+  return shapedType.getNumElements() *
+         IREE::HAL::getRoundedElementByteWidth(shapedType.getElementType());
+}
+
+// Returns the ordinal of the last op in the stream that uses |streamValue|,
+// either directly or through ops that alias its buffer.
+static int64_t findLastUseOrdinal(
+    Value streamValue, int64_t defOrdinal,
+    const DenseMap<Operation *, int64_t> &opOrdinals) {
+  int64_t lastOrdinal = defOrdinal;
+  SmallVector<Value, 4> worklist = {streamValue};
+  while (!worklist.empty()) {
+    auto value = worklist.pop_back_val();
+    for (auto *user : value.getUsers()) {
+      lastOrdinal = std::max(lastOrdinal, opOrdinals.lookup(user));
+      if (getAliasedOperand(user) == value) {
+        worklist.push_back(user->getResult(0));
+      }
+    }
+  }
+  return lastOrdinal;
+}
+
+// Returns the most conservative buffer constraints across all target backends
+// that may execute dispatches within the stream.
+static IREE::HAL::BufferConstraintsAttr computeStreamBufferConstraints(
+    IREE::Flow::ExStreamFragmentOp streamOp) {
+  IREE::HAL::BufferConstraintsAttr bufferConstraints = {};
+  streamOp.walk([&](IREE::Flow::DispatchOp dispatchOp) {
+    auto executableOp = dyn_cast_or_null<IREE::HAL::ExecutableOp>(
+        SymbolTable::lookupNearestSymbolFrom(dispatchOp,
+                                             dispatchOp.executable()));
+    if (!executableOp) return;
+    for (auto targetOp :
+         executableOp.getBlock().getOps<IREE::HAL::ExecutableTargetOp>()) {
+      for (auto &targetBackend : IREE::HAL::matchTargetBackends(
+               {targetOp.target_backend_filter().str()})) {
+        auto targetConstraints =
+            targetBackend->queryBufferConstraints(streamOp.getContext());
+        bufferConstraints = bufferConstraints
+                                ? IREE::HAL::intersectBufferConstraints(
+                                      bufferConstraints, targetConstraints)
+                                : targetConstraints;
+      }
+    }
+  });
+  if (!bufferConstraints) {
+    bufferConstraints = IREE::HAL::TargetBackend::makeDefaultBufferConstraints(
+        streamOp.getContext());
+  }
+  return bufferConstraints;
+}
+
+// Assigns slab offsets to |transientValues| such that values with overlapping
+// lifetimes never overlap in memory and returns the total slab size.
+//
+// Values are placed largest-first into the smallest gap between the already
+// placed values they are live with that can hold them (best-fit), or after all
+// of them if no gap is large enough. Since all commands in a stream are
+// currently separated by full execution barriers the storage of a value can be
+// reused by any value defined after its last use.
+static uint64_t packTransientValues(
+    MutableArrayRef<TransientValue> transientValues, uint64_t alignment) {
+  SmallVector<TransientValue *, 8> sortedValues;
+  for (auto &transientValue : transientValues) {
+    sortedValues.push_back(&transientValue);
+  }
+  llvm::stable_sort(sortedValues,
+                    [](const TransientValue *lhs, const TransientValue *rhs) {
+                      return lhs->byteSize > rhs->byteSize;
+                    });
+
+  uint64_t slabSize = 0;
+  SmallVector<TransientValue *, 8> placedValues;
+  for (auto *transientValue : sortedValues) {
+    SmallVector<TransientValue *, 8> liveValues;
+    for (auto *placedValue : placedValues) {
+      if (placedValue->liveStart <= transientValue->liveEnd &&
+          transientValue->liveStart <= placedValue->liveEnd) {
+        liveValues.push_back(placedValue);
+      }
+    }
+    llvm::sort(liveValues,
+               [](const TransientValue *lhs, const TransientValue *rhs) {
+                 return lhs->slabOffset < rhs->slabOffset;
+               });
+
+    uint64_t candidateOffset = 0;
+    Optional<uint64_t> bestOffset;
+    uint64_t bestGapSize = 0;
+    for (auto *liveValue : liveValues) {
+      if (liveValue->slabOffset >= candidateOffset) {
+        uint64_t gapSize = liveValue->slabOffset - candidateOffset;
+        if (gapSize >= transientValue->byteSize &&
+            (!bestOffset || gapSize < bestGapSize)) {
+          bestOffset = candidateOffset;
+          bestGapSize = gapSize;
+        }
+      }
+      candidateOffset =
+          std::max(candidateOffset,
+                   IREE::HAL::align(
+                       liveValue->slabOffset + liveValue->byteSize, alignment));
+    }
+    transientValue->slabOffset = bestOffset.getValueOr(candidateOffset);
+    slabSize = std::max(slabSize,
+                        transientValue->slabOffset + transientValue->byteSize);
+    placedValues.push_back(transientValue);
+  }
+  return IREE::HAL::align(slabSize, alignment);
+}
+
+// Packs |transientValues| into a single transient slab allocation based on
+// their lifetimes and maps each value to its subspan of the slab.
+static void allocateTransientSlab(
+    IREE::Flow::ExStreamFragmentOp streamOp,
+    MutableArrayRef<TransientValue> transientValues, BufferSet &bufferSet,
+    ConversionPatternRewriter &rewriter) {
+  auto bufferConstraints = computeStreamBufferConstraints(streamOp);
+  uint64_t alignment =
+      bufferConstraints.min_buffer_offset_alignment().getZExtValue();
+  uint64_t slabSize = packTransientValues(transientValues, alignment);
+  LLVM_DEBUG(llvm::dbgs() << "  + PACKED " << transientValues.size()
+                          << " TRANSIENT VALUES INTO " << slabSize
+                          << " BYTE SLAB\n");
+  if (slabSize > bufferConstraints.max_allocation_size().getZExtValue()) {
+    // TODO(benvanik): split into multiple slabs instead.
+    for (auto &transientValue : transientValues) {
+      bufferSet.rangeMap[transientValue.value] =
+          BufferRange{allocateTransientBuffer(transientValue.value,
+                                              bufferSet.allocator, rewriter)};
+    }
+    return;
+  }
+
+  Location loc = streamOp.getLoc();
+  auto slabBuffer = allocateTransientStorage(
+      loc, bufferSet.allocator,
+      rewriter.createOrFold<mlir::ConstantIndexOp>(loc, slabSize), rewriter);
+  for (auto &transientValue : transientValues) {
+    // Values that span the entire slab can use it directly.
+    if (transientValue.slabOffset == 0 &&
+        IREE::HAL::align(transientValue.byteSize, alignment) == slabSize) {
+      bufferSet.rangeMap[transientValue.value] = BufferRange{slabBuffer};
+      continue;
+    }
+    auto valueLoc = transientValue.value.getLoc();
+    auto buffer = rewriter.createOrFold<IREE::HAL::BufferSubspanOp>(
+        valueLoc, IREE::HAL::BufferType::get(rewriter.getContext()),
+        slabBuffer,
+        rewriter.createOrFold<mlir::ConstantIndexOp>(valueLoc,
+                                                     transientValue.slabOffset),
+        rewriter.createOrFold<mlir::ConstantIndexOp>(valueLoc,
+                                                     transientValue.byteSize));
+    bufferSet.rangeMap[transientValue.value] = BufferRange{buffer};
+  }
 }
 
 // Allocates transient buffers to store the intra-stream results and populates
@@ -171,9 +436,8 @@ static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
     bool madeChange = false;
     // Pull outputs that terminate on identities to operands.
     for (auto &op : llvm::reverse(streamOp.body().front())) {
-      if (isIdentityOp(&op)) {
+      if (auto operand = getAliasedOperand(&op)) {
         auto result = op.getResult(0);
-        auto operand = op.getOperand(0);
         if (bufferSet.rangeMap[result].buffer &&
             !bufferSet.rangeMap[operand].buffer) {
           LLVM_DEBUG(llvm::dbgs() << "  + PROPAGATE IDENTITY RESULT->OPERAND: "
@@ -187,8 +451,7 @@ static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
 
     // Push inputs that originate on identities to results.
     for (auto &op : streamOp.body().front()) {
-      if (isIdentityOp(&op)) {
-        auto operand = op.getOperand(0);
+      if (auto operand = getAliasedOperand(&op)) {
         auto result = op.getResult(0);
         if (bufferSet.rangeMap[operand].buffer &&
             !bufferSet.rangeMap[result].buffer) {
@@ -213,10 +476,23 @@ static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
   // the interior).
   // Because there may be runs of identity ops, propagation loops until no
   // changes are made.
+  //
+  // In-place tensor updates are treated as identities between their target
+  // and result so that the update is recorded directly into the target buffer.
+  //
+  // Transient values with static sizes are packed into a single slab based on
+  // their lifetimes within the stream while dynamically-sized values each get
+  // their own allocation.
   while (propagateIdentityBuffers()) {
   }
+  DenseMap<Operation *, int64_t> opOrdinals;
+  for (auto &op : streamOp.body().front()) {
+    int64_t ordinal = opOrdinals.size();
+    opOrdinals[&op] = ordinal;
+  }
+  SmallVector<TransientValue, 8> transientValues;
   for (auto &op : streamOp.body().front()) {
-    if (isNoOp(&op) || isIdentityOp(&op)) continue;
+    if (isNoOp(&op) || getAliasedOperand(&op)) continue;
     for (auto it : llvm::enumerate(op.getResults())) {
       auto result = it.value();
       // If the result is an output buffer we can just use that directly.
@@ -225,6 +501,19 @@ static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
                                 << it.index() << "): " << op << "\n");
         continue;
       }
+      auto byteSize = computeStaticByteSize(result);
+      if (byteSize && byteSize.getValue() > 0) {
+        LLVM_DEBUG(llvm::dbgs() << "    -- PACK SLAB BUFFER FOR RESULT("
+                                << it.index() << "): " << op << "\n");
+        TransientValue transientValue;
+        transientValue.value = result;
+        transientValue.liveStart = opOrdinals[&op];
+        transientValue.liveEnd =
+            findLastUseOrdinal(result, transientValue.liveStart, opOrdinals);
+        transientValue.byteSize = byteSize.getValue();
+        transientValues.push_back(transientValue);
+        continue;
+      }
       LLVM_DEBUG(llvm::dbgs() << "    -- ALLOCATE BUFFER FOR RESULT("
                               << it.index() << "): " << op << "\n");
       auto buffer =
@@ -232,6 +521,9 @@ static void allocateTransientBuffers(IREE::Flow::ExStreamFragmentOp streamOp,
       bufferSet.rangeMap[result] = BufferRange{buffer};
     }
   }
+  if (!transientValues.empty()) {
+    allocateTransientSlab(streamOp, transientValues, bufferSet, rewriter);
+  }
   while (propagateIdentityBuffers()) {
   }
 }
@@ -483,15 +775,18 @@ static LogicalResult recordTensorUpdate(Value device, Value commandBuffer,
       target->computeRange(startIndices, *update->getShapeDims());
   if (!targetRange) return failure();
 
-  // TODO(benvanik): actual buffer allocation so we aren't doing this copy.
-  auto targetByteLength = target->getByteLength();
-  if (!targetByteLength) return failure();
-
-  rewriter.create<IREE::HAL::CommandBufferCopyBufferOp>(
-      updateOp.getLoc(), commandBuffer, target->getBuffer(), zeroOffset,
-      result->getBuffer(), zeroOffset, targetByteLength);
-  // TODO(benvanik): slice left/mid/right, but really just don't do this.
-  recordFullExecutionBarrier(commandBuffer, updateOp.getLoc(), rewriter);
+  // In-place updates alias the target buffer and only need the update range
+  // written. Otherwise the target contents are first copied to the result.
+  if (targetBuffer.buffer != resultBuffer.buffer) {
+    auto targetByteLength = target->getByteLength();
+    if (!targetByteLength) return failure();
+
+    rewriter.create<IREE::HAL::CommandBufferCopyBufferOp>(
+        updateOp.getLoc(), commandBuffer, target->getBuffer(), zeroOffset,
+        result->getBuffer(), zeroOffset, targetByteLength);
+    // TODO(benvanik): slice left/mid/right.
+    recordFullExecutionBarrier(commandBuffer, updateOp.getLoc(), rewriter);
+  }
   rewriter.create<IREE::HAL::CommandBufferCopyBufferOp>(
       updateOp.getLoc(), commandBuffer, update->getBuffer(), zeroOffset,
       result->getBuffer(), targetRange->offset, targetRange->length);
@@ -585,12 +880,27 @@ class ExStreamFragmentOpConversion
     }
 
     // End and submit the command buffer.
-    // In a real version we'd want to setup a semaphore chain instead of
-    // submitting and waiting.
+    // The submission signals a semaphore that we immediately wait on as the
+    // results of the stream are consumed by host code below; this is where a
+    // semaphore chain between streams would hook in.
     rewriter.create<IREE::HAL::CommandBufferEndOp>(streamOp.getLoc(),
                                                    commandBuffer);
-    rewriter.create<IREE::HAL::ExSubmitAndWaitOp>(streamOp.getLoc(), device,
-                                                  commandBuffer);
+    auto zeroValue =
+        rewriter.createOrFold<mlir::ConstantIndexOp>(streamOp.getLoc(), 0);
+    auto signalValue =
+        rewriter.createOrFold<mlir::ConstantIndexOp>(streamOp.getLoc(), 1);
+    auto semaphore = rewriter.createOrFold<IREE::HAL::SemaphoreCreateOp>(
+        streamOp.getLoc(), IREE::HAL::SemaphoreType::get(device.getContext()),
+        device, zeroValue);
+    rewriter.create<IREE::HAL::ExSubmitOp>(
+        streamOp.getLoc(), device, /*waitSemaphores=*/ValueRange{},
+        /*waitValues=*/ValueRange{}, ValueRange{commandBuffer},
+        ValueRange{semaphore}, ValueRange{signalValue});
+    auto awaitOp = rewriter.create<IREE::HAL::SemaphoreAwaitOp>(
+        streamOp.getLoc(), rewriter.getIntegerType(32), semaphore,
+        signalValue);
+    rewriter.create<IREE::HAL::CheckSuccessOp>(
+        streamOp.getLoc(), awaitOp.getResult(), "stream submission failed");
 
     // It's annoying, but we need to do this replacement at the very end as
     // otherwise we lose access to the original values (which we need for
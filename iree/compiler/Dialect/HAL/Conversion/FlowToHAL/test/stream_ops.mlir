@@ -37,13 +37,58 @@ func @multipleDispatches(%arg0: tensor<128xf32>) -> tensor<128xf32> {
     flow.return %2 : tensor<128xf32>
   }
   // CHECK: hal.command_buffer.end %[[CMD]]
-  // CHECK-NEXT: hal.ex.submit_and_wait {{.+}}, %[[CMD]]
+  // CHECK: %[[SEM:.+]] = hal.semaphore.create
+  // CHECK-NEXT: hal.ex.submit {{.+}} commands(%[[CMD]]) signal(%[[SEM]]) signal_values(%[[SIGNAL_VALUE:.+]])
+  // CHECK-NEXT: %[[STATUS:.+]] = hal.semaphore.await %[[SEM]], min_value = %[[SIGNAL_VALUE]]
+  // CHECK-NEXT: hal.check_success %[[STATUS]]
   // CHECK-NEXT: return %[[RET_BUF]]
   return %0 : tensor<128xf32>
 }
 
 // -----
 
+hal.executable @ex0 {
+  hal.interface @interface {
+    hal.interface.binding @s0b0, set=0, binding=0, type="StorageBuffer", access="Read"
+    hal.interface.binding @s0b1, set=0, binding=1, type="StorageBuffer", access="Read|Write"
+  }
+  hal.executable.target @vmla, filter="vmla" {
+    hal.executable.entry_point @entry0 attributes {
+      interface = @interface,
+      ordinal = 0 : i32,
+      signature = (tensor<128xf32>) -> tensor<128xf32>
+    }
+    module {}
+  }
+}
+
+// Transient values with disjoint lifetimes share storage within a single slab.
+// CHECK-LABEL: func @transientSlabReuse
+func @transientSlabReuse(%arg0: tensor<128xf32>) -> tensor<128xf32> {
+  %cst = constant 128 : index
+  // CHECK: %[[RET_BUF:.+]] = hal.allocator.allocate {{.+}}, "HostVisible|DeviceVisible|DeviceLocal", "Constant|Transfer|Mapping|Dispatch"
+  // CHECK: %[[SLAB:.+]] = hal.allocator.allocate {{.+}}, "DeviceVisible|DeviceLocal", "Transfer|Dispatch", %c1024
+  // CHECK-NOT: hal.allocator.allocate
+  // CHECK-DAG: %[[TMP0:.+]] = hal.buffer.subspan %[[SLAB]], %c0, %c512
+  // CHECK-DAG: %[[TMP1:.+]] = hal.buffer.subspan %[[SLAB]], %c512, %c512
+  // CHECK: %[[CMD:.+]] = hal.command_buffer.create
+  %0 = flow.ex.stream.fragment(%arg1 = %cst : index, %arg2 = %arg0 : tensor<128xf32>) -> tensor<128xf32> {
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%arg0, %c0, %c512), 1 = (%[[TMP0]], %c0, %c512)]
+    %1 = flow.dispatch @ex0::@entry0[%arg1] (%arg2) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[TMP0]], %c0, %c512), 1 = (%[[TMP1]], %c0, %c512)]
+    %2 = flow.dispatch @ex0::@entry0[%arg1] (%1) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[TMP1]], %c0, %c512), 1 = (%[[TMP2:[a-z0-9_]+]], %c0, %c512)]
+    %3 = flow.dispatch @ex0::@entry0[%arg1] (%2) : (tensor<128xf32>) -> tensor<128xf32>
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[TMP2]], %c0, %c512), 1 = (%[[RET_BUF]], %c0, %c512)]
+    %4 = flow.dispatch @ex0::@entry0[%arg1] (%3) : (tensor<128xf32>) -> tensor<128xf32>
+    flow.return %4 : tensor<128xf32>
+  }
+  // CHECK: return %[[RET_BUF]]
+  return %0 : tensor<128xf32>
+}
+
+// -----
+
 // CHECK-LABEL: @tensorUpdate
 // CHECK-SAME: (%[[UBUF:.+]]:{{.+}}, %[[TBUF:.+]]:{{.+}})
 func @tensorUpdate(%arg0 : tensor<1x1x10xf32>, %arg1 : tensor<5x1x10xf32>) -> tensor<5x1x10xf32> {
@@ -68,6 +113,93 @@ func @tensorUpdate(%arg0 : tensor<1x1x10xf32>, %arg1 : tensor<5x1x10xf32>) -> te
 
 // -----
 
+hal.executable @ex0 {
+  hal.interface @interface {
+    hal.interface.binding @s0b0, set=0, binding=0, type="StorageBuffer", access="Read"
+    hal.interface.binding @s0b1, set=0, binding=1, type="StorageBuffer", access="Read|Write"
+  }
+  hal.executable.target @vmla, filter="vmla" {
+    hal.executable.entry_point @entry0 attributes {
+      interface = @interface,
+      ordinal = 0 : i32,
+      signature = (tensor<5x1x10xf32>) -> tensor<5x1x10xf32>
+    }
+    module {}
+  }
+}
+
+// Updates of targets that die at the update are recorded in-place.
+// CHECK-LABEL: @tensorUpdateInPlace
+// CHECK-SAME: (%[[UBUF:.+]]:{{.+}}, %[[TBUF:.+]]:{{.+}})
+func @tensorUpdateInPlace(%arg0 : tensor<1x1x10xf32>, %arg1 : tensor<5x1x10xf32>) -> tensor<5x1x10xf32> {
+  %c4 = constant 4 : index
+  %c1 = constant 1 : index
+  // CHECK: %[[RET_BUF:.+]] = hal.allocator.allocate
+  // CHECK-NOT: hal.allocator.allocate
+  // CHECK: %[[CMD:.+]] = hal.command_buffer.create
+  %0 = flow.ex.stream.fragment(%arg2 = %arg0 : tensor<1x1x10xf32>, %arg3 = %arg1 : tensor<5x1x10xf32>, %arg4 = %c4 : index, %arg5 = %c1 : index) -> tensor<5x1x10xf32> {
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[TBUF]], %c0, %c200), 1 = (%[[RET_BUF]], %c0, %c200)]
+    // CHECK: hal.command_buffer.execution_barrier
+    %1 = flow.dispatch @ex0::@entry0[%arg4] (%arg3) : (tensor<5x1x10xf32>) -> tensor<5x1x10xf32>
+    // CHECK-NOT: hal.command_buffer.copy_buffer {{.+}}, %c200
+    // CHECK: hal.command_buffer.copy_buffer %[[CMD]], %[[UBUF]], %c0, %[[RET_BUF]], %c204, %c40
+    // CHECK: hal.command_buffer.execution_barrier
+    %2 = flow.tensor.update %arg2, %1[%arg4, %arg5, %arg5] : tensor<1x1x10xf32> -> tensor<5x1x10xf32>
+    flow.return %2 : tensor<5x1x10xf32>
+  }
+  // CHECK: hal.command_buffer.end %[[CMD]]
+  // CHECK: return %[[RET_BUF]]
+  return %0 : tensor<5x1x10xf32>
+}
+
+// -----
+
+hal.executable @ex0 {
+  hal.interface @interface {
+    hal.interface.binding @s0b0, set=0, binding=0, type="StorageBuffer", access="Read"
+    hal.interface.binding @s0b1, set=0, binding=1, type="StorageBuffer", access="Read|Write"
+  }
+  hal.executable.target @vmla, filter="vmla" {
+    hal.executable.entry_point @entry0 attributes {
+      interface = @interface,
+      ordinal = 0 : i32,
+      signature = (tensor<5x1x10xf32>) -> tensor<5x1x10xf32>
+    }
+    module {}
+  }
+}
+
+// Updates of stream operands whose external values die at the stream are
+// recorded in-place into the operand buffer.
+// CHECK-LABEL: @tensorUpdateInPlaceOperand
+// CHECK-SAME: (%[[UBUF:.+]]:{{.+}}, %[[TBUF:.+]]:{{.+}})
+func @tensorUpdateInPlaceOperand(%arg0 : tensor<1x1x10xf32>, %arg1 : tensor<5x1x10xf32>) -> tensor<5x1x10xf32> {
+  %c4 = constant 4 : index
+  %c1 = constant 1 : index
+  // CHECK: %[[DISPATCH_BUF:.+]] = hal.allocator.allocate
+  // CHECK: %[[CMD0:.+]] = hal.command_buffer.create
+  %0 = flow.ex.stream.fragment(%arg2 = %arg1 : tensor<5x1x10xf32>, %arg3 = %c4 : index) -> tensor<5x1x10xf32> {
+    // CHECK: hal.command_buffer.push_descriptor_set {{.+}}, bindings=[0 = (%[[TBUF]], %c0, %c200), 1 = (%[[DISPATCH_BUF]], %c0, %c200)]
+    %1 = flow.dispatch @ex0::@entry0[%arg3] (%arg2) : (tensor<5x1x10xf32>) -> tensor<5x1x10xf32>
+    flow.return %1 : tensor<5x1x10xf32>
+  }
+  // CHECK: hal.command_buffer.end %[[CMD0]]
+  // CHECK-NOT: hal.allocator.allocate
+  // CHECK: %[[CMD1:.+]] = hal.command_buffer.create
+  %2 = flow.ex.stream.fragment(%arg2 = %arg0 : tensor<1x1x10xf32>, %arg3 = %0 : tensor<5x1x10xf32>, %arg4 = %c4 : index, %arg5 = %c1 : index) -> tensor<5x1x10xf32> {
+    // CHECK-NOT: hal.command_buffer.copy_buffer {{.+}}, %c200
+    // CHECK: hal.command_buffer.copy_buffer %[[CMD1]], %[[UBUF]], %c0, %[[DISPATCH_BUF]], %c204, %c40
+    // CHECK: hal.command_buffer.execution_barrier
+    %3 = flow.tensor.update %arg2, %arg3[%arg4, %arg5, %arg5] : tensor<1x1x10xf32> -> tensor<5x1x10xf32>
+    flow.return %3 : tensor<5x1x10xf32>
+  }
+  // CHECK: hal.command_buffer.end %[[CMD1]]
+  // CHECK: return %[[DISPATCH_BUF]]
+  return %2 : tensor<5x1x10xf32>
+}
+
+// -----
+
 hal.executable @ex0 {
   hal.interface @interface attributes {push_constants = 2 : i32} {
     hal.interface.binding @s0b0, set=0, binding=0, type="StorageBuffer", access="Read"
@@ -25,6 +25,8 @@ void populateHALExperimentalToVMPatterns(MLIRContext *context,
                                          OwningRewritePatternList &patterns) {
   patterns.insert<VMImportOpConversion<IREE::HAL::ExSharedDeviceOp>>(
       context, importSymbols, typeConverter, "hal.ex.shared_device");
+  patterns.insert<VMImportOpConversion<IREE::HAL::ExSubmitOp>>(
+      context, importSymbols, typeConverter, "hal.ex.submit");
   patterns.insert<VMImportOpConversion<IREE::HAL::ExSubmitAndWaitOp>>(
       context, importSymbols, typeConverter, "hal.ex.submit_and_wait");
 }
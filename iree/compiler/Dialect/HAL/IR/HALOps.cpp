@@ -65,6 +65,20 @@ void ExSharedDeviceOp::getAsmResultNames(
   setNameFn(result(), "dev");
 }
 
+//===----------------------------------------------------------------------===//
+// hal.ex.submit
+//===----------------------------------------------------------------------===//
+
+static LogicalResult verifyExSubmitOp(ExSubmitOp op) {
+  if (op.wait_semaphores().size() != op.wait_values().size()) {
+    return op.emitOpError() << "requires one wait value per wait semaphore";
+  }
+  if (op.signal_semaphores().size() != op.signal_values().size()) {
+    return op.emitOpError() << "requires one signal value per signal semaphore";
+  }
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // hal.make_memory_barrier
 //===----------------------------------------------------------------------===//
@@ -19,3 +19,20 @@ func @submit_and_wait() {
   hal.ex.submit_and_wait %0, %1
   return
 }
+
+// -----
+
+// CHECK-LABEL: @submit
+func @submit() {
+  %0 = "test_hal.device"() : () -> !hal.device
+  %1 = "test_hal.command_buffer"() : () -> !hal.command_buffer
+  %2 = "test_hal.semaphore"() : () -> !hal.semaphore
+  %3 = "test_hal.semaphore"() : () -> !hal.semaphore
+  %c1 = constant 1 : index
+  %c2 = constant 2 : index
+  // CHECK: hal.ex.submit %0 wait(%2) wait_values(%c1) commands(%1) signal(%3) signal_values(%c2)
+  hal.ex.submit %0 wait(%2) wait_values(%c1) commands(%1) signal(%3) signal_values(%c2)
+  // CHECK: hal.ex.submit %0 commands(%1) signal(%3) signal_values(%c2)
+  hal.ex.submit %0 commands(%1) signal(%3) signal_values(%c2)
+  return
+}
@@ -20,14 +20,17 @@
 #include "iree/compiler/Conversion/Common/Attributes.h"
 #include "iree/compiler/Conversion/LinalgToLLVM/Passes.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LLVMIRPasses.h"
+#include "iree/compiler/Dialect/HAL/Target/LLVM/LibraryBuilder.h"
 #include "iree/compiler/Dialect/HAL/Target/LLVM/LinkerTool.h"
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Utils/FlatbufferUtils.h"
 #include "iree/schemas/dylib_executable_def_builder.h"
+#include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/LLVMContext.h"
 #include "llvm/IR/Module.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/TargetSelect.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Target/LLVMIR.h"
 
@@ -62,6 +65,57 @@ std::string guessModuleName(mlir::ModuleOp moduleOp) {
   }
 }
 
+// Creates an iree_hal_executable_dispatch_v0_t thunk calling |entryPointFn|,
+// which takes its arguments in the order produced by codegen:
+//   (bindings, push_constants, workgroup_id, workgroup_count, workgroup_size)
+// The entry point is internalized so that it is inlined into the thunk and not
+// exported from the library. Returns nullptr if the entry point signature is
+// not the expected one.
+llvm::Function *createDispatchThunk(llvm::Function *entryPointFn) {
+  // Thunk argument indices passed to each entry point argument.
+  static const unsigned kEntryPointArgs[] = {
+      5,  // bindings
+      4,  // push_constants
+      1,  // workgroup_id
+      3,  // workgroup_count
+      2,  // workgroup_size
+  };
+  auto *entryPointType = entryPointFn->getFunctionType();
+  if (entryPointType->getNumParams() != llvm::array_lengthof(kEntryPointArgs) ||
+      llvm::any_of(entryPointType->params(),
+                   [](llvm::Type *type) { return !type->isPointerTy(); })) {
+    return nullptr;
+  }
+
+  auto *module = entryPointFn->getParent();
+  auto *thunkFn = llvm::Function::Create(
+      LibraryBuilder::getDispatchFunctionType(module->getContext()),
+      llvm::GlobalValue::InternalLinkage, entryPointFn->getName() + "_thunk",
+      module);
+  static const char *kThunkArgNames[] = {
+      "state",           "workgroup_id",   "workgroup_size",
+      "workgroup_count", "push_constants", "bindings",
+  };
+  for (auto it : llvm::enumerate(kThunkArgNames)) {
+    thunkFn->getArg(it.index())->setName(it.value());
+  }
+  auto *block =
+      llvm::BasicBlock::Create(module->getContext(), "entry", thunkFn);
+  llvm::IRBuilder<> builder(block);
+  SmallVector<llvm::Value *, 5> args;
+  for (auto it : llvm::enumerate(kEntryPointArgs)) {
+    auto *arg = thunkFn->getArg(it.value());
+    args.push_back(builder.CreatePointerCast(
+        arg, entryPointType->getParamType(it.index()), arg->getName()));
+  }
+  auto *call = builder.CreateCall(entryPointFn, args);
+  call->setCallingConv(entryPointFn->getCallingConv());
+  builder.CreateRetVoid();
+
+  entryPointFn->setLinkage(llvm::GlobalValue::InternalLinkage);
+  return thunkFn;
+}
+
 }  // namespace
 
 class LLVMAOTTargetBackend final : public TargetBackend {
@@ -74,7 +128,12 @@ class LLVMAOTTargetBackend final : public TargetBackend {
   std::string filter_pattern() const override { return "dylib*"; }
 
   void buildTranslationPassPipeline(OpPassManager &passManager) override {
-    buildLLVMTransformPassPipeline(passManager);
+    auto targetInfo = getCPUTargetInfo(
+        options_.targetTriple, options_.targetCPU, options_.targetCPUFeatures);
+    // The database is loaded by the tiling passes so that errors are reported
+    // as pass failures.
+    targetInfo.tileSizeDatabase = options_.tileSizeDatabase;
+    buildLLVMTransformPassPipeline(passManager, targetInfo);
   }
 
   LogicalResult linkExecutables(mlir::ModuleOp moduleOp) override {
@@ -225,6 +284,31 @@ class LLVMAOTTargetBackend final : public TargetBackend {
                                      "dialect to the native llvm::Module";
     }
 
+    // Expose all entry points (of all executables linked into this one) through
+    // a single iree_hal_executable_library_v0_t so that loading the library
+    // only needs to resolve the query function. Ordinals match the order of
+    // the entry points in the flatbuffer below.
+    LibraryBuilder libraryBuilder(llvmModule.get(), libraryName);
+    for (auto entryPointOp :
+         targetOp.getBlock().getOps<ExecutableEntryPointOp>()) {
+      auto *entryPointFn = llvmModule->getFunction(entryPointOp.getName());
+      if (!entryPointFn) {
+        return entryPointOp.emitError()
+               << "entry point function not found in the LLVM module";
+      }
+      auto *dispatchFn = createDispatchThunk(entryPointFn);
+      if (!dispatchFn) {
+        return entryPointOp.emitError()
+               << "entry point function has an unexpected signature";
+      }
+      libraryBuilder.addEntryPoint(entryPointOp.getName(), /*tag=*/"",
+                                   dispatchFn);
+    }
+    auto *queryFn = libraryBuilder.build(LibraryBuilder::kQueryFunctionName);
+    if (options_.printLibraryIR) {
+      llvmModule->print(llvm::errs(), /*AAW=*/nullptr);
+    }
+
     // Try to grab a linker tool based on the options (and target environment).
     auto linkerTool = LinkerTool::getForTarget(targetTriple, options_);
     if (!linkerTool) {
@@ -234,12 +318,10 @@ class LLVMAOTTargetBackend final : public TargetBackend {
     }
 
     // Configure the module with any code generation options required later by
-    // linking (such as initializer functions).
-    auto entryPointNames = llvm::to_vector<8>(
-        llvm::map_range(targetOp.getBlock().getOps<ExecutableEntryPointOp>(),
-                        [&](auto op) { return op.getName(); }));
-    if (failed(
-            linkerTool->configureModule(llvmModule.get(), entryPointNames))) {
+    // linking (such as initializer functions). The library query function is
+    // the only symbol that needs to be exported.
+    SmallVector<StringRef, 1> exportedNames = {queryFn->getName()};
+    if (failed(linkerTool->configureModule(llvmModule.get(), exportedNames))) {
       return targetOp.emitError()
              << "failed to configure LLVM module for target linker";
     }
@@ -322,8 +404,8 @@ class LLVMAOTTargetBackend final : public TargetBackend {
                                   << linkArtifacts.libraryFile.path;
     }
 
-    // Entry point names up from.
-    // TODO(#3580): these won't be needed in the executable_library world.
+    // Entry point names up front. The runtime uses these for verification and
+    // tracing; the functions themselves are resolved through the library.
     auto entryPointsRef = builder.createStringVec(llvm::map_range(
         targetOp.getBlock().getOps<ExecutableEntryPointOp>(),
         [&](ExecutableEntryPointOp op) { return op.getName(); }));
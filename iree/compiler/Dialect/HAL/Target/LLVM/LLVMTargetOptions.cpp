@@ -121,6 +121,20 @@ LLVMTargetOptions getLLVMTargetOptionsFromFlags() {
       llvm::cl::init(llvmTargetOptions.keepLinkerArtifacts));
   llvmTargetOptions.keepLinkerArtifacts = clKeepLinkerArtifacts;
 
+  static llvm::cl::opt<bool> clPrintLibraryIR(
+      "iree-llvm-print-library-ir",
+      llvm::cl::desc("Prints the LLVM IR of each library with its library "
+                     "interface to stderr prior to optimization"),
+      llvm::cl::init(llvmTargetOptions.printLibraryIR));
+  llvmTargetOptions.printLibraryIR = clPrintLibraryIR;
+
+  static llvm::cl::opt<std::string> clTileSizeDatabase(
+      "iree-llvm-tile-size-database",
+      llvm::cl::desc("Tile size database with the tile sizes to use for ops "
+                     "tuned on the target CPU"),
+      llvm::cl::init(""));
+  llvmTargetOptions.tileSizeDatabase = clTileSizeDatabase;
+
   return llvmTargetOptions;
 }
 
@@ -46,6 +46,14 @@ struct LLVMTargetOptions {
 
   // True to keep linker artifacts for debugging.
   bool keepLinkerArtifacts = false;
+
+  // True to print the LLVM IR of each library to stderr after the library
+  // interface has been added and prior to optimization.
+  bool printLibraryIR = false;
+
+  // Path of a tile size database produced by offline tuning on the target CPU.
+  // See scripts/tune_llvm_tile_sizes.py.
+  std::string tileSizeDatabase;
 };
 
 // Returns LLVMTargetOptions struct intialized with the iree-llvm-* flags.
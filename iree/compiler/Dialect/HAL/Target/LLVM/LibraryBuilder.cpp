@@ -0,0 +1,199 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/compiler/Dialect/HAL/Target/LLVM/LibraryBuilder.h"
+
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/IRBuilder.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// iree_hal_executable_library_header_t
+static llvm::StructType *makeLibraryHeaderType(llvm::LLVMContext &context) {
+  auto *i32Type = llvm::IntegerType::getInt32Ty(context);
+  auto *i8PtrType = llvm::IntegerType::getInt8PtrTy(context);
+  auto *type = llvm::StructType::create(context,
+                                        {
+                                            i32Type,    // version
+                                            i8PtrType,  // name
+                                        },
+                                        "iree_hal_executable_library_header_t",
+                                        /*isPacked=*/false);
+  return type;
+}
+
+// iree_hal_executable_library_v0_t
+static llvm::StructType *makeLibraryV0Type(llvm::StructType *headerType,
+                                           llvm::FunctionType *dispatchType) {
+  auto &context = headerType->getContext();
+  auto *i32Type = llvm::IntegerType::getInt32Ty(context);
+  auto *i8PtrType = llvm::IntegerType::getInt8PtrTy(context);
+  auto *type = llvm::StructType::create(
+      context,
+      {
+          headerType->getPointerTo(),                    // header
+          i32Type,                                       // entry_point_count
+          dispatchType->getPointerTo()->getPointerTo(),  // entry_points
+          i8PtrType->getPointerTo(),                     // entry_point_names
+          i8PtrType->getPointerTo(),                     // entry_point_tags
+      },
+      "iree_hal_executable_library_v0_t",
+      /*isPacked=*/false);
+  return type;
+}
+
+llvm::FunctionType *LibraryBuilder::getDispatchFunctionType(
+    llvm::LLVMContext &context) {
+  auto *i8PtrType = llvm::IntegerType::getInt8PtrTy(context);
+  auto *i32PtrType = llvm::IntegerType::getInt32PtrTy(context);
+  return llvm::FunctionType::get(
+      llvm::Type::getVoidTy(context),
+      {
+          i8PtrType,                  // state
+          i32PtrType,                 // workgroup_id
+          i32PtrType,                 // workgroup_size
+          i32PtrType,                 // workgroup_count
+          i32PtrType,                 // push_constants
+          i8PtrType->getPointerTo(),  // bindings
+      },
+      /*isVarArg=*/false);
+}
+
+// Returns a constant i8* pointing at a private NUL-terminated copy of |value|.
+static llvm::Constant *createStringConstant(llvm::StringRef value,
+                                            llvm::Module *module) {
+  auto &context = module->getContext();
+  auto *data = llvm::ConstantDataArray::getString(context, value);
+  auto *global = new llvm::GlobalVariable(
+      *module, data->getType(), /*isConstant=*/true,
+      llvm::GlobalValue::PrivateLinkage, data, "__iree_string");
+  global->setUnnamedAddr(llvm::GlobalValue::UnnamedAddr::Global);
+  auto *zero = llvm::ConstantInt::get(llvm::Type::getInt32Ty(context), 0);
+  return llvm::ConstantExpr::getInBoundsGetElementPtr(data->getType(), global,
+                                                      {zero, zero});
+}
+
+// Returns a constant pointer to the first element of a private array global
+// holding |values| of |elementType|.
+static llvm::Constant *createArrayConstant(
+    llvm::StringRef name, llvm::Type *elementType,
+    llvm::ArrayRef<llvm::Constant *> values, llvm::Module *module) {
+  auto *arrayType = llvm::ArrayType::get(elementType, values.size());
+  auto *global = new llvm::GlobalVariable(
+      *module, arrayType, /*isConstant=*/true,
+      llvm::GlobalValue::PrivateLinkage,
+      llvm::ConstantArray::get(arrayType, values), name);
+  auto *zero = llvm::ConstantInt::get(
+      llvm::Type::getInt32Ty(module->getContext()), 0);
+  return llvm::ConstantExpr::getInBoundsGetElementPtr(arrayType, global,
+                                                      {zero, zero});
+}
+
+void LibraryBuilder::addEntryPoint(llvm::StringRef name, llvm::StringRef tag,
+                                   llvm::Function *func) {
+  entryPoints.push_back({name.str(), tag.str(), func});
+}
+
+llvm::Function *LibraryBuilder::build(llvm::StringRef queryFuncName) {
+  auto &context = module->getContext();
+  auto *i32Type = llvm::IntegerType::getInt32Ty(context);
+  auto *i8PtrType = llvm::IntegerType::getInt8PtrTy(context);
+  auto *dispatchType = getDispatchFunctionType(context);
+  auto *headerType = makeLibraryHeaderType(context);
+  auto *libraryType = makeLibraryV0Type(headerType, dispatchType);
+
+  // Entry point function table and optional name/tag tables.
+  llvm::SmallVector<llvm::Constant *, 8> entryPointValues;
+  llvm::SmallVector<llvm::Constant *, 8> entryPointNameValues;
+  llvm::SmallVector<llvm::Constant *, 8> entryPointTagValues;
+  bool hasTags = false;
+  for (auto &entryPoint : entryPoints) {
+    entryPointValues.push_back(llvm::ConstantExpr::getPointerCast(
+        entryPoint.func, dispatchType->getPointerTo()));
+    entryPointNameValues.push_back(
+        createStringConstant(entryPoint.name, module));
+    if (entryPoint.tag.empty()) {
+      entryPointTagValues.push_back(
+          llvm::ConstantPointerNull::get(i8PtrType));
+    } else {
+      entryPointTagValues.push_back(
+          createStringConstant(entryPoint.tag, module));
+      hasTags = true;
+    }
+  }
+  auto *entryPointTable = createArrayConstant(
+      "__iree_entry_points", dispatchType->getPointerTo(), entryPointValues,
+      module);
+  auto *entryPointNames = createArrayConstant(
+      "__iree_entry_point_names", i8PtrType, entryPointNameValues, module);
+  auto *entryPointTags =
+      hasTags ? createArrayConstant("__iree_entry_point_tags", i8PtrType,
+                                    entryPointTagValues, module)
+              : llvm::ConstantPointerNull::get(i8PtrType->getPointerTo());
+
+  // iree_hal_executable_library_header_t
+  auto *header = new llvm::GlobalVariable(
+      *module, headerType, /*isConstant=*/true,
+      llvm::GlobalValue::PrivateLinkage,
+      llvm::ConstantStruct::get(
+          headerType,
+          {
+              llvm::ConstantInt::get(i32Type,
+                                     static_cast<uint32_t>(Version::V_0)),
+              createStringConstant(libraryName, module),
+          }),
+      "__iree_library_header");
+
+  // iree_hal_executable_library_v0_t
+  auto *library = new llvm::GlobalVariable(
+      *module, libraryType, /*isConstant=*/true,
+      llvm::GlobalValue::PrivateLinkage,
+      llvm::ConstantStruct::get(
+          libraryType,
+          {
+              header,
+              llvm::ConstantInt::get(i32Type, entryPointValues.size()),
+              entryPointTable,
+              entryPointNames,
+              entryPointTags,
+          }),
+      "__iree_library");
+
+  // The query function returns a pointer to the header pointer leading the
+  // versioned library structure. V_0 is the only version so it is returned to
+  // all callers.
+  auto *queryFuncType =
+      llvm::FunctionType::get(headerType->getPointerTo()->getPointerTo(),
+                              {i32Type}, /*isVarArg=*/false);
+  auto *queryFunc = llvm::Function::Create(queryFuncType,
+                                           llvm::GlobalValue::ExternalLinkage,
+                                           queryFuncName, *module);
+  queryFunc->setDSOLocal(false);
+  queryFunc->getArg(0)->setName("max_version");
+  auto *block = llvm::BasicBlock::Create(context, "entry", queryFunc);
+  llvm::IRBuilder<> builder(block);
+  builder.CreateRet(builder.CreatePointerCast(
+      library, headerType->getPointerTo()->getPointerTo()));
+  return queryFunc;
+}
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
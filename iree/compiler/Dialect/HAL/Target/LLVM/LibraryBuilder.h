@@ -0,0 +1,86 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LIBRARYBUILDER_H_
+#define IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LIBRARYBUILDER_H_
+
+#include <string>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Module.h"
+
+namespace mlir {
+namespace iree_compiler {
+namespace IREE {
+namespace HAL {
+
+// Builds an iree_hal_executable_library_v0_t exposing all entry points of a
+// module along with the exported query function used by the runtime to
+// retrieve it. See iree/hal/local/executable_library.h for the runtime side;
+// the two must be kept in sync.
+//
+// Usage:
+//   LibraryBuilder builder(module, "my_library");
+//   builder.addEntryPoint("dispatch_0", "", dispatchFn0);
+//   builder.addEntryPoint("dispatch_1", "", dispatchFn1);
+//   builder.build(LibraryBuilder::kQueryFunctionName);
+class LibraryBuilder {
+ public:
+  // Name of the exported function returning the library.
+  // Matches IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME.
+  static constexpr const char *kQueryFunctionName =
+      "iree_hal_executable_library_query";
+
+  // Matches iree_hal_executable_library_version_e.
+  enum class Version : uint32_t {
+    V_0 = 0u,
+    LATEST = V_0,
+  };
+
+  LibraryBuilder(llvm::Module *module, std::string libraryName)
+      : module(module), libraryName(std::move(libraryName)) {}
+
+  // Returns the iree_hal_executable_dispatch_v0_t function type.
+  static llvm::FunctionType *getDispatchFunctionType(
+      llvm::LLVMContext &context);
+
+  // Adds a new entry point |func| with the iree_hal_executable_dispatch_v0_t
+  // signature. Entry points are assigned ordinals in the order they are added.
+  // |tag| is an optional human-readable description and may be empty.
+  void addEntryPoint(llvm::StringRef name, llvm::StringRef tag,
+                     llvm::Function *func);
+
+  // Builds the library constant and an exported query function named
+  // |queryFuncName| returning it. Returns the query function.
+  llvm::Function *build(llvm::StringRef queryFuncName);
+
+ private:
+  struct EntryPoint {
+    std::string name;
+    std::string tag;
+    llvm::Function *func;
+  };
+
+  llvm::Module *module = nullptr;
+  std::string libraryName;
+  llvm::SmallVector<EntryPoint, 8> entryPoints;
+};
+
+}  // namespace HAL
+}  // namespace IREE
+}  // namespace iree_compiler
+}  // namespace mlir
+
+#endif  // IREE_COMPILER_DIALECT_HAL_TARGET_LLVM_LIBRARYBUILDER_H_
@@ -97,8 +97,9 @@ class LinkerTool {
 
   // Configures a module prior to compilation with any additional
   // functions/exports it may need, such as shared object initializer functions.
+  // |exportedNames| are the functions that must be exported from the library.
   virtual LogicalResult configureModule(
-      llvm::Module* llvmModule, ArrayRef<StringRef> entryPointNames) = 0;
+      llvm::Module* llvmModule, ArrayRef<StringRef> exportedNames) = 0;
 
   // Links the given object files into a dynamically loadable library.
   // The resulting library (and other associated artifacts) will be returned on
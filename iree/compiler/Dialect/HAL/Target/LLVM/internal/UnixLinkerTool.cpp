@@ -82,7 +82,7 @@ class UnixLinkerTool : public LinkerTool {
   }
 
   LogicalResult configureModule(llvm::Module *llvmModule,
-                                ArrayRef<StringRef> entryPointNames) override {
+                                ArrayRef<StringRef> exportedNames) override {
     // Enable frame pointers to ensure that stack unwinding works, e.g. in
     // Tracy. In principle this could also be achieved by enabling unwind
     // tables, but we tried that and that didn't work in Tracy (which uses
@@ -35,7 +35,7 @@ class WindowsLinkerTool : public LinkerTool {
   }
 
   LogicalResult configureModule(llvm::Module *llvmModule,
-                                ArrayRef<StringRef> entryPointNames) override {
+                                ArrayRef<StringRef> exportedNames) override {
     auto &ctx = llvmModule->getContext();
 
     // Create a _DllMainCRTStartup replacement that does not initialize the CRT.
@@ -64,20 +64,17 @@ class WindowsLinkerTool : public LinkerTool {
       builder.CreateRet(one);
     }
 
-    // For now we ensure that our entry points are exported (via linker
-    // directives embedded in the object file) and in a compatible calling
-    // convention.
-    // TODO(benvanik): switch to executable libraries w/ internal functions.
-    for (auto entryPointName : entryPointNames) {
-      auto *entryPointFn = llvmModule->getFunction(entryPointName);
-      entryPointFn->setCallingConv(llvm::CallingConv::X86_StdCall);
-      entryPointFn->setDLLStorageClass(
+    // Ensure that the exported functions (the executable library query
+    // function) are exported via linker directives embedded in the object
+    // file. Entry points are internal and only reachable through the library.
+    for (auto exportedName : exportedNames) {
+      auto *exportedFn = llvmModule->getFunction(exportedName);
+      exportedFn->setDLLStorageClass(
           llvm::GlobalValue::DLLStorageClassTypes::DLLExportStorageClass);
-      entryPointFn->setLinkage(
-          llvm::GlobalValue::LinkageTypes::ExternalLinkage);
-      entryPointFn->setVisibility(
+      exportedFn->setLinkage(llvm::GlobalValue::LinkageTypes::ExternalLinkage);
+      exportedFn->setVisibility(
           llvm::GlobalValue::VisibilityTypes::DefaultVisibility);
-      entryPointFn->addFnAttr(llvm::Attribute::UWTable);
+      exportedFn->addFnAttr(llvm::Attribute::UWTable);
     }
 
     return success();
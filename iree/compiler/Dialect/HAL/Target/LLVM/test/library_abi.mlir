@@ -0,0 +1,41 @@
+// RUN: iree-opt -iree-hal-transformation-pipeline -iree-hal-target-backends=dylib-llvm-aot -iree-llvm-print-library-ir %s 2>&1 >/dev/null | IreeFileCheck %s
+
+// Checks the executable library interface exported by LLVM AOT libraries
+// against iree/hal/local/executable_library.h.
+
+flow.executable @simpleMath_ex_dispatch_0 {
+  flow.dispatch.entry @simpleMath_rgn_dispatch_0 attributes {
+    workload = 4 : index
+  }
+  module {
+    func @simpleMath_rgn_dispatch_0(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+      %0 = mhlo.add %arg0, %arg0 : tensor<4xf32>
+      return %0 : tensor<4xf32>
+    }
+  }
+}
+
+// iree_hal_executable_library_header_t and iree_hal_executable_library_v0_t:
+// CHECK-DAG: %iree_hal_executable_library_header_t = type { i32, i8* }
+// CHECK-DAG: %iree_hal_executable_library_v0_t = type { %iree_hal_executable_library_header_t*, i32, void (i8*, i32*, i32*, i32*, i32*, i8**)**, i8**, i8** }
+
+// The library is version 0 and lists the thunk of each entry point by ordinal
+// along with the entry point names.
+// CHECK-DAG: @[[NAME:__iree_string[0-9.]*]] = private unnamed_addr constant [26 x i8] c"simpleMath_rgn_dispatch_0\00"
+// CHECK-DAG: @__iree_entry_points = private constant [1 x void (i8*, i32*, i32*, i32*, i32*, i8**)*] [void (i8*, i32*, i32*, i32*, i32*, i8**)* @simpleMath_rgn_dispatch_0_thunk]
+// CHECK-DAG: @__iree_entry_point_names = private constant [1 x i8*] [i8* getelementptr inbounds ([26 x i8], [26 x i8]* @[[NAME]], i32 0, i32 0)]
+// CHECK-DAG: @__iree_library_header = private constant %iree_hal_executable_library_header_t { i32 0, i8* getelementptr
+// CHECK-DAG: @__iree_library = private constant %iree_hal_executable_library_v0_t { %iree_hal_executable_library_header_t* @__iree_library_header, i32 1, void (i8*, i32*, i32*, i32*, i32*, i8**)** getelementptr inbounds ({{.+}} @__iree_entry_points, i32 0, i32 0), i8** getelementptr inbounds ([1 x i8*], [1 x i8*]* @__iree_entry_point_names, i32 0, i32 0), i8** null }
+
+// The codegen entry point is internal and only reachable through the thunk,
+// which forwards the dispatch_v0 arguments in the order codegen expects:
+//   (bindings, push_constants, workgroup_id, workgroup_count, workgroup_size)
+// CHECK-DAG: define internal void @simpleMath_rgn_dispatch_0(
+// CHECK-LABEL: define internal void @simpleMath_rgn_dispatch_0_thunk(i8* %state, i32* %workgroup_id, i32* %workgroup_size, i32* %workgroup_count, i32* %push_constants, i8** %bindings)
+// CHECK: call void @simpleMath_rgn_dispatch_0(i8** %bindings, {{[^,]+}} %push_constants{{[0-9]*}}, {{[^,]+}} %workgroup_id{{[0-9]*}}, {{[^,]+}} %workgroup_count{{[0-9]*}}, {{[^,]+}} %workgroup_size{{[0-9]*}})
+// CHECK-NEXT: ret void
+
+// The query function is the only exported symbol and returns the library.
+// CHECK-LABEL: define %iree_hal_executable_library_header_t** @iree_hal_executable_library_query(i32 %max_version)
+// CHECK-NEXT: entry:
+// CHECK-NEXT: ret %iree_hal_executable_library_header_t** bitcast (%iree_hal_executable_library_v0_t* @__iree_library to %iree_hal_executable_library_header_t**)
@@ -11,6 +11,18 @@ vm.module @hal {
 vm.import @ex.shared_device() -> !vm.ref<!hal.device>
 attributes {nosideeffects}
 
+// Submits command buffers to the device queue without waiting. Execution
+// begins once all wait semaphores reach their values and the signal
+// semaphores are signaled to their values upon completion.
+vm.import @ex.submit(
+  %device : !vm.ref<!hal.device>,
+  %wait_semaphores : !vm.ref<!hal.semaphore> ...,
+  %wait_values : i32 ...,
+  %command_buffers : !vm.ref<!hal.command_buffer> ...,
+  %signal_semaphores : !vm.ref<!hal.semaphore> ...,
+  %signal_values : i32 ...
+)
+
 vm.import @ex.submit_and_wait(
   %device : !vm.ref<!hal.device>,
   %command_buffer : !vm.ref<!hal.command_buffer>
@@ -64,7 +64,8 @@ struct VMOpAsmInterface : public OpAsmDialectInterface {
       os << globalLoadOp.global();
     } else if (isa<ConstRefZeroOp>(op)) {
       os << "null";
-    } else if (isa<ConstI32ZeroOp>(op) || isa<ConstI64ZeroOp>(op)) {
+    } else if (isa<ConstI32ZeroOp>(op) || isa<ConstI64ZeroOp>(op) ||
+               isa<ConstF32ZeroOp>(op) || isa<ConstF64ZeroOp>(op)) {
       os << "zero";
     } else if (auto constOp = dyn_cast<ConstI32Op>(op)) {
       getIntegerName(constOp.value().dyn_cast<IntegerAttr>(), os);
@@ -101,6 +102,20 @@ struct VMOpAsmInterface : public OpAsmDialectInterface {
       os << "ugte";
     } else if (isa<CmpNZI32Op>(op) || isa<CmpNZI64Op>(op)) {
       os << "nz";
+    } else if (isa<CmpEQF32Op>(op) || isa<CmpEQF64Op>(op)) {
+      os << "oeq";
+    } else if (isa<CmpNEF32Op>(op) || isa<CmpNEF64Op>(op)) {
+      os << "une";
+    } else if (isa<CmpLTF32Op>(op) || isa<CmpLTF64Op>(op)) {
+      os << "olt";
+    } else if (isa<CmpLTEF32Op>(op) || isa<CmpLTEF64Op>(op)) {
+      os << "olte";
+    } else if (isa<CmpGTF32Op>(op) || isa<CmpGTF64Op>(op)) {
+      os << "ogt";
+    } else if (isa<CmpGTEF32Op>(op) || isa<CmpGTEF64Op>(op)) {
+      os << "ogte";
+    } else if (isa<CmpNZF32Op>(op) || isa<CmpNZF64Op>(op)) {
+      os << "nz";
     } else if (isa<CmpEQRefOp>(op)) {
       os << "req";
     } else if (isa<CmpNERefOp>(op)) {
@@ -285,6 +300,20 @@ Operation *VMDialect::materializeConstant(OpBuilder &builder, Attribute value,
       return builder.create<VM::ConstI64ZeroOp>(loc);
     }
     return builder.create<VM::ConstI64Op>(loc, convertedValue);
+  } else if (ConstF32Op::isBuildableWith(value, type)) {
+    auto convertedValue = ConstF32Op::convertConstValue(value);
+    auto floatValue = convertedValue.dyn_cast<FloatAttr>();
+    if (floatValue && floatValue.getValue().isPosZero()) {
+      return builder.create<VM::ConstF32ZeroOp>(loc);
+    }
+    return builder.create<VM::ConstF32Op>(loc, convertedValue);
+  } else if (ConstF64Op::isBuildableWith(value, type)) {
+    auto convertedValue = ConstF64Op::convertConstValue(value);
+    auto floatValue = convertedValue.dyn_cast<FloatAttr>();
+    if (floatValue && floatValue.getValue().isPosZero()) {
+      return builder.create<VM::ConstF64ZeroOp>(loc);
+    }
+    return builder.create<VM::ConstF64Op>(loc, convertedValue);
   } else if (type.isa<IREE::VM::RefType>()) {
     // The only constant type we support for ref_ptrs is null so we can just
     // emit that here.
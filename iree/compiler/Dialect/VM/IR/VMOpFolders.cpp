@@ -16,6 +16,7 @@
 
 #include "iree/compiler/Dialect/VM/IR/VMDialect.h"
 #include "iree/compiler/Dialect/VM/IR/VMOps.h"
+#include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/StringExtras.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
@@ -105,8 +106,15 @@ struct DropDefaultConstGlobalOpInitializer : public OpRewritePattern<T> {
   LogicalResult matchAndRewrite(T op,
                                 PatternRewriter &rewriter) const override {
     if (!op.initial_value().hasValue()) return failure();
-    auto value = op.initial_valueAttr().template cast<IntegerAttr>();
-    if (value.getValue() != 0) return failure();
+    auto value = op.initial_valueAttr();
+    if (auto intValue = value.template dyn_cast<IntegerAttr>()) {
+      if (intValue.getValue() != 0) return failure();
+    } else if (auto floatValue = value.template dyn_cast<FloatAttr>()) {
+      // Only +0.0 matches the zero-initialized bit pattern.
+      if (!floatValue.getValue().isPosZero()) return failure();
+    } else {
+      return failure();
+    }
     rewriter.replaceOpWithNewOp<T>(op, op.sym_name(), op.is_mutable(),
                                    op.type(),
                                    llvm::to_vector<4>(op->getDialectAttrs()));
@@ -128,6 +136,18 @@ void GlobalI64Op::getCanonicalizationPatterns(OwningRewritePatternList &results,
                  DropDefaultConstGlobalOpInitializer<GlobalI64Op>>(context);
 }
 
+void GlobalF32Op::getCanonicalizationPatterns(OwningRewritePatternList &results,
+                                              MLIRContext *context) {
+  results.insert<InlineConstGlobalOpInitializer<GlobalF32Op>,
+                 DropDefaultConstGlobalOpInitializer<GlobalF32Op>>(context);
+}
+
+void GlobalF64Op::getCanonicalizationPatterns(OwningRewritePatternList &results,
+                                              MLIRContext *context) {
+  results.insert<InlineConstGlobalOpInitializer<GlobalF64Op>,
+                 DropDefaultConstGlobalOpInitializer<GlobalF64Op>>(context);
+}
+
 void GlobalRefOp::getCanonicalizationPatterns(OwningRewritePatternList &results,
                                               MLIRContext *context) {
   results.insert<InlineConstGlobalOpInitializer<GlobalRefOp>>(context);
@@ -138,7 +158,7 @@ namespace {
 /// Inlines immutable global constants into their loads.
 template <typename LOAD_OP, typename GLOBAL_OP, typename CONST_OP,
           typename CONST_ZERO_OP>
-struct InlineConstGlobalLoadIntegerOp : public OpRewritePattern<LOAD_OP> {
+struct InlineConstGlobalLoadPrimitiveOp : public OpRewritePattern<LOAD_OP> {
   using OpRewritePattern<LOAD_OP>::OpRewritePattern;
   LogicalResult matchAndRewrite(LOAD_OP op,
                                 PatternRewriter &rewriter) const override {
@@ -162,15 +182,29 @@ struct InlineConstGlobalLoadIntegerOp : public OpRewritePattern<LOAD_OP> {
 
 void GlobalLoadI32Op::getCanonicalizationPatterns(
     OwningRewritePatternList &results, MLIRContext *context) {
-  results.insert<InlineConstGlobalLoadIntegerOp<GlobalLoadI32Op, GlobalI32Op,
-                                                ConstI32Op, ConstI32ZeroOp>>(
+  results.insert<InlineConstGlobalLoadPrimitiveOp<GlobalLoadI32Op, GlobalI32Op,
+                                                  ConstI32Op, ConstI32ZeroOp>>(
       context);
 }
 
 void GlobalLoadI64Op::getCanonicalizationPatterns(
     OwningRewritePatternList &results, MLIRContext *context) {
-  results.insert<InlineConstGlobalLoadIntegerOp<GlobalLoadI64Op, GlobalI64Op,
-                                                ConstI64Op, ConstI64ZeroOp>>(
+  results.insert<InlineConstGlobalLoadPrimitiveOp<GlobalLoadI64Op, GlobalI64Op,
+                                                  ConstI64Op, ConstI64ZeroOp>>(
+      context);
+}
+
+void GlobalLoadF32Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<InlineConstGlobalLoadPrimitiveOp<GlobalLoadF32Op, GlobalF32Op,
+                                                  ConstF32Op, ConstF32ZeroOp>>(
+      context);
+}
+
+void GlobalLoadF64Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<InlineConstGlobalLoadPrimitiveOp<GlobalLoadF64Op, GlobalF64Op,
+                                                  ConstF64Op, ConstF64ZeroOp>>(
       context);
 }
 
@@ -233,6 +267,20 @@ void GlobalLoadIndirectI64Op::getCanonicalizationPatterns(
       context);
 }
 
+void GlobalLoadIndirectF32Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<
+      PropagateGlobalLoadAddress<GlobalLoadIndirectF32Op, GlobalLoadF32Op>>(
+      context);
+}
+
+void GlobalLoadIndirectF64Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<
+      PropagateGlobalLoadAddress<GlobalLoadIndirectF64Op, GlobalLoadF64Op>>(
+      context);
+}
+
 void GlobalLoadIndirectRefOp::getCanonicalizationPatterns(
     OwningRewritePatternList &results, MLIRContext *context) {
   results.insert<
@@ -273,6 +321,20 @@ void GlobalStoreIndirectI64Op::getCanonicalizationPatterns(
       context);
 }
 
+void GlobalStoreIndirectF32Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<
+      PropagateGlobalStoreAddress<GlobalStoreIndirectF32Op, GlobalStoreF32Op>>(
+      context);
+}
+
+void GlobalStoreIndirectF64Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<
+      PropagateGlobalStoreAddress<GlobalStoreIndirectF64Op, GlobalStoreF64Op>>(
+      context);
+}
+
 void GlobalStoreIndirectRefOp::getCanonicalizationPatterns(
     OwningRewritePatternList &results, MLIRContext *context) {
   results.insert<
@@ -296,6 +358,18 @@ OpFoldResult ConstI64ZeroOp::fold(ArrayRef<Attribute> operands) {
   return IntegerAttr::get(getResult().getType(), 0);
 }
 
+OpFoldResult ConstF32Op::fold(ArrayRef<Attribute> operands) { return value(); }
+
+OpFoldResult ConstF64Op::fold(ArrayRef<Attribute> operands) { return value(); }
+
+OpFoldResult ConstF32ZeroOp::fold(ArrayRef<Attribute> operands) {
+  return FloatAttr::get(getResult().getType(), 0.0);
+}
+
+OpFoldResult ConstF64ZeroOp::fold(ArrayRef<Attribute> operands) {
+  return FloatAttr::get(getResult().getType(), 0.0);
+}
+
 OpFoldResult ConstRefZeroOp::fold(ArrayRef<Attribute> operands) {
   // TODO(b/144027097): relace unit attr with a proper null ref_ptr attr.
   return UnitAttr::get(getContext());
@@ -332,6 +406,14 @@ OpFoldResult SelectI64Op::fold(ArrayRef<Attribute> operands) {
   return foldSelectOp(*this);
 }
 
+OpFoldResult SelectF32Op::fold(ArrayRef<Attribute> operands) {
+  return foldSelectOp(*this);
+}
+
+OpFoldResult SelectF64Op::fold(ArrayRef<Attribute> operands) {
+  return foldSelectOp(*this);
+}
+
 OpFoldResult SelectRefOp::fold(ArrayRef<Attribute> operands) {
   return foldSelectOp(*this);
 }
@@ -787,6 +869,117 @@ OpFoldResult ShrI64UOp::fold(ArrayRef<Attribute> operands) {
   return foldShrUOp(*this, operands);
 }
 
+//===----------------------------------------------------------------------===//
+// Native floating-point arithmetic
+//===----------------------------------------------------------------------===//
+// NOTE: identities such as x + 0 = x do not hold for all IEEE values (-0, NaN)
+// so only fully-constant operations are folded.
+
+OpFoldResult AddF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a + b; });
+}
+
+OpFoldResult AddF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a + b; });
+}
+
+OpFoldResult SubF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a - b; });
+}
+
+OpFoldResult SubF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a - b; });
+}
+
+OpFoldResult MulF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a * b; });
+}
+
+OpFoldResult MulF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a * b; });
+}
+
+OpFoldResult DivF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a / b; });
+}
+
+OpFoldResult DivF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) { return a / b; });
+}
+
+template <typename T>
+static OpFoldResult foldRemFOp(T op, ArrayRef<Attribute> operands) {
+  return constFoldBinaryOp<FloatAttr>(
+      operands, [](const APFloat &a, const APFloat &b) {
+        // Matches the C fmod semantics used by the runtime.
+        APFloat result = a;
+        result.mod(b);
+        return result;
+      });
+}
+
+OpFoldResult RemF32Op::fold(ArrayRef<Attribute> operands) {
+  return foldRemFOp(*this, operands);
+}
+
+OpFoldResult RemF64Op::fold(ArrayRef<Attribute> operands) {
+  return foldRemFOp(*this, operands);
+}
+
+OpFoldResult AbsF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldUnaryOp<FloatAttr>(
+      operands, [](const APFloat &a) { return llvm::abs(a); });
+}
+
+OpFoldResult AbsF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldUnaryOp<FloatAttr>(
+      operands, [](const APFloat &a) { return llvm::abs(a); });
+}
+
+OpFoldResult NegF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldUnaryOp<FloatAttr>(
+      operands, [](const APFloat &a) { return llvm::neg(a); });
+}
+
+OpFoldResult NegF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldUnaryOp<FloatAttr>(
+      operands, [](const APFloat &a) { return llvm::neg(a); });
+}
+
+template <typename T>
+static OpFoldResult foldRoundFOp(T op, ArrayRef<Attribute> operands,
+                                 APFloat::roundingMode roundingMode) {
+  return constFoldUnaryOp<FloatAttr>(operands, [&](const APFloat &a) {
+    APFloat result = a;
+    result.roundToIntegral(roundingMode);
+    return result;
+  });
+}
+
+OpFoldResult CeilF32Op::fold(ArrayRef<Attribute> operands) {
+  return foldRoundFOp(*this, operands, APFloat::rmTowardPositive);
+}
+
+OpFoldResult CeilF64Op::fold(ArrayRef<Attribute> operands) {
+  return foldRoundFOp(*this, operands, APFloat::rmTowardPositive);
+}
+
+OpFoldResult FloorF32Op::fold(ArrayRef<Attribute> operands) {
+  return foldRoundFOp(*this, operands, APFloat::rmTowardNegative);
+}
+
+OpFoldResult FloorF64Op::fold(ArrayRef<Attribute> operands) {
+  return foldRoundFOp(*this, operands, APFloat::rmTowardNegative);
+}
+
 //===----------------------------------------------------------------------===//
 // Casting and type conversion/emulation
 //===----------------------------------------------------------------------===//
@@ -896,6 +1089,89 @@ OpFoldResult ExtI32I64UOp::fold(ArrayRef<Attribute> operands) {
       [&](const APInt &a) { return a.zext(64); });
 }
 
+/// Folds a constant integer `operands` value to a floating-point value of
+/// `resultType`, rounding to nearest.
+static Attribute constFoldIntToFloatOp(Type resultType,
+                                       ArrayRef<Attribute> operands,
+                                       bool isSigned) {
+  auto operand = operands[0].dyn_cast_or_null<IntegerAttr>();
+  if (!operand) return {};
+  APFloat result(resultType.cast<FloatType>().getFloatSemantics());
+  result.convertFromAPInt(operand.getValue(), isSigned,
+                          APFloat::rmNearestTiesToEven);
+  return FloatAttr::get(resultType, result);
+}
+
+/// Folds a constant floating-point `operands` value to an integer value of
+/// `resultType`, rounding toward zero. Values that cannot be represented (NaN
+/// and out of range) are undefined at runtime and are not folded.
+static Attribute constFoldFloatToIntOp(Type resultType,
+                                       ArrayRef<Attribute> operands,
+                                       bool isSigned) {
+  auto operand = operands[0].dyn_cast_or_null<FloatAttr>();
+  if (!operand) return {};
+  llvm::APSInt result(resultType.getIntOrFloatBitWidth(),
+                      /*isUnsigned=*/!isSigned);
+  bool isExact = false;
+  auto status = operand.getValue().convertToInteger(
+      result, APFloat::rmTowardZero, &isExact);
+  if (status & APFloat::opInvalidOp) return {};
+  return IntegerAttr::get(resultType, result);
+}
+
+/// Folds a constant floating-point `operands` value to the floating-point
+/// semantics of `resultType`.
+static Attribute constFoldFloatToFloatOp(Type resultType,
+                                         ArrayRef<Attribute> operands) {
+  auto operand = operands[0].dyn_cast_or_null<FloatAttr>();
+  if (!operand) return {};
+  APFloat result = operand.getValue();
+  bool losesInfo = false;
+  result.convert(resultType.cast<FloatType>().getFloatSemantics(),
+                 APFloat::rmNearestTiesToEven, &losesInfo);
+  return FloatAttr::get(resultType, result);
+}
+
+OpFoldResult CastSI32F32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldIntToFloatOp(getType(), operands, /*isSigned=*/true);
+}
+
+OpFoldResult CastUI32F32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldIntToFloatOp(getType(), operands, /*isSigned=*/false);
+}
+
+OpFoldResult CastF32SI32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatToIntOp(getType(), operands, /*isSigned=*/true);
+}
+
+OpFoldResult CastF32UI32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatToIntOp(getType(), operands, /*isSigned=*/false);
+}
+
+OpFoldResult CastSI32F64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldIntToFloatOp(getType(), operands, /*isSigned=*/true);
+}
+
+OpFoldResult CastUI32F64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldIntToFloatOp(getType(), operands, /*isSigned=*/false);
+}
+
+OpFoldResult CastF64SI32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatToIntOp(getType(), operands, /*isSigned=*/true);
+}
+
+OpFoldResult CastF64UI32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatToIntOp(getType(), operands, /*isSigned=*/false);
+}
+
+OpFoldResult ExtF32F64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatToFloatOp(getType(), operands);
+}
+
+OpFoldResult TruncF64F32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatToFloatOp(getType(), operands);
+}
+
 namespace {
 
 template <typename SRC_OP, typename OP_A, int SZ_T, typename OP_B>
@@ -1360,6 +1636,125 @@ OpFoldResult CmpNZI64Op::fold(ArrayRef<Attribute> operands) {
       operands, [&](const APInt &a) { return APInt(64, a.getBoolValue()); });
 }
 
+/// Performs const folding of an IEEE comparison of the two scalar attributes in
+/// `operands` with `predicate` and returns an i32 boolean result if possible.
+static Attribute constFoldFloatCmpOp(
+    Type resultType, ArrayRef<Attribute> operands,
+    function_ref<bool(APFloat::cmpResult)> predicate) {
+  assert(operands.size() == 2 && "binary op takes two operands");
+  auto lhs = operands[0].dyn_cast_or_null<FloatAttr>();
+  auto rhs = operands[1].dyn_cast_or_null<FloatAttr>();
+  if (!lhs || !rhs) return {};
+  bool result = predicate(lhs.getValue().compare(rhs.getValue()));
+  return IntegerAttr::get(resultType, result ? 1 : 0);
+}
+
+OpFoldResult CmpEQF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpEqual;
+  });
+}
+
+OpFoldResult CmpEQF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpEqual;
+  });
+}
+
+OpFoldResult CmpNEF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r != APFloat::cmpEqual;
+  });
+}
+
+OpFoldResult CmpNEF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r != APFloat::cmpEqual;
+  });
+}
+
+OpFoldResult CmpLTF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpLessThan;
+  });
+}
+
+OpFoldResult CmpLTF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpLessThan;
+  });
+}
+
+OpFoldResult CmpLTEF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpLessThan || r == APFloat::cmpEqual;
+  });
+}
+
+OpFoldResult CmpLTEF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpLessThan || r == APFloat::cmpEqual;
+  });
+}
+
+OpFoldResult CmpGTF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpGreaterThan;
+  });
+}
+
+void CmpGTF32Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<RewritePseudoCmpGTToLT<CmpGTF32Op, CmpLTF32Op>>(context);
+}
+
+OpFoldResult CmpGTF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpGreaterThan;
+  });
+}
+
+void CmpGTF64Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  results.insert<RewritePseudoCmpGTToLT<CmpGTF64Op, CmpLTF64Op>>(context);
+}
+
+OpFoldResult CmpGTEF32Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpGreaterThan || r == APFloat::cmpEqual;
+  });
+}
+
+void CmpGTEF32Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  // NOTE: !(lhs < rhs) is not valid for NaN so only the operands are swapped.
+  results.insert<RewritePseudoCmpGTToLT<CmpGTEF32Op, CmpLTEF32Op>>(context);
+}
+
+OpFoldResult CmpGTEF64Op::fold(ArrayRef<Attribute> operands) {
+  return constFoldFloatCmpOp(getType(), operands, [](APFloat::cmpResult r) {
+    return r == APFloat::cmpGreaterThan || r == APFloat::cmpEqual;
+  });
+}
+
+void CmpGTEF64Op::getCanonicalizationPatterns(
+    OwningRewritePatternList &results, MLIRContext *context) {
+  // NOTE: !(lhs < rhs) is not valid for NaN so only the operands are swapped.
+  results.insert<RewritePseudoCmpGTToLT<CmpGTEF64Op, CmpLTEF64Op>>(context);
+}
+
+OpFoldResult CmpNZF32Op::fold(ArrayRef<Attribute> operands) {
+  auto operand = operands[0].dyn_cast_or_null<FloatAttr>();
+  if (!operand) return {};
+  return IntegerAttr::get(getType(), operand.getValue().isZero() ? 0 : 1);
+}
+
+OpFoldResult CmpNZF64Op::fold(ArrayRef<Attribute> operands) {
+  auto operand = operands[0].dyn_cast_or_null<FloatAttr>();
+  if (!operand) return {};
+  return IntegerAttr::get(getType(), operand.getValue().isZero() ? 0 : 1);
+}
+
 OpFoldResult CmpEQRefOp::fold(ArrayRef<Attribute> operands) {
   if (lhs() == rhs()) {
     // x == x = true
@@ -1740,7 +2135,7 @@ namespace {
 
 /// Rewrites a check op to a cmp and a cond_fail.
 template <typename CheckOp, typename CmpI32Op, typename CmpI64Op,
-          typename CmpRefOp>
+          typename CmpF32Op, typename CmpF64Op, typename CmpRefOp>
 struct RewriteCheckToCondFail : public OpRewritePattern<CheckOp> {
   using OpRewritePattern<CheckOp>::OpRewritePattern;
   LogicalResult matchAndRewrite(CheckOp op,
@@ -1760,6 +2155,14 @@ struct RewriteCheckToCondFail : public OpRewritePattern<CheckOp> {
       condValue = rewriter.template createOrFold<CmpI32Op>(
           op.getLoc(), ArrayRef<Type>{condType},
           op.getOperation()->getOperands());
+    } else if (operandType.isF32()) {
+      condValue = rewriter.template createOrFold<CmpF32Op>(
+          op.getLoc(), ArrayRef<Type>{condType},
+          op.getOperation()->getOperands());
+    } else if (operandType.isF64()) {
+      condValue = rewriter.template createOrFold<CmpF64Op>(
+          op.getLoc(), ArrayRef<Type>{condType},
+          op.getOperation()->getOperands());
     } else {
       return failure();
     }
@@ -1778,22 +2181,22 @@ struct RewriteCheckToCondFail : public OpRewritePattern<CheckOp> {
 
 void CheckEQOp::getCanonicalizationPatterns(OwningRewritePatternList &results,
                                             MLIRContext *context) {
-  results.insert<
-      RewriteCheckToCondFail<CheckEQOp, CmpEQI32Op, CmpEQI64Op, CmpEQRefOp>>(
+  results.insert<RewriteCheckToCondFail<CheckEQOp, CmpEQI32Op, CmpEQI64Op,
+                                        CmpEQF32Op, CmpEQF64Op, CmpEQRefOp>>(
       context);
 }
 
 void CheckNEOp::getCanonicalizationPatterns(OwningRewritePatternList &results,
                                             MLIRContext *context) {
-  results.insert<
-      RewriteCheckToCondFail<CheckNEOp, CmpNEI32Op, CmpNEI64Op, CmpNERefOp>>(
+  results.insert<RewriteCheckToCondFail<CheckNEOp, CmpNEI32Op, CmpNEI64Op,
+                                        CmpNEF32Op, CmpNEF64Op, CmpNERefOp>>(
       context);
 }
 
 void CheckNZOp::getCanonicalizationPatterns(OwningRewritePatternList &results,
                                             MLIRContext *context) {
-  results.insert<
-      RewriteCheckToCondFail<CheckNZOp, CmpNZI32Op, CmpNZI64Op, CmpNZRefOp>>(
+  results.insert<RewriteCheckToCondFail<CheckNZOp, CmpNZI32Op, CmpNZI64Op,
+                                        CmpNZF32Op, CmpNZF64Op, CmpNZRefOp>>(
       context);
 }
 
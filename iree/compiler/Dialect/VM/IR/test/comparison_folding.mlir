@@ -450,3 +450,34 @@ vm.module @cmp_nz_ref_folds {
     vm.return %ne : i32
   }
 }
+
+// -----
+
+// CHECK-LABEL: @cmp_f32_folds
+vm.module @cmp_f32_folds {
+  // CHECK-LABEL: @gt_to_lt
+  vm.func @gt_to_lt(%arg0 : f32, %arg1 : f32) -> i32 {
+    // CHECK: %olt = vm.cmp.lt.f32 %arg1, %arg0 : f32
+    // CHECK-NEXT: vm.return %olt : i32
+    %gt = vm.cmp.gt.f32 %arg0, %arg1 : f32
+    vm.return %gt : i32
+  }
+
+  // CHECK-LABEL: @self_eq
+  vm.func @self_eq(%arg0 : f32) -> i32 {
+    // x == x is false for NaN and must not fold.
+    // CHECK: %oeq = vm.cmp.eq.f32 %arg0, %arg0 : f32
+    // CHECK-NEXT: vm.return %oeq : i32
+    %eq = vm.cmp.eq.f32 %arg0, %arg0 : f32
+    vm.return %eq : i32
+  }
+
+  // CHECK-LABEL: @const_nan_ne
+  vm.func @const_nan_ne() -> i32 {
+    // CHECK: %c1 = vm.const.i32 1 : i32
+    // CHECK-NEXT: vm.return %c1 : i32
+    %nan = vm.const.f32 0x7FC00000 : f32
+    %ne = vm.cmp.ne.f32 %nan, %nan : f32
+    vm.return %ne : i32
+  }
+}
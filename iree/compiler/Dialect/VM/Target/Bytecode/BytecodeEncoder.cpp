@@ -115,6 +115,21 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     }
   }
 
+  LogicalResult encodeFloatAttr(FloatAttr value) override {
+    auto attr = value.cast<FloatAttr>();
+    unsigned int bitWidth = attr.getType().getIntOrFloatBitWidth();
+    uint64_t bits = attr.getValue().bitcastToAPInt().getZExtValue();
+    switch (bitWidth) {
+      case 32:
+        return writeUint32(static_cast<uint32_t>(bits));
+      case 64:
+        return writeUint64(bits);
+      default:
+        return currentOp_->emitOpError()
+               << "attribute of bitwidth " << bitWidth << " not supported";
+    }
+  }
+
   LogicalResult encodeIntArrayAttr(DenseIntElementsAttr value) override {
     if (value.getNumElements() > UINT16_MAX ||
         failed(writeUint16(value.getNumElements()))) {
@@ -153,17 +168,24 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     // Compute required remappings - we only need to emit them when the source
     // and dest registers differ. Hopefully the allocator did a good job and
     // this list is small :)
+    //
+    // The i32 and ref remappings are emitted as two separate lists so that the
+    // runtime can remap each bank without checking the type of each register.
+    // The banks are disjoint so this preserves the hazard-free ordering within
+    // each bank produced by the allocator.
     auto srcDstRegs = registerAllocation_->remapSuccessorRegisters(
         currentOp_, successorIndex);
-    writeUint16(srcDstRegs.size());
+    SmallVector<std::pair<Register, Register>, 8> i32SrcDstRegs;
+    SmallVector<std::pair<Register, Register>, 8> refSrcDstRegs;
     for (auto srcDstReg : srcDstRegs) {
-      if (failed(writeUint16(srcDstReg.first.encode())) ||
-          failed(writeUint16(srcDstReg.second.encode()))) {
-        return failure();
+      if (srcDstReg.first.isRef()) {
+        refSrcDstRegs.push_back(srcDstReg);
+      } else {
+        i32SrcDstRegs.push_back(srcDstReg);
       }
     }
-
-    return success();
+    return failure(failed(writeRemapList(i32SrcDstRegs)) ||
+                   failed(writeRemapList(refSrcDstRegs)));
   }
 
   LogicalResult encodeOperand(Value value, int ordinal) override {
@@ -203,6 +225,45 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     return success();
   }
 
+  // Encodes |cmpOp| and the vm.cond_br |branchOp| that immediately follows it
+  // and uses its result as the condition as a single superinstruction.
+  LogicalResult encodeCompareBranch(Opcode opcode, Operation *cmpOp,
+                                    CondBranchOp branchOp) {
+    if (failed(beginOp(cmpOp)) ||
+        failed(encodeOpcode(stringifyOpcode(opcode),
+                            static_cast<int>(opcode)))) {
+      return failure();
+    }
+    for (auto operand : llvm::enumerate(cmpOp->getOperands())) {
+      if (failed(encodeOperand(operand.value(), operand.index()))) {
+        return failure();
+      }
+    }
+    if (failed(endOp(cmpOp)) || failed(beginOp(branchOp)) ||
+        failed(encodeBranch(branchOp.getTrueDest(), branchOp.getTrueOperands(),
+                            0)) ||
+        failed(encodeBranch(branchOp.getFalseDest(),
+                            branchOp.getFalseOperands(), 1))) {
+      return failure();
+    }
+    return endOp(branchOp);
+  }
+
+  // Encodes |addOp| with the operand at |immOperandIndex| replaced by the
+  // constant |immValue|.
+  LogicalResult encodeAddImmediate(AddI32Op addOp, int immOperandIndex,
+                                   int32_t immValue) {
+    int operandIndex = immOperandIndex == 0 ? 1 : 0;
+    if (failed(beginOp(addOp)) ||
+        failed(encodeOpcode(stringifyOpcode(Opcode::AddI32Imm),
+                            static_cast<int>(Opcode::AddI32Imm))) ||
+        failed(encodeOperand(addOp.getOperand(operandIndex), operandIndex)) ||
+        failed(writeInt32(immValue)) || failed(encodeResult(addOp.result()))) {
+      return failure();
+    }
+    return endOp(addOp);
+  }
+
   Optional<std::vector<uint8_t>> finish() {
     if (failed(fixupOffsets())) {
       return llvm::None;
@@ -250,6 +311,18 @@ class V0BytecodeEncoder : public BytecodeEncoder {
     return writeBytes(&value, sizeof(value));
   }
 
+  LogicalResult writeRemapList(
+      ArrayRef<std::pair<Register, Register>> srcDstRegs) {
+    if (failed(writeUint16(srcDstRegs.size()))) return failure();
+    for (auto srcDstReg : srcDstRegs) {
+      if (failed(writeUint16(srcDstReg.first.encode())) ||
+          failed(writeUint16(srcDstReg.second.encode()))) {
+        return failure();
+      }
+    }
+    return success();
+  }
+
   LogicalResult fixupOffsets() {
     for (const auto &fixup : blockOffsetFixups_) {
       auto blockOffset = blockOffsets_.find(fixup.first);
@@ -274,12 +347,71 @@ class V0BytecodeEncoder : public BytecodeEncoder {
   std::vector<std::pair<Block *, size_t>> blockOffsetFixups_;
 };
 
+//===----------------------------------------------------------------------===//
+// Superinstruction selection
+//===----------------------------------------------------------------------===//
+// Common op sequences are encoded as single superinstruction opcodes to reduce
+// the per-op dispatch overhead of the interpreter. Superinstructions have no
+// corresponding VM ops and are only selected here during encoding.
+
+// Returns the compare-and-branch superinstruction |op| can be fused into with
+// |nextOp| if |nextOp| is a vm.cond_br that is the sole user of |op|.
+static Optional<Opcode> matchCompareBranch(Operation *op, Operation *nextOp) {
+  auto branchOp = dyn_cast_or_null<CondBranchOp>(nextOp);
+  if (!branchOp || op->getNumResults() != 1 ||
+      branchOp.condition() != op->getResult(0) ||
+      !op->getResult(0).hasOneUse()) {
+    return llvm::None;
+  }
+  if (isa<CmpEQI32Op>(op)) return Opcode::CondBranchEQI32;
+  if (isa<CmpNEI32Op>(op)) return Opcode::CondBranchNEI32;
+  if (isa<CmpLTI32SOp>(op)) return Opcode::CondBranchLTI32S;
+  if (isa<CmpLTI32UOp>(op)) return Opcode::CondBranchLTI32U;
+  if (isa<CmpNZI32Op>(op)) return Opcode::CondBranchNZI32;
+  return llvm::None;
+}
+
+// Returns the value of the vm.const.i32 defining |value|, if any.
+static Optional<int32_t> matchConstI32(Value value) {
+  auto constOp = dyn_cast_or_null<ConstI32Op>(value.getDefiningOp());
+  if (!constOp) return llvm::None;
+  return static_cast<int32_t>(
+      constOp.getOperation()->getAttrOfType<IntegerAttr>("value").getInt());
+}
+
+// Returns the index of the operand of |addOp| that will be encoded as an
+// immediate in an AddI32Imm superinstruction, if any. Prefers the rhs as that
+// is where canonicalization places constants.
+static Optional<int> matchAddImmediateOperand(AddI32Op addOp) {
+  if (matchConstI32(addOp.rhs())) return 1;
+  if (matchConstI32(addOp.lhs())) return 0;
+  return llvm::None;
+}
+
+// Returns true if |op| is a vm.const.i32 whose uses are all folded into
+// AddI32Imm superinstructions such that it need not be encoded at all.
+static bool isFoldedIntoSuperinstructions(Operation *op) {
+  if (!isa<ConstI32Op>(op) || op->use_empty()) return false;
+  for (auto &use : op->getUses()) {
+    auto addOp = dyn_cast<AddI32Op>(use.getOwner());
+    if (!addOp) return false;
+    auto immOperandIndex = matchAddImmediateOperand(addOp);
+    if (!immOperandIndex ||
+        immOperandIndex.getValue() !=
+            static_cast<int>(use.getOperandNumber()) ||
+        addOp.lhs() == addOp.rhs()) {
+      return false;
+    }
+  }
+  return true;
+}
+
 }  // namespace
 
 // static
 Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
     IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-    SymbolTable &symbolTable) {
+    SymbolTable &symbolTable, bool fuseSuperinstructions) {
   EncodedBytecodeFunction result;
 
   // Perform register allocation first so that we can quickly lookup values as
@@ -297,7 +429,38 @@ Optional<EncodedBytecodeFunction> BytecodeEncoder::encodeFunction(
       return llvm::None;
     }
 
-    for (auto &op : block.getOperations()) {
+    for (auto it = block.begin(); it != block.end(); ++it) {
+      auto &op = *it;
+      if (fuseSuperinstructions) {
+        if (isFoldedIntoSuperinstructions(&op)) continue;
+        auto nextIt = std::next(it);
+        auto compareBranchOpcode = matchCompareBranch(
+            &op, nextIt != block.end() ? &*nextIt : nullptr);
+        if (compareBranchOpcode) {
+          if (failed(encoder.encodeCompareBranch(
+                  compareBranchOpcode.getValue(), &op,
+                  cast<CondBranchOp>(&*nextIt)))) {
+            op.emitOpError() << "failed to encode compare-and-branch";
+            return llvm::None;
+          }
+          it = nextIt;
+          continue;
+        }
+        if (auto addOp = dyn_cast<AddI32Op>(&op)) {
+          if (auto immOperandIndex = matchAddImmediateOperand(addOp)) {
+            int32_t immValue =
+                matchConstI32(addOp.getOperand(immOperandIndex.getValue()))
+                    .getValue();
+            if (failed(encoder.encodeAddImmediate(
+                    addOp, immOperandIndex.getValue(), immValue))) {
+              op.emitOpError() << "failed to encode add immediate";
+              return llvm::None;
+            }
+            continue;
+          }
+        }
+      }
+
       auto *serializableOp =
           op.getAbstractOperation()->getInterface<IREE::VM::VMSerializableOp>();
       if (!serializableOp) {
@@ -24,6 +24,11 @@ namespace iree_compiler {
 namespace IREE {
 namespace VM {
 
+// Version of the bytecode encoding produced by BytecodeEncoder as a
+// BytecodeVersion enum value. Must be bumped along with the schema and the
+// runtime (IREE_VM_BYTECODE_VERSION) whenever the encoding changes.
+constexpr uint32_t kBytecodeVersion = 1;
+
 struct EncodedBytecodeFunction {
   std::vector<uint8_t> bytecodeData;
   uint16_t i32RegisterCount = 0;
@@ -34,10 +39,12 @@ struct EncodedBytecodeFunction {
 class BytecodeEncoder : public VMFuncEncoder {
  public:
   // Encodes a vm.func to bytecode and returns the result.
+  // When |fuseSuperinstructions| is set common op sequences are encoded as
+  // single superinstruction opcodes.
   // Returns None on failure.
   static Optional<EncodedBytecodeFunction> encodeFunction(
       IREE::VM::FuncOp funcOp, llvm::DenseMap<Type, int> &typeTable,
-      SymbolTable &symbolTable);
+      SymbolTable &symbolTable, bool fuseSuperinstructions = true);
 
   BytecodeEncoder() = default;
   ~BytecodeEncoder() = default;
@@ -376,7 +376,8 @@ static LogicalResult buildFlatBufferModule(BytecodeTargetOptions targetOptions,
   size_t totalBytecodeLength = 0;
   for (auto funcOp : llvm::enumerate(internalFuncOps)) {
     auto encodedFunction = BytecodeEncoder::encodeFunction(
-        funcOp.value(), typeOrdinalMap, symbolTable);
+        funcOp.value(), typeOrdinalMap, symbolTable,
+        targetOptions.fuseSuperinstructions);
     if (!encodedFunction) {
       return funcOp.value().emitError() << "failed to encode function bytecode";
     }
@@ -504,6 +505,7 @@ static LogicalResult buildFlatBufferModule(BytecodeTargetOptions targetOptions,
   iree_vm_BytecodeModuleDef_function_descriptors_add(fbb,
                                                      functionDescriptorsRef);
   iree_vm_BytecodeModuleDef_bytecode_data_add(fbb, bytecodeDataRef);
+  iree_vm_BytecodeModuleDef_bytecode_version_add(fbb, kBytecodeVersion);
   iree_vm_BytecodeModuleDef_end_as_root(fbb);
   return success();
 }
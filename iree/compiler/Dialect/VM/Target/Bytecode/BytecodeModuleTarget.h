@@ -53,6 +53,9 @@ struct BytecodeTargetOptions {
   bool stripSourceMap = false;
   // Strips vm ops with the VM_DebugOnly trait.
   bool stripDebugOps = false;
+
+  // Encodes common op sequences as single superinstruction opcodes.
+  bool fuseSuperinstructions = true;
 };
 
 // Translates a vm.module to a bytecode module flatbuffer.
@@ -66,6 +66,12 @@ static llvm::cl::opt<bool> stripDebugOpsFlag{
     llvm::cl::init(false),
 };
 
+static llvm::cl::opt<bool> fuseSuperinstructionsFlag{
+    "iree-vm-bytecode-module-fuse-superinstructions",
+    llvm::cl::desc("Encodes common op sequences as single superinstructions"),
+    llvm::cl::init(true),
+};
+
 BytecodeTargetOptions getBytecodeTargetOptionsFromFlags() {
   BytecodeTargetOptions targetOptions;
   targetOptions.outputFormat = outputFormatFlag;
@@ -73,6 +79,7 @@ BytecodeTargetOptions getBytecodeTargetOptionsFromFlags() {
   targetOptions.stripSymbols = stripSymbolsFlag;
   targetOptions.stripSourceMap = stripSourceMapFlag;
   targetOptions.stripDebugOps = stripDebugOpsFlag;
+  targetOptions.fuseSuperinstructions = fuseSuperinstructionsFlag;
   return targetOptions;
 }
 
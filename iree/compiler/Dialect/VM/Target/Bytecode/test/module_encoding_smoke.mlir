@@ -29,4 +29,5 @@ vm.module @simple_module {
   // CHECK-NEXT:   0,
   // CHECK-NEXT:   0
   // CHECK-NEXT: ]
+  // CHECK-NEXT: "bytecode_version": "V1"
 }
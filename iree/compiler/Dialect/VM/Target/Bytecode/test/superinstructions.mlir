@@ -0,0 +1,54 @@
+// RUN: iree-translate -split-input-file -iree-vm-ir-to-bytecode-module -iree-vm-bytecode-module-output-format=flatbuffer-text %s | IreeFileCheck %s
+// RUN: iree-translate -split-input-file -iree-vm-ir-to-bytecode-module -iree-vm-bytecode-module-output-format=flatbuffer-text -iree-vm-bytecode-module-fuse-superinstructions=false %s | IreeFileCheck %s --check-prefix=NOFUSE
+
+vm.module @add_imm_module {
+  vm.export @add_imm
+  vm.func @add_imm(%arg0 : i32) -> i32 {
+    %c5 = vm.const.i32 5 : i32
+    %0 = vm.add.i32 %arg0, %c5 : i32
+    vm.return %0 : i32
+  }
+  //      CHECK: "bytecode_data": [
+  // AddI32Imm %arg0, 5:
+  // CHECK-NEXT:   48,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   5,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+
+  // ConstI32 5:
+  //      NOFUSE: "bytecode_data": [
+  // NOFUSE-NEXT:   9,
+  // NOFUSE-NEXT:   5,
+}
+
+// -----
+
+vm.module @cmp_branch_module {
+  vm.export @cmp_branch
+  vm.func @cmp_branch(%arg0 : i32, %arg1 : i32) -> i32 {
+    %cmp = vm.cmp.lt.i32.s %arg0, %arg1 : i32
+    vm.cond_br %cmp, ^bb1, ^bb2
+  ^bb1:
+    vm.return %arg0 : i32
+  ^bb2:
+    vm.return %arg1 : i32
+  }
+  //      CHECK: "bytecode_data": [
+  // CondBranchLTI32S %arg0, %arg1:
+  // CHECK-NEXT:   88,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   0,
+  // CHECK-NEXT:   1,
+  // CHECK-NEXT:   0,
+
+  // CmpLTI32S %arg0, %arg1:
+  //      NOFUSE: "bytecode_data": [
+  // NOFUSE-NEXT:   66,
+  // NOFUSE-NEXT:   0,
+  // NOFUSE-NEXT:   0,
+  // NOFUSE-NEXT:   1,
+  // NOFUSE-NEXT:   0,
+}
@@ -30,6 +30,7 @@ namespace VM {
 //
 // Examples:
 //  i32              -> i
+//  f32              -> f
 //  !vm.ref<...>     -> r
 //  tuple<i32, i64>  -> iI
 LogicalResult encodeCallingConventionType(Operation *op, Type type,
@@ -47,6 +48,19 @@ LogicalResult encodeCallingConventionType(Operation *op, Type type,
         s.push_back('I');
         return success();
     }
+  } else if (auto floatType = type.dyn_cast<FloatType>()) {
+    switch (floatType.getWidth()) {
+      case 32:
+        s.push_back('f');
+        return success();
+      case 64:
+        s.push_back('F');
+        return success();
+      default:
+        return op->emitError()
+               << "unsupported external calling convention float type "
+               << type;
+    }
   } else if (auto tupleType = type.dyn_cast<TupleType>()) {
     // Flatten tuple (so tuple<i32, i64> -> `...iI...`).
     SmallVector<Type, 4> flattenedTypes;
@@ -143,6 +143,19 @@ class GlobalInitializationPass
         default:
           return {failure(), {}};
       }
+    } else if (auto floatValue = value.dyn_cast<FloatAttr>()) {
+      if (floatValue.getValue().isPosZero()) {
+        // Globals are zero-initialized by default.
+        return {success(), {}};
+      }
+      switch (floatValue.getType().getIntOrFloatBitWidth()) {
+        case 32:
+          return {success(), builder.createOrFold<ConstF32Op>(loc, floatValue)};
+        case 64:
+          return {success(), builder.createOrFold<ConstF64Op>(loc, floatValue)};
+        default:
+          return {failure(), {}};
+      }
     }
     return {failure(), {}};
   }
@@ -161,6 +174,17 @@ class GlobalInitializationPass
         default:
           return failure();
       }
+    } else if (auto floatType = value.getType().dyn_cast<FloatType>()) {
+      switch (floatType.getWidth()) {
+        case 32:
+          builder.create<GlobalStoreF32Op>(loc, value, symName);
+          return success();
+        case 64:
+          builder.create<GlobalStoreF64Op>(loc, value, symName);
+          return success();
+        default:
+          return failure();
+      }
     }
     return failure();
   }
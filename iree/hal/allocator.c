@@ -28,6 +28,17 @@ iree_hal_allocator_host_allocator(const iree_hal_allocator_t* allocator) {
   return _VTABLE_DISPATCH(allocator, host_allocator)(allocator);
 }
 
+IREE_API_EXPORT void IREE_API_CALL iree_hal_allocator_query_statistics(
+    iree_hal_allocator_t* allocator,
+    iree_hal_allocator_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (_VTABLE_DISPATCH(allocator, query_statistics)) {
+    _VTABLE_DISPATCH(allocator, query_statistics)(allocator, out_statistics);
+  }
+}
+
 IREE_API_EXPORT iree_hal_buffer_compatibility_t
 iree_hal_allocator_query_buffer_compatibility(
     iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
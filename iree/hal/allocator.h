@@ -55,6 +55,21 @@ enum iree_hal_buffer_compatibility_e {
 };
 typedef uint32_t iree_hal_buffer_compatibility_t;
 
+// Statistics of the allocations made by an allocator.
+// Only allocations made with iree_hal_allocator_allocate_buffer are tracked;
+// wrapped buffers reference memory owned by the caller.
+typedef struct {
+  // Total bytes of all live allocations. May be larger than the sum of the
+  // requested allocation sizes if the allocator rounds or pads allocations.
+  iree_device_size_t bytes_allocated;
+  // Maximum value of |bytes_allocated| over the lifetime of the allocator.
+  iree_device_size_t bytes_allocated_peak;
+  // Number of live allocations.
+  iree_host_size_t allocation_count;
+  // Total number of allocations made over the lifetime of the allocator.
+  uint64_t total_allocation_count;
+} iree_hal_allocator_statistics_t;
+
 //===----------------------------------------------------------------------===//
 // iree_hal_allocator_t
 //===----------------------------------------------------------------------===//
@@ -73,6 +88,12 @@ iree_hal_allocator_release(iree_hal_allocator_t* allocator);
 IREE_API_EXPORT iree_allocator_t IREE_API_CALL
 iree_hal_allocator_host_allocator(const iree_hal_allocator_t* allocator);
 
+// Queries the current allocation statistics of |allocator|.
+// Allocators that do not track statistics return all zeros.
+IREE_API_EXPORT void IREE_API_CALL iree_hal_allocator_query_statistics(
+    iree_hal_allocator_t* allocator,
+    iree_hal_allocator_statistics_t* out_statistics);
+
 // Returns a bitmask indicating what operations with buffers of the given type
 // are available on the allocator.
 //
@@ -135,6 +156,60 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_hal_allocator_create_heap(
     iree_string_view_t identifier, iree_allocator_t host_allocator,
     iree_hal_allocator_t** out_allocator);
 
+// Parameters configuring an iree_hal_heap_allocator_t.
+// Must be initialized with iree_hal_heap_allocator_params_initialize prior to
+// use.
+typedef struct {
+  // Maximum total size in bytes of freed buffer storage that is retained by
+  // the allocator for reuse (the high-water mark of the cache). Allocations
+  // are rounded up to size classes with at most 25% waste and freed storage is
+  // kept on a free list per size class such that steady-state workloads that
+  // repeatedly allocate the same sizes do not round-trip to the host allocator.
+  //
+  // Storage freed while the cache is at the limit is returned to the host
+  // allocator immediately. Set to 0 to disable caching.
+  iree_device_size_t max_cached_bytes;
+} iree_hal_heap_allocator_params_t;
+
+// Initializes |out_params| to default values (caching disabled).
+IREE_API_EXPORT void IREE_API_CALL iree_hal_heap_allocator_params_initialize(
+    iree_hal_heap_allocator_params_t* out_params);
+
+// Creates a host-local heap allocator as with iree_hal_allocator_create_heap
+// configured with the given |params|.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_create_heap_with_params(
+    iree_string_view_t identifier,
+    const iree_hal_heap_allocator_params_t* params,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
+
+// Statistics of a heap allocator.
+typedef struct {
+  // Total bytes of storage held by live buffers, including size-class rounding.
+  iree_device_size_t bytes_in_use;
+  // Maximum value of |bytes_in_use| over the lifetime of the allocator.
+  iree_device_size_t bytes_in_use_peak;
+  // Total bytes of freed storage retained in the cache.
+  iree_device_size_t bytes_cached;
+  // Number of allocations served from the cache.
+  uint64_t cache_hit_count;
+  // Number of allocations that had to be made from the host allocator.
+  uint64_t cache_miss_count;
+} iree_hal_heap_allocator_statistics_t;
+
+// Queries the current statistics of a heap |allocator|.
+// Fails if |allocator| was not created with iree_hal_allocator_create_heap*.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_heap_allocator_query_statistics(
+    iree_hal_allocator_t* allocator,
+    iree_hal_heap_allocator_statistics_t* out_statistics);
+
+// Returns all storage retained in the cache of a heap |allocator| to the host
+// allocator. Live buffers are unaffected.
+// Fails if |allocator| was not created with iree_hal_allocator_create_heap*.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_heap_allocator_trim(iree_hal_allocator_t* allocator);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_allocator_t implementation details
 //===----------------------------------------------------------------------===//
@@ -148,6 +223,10 @@ typedef struct {
   iree_allocator_t(IREE_API_PTR* host_allocator)(
       const iree_hal_allocator_t* allocator);
 
+  void(IREE_API_PTR* query_statistics)(
+      iree_hal_allocator_t* allocator,
+      iree_hal_allocator_statistics_t* out_statistics);
+
   iree_hal_buffer_compatibility_t(IREE_API_PTR* query_buffer_compatibility)(
       iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
       iree_hal_buffer_usage_t allowed_usage,
@@ -169,6 +248,28 @@ typedef struct {
 IREE_API_EXPORT void IREE_API_CALL
 iree_hal_allocator_destroy(iree_hal_allocator_t* allocator);
 
+// Records a new allocation of |byte_length| bytes in |statistics|.
+// Implementations must synchronize access to |statistics|.
+static inline void iree_hal_allocator_statistics_record_alloc(
+    iree_hal_allocator_statistics_t* statistics,
+    iree_device_size_t byte_length) {
+  statistics->bytes_allocated += byte_length;
+  if (statistics->bytes_allocated > statistics->bytes_allocated_peak) {
+    statistics->bytes_allocated_peak = statistics->bytes_allocated;
+  }
+  ++statistics->allocation_count;
+  ++statistics->total_allocation_count;
+}
+
+// Records the release of an allocation of |byte_length| bytes in |statistics|.
+// Implementations must synchronize access to |statistics|.
+static inline void iree_hal_allocator_statistics_record_free(
+    iree_hal_allocator_statistics_t* statistics,
+    iree_device_size_t byte_length) {
+  statistics->bytes_allocated -= byte_length;
+  --statistics->allocation_count;
+}
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
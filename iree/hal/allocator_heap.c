@@ -12,22 +12,108 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include "iree/base/math.h"
+#include "iree/base/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/detail.h"
 
+//===----------------------------------------------------------------------===//
+// Size classes
+//===----------------------------------------------------------------------===//
+// Cached storage is bucketed into size classes so that allocations of similar
+// (but not identical) sizes can reuse each other's storage. Each power of two
+// is divided into 4 classes such that rounding wastes at most 25%:
+//   256, 320, 384, 448, 512, 640, 768, 896, 1024, 1280, ...
+// Allocations larger than the largest class bypass the cache.
+
+// log2 of the smallest size class; smaller allocations are rounded up to it.
+#define IREE_HAL_HEAP_MIN_SIZE_CLASS_LOG2 8
+// Total number of size classes; with 4 classes per power of two this covers
+// allocations up to 1TB.
+#define IREE_HAL_HEAP_SIZE_CLASS_COUNT 128
+
+// Returns the index of the smallest size class that can hold |size| bytes.
+// May be >= IREE_HAL_HEAP_SIZE_CLASS_COUNT if |size| is not cacheable.
+static iree_host_size_t iree_hal_heap_size_class_index(uint64_t size) {
+  if (size <= (1ull << IREE_HAL_HEAP_MIN_SIZE_CLASS_LOG2)) return 0;
+  // size is in (2^(p-1), 2^p] and that range is split into 4 steps.
+  int p = 64 - iree_math_count_leading_zeros_u64(size - 1);
+  uint64_t base = 1ull << (p - 1);
+  int step_log2 = p - 3;
+  uint64_t m = (size - base + (1ull << step_log2) - 1) >> step_log2;
+  return (iree_host_size_t)(p - 1 - IREE_HAL_HEAP_MIN_SIZE_CLASS_LOG2) * 4 +
+         (iree_host_size_t)m;
+}
+
+// Returns the size in bytes of the size class at |index|.
+static uint64_t iree_hal_heap_size_class_size(iree_host_size_t index) {
+  if (index == 0) return 1ull << IREE_HAL_HEAP_MIN_SIZE_CLASS_LOG2;
+  uint64_t base = 1ull << ((index - 1) / 4 + IREE_HAL_HEAP_MIN_SIZE_CLASS_LOG2);
+  return base + ((index - 1) % 4 + 1) * (base / 4);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_heap_allocator_t
+//===----------------------------------------------------------------------===//
+
+// Name of the memory pool used for tracing heap buffer storage.
+#define IREE_HAL_HEAP_ALLOCATOR_TRACE_ID "iree-hal-heap-allocator"
+
+// Header prefixed to all storage allocated by the heap allocator.
+// Padded to the maximum alignment so that the storage following it retains
+// the alignment guarantees of the host allocator.
+typedef iree_alignas(iree_max_align_t) struct iree_hal_heap_block_s {
+  // Next block in the size class free list while cached.
+  struct iree_hal_heap_block_s* next;
+  // Size of the storage following the header in bytes.
+  iree_host_size_t size;
+} iree_hal_heap_block_t;
+
 typedef struct iree_hal_heap_allocator_s {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
+  iree_hal_heap_allocator_params_t params;
+
+  // Guards the free lists and statistics.
+  iree_slim_mutex_t mutex;
+  // LIFO free lists of cached blocks for each size class.
+  iree_hal_heap_block_t* free_lists[IREE_HAL_HEAP_SIZE_CLASS_COUNT];
+  // Total bytes of storage in the free lists.
+  iree_device_size_t bytes_cached;
+  uint64_t cache_hit_count;
+  uint64_t cache_miss_count;
+  // Statistics of storage held by live buffers.
+  iree_hal_allocator_statistics_t statistics;
 } iree_hal_heap_allocator_t;
 
 static const iree_hal_allocator_vtable_t iree_hal_heap_allocator_vtable;
 
+IREE_API_EXPORT void IREE_API_CALL iree_hal_heap_allocator_params_initialize(
+    iree_hal_heap_allocator_params_t* out_params) {
+  memset(out_params, 0, sizeof(*out_params));
+  out_params->max_cached_bytes = 0;
+}
+
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_hal_allocator_create_heap(
     iree_string_view_t identifier, iree_allocator_t host_allocator,
     iree_hal_allocator_t** out_allocator) {
+  iree_hal_heap_allocator_params_t params;
+  iree_hal_heap_allocator_params_initialize(&params);
+  return iree_hal_allocator_create_heap_with_params(identifier, &params,
+                                                    host_allocator,
+                                                    out_allocator);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_allocator_create_heap_with_params(
+    iree_string_view_t identifier,
+    const iree_hal_heap_allocator_params_t* params,
+    iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
+  IREE_ASSERT_ARGUMENT(params);
   IREE_ASSERT_ARGUMENT(out_allocator);
+  *out_allocator = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_heap_allocator_t* allocator = NULL;
@@ -41,11 +127,38 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_hal_allocator_create_heap(
     iree_string_view_append_to_buffer(
         identifier, &allocator->identifier,
         (char*)allocator + total_size - identifier.size);
+    allocator->params = *params;
+    iree_slim_mutex_initialize(&allocator->mutex);
+    memset(allocator->free_lists, 0, sizeof(allocator->free_lists));
+    allocator->bytes_cached = 0;
+    allocator->cache_hit_count = 0;
+    allocator->cache_miss_count = 0;
+    memset(&allocator->statistics, 0, sizeof(allocator->statistics));
     *out_allocator = (iree_hal_allocator_t*)allocator;
   }
 
   IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
+  return status;
+}
+
+// Frees all blocks in the cache back to the host allocator.
+static void iree_hal_heap_allocator_trim_cache(
+    iree_hal_heap_allocator_t* allocator) {
+  iree_hal_heap_block_t* free_lists[IREE_HAL_HEAP_SIZE_CLASS_COUNT];
+  iree_slim_mutex_lock(&allocator->mutex);
+  memcpy(free_lists, allocator->free_lists, sizeof(free_lists));
+  memset(allocator->free_lists, 0, sizeof(allocator->free_lists));
+  allocator->bytes_cached = 0;
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(free_lists); ++i) {
+    iree_hal_heap_block_t* block = free_lists[i];
+    while (block) {
+      iree_hal_heap_block_t* next = block->next;
+      iree_allocator_free(allocator->host_allocator, block);
+      block = next;
+    }
+  }
 }
 
 static void iree_hal_heap_allocator_destroy(
@@ -55,6 +168,8 @@ static void iree_hal_heap_allocator_destroy(
   iree_allocator_t host_allocator = allocator->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_heap_allocator_trim_cache(allocator);
+  iree_slim_mutex_deinitialize(&allocator->mutex);
   iree_allocator_free(host_allocator, allocator);
 
   IREE_TRACE_ZONE_END(z0);
@@ -116,6 +231,85 @@ static iree_status_t iree_hal_heap_allocator_make_compatible(
   return iree_ok_status();
 }
 
+// Acquires |size| bytes of storage either from the cache or the host allocator.
+static iree_status_t iree_hal_heap_allocator_acquire_storage(
+    iree_hal_heap_allocator_t* allocator, iree_host_size_t size,
+    void** out_ptr) {
+  // Round up to the size class if the storage may end up in the cache.
+  iree_host_size_t class_index = iree_hal_heap_size_class_index(size);
+  bool cacheable = allocator->params.max_cached_bytes > 0 &&
+                   class_index < IREE_HAL_HEAP_SIZE_CLASS_COUNT;
+  iree_host_size_t storage_size =
+      cacheable ? (iree_host_size_t)iree_hal_heap_size_class_size(class_index)
+                : size;
+
+  iree_hal_heap_block_t* block = NULL;
+  if (cacheable) {
+    iree_slim_mutex_lock(&allocator->mutex);
+    block = allocator->free_lists[class_index];
+    if (block) {
+      allocator->free_lists[class_index] = block->next;
+      allocator->bytes_cached -= storage_size;
+    }
+    iree_slim_mutex_unlock(&allocator->mutex);
+  }
+
+  bool cache_hit = block != NULL;
+  if (!cache_hit) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(allocator->host_allocator,
+                                               sizeof(*block) + storage_size,
+                                               (void**)&block));
+    block->size = storage_size;
+  }
+  block->next = NULL;
+
+  iree_slim_mutex_lock(&allocator->mutex);
+  if (cache_hit) {
+    ++allocator->cache_hit_count;
+  } else {
+    ++allocator->cache_miss_count;
+  }
+  iree_hal_allocator_statistics_record_alloc(&allocator->statistics,
+                                             storage_size);
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  *out_ptr = (uint8_t*)block + sizeof(*block);
+  IREE_TRACE_ALLOC_NAMED(IREE_HAL_HEAP_ALLOCATOR_TRACE_ID, *out_ptr,
+                         storage_size);
+  return iree_ok_status();
+}
+
+// Releases storage previously acquired with
+// iree_hal_heap_allocator_acquire_storage either into the cache or back to the
+// host allocator. Used as the data allocator free function of heap buffers.
+static void iree_hal_heap_allocator_release_storage(void* self, void* ptr) {
+  iree_hal_heap_allocator_t* allocator = (iree_hal_heap_allocator_t*)self;
+  iree_hal_heap_block_t* block =
+      (iree_hal_heap_block_t*)((uint8_t*)ptr - sizeof(iree_hal_heap_block_t));
+  iree_host_size_t storage_size = block->size;
+  iree_host_size_t class_index = iree_hal_heap_size_class_index(storage_size);
+  IREE_TRACE_FREE_NAMED(IREE_HAL_HEAP_ALLOCATOR_TRACE_ID, ptr);
+
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_hal_allocator_statistics_record_free(&allocator->statistics,
+                                            storage_size);
+  // Only blocks that were rounded to a size class are cacheable.
+  bool cache = class_index < IREE_HAL_HEAP_SIZE_CLASS_COUNT &&
+               iree_hal_heap_size_class_size(class_index) == storage_size &&
+               allocator->bytes_cached + storage_size <=
+                   allocator->params.max_cached_bytes;
+  if (cache) {
+    block->next = allocator->free_lists[class_index];
+    allocator->free_lists[class_index] = block;
+    allocator->bytes_cached += storage_size;
+  }
+  iree_slim_mutex_unlock(&allocator->mutex);
+
+  if (!cache) {
+    iree_allocator_free(allocator->host_allocator, block);
+  }
+}
+
 static iree_status_t iree_hal_heap_allocator_allocate_buffer(
     iree_hal_allocator_t* base_allocator, iree_hal_memory_type_t memory_type,
     iree_hal_buffer_usage_t allowed_usage, iree_host_size_t allocation_size,
@@ -131,14 +325,19 @@ static iree_status_t iree_hal_heap_allocator_allocate_buffer(
   iree_byte_span_t data = iree_make_byte_span(NULL, allocation_size);
   if (allocation_size > 0) {
     // Zero-length buffers are valid but we don't want to try to malloc them.
-    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
-        allocator->host_allocator, allocation_size, (void**)&data.data));
+    IREE_RETURN_IF_ERROR(iree_hal_heap_allocator_acquire_storage(
+        allocator, allocation_size, (void**)&data.data));
   }
+  iree_allocator_t data_allocator = {
+      .self = allocator,
+      .alloc = NULL,
+      .free = iree_hal_heap_allocator_release_storage,
+  };
   iree_status_t status = iree_hal_heap_buffer_wrap(
       base_allocator, memory_type, allowed_access, allowed_usage,
-      allocation_size, data, allocator->host_allocator, out_buffer);
+      allocation_size, data, data_allocator, out_buffer);
   if (!iree_status_is_ok(status)) {
-    iree_allocator_free(allocator->host_allocator, data.data);
+    iree_allocator_free(data_allocator, data.data);
   }
   return status;
 }
@@ -157,9 +356,57 @@ static iree_status_t iree_hal_heap_allocator_wrap_buffer(
                                    data_allocator, out_buffer);
 }
 
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_heap_allocator_query_statistics(
+    iree_hal_allocator_t* base_allocator,
+    iree_hal_heap_allocator_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(base_allocator);
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  if (!iree_hal_resource_is(base_allocator, &iree_hal_heap_allocator_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "allocator is not a heap allocator");
+  }
+  iree_hal_heap_allocator_t* allocator =
+      (iree_hal_heap_allocator_t*)base_allocator;
+  iree_slim_mutex_lock(&allocator->mutex);
+  out_statistics->bytes_in_use = allocator->statistics.bytes_allocated;
+  out_statistics->bytes_in_use_peak =
+      allocator->statistics.bytes_allocated_peak;
+  out_statistics->bytes_cached = allocator->bytes_cached;
+  out_statistics->cache_hit_count = allocator->cache_hit_count;
+  out_statistics->cache_miss_count = allocator->cache_miss_count;
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_hal_heap_allocator_trim(iree_hal_allocator_t* base_allocator) {
+  IREE_ASSERT_ARGUMENT(base_allocator);
+  if (!iree_hal_resource_is(base_allocator, &iree_hal_heap_allocator_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "allocator is not a heap allocator");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_heap_allocator_trim_cache(
+      (iree_hal_heap_allocator_t*)base_allocator);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_heap_allocator_query_allocation_statistics(
+    iree_hal_allocator_t* base_allocator,
+    iree_hal_allocator_statistics_t* out_statistics) {
+  iree_hal_heap_allocator_t* allocator =
+      (iree_hal_heap_allocator_t*)base_allocator;
+  iree_slim_mutex_lock(&allocator->mutex);
+  *out_statistics = allocator->statistics;
+  iree_slim_mutex_unlock(&allocator->mutex);
+}
+
 static const iree_hal_allocator_vtable_t iree_hal_heap_allocator_vtable = {
     .destroy = iree_hal_heap_allocator_destroy,
     .host_allocator = iree_hal_heap_allocator_host_allocator,
+    .query_statistics = iree_hal_heap_allocator_query_allocation_statistics,
     .query_buffer_compatibility =
         iree_hal_heap_allocator_query_buffer_compatibility,
     .allocate_buffer = iree_hal_heap_allocator_allocate_buffer,
@@ -0,0 +1,163 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+static iree_hal_allocator_t* CreateAllocator(
+    iree_device_size_t max_cached_bytes) {
+  iree_hal_heap_allocator_params_t params;
+  iree_hal_heap_allocator_params_initialize(&params);
+  params.max_cached_bytes = max_cached_bytes;
+  iree_hal_allocator_t* allocator = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_create_heap_with_params(
+      iree_make_cstring_view("heap"), &params, iree_allocator_system(),
+      &allocator));
+  return allocator;
+}
+
+static iree_hal_buffer_t* Allocate(iree_hal_allocator_t* allocator,
+                                   iree_host_size_t allocation_size) {
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+      allocator, IREE_HAL_MEMORY_TYPE_HOST_LOCAL,
+      IREE_HAL_BUFFER_USAGE_ALL, allocation_size, &buffer));
+  return buffer;
+}
+
+static iree_hal_heap_allocator_statistics_t QueryStatistics(
+    iree_hal_allocator_t* allocator) {
+  iree_hal_heap_allocator_statistics_t statistics;
+  IREE_CHECK_OK(
+      iree_hal_heap_allocator_query_statistics(allocator, &statistics));
+  return statistics;
+}
+
+static void* MapBuffer(iree_hal_buffer_t* buffer) {
+  iree_hal_buffer_mapping_t mapping;
+  IREE_CHECK_OK(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MEMORY_ACCESS_READ, 0, IREE_WHOLE_BUFFER, &mapping));
+  void* data = mapping.contents.data;
+  iree_hal_buffer_unmap_range(&mapping);
+  return data;
+}
+
+TEST(HeapAllocatorTest, CachingDisabled) {
+  iree_hal_allocator_t* allocator = CreateAllocator(0);
+  for (int i = 0; i < 2; ++i) {
+    iree_hal_buffer_t* buffer = Allocate(allocator, 1000);
+    EXPECT_EQ(1000, iree_hal_buffer_byte_length(buffer));
+    iree_hal_buffer_release(buffer);
+  }
+  auto statistics = QueryStatistics(allocator);
+  EXPECT_EQ(0, statistics.cache_hit_count);
+  EXPECT_EQ(2, statistics.cache_miss_count);
+  EXPECT_EQ(0, statistics.bytes_cached);
+  EXPECT_EQ(0, statistics.bytes_in_use);
+  EXPECT_EQ(1000, statistics.bytes_in_use_peak);
+  iree_hal_allocator_release(allocator);
+}
+
+// Tests that freed storage is reused by allocations in the same size class.
+TEST(HeapAllocatorTest, ReuseSizeClass) {
+  iree_hal_allocator_t* allocator = CreateAllocator(1024 * 1024);
+
+  iree_hal_buffer_t* buffer0 = Allocate(allocator, 1000);
+  void* data0 = MapBuffer(buffer0);
+  iree_hal_buffer_release(buffer0);
+  auto statistics = QueryStatistics(allocator);
+  EXPECT_EQ(1024, statistics.bytes_cached);
+  EXPECT_EQ(0, statistics.bytes_in_use);
+
+  // 900 rounds up to the same 1024 byte class as 1000.
+  iree_hal_buffer_t* buffer1 = Allocate(allocator, 900);
+  EXPECT_EQ(900, iree_hal_buffer_byte_length(buffer1));
+  EXPECT_EQ(data0, MapBuffer(buffer1));
+  statistics = QueryStatistics(allocator);
+  EXPECT_EQ(1, statistics.cache_hit_count);
+  EXPECT_EQ(1, statistics.cache_miss_count);
+  EXPECT_EQ(0, statistics.bytes_cached);
+  EXPECT_EQ(1024, statistics.bytes_in_use);
+
+  // A different class must not reuse the storage.
+  iree_hal_buffer_t* buffer2 = Allocate(allocator, 2000);
+  EXPECT_EQ(2, QueryStatistics(allocator).cache_miss_count);
+  EXPECT_EQ(1024 + 2048, QueryStatistics(allocator).bytes_in_use_peak);
+
+  iree_hal_buffer_release(buffer1);
+  iree_hal_buffer_release(buffer2);
+  iree_hal_allocator_release(allocator);
+}
+
+// Tests that storage is not cached beyond max_cached_bytes.
+TEST(HeapAllocatorTest, CacheLimit) {
+  iree_hal_allocator_t* allocator = CreateAllocator(4096);
+  iree_hal_buffer_t* buffers[3] = {
+      Allocate(allocator, 2048),
+      Allocate(allocator, 2048),
+      Allocate(allocator, 2048),
+  };
+  for (auto* buffer : buffers) iree_hal_buffer_release(buffer);
+  EXPECT_EQ(4096, QueryStatistics(allocator).bytes_cached);
+  iree_hal_allocator_release(allocator);
+}
+
+// Tests the generic allocator statistics, which track storage held by live
+// buffers independent of the cache.
+TEST(HeapAllocatorTest, AllocatorStatistics) {
+  iree_hal_allocator_t* allocator = CreateAllocator(1024 * 1024);
+  iree_hal_buffer_t* buffer0 = Allocate(allocator, 1000);
+  iree_hal_buffer_t* buffer1 = Allocate(allocator, 2048);
+  iree_hal_allocator_statistics_t statistics;
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(1024 + 2048, statistics.bytes_allocated);
+  EXPECT_EQ(2, statistics.allocation_count);
+  iree_hal_buffer_release(buffer0);
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(2048, statistics.bytes_allocated);
+  EXPECT_EQ(1024 + 2048, statistics.bytes_allocated_peak);
+  EXPECT_EQ(1, statistics.allocation_count);
+  EXPECT_EQ(2, statistics.total_allocation_count);
+  iree_hal_buffer_release(buffer1);
+
+  // Wrapped buffers are not tracked.
+  uint8_t data[16];
+  iree_hal_buffer_t* wrapped_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_wrap_buffer(
+      allocator, IREE_HAL_MEMORY_TYPE_HOST_LOCAL, IREE_HAL_MEMORY_ACCESS_ALL,
+      IREE_HAL_BUFFER_USAGE_ALL, iree_make_byte_span(data, sizeof(data)),
+      iree_allocator_null(), &wrapped_buffer));
+  iree_hal_allocator_query_statistics(allocator, &statistics);
+  EXPECT_EQ(0, statistics.allocation_count);
+  iree_hal_buffer_release(wrapped_buffer);
+
+  iree_hal_allocator_release(allocator);
+}
+
+TEST(HeapAllocatorTest, Trim) {
+  iree_hal_allocator_t* allocator = CreateAllocator(1024 * 1024);
+  iree_hal_buffer_release(Allocate(allocator, 4096));
+  EXPECT_EQ(4096, QueryStatistics(allocator).bytes_cached);
+  IREE_ASSERT_OK(iree_hal_heap_allocator_trim(allocator));
+  EXPECT_EQ(0, QueryStatistics(allocator).bytes_cached);
+  iree_hal_buffer_release(Allocate(allocator, 4096));
+  EXPECT_EQ(2, QueryStatistics(allocator).cache_miss_count);
+  iree_hal_allocator_release(allocator);
+}
+
+}  // namespace
@@ -238,6 +238,274 @@ TEST_P(CommandBufferTest, CopySubBuffer) {
   iree_hal_buffer_release(host_buffer);
 }
 
+// Records a full barrier as emitted by the compiler between dispatches.
+static iree_status_t RecordFullBarrier(
+    iree_hal_command_buffer_t* command_buffer) {
+  iree_hal_memory_barrier_t memory_barrier;
+  memory_barrier.source_scope = IREE_HAL_ACCESS_SCOPE_DISPATCH_WRITE |
+                                IREE_HAL_ACCESS_SCOPE_TRANSFER_WRITE;
+  memory_barrier.target_scope = IREE_HAL_ACCESS_SCOPE_DISPATCH_READ |
+                                IREE_HAL_ACCESS_SCOPE_TRANSFER_READ;
+  return iree_hal_command_buffer_execution_barrier(
+      command_buffer,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE |
+          IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE |
+          IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      /*memory_barrier_count=*/1, &memory_barrier,
+      /*buffer_barrier_count=*/0, /*buffer_barriers=*/NULL);
+}
+
+// Tests that commands separated by barriers observe read-after-write,
+// write-after-read, and write-after-write ordering while unrelated commands
+// are interleaved.
+TEST_P(CommandBufferTest, BarrierOrdering) {
+  iree_hal_command_buffer_t* command_buffer;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, &command_buffer));
+
+  iree_hal_buffer_t* buffers[4] = {NULL};
+  for (auto*& buffer : buffers) {
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_,
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+        IREE_HAL_BUFFER_USAGE_ALL, kBufferSize, &buffer));
+  }
+  iree_hal_buffer_t* buffer_a = buffers[0];
+  iree_hal_buffer_t* buffer_b = buffers[1];
+  iree_hal_buffer_t* buffer_c = buffers[2];
+  iree_hal_buffer_t* buffer_d = buffers[3];
+
+  uint8_t val1 = 0x11;
+  uint8_t val2 = 0x22;
+  uint8_t val3 = 0x33;
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_a, 0, kBufferSize, &val1, sizeof(val1)));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  // RAW on A; D is unrelated.
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, buffer_a, 0, buffer_b, 0, kBufferSize));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_d, 0, kBufferSize, &val3, sizeof(val3)));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  // WAR on A and RAW on B.
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer_a, 0, kBufferSize, &val2, sizeof(val2)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, buffer_b, 0, buffer_c, 0, kBufferSize));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  // RAW on A and WAW on the upper half of C.
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, buffer_a, 0, buffer_c, kBufferSize / 2,
+      kBufferSize / 2));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  IREE_ASSERT_OK(SubmitCommandBufferAndWait(IREE_HAL_COMMAND_CATEGORY_TRANSFER,
+                                            command_buffer));
+
+  std::vector<uint8_t> reference_a(kBufferSize, val2);
+  std::vector<uint8_t> reference_b(kBufferSize, val1);
+  std::vector<uint8_t> reference_c(kBufferSize, val1);
+  std::memset(reference_c.data() + kBufferSize / 2, val2, kBufferSize / 2);
+  std::vector<uint8_t> reference_d(kBufferSize, val3);
+  const std::vector<uint8_t>* references[4] = {&reference_a, &reference_b,
+                                               &reference_c, &reference_d};
+  for (int i = 0; i < 4; ++i) {
+    std::vector<uint8_t> actual_data(kBufferSize);
+    IREE_ASSERT_OK(iree_hal_buffer_read_data(buffers[i], 0, actual_data.data(),
+                                             kBufferSize));
+    EXPECT_THAT(actual_data, ContainerEq(*references[i])) << "buffer " << i;
+  }
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  for (auto* buffer : buffers) iree_hal_buffer_release(buffer);
+}
+
+// Tests that barriers order commands that reference the same memory through
+// different subspans of a buffer.
+TEST_P(CommandBufferTest, BarrierOrderingSubspans) {
+  iree_hal_command_buffer_t* command_buffer;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, &command_buffer));
+
+  iree_hal_buffer_t* source_buffer;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_,
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      IREE_HAL_BUFFER_USAGE_ALL, kBufferSize, &source_buffer));
+  iree_hal_buffer_t* source_subspan;
+  IREE_ASSERT_OK(iree_hal_buffer_subspan(source_buffer, kBufferSize / 4,
+                                         kBufferSize / 2, &source_subspan));
+  iree_hal_buffer_t* target_buffer;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_,
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      IREE_HAL_BUFFER_USAGE_ALL, kBufferSize, &target_buffer));
+
+  uint8_t val1 = 0x11;
+  uint8_t val2 = 0x22;
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, source_buffer, 0, kBufferSize, &val1, sizeof(val1)));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, source_subspan, 0, IREE_WHOLE_BUFFER, &val2,
+      sizeof(val2)));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, source_buffer, 0, target_buffer, 0, kBufferSize));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  IREE_ASSERT_OK(SubmitCommandBufferAndWait(IREE_HAL_COMMAND_CATEGORY_TRANSFER,
+                                            command_buffer));
+
+  std::vector<uint8_t> reference_buffer(kBufferSize, val1);
+  std::memset(reference_buffer.data() + kBufferSize / 4, val2,
+              kBufferSize / 2);
+  std::vector<uint8_t> actual_data(kBufferSize);
+  IREE_ASSERT_OK(iree_hal_buffer_read_data(target_buffer, 0,
+                                           actual_data.data(), kBufferSize));
+  EXPECT_THAT(actual_data, ContainerEq(reference_buffer));
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_buffer_release(source_subspan);
+  iree_hal_buffer_release(source_buffer);
+}
+
+// Transfers large enough that implementations may split them up (such as into
+// tiles processed in parallel) with lengths and offsets that don't line up with
+// any natural split.
+TEST_P(CommandBufferTest, LargeTransfers) {
+  constexpr iree_device_size_t kLargeBufferSize = 4 * 1024 * 1024 + 4;
+  constexpr iree_device_size_t kCopyOffset = 3;
+  constexpr iree_device_size_t kCopyLength = kLargeBufferSize - 2 * kCopyOffset;
+
+  iree_hal_command_buffer_t* command_buffer;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, &command_buffer));
+
+  iree_hal_buffer_t* source_buffer;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_,
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      IREE_HAL_BUFFER_USAGE_ALL, kLargeBufferSize, &source_buffer));
+  iree_hal_buffer_t* target_buffer;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_,
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      IREE_HAL_BUFFER_USAGE_ALL, kLargeBufferSize, &target_buffer));
+
+  // Non-repeating contents so that misplaced tiles are detected.
+  std::vector<uint8_t> update_data(kLargeBufferSize / 2);
+  for (size_t i = 0; i < update_data.size(); ++i) {
+    update_data[i] = (uint8_t)((i * 31) ^ (i >> 12));
+  }
+
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  uint32_t pattern = 0xA1B2C3D4u;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, source_buffer, /*target_offset=*/0,
+      /*length=*/IREE_WHOLE_BUFFER, &pattern, sizeof(pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, target_buffer, /*target_offset=*/0,
+      /*length=*/kLargeBufferSize, &pattern, sizeof(pattern)));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_update_buffer(
+      command_buffer, update_data.data(), /*source_offset=*/0, source_buffer,
+      /*target_offset=*/1, update_data.size()));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, source_buffer, /*source_offset=*/1, target_buffer,
+      /*target_offset=*/kCopyOffset, kCopyLength));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  IREE_ASSERT_OK(SubmitCommandBufferAndWait(IREE_HAL_COMMAND_CATEGORY_TRANSFER,
+                                            command_buffer));
+
+  std::vector<uint8_t> source_data(kLargeBufferSize);
+  for (size_t i = 0; i < source_data.size(); ++i) {
+    source_data[i] = ((const uint8_t*)&pattern)[i % sizeof(pattern)];
+  }
+  std::memcpy(source_data.data() + 1, update_data.data(), update_data.size());
+  std::vector<uint8_t> reference_buffer(kLargeBufferSize);
+  for (size_t i = 0; i < reference_buffer.size(); ++i) {
+    reference_buffer[i] = ((const uint8_t*)&pattern)[i % sizeof(pattern)];
+  }
+  std::memcpy(reference_buffer.data() + kCopyOffset, source_data.data() + 1,
+              kCopyLength);
+  std::vector<uint8_t> actual_data(kLargeBufferSize);
+  IREE_ASSERT_OK(iree_hal_buffer_read_data(target_buffer, 0, actual_data.data(),
+                                           kLargeBufferSize));
+  EXPECT_TRUE(actual_data == reference_buffer);
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_buffer_release(source_buffer);
+}
+
+TEST_P(CommandBufferTest, SubmitReusableMultipleTimes) {
+  // Large enough that implementations may split the fill up.
+  constexpr iree_device_size_t kLargeBufferSize = 2 * 1024 * 1024;
+
+  iree_hal_command_buffer_t* command_buffer;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_REUSABLE,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, &command_buffer));
+
+  iree_hal_buffer_t* source_buffer;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_,
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      IREE_HAL_BUFFER_USAGE_ALL, kBufferSize, &source_buffer));
+  iree_hal_buffer_t* target_buffer;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_,
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+      IREE_HAL_BUFFER_USAGE_ALL, kLargeBufferSize, &target_buffer));
+
+  // Clear the whole target and then copy the source over its head. The clear
+  // ensures that each submission has to redo the copy.
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  uint8_t zero = 0;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, target_buffer, /*target_offset=*/0, kLargeBufferSize,
+      &zero, sizeof(zero)));
+  IREE_ASSERT_OK(RecordFullBarrier(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, source_buffer, /*source_offset=*/0, target_buffer,
+      /*target_offset=*/0, kBufferSize));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  for (uint8_t i = 1; i <= 3; ++i) {
+    IREE_ASSERT_OK(iree_hal_buffer_fill(source_buffer, 0, kBufferSize, &i,
+                                        sizeof(i)));
+    IREE_ASSERT_OK(iree_hal_buffer_fill(target_buffer, 0, kLargeBufferSize,
+                                        &i, sizeof(i)));
+    IREE_ASSERT_OK(SubmitCommandBufferAndWait(
+        IREE_HAL_COMMAND_CATEGORY_TRANSFER, command_buffer));
+
+    std::vector<uint8_t> reference_buffer(kLargeBufferSize, 0);
+    std::memset(reference_buffer.data(), i, kBufferSize);
+    std::vector<uint8_t> actual_data(kLargeBufferSize);
+    IREE_ASSERT_OK(iree_hal_buffer_read_data(
+        target_buffer, 0, actual_data.data(), kLargeBufferSize));
+    EXPECT_TRUE(actual_data == reference_buffer) << "submission " << (int)i;
+  }
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_buffer_release(source_buffer);
+}
+
 INSTANTIATE_TEST_SUITE_P(
     AllDrivers, CommandBufferTest,
     ::testing::ValuesIn(testing::EnumerateAvailableDrivers()),
@@ -19,6 +19,7 @@
 #include "absl/flags/flag.h"
 #include "iree/hal/local/loaders/legacy_library_loader.h"
 #include "iree/hal/local/task_driver.h"
+#include "iree/task/tuning.h"
 
 // TODO(#4298): remove this driver registration and wrapper.
 // By having a single iree/hal/local/registration that then has the loaders
@@ -31,6 +32,13 @@ ABSL_FLAG(int, dylib_worker_count, 0,
           "Specified number of workers to use or 0 for automatic.");
 ABSL_FLAG(int, dylib_max_worker_count, 16,
           "Maximum number of task system workers to use.");
+ABSL_FLAG(int, dylib_worker_spin_us,
+          IREE_TASK_EXECUTOR_DEFAULT_WORKER_SPIN_NS / 1000,
+          "Maximum duration in microseconds that idle task system workers "
+          "spin waiting for new work before parking; 0 to always park.");
+ABSL_FLAG(bool, dylib_inline_execution, false,
+          "Executes all work inline on the submitting and waiting threads "
+          "without creating any task system workers.");
 
 #define IREE_HAL_DYLIB_DRIVER_ID 0x58444C4Cu  // XDLL
 
@@ -65,7 +73,10 @@ static iree_status_t iree_hal_dylib_driver_factory_try_create(
 
   iree_task_topology_t topology;
   iree_task_topology_initialize(&topology);
-  if (absl::GetFlag(FLAGS_dylib_worker_count) > 0) {
+  if (absl::GetFlag(FLAGS_dylib_inline_execution)) {
+    iree_task_topology_initialize_from_group_count(/*group_count=*/0,
+                                                   &topology);
+  } else if (absl::GetFlag(FLAGS_dylib_worker_count) > 0) {
     iree_task_topology_initialize_from_group_count(
         absl::GetFlag(FLAGS_dylib_worker_count), &topology);
   } else {
@@ -84,6 +95,11 @@ static iree_status_t iree_hal_dylib_driver_factory_try_create(
     status = iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
                                        &topology, allocator, &executor);
   }
+  if (iree_status_is_ok(status)) {
+    iree_task_executor_set_worker_spin_ns(
+        executor, (iree_duration_t)absl::GetFlag(FLAGS_dylib_worker_spin_us) *
+                      1000);
+  }
 
   if (iree_status_is_ok(status)) {
     status = iree_hal_task_driver_create(
@@ -15,11 +15,26 @@
 #include "iree/hal/local/arena.h"
 
 #include "iree/base/alignment.h"
+#include "iree/base/tracing.h"
 
 //===----------------------------------------------------------------------===//
 // iree_arena_block_pool_t
 //===----------------------------------------------------------------------===//
 
+// Plots the total bytes allocated by |block_pool| if it has a trace plot.
+static void iree_arena_block_pool_trace_plot(
+    iree_arena_block_pool_t* block_pool) {
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  if (block_pool->trace_plot_name) {
+    int32_t allocated_count = iree_atomic_load_int32(
+        &block_pool->allocated_count, iree_memory_order_relaxed);
+    IREE_TRACE_PLOT_VALUE_I64(
+        block_pool->trace_plot_name,
+        (int64_t)allocated_count * (int64_t)block_pool->total_block_size);
+  }
+#endif  // IREE_TRACING_FEATURE_INSTRUMENTATION
+}
+
 void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
                                       iree_allocator_t block_allocator,
                                       iree_arena_block_pool_t* out_block_pool) {
@@ -29,6 +44,12 @@ void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
       total_block_size - sizeof(iree_arena_block_t);
   out_block_pool->block_allocator = block_allocator;
   iree_atomic_arena_block_slist_initialize(&out_block_pool->available_slist);
+  iree_atomic_store_int32(&out_block_pool->available_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int32(&out_block_pool->allocated_count, 0,
+                          iree_memory_order_relaxed);
+  out_block_pool->max_available_count = IREE_ARENA_BLOCK_POOL_NO_LIMIT;
+  out_block_pool->trace_plot_name = NULL;
 }
 
 void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool) {
@@ -38,16 +59,69 @@ void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool) {
   iree_atomic_arena_block_slist_deinitialize(&block_pool->available_slist);
 }
 
+// Frees a single |block| back to the block allocator.
+static void iree_arena_block_pool_free_block(
+    iree_arena_block_pool_t* block_pool, iree_arena_block_t* block) {
+  void* ptr = (uint8_t*)block - block_pool->usable_block_size;
+  iree_allocator_free(block_pool->block_allocator, ptr);
+  iree_atomic_fetch_sub_int32(&block_pool->allocated_count, 1,
+                              iree_memory_order_relaxed);
+}
+
 void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool) {
   iree_arena_block_t* head = NULL;
   iree_atomic_arena_block_slist_flush(
       &block_pool->available_slist,
       IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL);
+  int32_t freed_count = 0;
   while (head) {
-    void* ptr = (uint8_t*)head - block_pool->usable_block_size;
-    head = head->next;
-    iree_allocator_free(block_pool->block_allocator, ptr);
+    iree_arena_block_t* next = head->next;
+    iree_arena_block_pool_free_block(block_pool, head);
+    head = next;
+    ++freed_count;
+  }
+  iree_atomic_fetch_sub_int32(&block_pool->available_count, freed_count,
+                              iree_memory_order_relaxed);
+  iree_arena_block_pool_trace_plot(block_pool);
+}
+
+void iree_arena_block_pool_trim_to(iree_arena_block_pool_t* block_pool,
+                                   iree_host_size_t retained_count) {
+  if ((iree_host_size_t)iree_atomic_load_int32(&block_pool->available_count,
+                                               iree_memory_order_relaxed) <=
+      retained_count) {
+    return;
+  }
+
+  // Take the whole list so that we can free from the tail: the blocks at the
+  // head of the LIFO were most recently released (and are most likely to be
+  // warm in cache) and are the ones we want to keep. Blocks released by other
+  // threads while we are trimming are pushed to the emptied list and kept.
+  iree_arena_block_t* head = NULL;
+  iree_atomic_arena_block_slist_flush(
+      &block_pool->available_slist,
+      IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL);
+  iree_arena_block_t* retained_tail = NULL;
+  iree_arena_block_t* block = head;
+  for (iree_host_size_t i = 0; block && i < retained_count; ++i) {
+    retained_tail = block;
+    block = block->next;
   }
+  int32_t freed_count = 0;
+  while (block) {
+    iree_arena_block_t* next = block->next;
+    iree_arena_block_pool_free_block(block_pool, block);
+    block = next;
+    ++freed_count;
+  }
+  iree_atomic_fetch_sub_int32(&block_pool->available_count, freed_count,
+                              iree_memory_order_relaxed);
+  if (retained_tail) {
+    retained_tail->next = NULL;
+    iree_atomic_arena_block_slist_concat(&block_pool->available_slist, head,
+                                         retained_tail);
+  }
+  iree_arena_block_pool_trace_plot(block_pool);
 }
 
 iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
@@ -55,7 +129,10 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
   iree_arena_block_t* block =
       iree_atomic_arena_block_slist_pop(&block_pool->available_slist);
 
-  if (!block) {
+  if (block) {
+    iree_atomic_fetch_sub_int32(&block_pool->available_count, 1,
+                                iree_memory_order_relaxed);
+  } else {
     // No blocks available; allocate one now.
     // Note that it's possible for there to be a race here where one thread
     // releases a block to the pool while we are trying to acquire one - in that
@@ -68,6 +145,9 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
                                                (void**)&block_base));
     block = (iree_arena_block_t*)(block_base + (block_pool->total_block_size -
                                                 sizeof(iree_arena_block_t)));
+    iree_atomic_fetch_add_int32(&block_pool->allocated_count, 1,
+                                iree_memory_order_relaxed);
+    iree_arena_block_pool_trace_plot(block_pool);
   }
 
   block->next = NULL;
@@ -78,8 +158,18 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
 void iree_arena_block_pool_release(iree_arena_block_pool_t* block_pool,
                                    iree_arena_block_t* block_head,
                                    iree_arena_block_t* block_tail) {
+  int32_t block_count = 1;
+  for (iree_arena_block_t* block = block_head; block != block_tail;
+       block = block->next) {
+    ++block_count;
+  }
+  iree_atomic_fetch_add_int32(&block_pool->available_count, block_count,
+                              iree_memory_order_relaxed);
   iree_atomic_arena_block_slist_concat(&block_pool->available_slist, block_head,
                                        block_tail);
+  if (block_pool->max_available_count != IREE_ARENA_BLOCK_POOL_NO_LIMIT) {
+    iree_arena_block_pool_trim_to(block_pool, block_pool->max_available_count);
+  }
 }
 
 //===----------------------------------------------------------------------===//
@@ -17,6 +17,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/atomic_slist.h"
+#include "iree/base/atomics.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -38,6 +39,9 @@ typedef struct iree_arena_block_s {
 IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
                                 offsetof(iree_arena_block_t, next));
 
+// Used as iree_arena_block_pool_t::max_available_count to retain all blocks.
+#define IREE_ARENA_BLOCK_POOL_NO_LIMIT ((iree_host_size_t)-1)
+
 // A simple atomic fixed-size block pool.
 // Blocks are allocated from the system as required and kept in the pool to
 // satisfy future requests. Blocks are all of a uniform size specified when the
@@ -45,6 +49,11 @@ IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
 // blocks so that the underlying allocator is more likely to bucket them
 // appropriately.
 //
+// By default all released blocks are retained until the pool is trimmed with
+// iree_arena_block_pool_trim_to or deinitialized. A hard cap on the number of
+// retained blocks can be set with |max_available_count| such that a one-off
+// burst of usage does not keep its peak memory alive for the life of the pool.
+//
 // Thread-safe; multiple threads may acquire and release blocks from the pool.
 // The underlying allocator must also be thread-safe.
 typedef struct {
@@ -57,6 +66,18 @@ typedef struct {
   iree_allocator_t block_allocator;
   // Linked list of free blocks (LIFO).
   iree_atomic_arena_block_slist_t available_slist;
+  // Approximate number of blocks in |available_slist|.
+  iree_atomic_int32_t available_count;
+  // Total number of blocks allocated from |block_allocator|, including both
+  // those acquired and those available.
+  iree_atomic_int32_t allocated_count;
+  // Maximum number of blocks retained in |available_slist|; blocks released
+  // beyond this are freed immediately. Defaults to
+  // IREE_ARENA_BLOCK_POOL_NO_LIMIT and may be changed prior to use.
+  iree_host_size_t max_available_count;
+  // Optional name of a tracing plot that receives the total bytes allocated by
+  // the pool. Must be a string literal. May be set prior to use.
+  const char* trace_plot_name;
 } iree_arena_block_pool_t;
 
 // Initializes a new block pool in |out_block_pool|.
@@ -76,6 +97,14 @@ void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool);
 // Acquired blocks are not freed and remain valid.
 void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool);
 
+// Trims the pool by freeing unused blocks back to the allocator until at most
+// |retained_count| blocks remain available. The most recently released blocks
+// are the ones retained. Acquired blocks are not freed and remain valid. The
+// retention is approximate if other threads are concurrently acquiring or
+// releasing blocks.
+void iree_arena_block_pool_trim_to(iree_arena_block_pool_t* block_pool,
+                                   iree_host_size_t retained_count);
+
 // Acquires a single block from the pool and returns it in |out_block|.
 // The block may be either a new allocation with undefined contents or a reused
 // prior allocation with undefined contents.
@@ -93,7 +122,10 @@ void iree_arena_block_pool_release(iree_arena_block_pool_t* block_pool,
 // iree_arena_allocator_t
 //===----------------------------------------------------------------------===//
 
-typedef struct iree_arena_oversized_allocation_s {
+// Header prefixing oversized allocations. Aligned such that the allocation
+// following it has the same alignment as those made from blocks.
+typedef struct iree_alignas(iree_max_align_t)
+    iree_arena_oversized_allocation_s {
   struct iree_arena_oversized_allocation_s* next;
 } iree_arena_oversized_allocation_t;
 
@@ -0,0 +1,134 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/local/arena.h"
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+static int32_t AvailableCount(iree_arena_block_pool_t* block_pool) {
+  return iree_atomic_load_int32(&block_pool->available_count,
+                                iree_memory_order_relaxed);
+}
+
+static int32_t AllocatedCount(iree_arena_block_pool_t* block_pool) {
+  return iree_atomic_load_int32(&block_pool->allocated_count,
+                                iree_memory_order_relaxed);
+}
+
+// Acquires |count| blocks and releases them back to the pool as one chain.
+static void AcquireAndRelease(iree_arena_block_pool_t* block_pool, int count) {
+  iree_arena_block_t* head = NULL;
+  iree_arena_block_t* tail = NULL;
+  for (int i = 0; i < count; ++i) {
+    iree_arena_block_t* block = NULL;
+    IREE_ASSERT_OK(iree_arena_block_pool_acquire(block_pool, &block));
+    if (tail) {
+      tail->next = block;
+    } else {
+      head = block;
+    }
+    tail = block;
+  }
+  iree_arena_block_pool_release(block_pool, head, tail);
+}
+
+TEST(ArenaBlockPoolTest, RetainsReleasedBlocks) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+  AcquireAndRelease(&block_pool, 4);
+  EXPECT_EQ(4, AvailableCount(&block_pool));
+  EXPECT_EQ(4, AllocatedCount(&block_pool));
+
+  // Reacquiring should reuse the available blocks.
+  AcquireAndRelease(&block_pool, 4);
+  EXPECT_EQ(4, AvailableCount(&block_pool));
+  EXPECT_EQ(4, AllocatedCount(&block_pool));
+
+  iree_arena_block_pool_trim(&block_pool);
+  EXPECT_EQ(0, AvailableCount(&block_pool));
+  EXPECT_EQ(0, AllocatedCount(&block_pool));
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+TEST(ArenaBlockPoolTest, TrimTo) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+  AcquireAndRelease(&block_pool, 8);
+  iree_arena_block_pool_trim_to(&block_pool, 3);
+  EXPECT_EQ(3, AvailableCount(&block_pool));
+  EXPECT_EQ(3, AllocatedCount(&block_pool));
+
+  // Trimming to more than is available is a no-op.
+  iree_arena_block_pool_trim_to(&block_pool, 16);
+  EXPECT_EQ(3, AvailableCount(&block_pool));
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+// Tests that trimming keeps the most recently released blocks.
+TEST(ArenaBlockPoolTest, TrimToKeepsMostRecentlyReleased) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+  iree_arena_block_t* blocks[4] = {NULL};
+  for (int i = 0; i < 4; ++i) {
+    IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &blocks[i]));
+  }
+  for (int i = 0; i < 4; ++i) {
+    iree_arena_block_pool_release(&block_pool, blocks[i], blocks[i]);
+  }
+  iree_arena_block_pool_trim_to(&block_pool, 2);
+  EXPECT_EQ(2, AvailableCount(&block_pool));
+  EXPECT_EQ(2, AllocatedCount(&block_pool));
+
+  iree_arena_block_t* block0 = NULL;
+  iree_arena_block_t* block1 = NULL;
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block0));
+  IREE_ASSERT_OK(iree_arena_block_pool_acquire(&block_pool, &block1));
+  EXPECT_EQ(blocks[3], block0);
+  EXPECT_EQ(blocks[2], block1);
+  EXPECT_EQ(2, AllocatedCount(&block_pool));
+  iree_arena_block_pool_release(&block_pool, block0, block0);
+  iree_arena_block_pool_release(&block_pool, block1, block1);
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+TEST(ArenaBlockPoolTest, MaxAvailableCount) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+  block_pool.max_available_count = 2;
+  AcquireAndRelease(&block_pool, 5);
+  EXPECT_EQ(2, AvailableCount(&block_pool));
+  EXPECT_EQ(2, AllocatedCount(&block_pool));
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+TEST(ArenaTest, ResetReturnsBlocks) {
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+  iree_arena_allocator_t arena;
+  iree_arena_initialize(&block_pool, &arena);
+  void* ptr = NULL;
+  for (int i = 0; i < 4; ++i) {
+    IREE_ASSERT_OK(iree_arena_allocate(&arena, 3000, &ptr));
+  }
+  EXPECT_EQ(0, AvailableCount(&block_pool));
+  iree_arena_deinitialize(&arena);
+  EXPECT_EQ(AllocatedCount(&block_pool), AvailableCount(&block_pool));
+  iree_arena_block_pool_deinitialize(&block_pool);
+}
+
+}  // namespace
@@ -56,7 +56,11 @@ typedef struct {
 // The provided |max_version| is the maximum version the caller supports;
 // callees must return NULL if their lowest available version is greater
 // than the max version supported by the caller.
-typedef const iree_hal_executable_library_header_t* (
+//
+// The returned pointer is to the header pointer that leads every versioned
+// library structure (such as iree_hal_executable_library_v0_t::header) so that
+// callers can check the version before casting to the versioned structure.
+typedef const iree_hal_executable_library_header_t* const* (
     *iree_hal_executable_library_query_fn_t)(
     iree_hal_executable_library_version_t max_version);
 
@@ -100,6 +100,10 @@ typedef struct {
   // Flatbuffer definition referencing the executable memory.
   iree_DyLibExecutableDef_table_t def;
 
+  // Copy of the executable data that |def| references when the caller did not
+  // allow aliasing the data it provided. NULL if |def| aliases caller memory.
+  void* owned_data;
+
   // Temporary files created as part of extraction.
   // Strings are allocated from the host allocator.
   iree_host_size_t temp_file_count;
@@ -108,6 +112,10 @@ typedef struct {
   // Loaded platform dynamic library.
   iree::DynamicLibrary* library;
 
+  // Library interface exposing all entry points, if the library exports one.
+  // When NULL the entry points are resolved individually into entry_fns.
+  const iree_hal_executable_library_v0_t* library_v0;
+
   // Resolved entry points from the dynamic library.
   iree_host_size_t entry_fn_count;
   iree_hal_legacy_executable_fn_ptr_t entry_fns[];
@@ -116,16 +124,44 @@ typedef struct {
 extern const iree_hal_local_executable_vtable_t
     iree_hal_legacy_executable_vtable;
 
+// Loads the embedded library directly from memory without touching the file
+// system. Returns an UNIMPLEMENTED/UNAVAILABLE error if the platform does not
+// support in-memory loading and the caller should fall back to extraction.
+static iree_status_t iree_hal_legacy_executable_load_from_memory(
+    iree_hal_legacy_executable_t* executable) {
+  flatbuffers_uint8_vec_t embedded_library_vec =
+      iree_DyLibExecutableDef_library_embedded_get(executable->def);
+  IREE_ASSIGN_OR_RETURN(
+      auto library,
+      iree::DynamicLibrary::LoadFromMemory(
+          "dylib_executable",
+          absl::MakeConstSpan(
+              embedded_library_vec,
+              flatbuffers_uint8_vec_len(embedded_library_vec))));
+  executable->library = library.release();
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_legacy_executable_extract_and_load(
     iree_hal_legacy_executable_t* executable, iree_allocator_t host_allocator) {
+  // Prefer loading from memory where supported (memfd_create on Linux) so that
+  // we avoid writing to potentially slow or noexec temp directories. The debug
+  // database is only consumed on platforms that take the file path below.
+  iree_status_t status =
+      iree_hal_legacy_executable_load_from_memory(executable);
+  if (iree_status_is_ok(status)) {
+    return status;
+  } else if (!iree_status_is_unimplemented(status) &&
+             !iree_status_is_unavailable(status)) {
+    return status;
+  }
+  iree_status_ignore(status);
+
   // Write the embedded library out to a temp file, since all of the dynamic
-  // library APIs work with files. We could instead use in-memory files on
-  // platforms where that is convenient.
+  // library APIs on this platform work with files.
   //
-  // TODO(#3845): use dlopen on an fd with either dlopen(/proc/self/fd/NN),
-  // fdlopen, or android_dlopen_ext to avoid needing to write the file to disk.
-  // Can fallback to memfd_create + dlopen where available, and fallback from
-  // that to disk (maybe just windows/mac).
+  // TODO(#3845): use fdlopen or android_dlopen_ext on platforms that have them
+  // to avoid needing to write the file to disk.
   IREE_ASSIGN_OR_RETURN(auto library_temp_path,
                         iree::file_io::GetTempFile("dylib_executable"));
 
@@ -188,8 +224,51 @@ static iree_status_t iree_hal_legacy_executable_extract_and_load(
   return iree_ok_status();
 }
 
+// Queries the iree_hal_executable_library_v0_t exported by the library, if
+// any. Libraries produced by the compiler export all entry points through a
+// single library structure so only one symbol needs to be resolved regardless
+// of how many executables were linked into the library.
+static iree_status_t iree_hal_legacy_executable_query_library(
+    iree_hal_legacy_executable_t* executable) {
+  iree_hal_executable_library_query_fn_t query_fn =
+      (iree_hal_executable_library_query_fn_t)executable->library->GetSymbol(
+          IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME);
+  if (!query_fn) return iree_ok_status();
+
+  const iree_hal_executable_library_header_t* const* library =
+      query_fn(IREE_HAL_EXECUTABLE_LIBRARY_LATEST_VERSION);
+  if (!library || !*library) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "executable library does not support runtime version %u",
+        (uint32_t)IREE_HAL_EXECUTABLE_LIBRARY_LATEST_VERSION);
+  }
+  const iree_hal_executable_library_header_t* header = *library;
+  if (header->version != IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "executable library version %u not supported",
+                            header->version);
+  }
+
+  const iree_hal_executable_library_v0_t* library_v0 =
+      (const iree_hal_executable_library_v0_t*)library;
+  if (library_v0->entry_point_count != executable->entry_fn_count) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "executable library provides %u entry points but "
+                            "the executable declares %zu; must match",
+                            library_v0->entry_point_count,
+                            executable->entry_fn_count);
+  }
+  executable->library_v0 = library_v0;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_legacy_executable_resolve_symbols(
     iree_hal_legacy_executable_t* executable) {
+  IREE_RETURN_IF_ERROR(iree_hal_legacy_executable_query_library(executable));
+  if (executable->library_v0) return iree_ok_status();
+
+  // Libraries without the library interface export each entry point.
   flatbuffers_string_vec_t entry_points_vec =
       iree_DyLibExecutableDef_entry_points_get(executable->def);
   for (iree_host_size_t i = 0; i < executable->entry_fn_count; ++i) {
@@ -207,8 +286,11 @@ static iree_status_t iree_hal_legacy_executable_resolve_symbols(
   return iree_ok_status();
 }
 
+// Creates an executable from |executable_def|. If |owned_data| is provided it
+// is the memory |executable_def| references and ownership passes to the
+// executable, even on failure.
 static iree_status_t iree_hal_legacy_executable_create(
-    iree_DyLibExecutableDef_table_t executable_def,
+    iree_DyLibExecutableDef_table_t executable_def, void* owned_data,
     iree_host_size_t executable_layout_count,
     iree_hal_executable_layout_t* const* executable_layouts,
     iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
@@ -223,6 +305,8 @@ static iree_status_t iree_hal_legacy_executable_create(
   iree_host_size_t entry_point_count =
       flatbuffers_string_vec_len(entry_points_vec);
   if (entry_point_count != executable_layout_count) {
+    iree_allocator_free(host_allocator, owned_data);
+    IREE_TRACE_ZONE_END(z0);
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "executable provides %zu entry points but caller "
                             "provided %zu; must match",
@@ -235,7 +319,9 @@ static iree_status_t iree_hal_legacy_executable_create(
       executable_layout_count * sizeof(iree_hal_local_executable_layout_t);
   iree_status_t status =
       iree_allocator_malloc(host_allocator, total_size, (void**)&executable);
-  if (iree_status_is_ok(status)) {
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(host_allocator, owned_data);
+  } else {
     iree_hal_local_executable_layout_t** executable_layouts_ptr =
         (iree_hal_local_executable_layout_t**)(((uint8_t*)executable) +
                                                sizeof(*executable) +
@@ -247,6 +333,8 @@ static iree_status_t iree_hal_legacy_executable_create(
         executable_layouts, executable_layouts_ptr, host_allocator,
         &executable->base);
     executable->def = executable_def;
+    executable->owned_data = owned_data;
+    executable->library_v0 = NULL;
     executable->entry_fn_count = entry_point_count;
   }
   if (iree_status_is_ok(status)) {
@@ -297,6 +385,7 @@ static void iree_hal_legacy_executable_destroy(
 
   iree_hal_local_executable_deinitialize(
       (iree_hal_local_executable_t*)base_executable);
+  iree_allocator_free(host_allocator, executable->owned_data);
   iree_allocator_free(host_allocator, executable);
 
   IREE_TRACE_ZONE_END(z0);
@@ -325,10 +414,16 @@ static iree_status_t iree_hal_legacy_executable_issue_call(
                                       entry_point_name.size);
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
-  executable->entry_fns[ordinal](call->bindings, call->push_constants,
-                                 (const uint32_t*)&call->workgroup_id,
-                                 (const uint32_t*)&call->workgroup_count,
-                                 (const uint32_t*)&call->workgroup_size);
+  if (executable->library_v0) {
+    executable->library_v0->entry_points[ordinal](
+        call->state, &call->workgroup_id, &call->workgroup_size,
+        &call->workgroup_count, call->push_constants, call->bindings);
+  } else {
+    executable->entry_fns[ordinal](call->bindings, call->push_constants,
+                                   (const uint32_t*)&call->workgroup_id,
+                                   (const uint32_t*)&call->workgroup_count,
+                                   (const uint32_t*)&call->workgroup_size);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 
@@ -408,13 +503,29 @@ static iree_status_t iree_hal_legacy_library_loader_try_load(
       z0, iree_hal_dylib_executable_flatbuffer_verify(
               executable_spec->executable_data,
               executable_spec->executable_layout_count));
+
+  // The executable references the flatbuffer for as long as it is loaded. If
+  // the caller guarantees the data outlives the executable we can alias it and
+  // otherwise we clone it and let the executable take ownership.
+  const void* executable_data = executable_spec->executable_data.data;
+  void* owned_data = NULL;
+  if (!iree_all_bits_set(
+          executable_spec->caching_mode,
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA)) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_clone(executable_loader->host_allocator,
+                                 executable_spec->executable_data,
+                                 &owned_data));
+    executable_data = owned_data;
+  }
   iree_DyLibExecutableDef_table_t executable_def =
-      iree_DyLibExecutableDef_as_root(executable_spec->executable_data.data);
+      iree_DyLibExecutableDef_as_root(executable_data);
 
   // Perform the load (and requisite disgusting hackery).
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_legacy_executable_create(
-              executable_def, executable_spec->executable_layout_count,
+              executable_def, owned_data,
+              executable_spec->executable_layout_count,
               executable_spec->executable_layouts,
               executable_loader->host_allocator, out_executable));
 
@@ -0,0 +1,177 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests loading libraries exporting iree_hal_executable_library_v0_t through
+// the legacy dylib loader.
+
+#include "iree/hal/local/loaders/legacy_library_loader.h"
+
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/flatcc.h"
+#include "iree/hal/local/loaders/legacy_library_loader_test_library_embed.h"
+#include "iree/hal/local/local_descriptor_set_layout.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/local/local_executable_layout.h"
+#include "iree/schemas/dylib_executable_def_builder.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+// Builds a DyLibExecutableDef flatbuffer embedding the test library and
+// declaring |entry_point_names|.
+static std::vector<uint8_t> BuildExecutableDef(
+    const std::vector<std::string>& entry_point_names) {
+  const auto* file_toc = iree::legacy_library_loader_test_library_create();
+  flatcc_builder_t builder;
+  flatcc_builder_init(&builder);
+  std::vector<flatbuffers_string_ref_t> entry_point_refs;
+  for (const auto& name : entry_point_names) {
+    entry_point_refs.push_back(
+        flatbuffers_string_create(&builder, name.data(), name.size()));
+  }
+  flatbuffers_string_vec_ref_t entry_points_ref = flatbuffers_string_vec_create(
+      &builder, entry_point_refs.data(), entry_point_refs.size());
+  flatbuffers_uint8_vec_ref_t library_ref = flatbuffers_uint8_vec_create(
+      &builder, reinterpret_cast<const uint8_t*>(file_toc->data),
+      file_toc->size);
+  iree_DyLibExecutableDef_start_as_root(&builder);
+  iree_DyLibExecutableDef_entry_points_add(&builder, entry_points_ref);
+  iree_DyLibExecutableDef_library_embedded_add(&builder, library_ref);
+  iree_DyLibExecutableDef_end_as_root(&builder);
+  size_t buffer_size = 0;
+  void* buffer = flatcc_builder_finalize_aligned_buffer(&builder, &buffer_size);
+  std::vector<uint8_t> data(static_cast<uint8_t*>(buffer),
+                            static_cast<uint8_t*>(buffer) + buffer_size);
+  flatcc_builder_aligned_free(buffer);
+  flatcc_builder_clear(&builder);
+  return data;
+}
+
+class LegacyLibraryLoaderTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_legacy_library_loader_create(
+        iree_allocator_system(), &executable_loader_));
+
+    iree_hal_descriptor_set_layout_binding_t binding;
+    binding.binding = 0;
+    binding.type = IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    binding.access = IREE_HAL_MEMORY_ACCESS_ALL;
+    iree_hal_descriptor_set_layout_t* set_layout = nullptr;
+    IREE_ASSERT_OK(iree_hal_local_descriptor_set_layout_create(
+        IREE_HAL_DESCRIPTOR_SET_LAYOUT_USAGE_TYPE_PUSH_ONLY, 1, &binding,
+        iree_allocator_system(), &set_layout));
+    IREE_ASSERT_OK(iree_hal_local_executable_layout_create(
+        1, &set_layout, /*push_constants=*/1, iree_allocator_system(),
+        &executable_layout_));
+    iree_hal_descriptor_set_layout_release(set_layout);
+  }
+
+  void TearDown() override {
+    iree_hal_executable_layout_release(executable_layout_);
+    iree_hal_executable_loader_release(executable_loader_);
+  }
+
+  // Loads |executable_data| declaring |entry_point_count| entry points.
+  // |executable_data| must outlive the executable.
+  iree_status_t Load(const std::vector<uint8_t>& executable_data,
+                     iree_host_size_t entry_point_count,
+                     iree_hal_executable_t** out_executable) {
+    std::vector<iree_hal_executable_layout_t*> executable_layouts(
+        entry_point_count, executable_layout_);
+    iree_hal_executable_spec_t spec;
+    spec.caching_mode = IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    spec.executable_format = iree_hal_make_executable_format("DLIB");
+    spec.executable_data = iree_make_const_byte_span(executable_data.data(),
+                                                     executable_data.size());
+    spec.executable_layout_count = executable_layouts.size();
+    spec.executable_layouts = executable_layouts.data();
+    return iree_hal_executable_loader_try_load(executable_loader_, &spec,
+                                               out_executable);
+  }
+
+  // Issues a single workgroup of entry point |ordinal| with |output| bound as
+  // its only binding.
+  iree_status_t IssueCall(iree_hal_executable_t* executable,
+                          iree_host_size_t ordinal, uint32_t* output,
+                          iree_host_size_t output_length) {
+    iree_hal_executable_dispatch_state_v0_t state;
+    state.reserved = 0;
+    alignas(16) uint32_t push_constants[4] = {0x1234u, 0, 0, 0};
+    iree_hal_executable_binding_ptr_t bindings[1] = {output};
+    iree_device_size_t binding_lengths[1] = {output_length};
+    iree_hal_local_executable_call_t call;
+    call.state = &state;
+    call.workgroup_id.x = 1;
+    call.workgroup_id.y = 2;
+    call.workgroup_id.z = 3;
+    call.workgroup_size.x = 4;
+    call.workgroup_size.y = 5;
+    call.workgroup_size.z = 6;
+    call.workgroup_count.x = 7;
+    call.workgroup_count.y = 8;
+    call.workgroup_count.z = 9;
+    call.push_constants = push_constants;
+    call.bindings = bindings;
+    call.binding_lengths = binding_lengths;
+    return iree_hal_local_executable_issue_call(
+        iree_hal_local_executable_cast(executable), ordinal, &call);
+  }
+
+  iree_hal_executable_loader_t* executable_loader_ = nullptr;
+  iree_hal_executable_layout_t* executable_layout_ = nullptr;
+};
+
+// Tests that each entry point is dispatched through the library table by
+// ordinal and receives the dispatch arguments in the v0 order.
+TEST_F(LegacyLibraryLoaderTest, DispatchLibraryV0) {
+  std::vector<uint8_t> executable_data =
+      BuildExecutableDef({"write_dispatch_args", "write_marker"});
+  iree_hal_executable_t* executable = nullptr;
+  IREE_ASSERT_OK(Load(executable_data, 2, &executable));
+
+  uint32_t output[10] = {0};
+  IREE_ASSERT_OK(IssueCall(executable, 0, output, sizeof(output)));
+  const uint32_t expected[10] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 0x1234u};
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_EQ(expected[i], output[i]) << "at index " << i;
+  }
+
+  uint32_t marker = 0;
+  IREE_ASSERT_OK(IssueCall(executable, 1, &marker, sizeof(marker)));
+  EXPECT_EQ(0xCAFEu, marker);
+
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT,
+            iree_status_consume_code(
+                IssueCall(executable, 2, &marker, sizeof(marker))));
+
+  iree_hal_executable_release(executable);
+}
+
+// Tests that a library must provide exactly the entry points the executable
+// declares.
+TEST_F(LegacyLibraryLoaderTest, EntryPointCountMismatch) {
+  std::vector<uint8_t> executable_data =
+      BuildExecutableDef({"write_dispatch_args"});
+  iree_hal_executable_t* executable = nullptr;
+  EXPECT_EQ(IREE_STATUS_FAILED_PRECONDITION,
+            iree_status_consume_code(Load(executable_data, 1, &executable)));
+  EXPECT_EQ(nullptr, executable);
+}
+
+}  // namespace
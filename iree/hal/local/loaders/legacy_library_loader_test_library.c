@@ -0,0 +1,82 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// A hand-written executable library exporting the same
+// iree_hal_executable_library_v0_t interface as the libraries produced by the
+// LLVM AOT compiler target. Used by legacy_library_loader_test.cc.
+
+#include "iree/hal/local/executable_library.h"
+
+#if defined(_WIN32)
+#define IREE_SYM_EXPORT __declspec(dllexport)
+#else
+#define IREE_SYM_EXPORT __attribute__((visibility("default")))
+#endif  // _WIN32
+
+// Writes all dispatch arguments into the first binding in the order they are
+// declared by iree_hal_executable_dispatch_v0_t so that the test can verify
+// the loader passes them through unchanged.
+static void write_dispatch_args(
+    const iree_hal_executable_dispatch_state_v0_t* state,
+    const iree_hal_vec3_t* workgroup_id, const iree_hal_vec3_t* workgroup_size,
+    const iree_hal_vec3_t* workgroup_count,
+    const iree_hal_executable_push_constants_ptr_t push_constants,
+    const iree_hal_executable_binding_ptr_t* bindings) {
+  uint32_t* output = (uint32_t*)bindings[0];
+  for (int i = 0; i < 3; ++i) {
+    output[0 + i] = workgroup_id->value[i];
+    output[3 + i] = workgroup_size->value[i];
+    output[6 + i] = workgroup_count->value[i];
+  }
+  output[9] = push_constants[0];
+}
+
+// Writes a marker identifying the entry point into the first binding.
+static void write_marker(
+    const iree_hal_executable_dispatch_state_v0_t* state,
+    const iree_hal_vec3_t* workgroup_id, const iree_hal_vec3_t* workgroup_size,
+    const iree_hal_vec3_t* workgroup_count,
+    const iree_hal_executable_push_constants_ptr_t push_constants,
+    const iree_hal_executable_binding_ptr_t* bindings) {
+  uint32_t* output = (uint32_t*)bindings[0];
+  output[0] = 0xCAFEu;
+}
+
+static const iree_hal_executable_dispatch_v0_t entry_points[2] = {
+    write_dispatch_args,
+    write_marker,
+};
+static const char* entry_point_names[2] = {
+    "write_dispatch_args",
+    "write_marker",
+};
+
+static const iree_hal_executable_library_header_t header = {
+    /*.version=*/IREE_HAL_EXECUTABLE_LIBRARY_VERSION_0,
+    /*.name=*/"legacy_library_loader_test_library",
+};
+static const iree_hal_executable_library_v0_t library = {
+    /*.header=*/&header,
+    /*.entry_point_count=*/2,
+    /*.entry_points=*/entry_points,
+    /*.entry_point_names=*/entry_point_names,
+    /*.entry_point_tags=*/NULL,
+};
+
+// VERSION_0 is the only version so the library is returned to all callers.
+IREE_SYM_EXPORT const iree_hal_executable_library_header_t* const*
+iree_hal_executable_library_query(
+    iree_hal_executable_library_version_t max_version) {
+  return (const iree_hal_executable_library_header_t* const*)&library;
+}
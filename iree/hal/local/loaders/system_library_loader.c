@@ -30,7 +30,7 @@ typedef struct {
   // TODO(benvanik): library handle for ownership.
 
   union {
-    const iree_hal_executable_library_header_t* header;
+    const iree_hal_executable_library_header_t* const* header;
     const iree_hal_executable_library_v0_t* v0;
   } library;
 } iree_hal_system_executable_t;
@@ -40,7 +40,7 @@ static const iree_hal_local_executable_vtable_t
 
 static iree_status_t iree_hal_system_executable_create(
     iree_hal_executable_layout_t* base_layout,
-    const iree_hal_executable_library_header_t* library_header,
+    const iree_hal_executable_library_header_t* const* library_header,
     iree_host_size_t executable_layout_count,
     iree_hal_executable_layout_t* const* executable_layouts,
     iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
@@ -14,6 +14,8 @@
 
 #include "iree/hal/local/local_executable.h"
 
+#include "iree/base/atomics.h"
+
 void iree_hal_local_executable_initialize(
     const iree_hal_local_executable_vtable_t* vtable,
     iree_host_size_t executable_layout_count,
@@ -24,6 +26,10 @@ void iree_hal_local_executable_initialize(
   iree_hal_resource_initialize(vtable, &out_base_executable->resource);
   out_base_executable->host_allocator = host_allocator;
 
+  static iree_atomic_int32_t next_executable_id = IREE_ATOMIC_VAR_INIT(1);
+  out_base_executable->executable_id = (uint32_t)iree_atomic_fetch_add_int32(
+      &next_executable_id, 1, iree_memory_order_seq_cst);
+
   out_base_executable->executable_layout_count = executable_layout_count;
   out_base_executable->executable_layouts = target_executable_layouts;
   for (iree_host_size_t i = 0; i < executable_layout_count; ++i) {
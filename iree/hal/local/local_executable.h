@@ -37,6 +37,10 @@ typedef struct {
 typedef struct {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
+  // Process-unique identifier assigned when the executable is initialized.
+  // Unlike the executable address it is never reused after the executable is
+  // destroyed.
+  uint32_t executable_id;
   iree_host_size_t executable_layout_count;
   iree_hal_local_executable_layout_t** executable_layouts;
 } iree_hal_local_executable_t;
@@ -14,12 +14,47 @@
 
 #include "iree/hal/local/local_executable_cache.h"
 
+#include "iree/base/synchronization.h"
 #include "iree/base/tracing.h"
+#include "iree/hal/local/local_descriptor_set_layout.h"
+#include "iree/hal/local/local_executable_layout.h"
+
+// Caching mode bits that change the executable produced by the loaders.
+// Executables prepared with differing bits are never shared.
+#define IREE_HAL_LOCAL_EXECUTABLE_CACHE_KEY_MODE_MASK           \
+  (IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION |        \
+   IREE_HAL_EXECUTABLE_CACHING_MODE_ENABLE_DEBUGGING |          \
+   IREE_HAL_EXECUTABLE_CACHING_MODE_ENABLE_COVERAGE |           \
+   IREE_HAL_EXECUTABLE_CACHING_MODE_ENABLE_PROFILING)
+
+typedef struct iree_hal_local_executable_cache_entry_s {
+  // Next entry in the cache in most-recently-used order.
+  struct iree_hal_local_executable_cache_entry_s* next;
+  // Content hash of the executable spec; see
+  // iree_hal_local_executable_cache_hash_spec.
+  uint64_t key;
+  iree_hal_executable_format_t executable_format;
+  // Copy of the executable data the entry was prepared from, stored inline
+  // after the entry. Hits compare against it so that hash collisions never
+  // return the wrong executable.
+  iree_const_byte_span_t executable_data;
+  iree_hal_executable_t* executable;
+} iree_hal_local_executable_cache_entry_t;
 
 typedef struct {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
+
+  // Maximum number of entries retained; 0 disables caching.
+  iree_host_size_t capacity;
+
+  // Guards the entry list and statistics. Executables are loaded outside of
+  // the lock so that slow loads do not block unrelated preparation.
+  iree_slim_mutex_t mutex;
+  iree_hal_local_executable_cache_entry_t* entry_head;
+  iree_hal_local_executable_cache_statistics_t statistics;
+
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_local_executable_cache_t;
@@ -34,8 +69,9 @@ static iree_hal_local_executable_cache_t* iree_hal_local_executable_cache_cast(
 }
 
 iree_status_t iree_hal_local_executable_cache_create(
-    iree_string_view_t identifier, iree_host_size_t loader_count,
-    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
+    iree_string_view_t identifier, iree_host_size_t capacity,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
   IREE_ASSERT_ARGUMENT(out_executable_cache);
@@ -57,6 +93,12 @@ iree_status_t iree_hal_local_executable_cache_create(
         identifier, &executable_cache->identifier,
         (char*)executable_cache + total_size - identifier.size);
 
+    executable_cache->capacity = capacity;
+    iree_slim_mutex_initialize(&executable_cache->mutex);
+    executable_cache->entry_head = NULL;
+    memset(&executable_cache->statistics, 0,
+           sizeof(executable_cache->statistics));
+
     executable_cache->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
       executable_cache->loaders[i] = loaders[i];
@@ -70,6 +112,13 @@ iree_status_t iree_hal_local_executable_cache_create(
   return status;
 }
 
+static void iree_hal_local_executable_cache_entry_free(
+    iree_hal_local_executable_cache_t* executable_cache,
+    iree_hal_local_executable_cache_entry_t* entry) {
+  iree_hal_executable_release(entry->executable);
+  iree_allocator_free(executable_cache->host_allocator, entry);
+}
+
 static void iree_hal_local_executable_cache_destroy(
     iree_hal_executable_cache_t* base_executable_cache) {
   iree_hal_local_executable_cache_t* executable_cache =
@@ -77,6 +126,14 @@ static void iree_hal_local_executable_cache_destroy(
   iree_allocator_t host_allocator = executable_cache->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_local_executable_cache_entry_t* entry = executable_cache->entry_head;
+  while (entry) {
+    iree_hal_local_executable_cache_entry_t* next = entry->next;
+    iree_hal_local_executable_cache_entry_free(executable_cache, entry);
+    entry = next;
+  }
+  iree_slim_mutex_deinitialize(&executable_cache->mutex);
+
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     iree_hal_executable_loader_release(executable_cache->loaders[i]);
   }
@@ -85,6 +142,154 @@ static void iree_hal_local_executable_cache_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_hal_local_executable_cache_query_statistics(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_hal_local_executable_cache_statistics_t* out_statistics) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+  iree_slim_mutex_lock(&executable_cache->mutex);
+  *out_statistics = executable_cache->statistics;
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// Content hashing
+//===----------------------------------------------------------------------===//
+
+// 64-bit FNV-1a. Not cryptographic; entries additionally compare the format
+// and the full executable data before being reused.
+#define IREE_HAL_LOCAL_EXECUTABLE_CACHE_HASH_SEED 0xCBF29CE484222325ull
+#define IREE_HAL_LOCAL_EXECUTABLE_CACHE_HASH_PRIME 0x00000100000001B3ull
+
+static uint64_t iree_hal_local_executable_cache_hash_bytes(
+    uint64_t hash, const void* data, iree_host_size_t data_length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (iree_host_size_t i = 0; i < data_length; ++i) {
+    hash ^= bytes[i];
+    hash *= IREE_HAL_LOCAL_EXECUTABLE_CACHE_HASH_PRIME;
+  }
+  return hash;
+}
+
+static uint64_t iree_hal_local_executable_cache_hash_uint64(uint64_t hash,
+                                                            uint64_t value) {
+  return iree_hal_local_executable_cache_hash_bytes(hash, &value,
+                                                    sizeof(value));
+}
+
+// Hashes everything about |executable_spec| that affects the executable the
+// loaders produce. Executable layouts are hashed by their structure so that
+// identical layouts created by different contexts produce the same key.
+static uint64_t iree_hal_local_executable_cache_hash_spec(
+    const iree_hal_executable_spec_t* executable_spec) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0,
+                               executable_spec->executable_data.data_length);
+
+  uint64_t hash = IREE_HAL_LOCAL_EXECUTABLE_CACHE_HASH_SEED;
+  hash = iree_hal_local_executable_cache_hash_uint64(
+      hash, executable_spec->executable_format);
+  hash = iree_hal_local_executable_cache_hash_uint64(
+      hash, executable_spec->caching_mode &
+                IREE_HAL_LOCAL_EXECUTABLE_CACHE_KEY_MODE_MASK);
+  hash = iree_hal_local_executable_cache_hash_uint64(
+      hash, executable_spec->executable_data.data_length);
+  hash = iree_hal_local_executable_cache_hash_bytes(
+      hash, executable_spec->executable_data.data,
+      executable_spec->executable_data.data_length);
+
+  hash = iree_hal_local_executable_cache_hash_uint64(
+      hash, executable_spec->executable_layout_count);
+  for (iree_host_size_t i = 0; i < executable_spec->executable_layout_count;
+       ++i) {
+    iree_hal_local_executable_layout_t* executable_layout =
+        iree_hal_local_executable_layout_cast(
+            executable_spec->executable_layouts[i]);
+    hash = iree_hal_local_executable_cache_hash_uint64(
+        hash, executable_layout->push_constants);
+    hash = iree_hal_local_executable_cache_hash_uint64(
+        hash, executable_layout->set_layout_count);
+    for (iree_host_size_t j = 0; j < executable_layout->set_layout_count;
+         ++j) {
+      iree_hal_local_descriptor_set_layout_t* set_layout =
+          iree_hal_local_descriptor_set_layout_cast(
+              executable_layout->set_layouts[j]);
+      hash = iree_hal_local_executable_cache_hash_uint64(
+          hash, set_layout->usage_type);
+      hash = iree_hal_local_executable_cache_hash_uint64(
+          hash, set_layout->binding_count);
+      for (iree_host_size_t k = 0; k < set_layout->binding_count; ++k) {
+        const iree_hal_descriptor_set_layout_binding_t* binding =
+            &set_layout->bindings[k];
+        hash = iree_hal_local_executable_cache_hash_uint64(hash,
+                                                           binding->binding);
+        hash =
+            iree_hal_local_executable_cache_hash_uint64(hash, binding->type);
+        hash =
+            iree_hal_local_executable_cache_hash_uint64(hash, binding->access);
+      }
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return hash;
+}
+
+//===----------------------------------------------------------------------===//
+// Cache entry management
+//===----------------------------------------------------------------------===//
+
+// Looks up an executable matching |key| and moves it to the front of the list.
+// Must be called with the lock held. Returns a new reference to the executable
+// or NULL on a miss.
+static iree_hal_executable_t* iree_hal_local_executable_cache_lookup(
+    iree_hal_local_executable_cache_t* executable_cache, uint64_t key,
+    const iree_hal_executable_spec_t* executable_spec) {
+  iree_hal_local_executable_cache_entry_t** entry_ptr =
+      &executable_cache->entry_head;
+  while (*entry_ptr) {
+    iree_hal_local_executable_cache_entry_t* entry = *entry_ptr;
+    if (entry->key == key &&
+        entry->executable_format == executable_spec->executable_format &&
+        entry->executable_data.data_length ==
+            executable_spec->executable_data.data_length &&
+        memcmp(entry->executable_data.data,
+               executable_spec->executable_data.data,
+               entry->executable_data.data_length) == 0) {
+      *entry_ptr = entry->next;
+      entry->next = executable_cache->entry_head;
+      executable_cache->entry_head = entry;
+      iree_hal_executable_retain(entry->executable);
+      return entry->executable;
+    }
+    entry_ptr = &entry->next;
+  }
+  return NULL;
+}
+
+// Trims the least recently used entries until the cache is within capacity.
+// Must be called with the lock held.
+static void iree_hal_local_executable_cache_trim(
+    iree_hal_local_executable_cache_t* executable_cache) {
+  if (executable_cache->statistics.entry_count <= executable_cache->capacity) {
+    return;
+  }
+  iree_hal_local_executable_cache_entry_t** entry_ptr =
+      &executable_cache->entry_head;
+  for (iree_host_size_t i = 0; i < executable_cache->capacity; ++i) {
+    entry_ptr = &(*entry_ptr)->next;
+  }
+  iree_hal_local_executable_cache_entry_t* entry = *entry_ptr;
+  *entry_ptr = NULL;
+  while (entry) {
+    iree_hal_local_executable_cache_entry_t* next = entry->next;
+    iree_hal_local_executable_cache_entry_free(executable_cache, entry);
+    ++executable_cache->statistics.eviction_count;
+    --executable_cache->statistics.entry_count;
+    entry = next;
+  }
+}
+
 static bool iree_hal_local_executable_cache_can_prepare_format(
     iree_hal_executable_cache_t* base_executable_cache,
     iree_hal_executable_caching_mode_t caching_mode,
@@ -100,12 +305,10 @@ static bool iree_hal_local_executable_cache_can_prepare_format(
   return false;
 }
 
-static iree_status_t iree_hal_local_executable_cache_prepare_executable(
-    iree_hal_executable_cache_t* base_executable_cache,
+static iree_status_t iree_hal_local_executable_cache_load_executable(
+    iree_hal_local_executable_cache_t* executable_cache,
     const iree_hal_executable_spec_t* executable_spec,
     iree_hal_executable_t** out_executable) {
-  iree_hal_local_executable_cache_t* executable_cache =
-      iree_hal_local_executable_cache_cast(base_executable_cache);
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     if (iree_hal_executable_loader_query_support(
             executable_cache->loaders[i], executable_spec->caching_mode,
@@ -128,6 +331,99 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
       "no executable loader registered for the given file format");
 }
 
+static iree_status_t iree_hal_local_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_spec_t* executable_spec,
+    iree_hal_executable_t** out_executable) {
+  iree_hal_local_executable_cache_t* executable_cache =
+      iree_hal_local_executable_cache_cast(base_executable_cache);
+
+  // Executables that are not expected to be used again bypass the cache.
+  if (executable_cache->capacity == 0 ||
+      !iree_all_bits_set(
+          executable_spec->caching_mode,
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING)) {
+    return iree_hal_local_executable_cache_load_executable(
+        executable_cache, executable_spec, out_executable);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  uint64_t key = iree_hal_local_executable_cache_hash_spec(executable_spec);
+
+  iree_slim_mutex_lock(&executable_cache->mutex);
+  iree_hal_executable_t* executable =
+      iree_hal_local_executable_cache_lookup(executable_cache, key,
+                                             executable_spec);
+  if (executable) {
+    ++executable_cache->statistics.hit_count;
+  } else {
+    ++executable_cache->statistics.miss_count;
+  }
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+  if (executable) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
+    *out_executable = executable;
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, "miss");
+
+  // Load outside of the lock; loading may dlopen, JIT, etc.
+  // Cached executables are handed to other callers whose lifetimes are
+  // unrelated to that of the caller that provided the data, so they must never
+  // alias it: the loader is asked for its own copy.
+  iree_hal_executable_spec_t owned_spec = *executable_spec;
+  owned_spec.caching_mode &=
+      ~IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_local_executable_cache_load_executable(
+              executable_cache, &owned_spec, &executable));
+
+  iree_hal_local_executable_cache_entry_t* entry = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      executable_cache->host_allocator,
+      sizeof(*entry) + executable_spec->executable_data.data_length,
+      (void**)&entry);
+  if (!iree_status_is_ok(status)) {
+    // Failing to cache is not fatal; the caller still gets the executable.
+    iree_status_ignore(status);
+    *out_executable = executable;
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+  entry->key = key;
+  entry->executable_format = executable_spec->executable_format;
+  uint8_t* entry_data = (uint8_t*)entry + sizeof(*entry);
+  memcpy(entry_data, executable_spec->executable_data.data,
+         executable_spec->executable_data.data_length);
+  entry->executable_data = iree_make_const_byte_span(
+      entry_data, executable_spec->executable_data.data_length);
+  entry->executable = executable;
+  iree_hal_executable_retain(executable);
+
+  iree_slim_mutex_lock(&executable_cache->mutex);
+  // Another thread may have loaded the same executable while we were; prefer
+  // the one already in the cache so that all callers share it.
+  iree_hal_executable_t* existing_executable =
+      iree_hal_local_executable_cache_lookup(executable_cache, key,
+                                             executable_spec);
+  if (existing_executable) {
+    iree_hal_executable_release(executable);
+    executable = existing_executable;
+    iree_hal_local_executable_cache_entry_free(executable_cache, entry);
+  } else {
+    entry->next = executable_cache->entry_head;
+    executable_cache->entry_head = entry;
+    ++executable_cache->statistics.entry_count;
+    iree_hal_local_executable_cache_trim(executable_cache);
+  }
+  iree_slim_mutex_unlock(&executable_cache->mutex);
+
+  *out_executable = executable;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 static const iree_hal_executable_cache_vtable_t
     iree_hal_local_executable_cache_vtable = {
         .destroy = iree_hal_local_executable_cache_destroy,
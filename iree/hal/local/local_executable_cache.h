@@ -23,19 +23,49 @@
 extern "C" {
 #endif  // __cplusplus
 
-// TODO(benvanik): when we refactor executable caches this can become something
-// more specialized; like nop_executable_cache (does nothing but pass through)
-// or inproc_lru_executable_cache (simple in-memory LRU of recent executables).
+// Content-addressed in-memory cache of prepared executables.
 //
-// We can also set this up so they share storage. Ideally a JIT'ed executable in
-// one device is the same JIT'ed executable in another, and in multi-tenant
-// situations we're likely to want that isolation _and_ sharing.
+// Executables are keyed by a hash of their format, data, relevant caching mode
+// bits, and the structure of their executable layouts (not the layout object
+// identities), so the same executable prepared from different contexts maps to
+// the same cache entry. Each entry keeps a copy of the executable data that
+// hits are compared against. Devices should create a single cache and share it
+// across all iree_hal_executable_cache_t requests so that every context loading
+// the same module reuses the executables loaded by the first.
+//
+// Executables are only retained by the cache when prepared with
+// IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING. As they may be
+// shared with other callers they are always loaded from a copy of the data even
+// if IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA is set.
+// When more than |capacity| executables are cached the least recently used are
+// evicted; a |capacity| of 0 disables caching entirely.
+//
+// TODO(benvanik): persistent (on-disk) caching for JIT'ed executables.
+
+// Statistics of an executable cache since it was created.
+typedef struct {
+  // Number of prepare requests served from the cache.
+  uint64_t hit_count;
+  // Number of prepare requests that loaded a new executable.
+  uint64_t miss_count;
+  // Number of executables dropped from the cache to stay within capacity.
+  uint64_t eviction_count;
+  // Number of executables currently retained by the cache.
+  iree_host_size_t entry_count;
+} iree_hal_local_executable_cache_statistics_t;
 
 iree_status_t iree_hal_local_executable_cache_create(
-    iree_string_view_t identifier, iree_host_size_t loader_count,
-    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
+    iree_string_view_t identifier, iree_host_size_t capacity,
+    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
+    iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
 
+// Queries the hit/miss statistics of a cache created with
+// iree_hal_local_executable_cache_create.
+void iree_hal_local_executable_cache_query_statistics(
+    iree_hal_executable_cache_t* executable_cache,
+    iree_hal_local_executable_cache_statistics_t* out_statistics);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,345 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "iree/hal/local/local_executable_cache.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/local/local_descriptor_set_layout.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/local/local_executable_layout.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Counting loader
+//===----------------------------------------------------------------------===//
+// Loads an empty executable for any data in kTestFormat and counts the loads.
+
+static const iree_hal_executable_format_t kTestFormat =
+    iree_hal_make_executable_format("TEST");
+
+typedef struct {
+  iree_hal_local_executable_t base;
+  iree_hal_local_executable_layout_t* layouts[];
+} test_executable_t;
+
+static void test_executable_destroy(iree_hal_executable_t* base_executable) {
+  test_executable_t* executable = (test_executable_t*)base_executable;
+  iree_allocator_t host_allocator = executable->base.host_allocator;
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(host_allocator, executable);
+}
+
+static iree_status_t test_executable_issue_call(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_local_executable_call_t* call) {
+  return iree_ok_status();
+}
+
+static const iree_hal_local_executable_vtable_t test_executable_vtable = {
+    /*.base=*/{
+        /*.destroy=*/test_executable_destroy,
+    },
+    /*.issue_call=*/test_executable_issue_call,
+};
+
+typedef struct {
+  iree_hal_executable_loader_t base;
+  int load_count;
+  iree_hal_executable_caching_mode_t last_caching_mode;
+} test_loader_t;
+
+static void test_loader_destroy(iree_hal_executable_loader_t* base_loader) {}
+
+static bool test_loader_query_support(
+    iree_hal_executable_loader_t* base_loader,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_hal_executable_format_t executable_format) {
+  return executable_format == kTestFormat;
+}
+
+static iree_status_t test_loader_try_load(
+    iree_hal_executable_loader_t* base_loader,
+    const iree_hal_executable_spec_t* executable_spec,
+    iree_hal_executable_t** out_executable) {
+  test_loader_t* loader = (test_loader_t*)base_loader;
+  ++loader->load_count;
+  loader->last_caching_mode = executable_spec->caching_mode;
+  test_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      iree_allocator_system(),
+      sizeof(*executable) + executable_spec->executable_layout_count *
+                                sizeof(executable->layouts[0]),
+      (void**)&executable));
+  iree_hal_local_executable_initialize(
+      &test_executable_vtable, executable_spec->executable_layout_count,
+      executable_spec->executable_layouts, executable->layouts,
+      iree_allocator_system(), &executable->base);
+  *out_executable = (iree_hal_executable_t*)executable;
+  return iree_ok_status();
+}
+
+static const iree_hal_executable_loader_vtable_t test_loader_vtable = {
+    /*.destroy=*/test_loader_destroy,
+    /*.query_support=*/test_loader_query_support,
+    /*.try_load=*/test_loader_try_load,
+};
+
+class LocalExecutableCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_hal_executable_loader_initialize(&test_loader_vtable, &loader_.base);
+    loader_.load_count = 0;
+    loader_.last_caching_mode = 0;
+  }
+
+  void TearDown() override {
+    for (auto* executable_layout : executable_layouts_) {
+      iree_hal_executable_layout_release(executable_layout);
+    }
+  }
+
+  iree_hal_executable_cache_t* CreateCache(iree_host_size_t capacity) {
+    iree_hal_executable_loader_t* loaders[] = {&loader_.base};
+    iree_hal_executable_cache_t* executable_cache = NULL;
+    IREE_CHECK_OK(iree_hal_local_executable_cache_create(
+        iree_make_cstring_view("test"), capacity, IREE_ARRAYSIZE(loaders),
+        loaders, iree_allocator_system(), &executable_cache));
+    return executable_cache;
+  }
+
+  // Creates a new executable layout with one set of |binding_count| bindings.
+  // Every call returns a new layout object, as each context would.
+  iree_hal_executable_layout_t* CreateLayout(iree_host_size_t binding_count) {
+    std::vector<iree_hal_descriptor_set_layout_binding_t> bindings(
+        binding_count);
+    for (iree_host_size_t i = 0; i < binding_count; ++i) {
+      bindings[i].binding = (uint32_t)i;
+      bindings[i].type = IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+      bindings[i].access = IREE_HAL_MEMORY_ACCESS_ALL;
+    }
+    iree_hal_descriptor_set_layout_t* set_layout = NULL;
+    IREE_CHECK_OK(iree_hal_local_descriptor_set_layout_create(
+        IREE_HAL_DESCRIPTOR_SET_LAYOUT_USAGE_TYPE_PUSH_ONLY, bindings.size(),
+        bindings.data(), iree_allocator_system(), &set_layout));
+    iree_hal_executable_layout_t* executable_layout = NULL;
+    IREE_CHECK_OK(iree_hal_local_executable_layout_create(
+        1, &set_layout, /*push_constants=*/0, iree_allocator_system(),
+        &executable_layout));
+    iree_hal_descriptor_set_layout_release(set_layout);
+    executable_layouts_.push_back(executable_layout);
+    return executable_layout;
+  }
+
+  iree_hal_executable_t* Prepare(
+      iree_hal_executable_cache_t* executable_cache,
+      iree_const_byte_span_t executable_data,
+      iree_hal_executable_layout_t* executable_layout,
+      iree_hal_executable_caching_mode_t caching_mode =
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING |
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION) {
+    iree_hal_executable_spec_t spec;
+    iree_hal_executable_spec_initialize(&spec);
+    spec.caching_mode = caching_mode;
+    spec.executable_format = kTestFormat;
+    spec.executable_data = executable_data;
+    spec.executable_layout_count = 1;
+    spec.executable_layouts = &executable_layout;
+    iree_hal_executable_t* executable = NULL;
+    IREE_CHECK_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache, &spec, &executable));
+    return executable;
+  }
+
+  iree_hal_local_executable_cache_statistics_t QueryStatistics(
+      iree_hal_executable_cache_t* executable_cache) {
+    iree_hal_local_executable_cache_statistics_t statistics;
+    iree_hal_local_executable_cache_query_statistics(executable_cache,
+                                                     &statistics);
+    return statistics;
+  }
+
+  test_loader_t loader_;
+  std::vector<iree_hal_executable_layout_t*> executable_layouts_;
+};
+
+static const uint8_t kDataA[] = {1, 2, 3, 4};
+static const uint8_t kDataB[] = {1, 2, 3, 5};
+
+// Tests that identical executables prepared with distinct but structurally
+// identical layouts (as from two contexts) share one load.
+TEST_F(LocalExecutableCacheTest, HitAcrossContexts) {
+  iree_hal_executable_cache_t* executable_cache = CreateCache(8);
+
+  iree_hal_executable_t* executable0 =
+      Prepare(executable_cache, iree_make_const_byte_span(kDataA, 4),
+              CreateLayout(2));
+  // Same contents at a different address.
+  std::vector<uint8_t> data_copy(kDataA, kDataA + 4);
+  iree_hal_executable_t* executable1 = Prepare(
+      executable_cache,
+      iree_make_const_byte_span(data_copy.data(), data_copy.size()),
+      CreateLayout(2));
+  EXPECT_EQ(executable0, executable1);
+  EXPECT_EQ(1, loader_.load_count);
+
+  auto statistics = QueryStatistics(executable_cache);
+  EXPECT_EQ(1, statistics.hit_count);
+  EXPECT_EQ(1, statistics.miss_count);
+  EXPECT_EQ(1, statistics.entry_count);
+
+  iree_hal_executable_release(executable0);
+  iree_hal_executable_release(executable1);
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Tests that cache hits compare against the cache's own copy of the data, as
+// the data provided by the caller is not guaranteed to outlive preparation.
+TEST_F(LocalExecutableCacheTest, HitAfterCallerDataFreed) {
+  iree_hal_executable_cache_t* executable_cache = CreateCache(8);
+  iree_hal_executable_layout_t* executable_layout = CreateLayout(1);
+
+  std::vector<uint8_t> data0(kDataA, kDataA + 4);
+  iree_hal_executable_t* executable0 = Prepare(
+      executable_cache, iree_make_const_byte_span(data0.data(), data0.size()),
+      executable_layout);
+  std::fill(data0.begin(), data0.end(), 0xCD);
+  data0.clear();
+  data0.shrink_to_fit();
+
+  std::vector<uint8_t> data1(kDataA, kDataA + 4);
+  iree_hal_executable_t* executable1 = Prepare(
+      executable_cache, iree_make_const_byte_span(data1.data(), data1.size()),
+      executable_layout);
+  EXPECT_EQ(executable0, executable1);
+  EXPECT_EQ(1, loader_.load_count);
+
+  iree_hal_executable_release(executable0);
+  iree_hal_executable_release(executable1);
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Tests that differing data or layouts do not share executables.
+TEST_F(LocalExecutableCacheTest, MissOnDifferentContents) {
+  iree_hal_executable_cache_t* executable_cache = CreateCache(8);
+
+  iree_hal_executable_t* executable0 =
+      Prepare(executable_cache, iree_make_const_byte_span(kDataA, 4),
+              CreateLayout(2));
+  iree_hal_executable_t* executable1 =
+      Prepare(executable_cache, iree_make_const_byte_span(kDataB, 4),
+              CreateLayout(2));
+  iree_hal_executable_t* executable2 =
+      Prepare(executable_cache, iree_make_const_byte_span(kDataA, 4),
+              CreateLayout(3));
+  iree_hal_executable_t* executable3 = Prepare(
+      executable_cache, iree_make_const_byte_span(kDataA, 4), CreateLayout(2),
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING |
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ENABLE_PROFILING);
+  EXPECT_NE(executable0, executable1);
+  EXPECT_NE(executable0, executable2);
+  EXPECT_NE(executable0, executable3);
+  EXPECT_EQ(4, loader_.load_count);
+  EXPECT_EQ(0, QueryStatistics(executable_cache).hit_count);
+
+  iree_hal_executable_release(executable0);
+  iree_hal_executable_release(executable1);
+  iree_hal_executable_release(executable2);
+  iree_hal_executable_release(executable3);
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Tests that executables not allowed to be cached are always loaded anew.
+TEST_F(LocalExecutableCacheTest, BypassWithoutCaching) {
+  iree_hal_executable_cache_t* executable_cache = CreateCache(8);
+
+  for (int i = 0; i < 2; ++i) {
+    iree_hal_executable_t* executable = Prepare(
+        executable_cache, iree_make_const_byte_span(kDataA, 4),
+        CreateLayout(2), IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION);
+    iree_hal_executable_release(executable);
+  }
+  EXPECT_EQ(2, loader_.load_count);
+  EXPECT_EQ(0, QueryStatistics(executable_cache).entry_count);
+
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Tests that the least recently used executables are evicted at capacity.
+TEST_F(LocalExecutableCacheTest, EvictToCapacity) {
+  iree_hal_executable_cache_t* executable_cache = CreateCache(2);
+
+  iree_hal_executable_layout_t* executable_layout = CreateLayout(1);
+  for (int i = 1; i <= 3; ++i) {
+    iree_hal_executable_release(Prepare(executable_cache,
+                                        iree_make_const_byte_span(kDataA, i),
+                                        executable_layout));
+  }
+  auto statistics = QueryStatistics(executable_cache);
+  EXPECT_EQ(2, statistics.entry_count);
+  EXPECT_EQ(1, statistics.eviction_count);
+
+  // The first was evicted and must be reloaded; the last is still cached.
+  iree_hal_executable_release(Prepare(
+      executable_cache, iree_make_const_byte_span(kDataA, 3),
+      executable_layout));
+  EXPECT_EQ(3, loader_.load_count);
+  iree_hal_executable_release(Prepare(
+      executable_cache, iree_make_const_byte_span(kDataA, 1),
+      executable_layout));
+  EXPECT_EQ(4, loader_.load_count);
+
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+// Tests that executables prepared with data the caller allows aliasing are
+// loaded from a copy so that sharing them never references that caller's data.
+TEST_F(LocalExecutableCacheTest, AliasedDataLoadedAsCopy) {
+  iree_hal_executable_cache_t* executable_cache = CreateCache(8);
+  const iree_hal_executable_caching_mode_t caching_mode =
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING;
+  iree_hal_executable_layout_t* executable_layout = CreateLayout(1);
+
+  std::vector<uint8_t> data0(kDataA, kDataA + 4);
+  iree_hal_executable_t* executable0 = Prepare(
+      executable_cache, iree_make_const_byte_span(data0.data(), data0.size()),
+      executable_layout, caching_mode);
+  EXPECT_EQ(1, loader_.load_count);
+  EXPECT_FALSE(iree_any_bit_set(
+      loader_.last_caching_mode,
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA));
+  data0.clear();
+  data0.shrink_to_fit();
+  iree_hal_executable_release(executable0);
+
+  // The executable stays shared after its first caller released it and freed
+  // its data.
+  iree_hal_executable_t* executable1 =
+      Prepare(executable_cache, iree_make_const_byte_span(kDataA, 4),
+              executable_layout, caching_mode);
+  EXPECT_EQ(executable0, executable1);
+  EXPECT_EQ(1, loader_.load_count);
+  EXPECT_EQ(0, QueryStatistics(executable_cache).eviction_count);
+  iree_hal_executable_release(executable1);
+
+  iree_hal_executable_cache_release(executable_cache);
+}
+
+}  // namespace
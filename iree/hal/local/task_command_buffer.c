@@ -15,6 +15,7 @@
 #include "iree/hal/local/task_command_buffer.h"
 
 #include "iree/base/debugging.h"
+#include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/local/local_descriptor_set_layout.h"
 #include "iree/hal/local/local_executable.h"
@@ -23,10 +24,63 @@
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 
+#if defined(IREE_ARCH_X86_64)
+#include <emmintrin.h>
+#endif  // IREE_ARCH_X86_64
+
 //===----------------------------------------------------------------------===//
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// A byte range of an allocated buffer accessed by a recorded command.
+// Accesses are tracked on the allocated buffer (and not the possibly-subspanned
+// buffer passed to the command) so that commands referencing different views
+// of the same allocation are still ordered correctly.
+typedef struct {
+  iree_hal_buffer_t* buffer;
+  iree_device_size_t offset;
+  iree_device_size_t length;
+  iree_hal_memory_access_t access;
+  // Set once a command recorded in a later barrier scope has written the entire
+  // range. Anything that would conflict with this access also conflicts with
+  // the later write and is ordered after it (and so transitively after us).
+  bool superseded;
+} iree_hal_task_access_t;
+
+typedef struct iree_hal_task_node_s iree_hal_task_node_t;
+
+// An edge in the task DAG from a producer node to a consumer node.
+typedef struct iree_hal_task_edge_s {
+  struct iree_hal_task_edge_s* next;
+  iree_hal_task_node_t* consumer;
+} iree_hal_task_edge_t;
+
+// A recorded execution task and the buffer ranges it accesses.
+// Nodes are only used during recording; when recording ends the edges are
+// translated into task completion/barrier dependencies.
+struct iree_hal_task_node_s {
+  // Next node in recording order.
+  iree_hal_task_node_t* next;
+  iree_task_t* task;
+  // Index of the barrier scope the node was recorded in. Nodes in the same
+  // scope are unordered with respect to each other.
+  iree_host_size_t scope_index;
+  iree_host_size_t producer_count;
+  iree_host_size_t consumer_count;
+  iree_hal_task_edge_t* consumers;
+  iree_host_size_t access_count;
+  iree_hal_task_access_t accesses[];
+};
+
+// Dependency state of a task as wired when recording ended. Reusable command
+// buffers restore this prior to each issue as execution consumes it.
+typedef struct {
+  iree_task_t* task;
+  iree_task_t* completion_task;
+  int32_t pending_dependency_count;
+  iree_task_flags_t flags;
+} iree_hal_task_rearm_t;
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -35,6 +89,18 @@
 // additional allocations required during recording or execution. That means our
 // command buffer here is essentially just a builder for the task system types
 // and manager of the lifetime of the tasks.
+//
+// Barriers and event waits don't join all work: instead each command records
+// the buffer ranges it reads and writes and only gets an edge to commands in
+// prior barrier scopes with which it has a hazard (read-after-write,
+// write-after-read, or write-after-write). Independent commands (such as
+// dispatches touching disjoint buffers) are free to overlap on the executor
+// even if the compiler inserted a full barrier between them.
+//
+// One-shot command buffers hand their tasks over to the executor when issued.
+// Reusable command buffers instead keep the tasks and re-arm their dependency
+// state on each issue so that the same DAG can be replayed without recording
+// or allocating anything.
 typedef struct {
   iree_hal_resource_t resource;
 
@@ -53,29 +119,33 @@ typedef struct {
 
   // One or more tasks at the leaves of the DAG.
   // Only once all these tasks have completed execution will the command buffer
-  // be considered completed as a whole.
-  //
-  // An empty list indicates that root_tasks are also the leaves.
-  iree_task_list_t leaf_tasks;
+  // be considered completed as a whole. Roots may also be leaves.
+  iree_host_size_t leaf_task_count;
+  iree_task_t** leaf_tasks;
+
+  // Tasks retained for replay by reusable command buffers.
+  // Roots are kept in a flat list as the intrusive root_tasks list is consumed
+  // by the executor when it is submitted.
+  struct {
+    iree_host_size_t root_task_count;
+    iree_task_t** root_tasks;
+    iree_host_size_t task_count;
+    iree_hal_task_rearm_t* tasks;
+    // Nonzero from when the command buffer is issued until the submission it
+    // was issued in retires. The tasks can only be re-armed once idle.
+    iree_atomic_int32_t in_flight;
+  } replay;
 
   // TODO(benvanik): move this out of the struct and allocate from the arena -
-  // we only need this during recording and it's ~4KB of waste otherwise.
+  // we only need this during recording and it's ~8KB of waste otherwise.
   // State tracked within the command buffer during recording only.
   struct {
-    // The last global barrier that was inserted, if any.
-    // The barrier is allocated and inserted into the DAG when requested but the
-    // actual barrier dependency list is only allocated and set on flushes.
-    // This lets us allocate the appropriately sized barrier task list from the
-    // arena even though when the barrier is recorded we don't yet know what
-    // other tasks we'll be emitting as we walk the command stream.
-    iree_task_barrier_t* open_barrier;
+    // All nodes recorded in recording order.
+    iree_hal_task_node_t* node_head;
+    iree_hal_task_node_t* node_tail;
 
-    // The number of tasks in the open barrier (|open_tasks|), used to quickly
-    // allocate storage for the task list without needing to walk the list.
-    iree_host_size_t open_task_count;
-
-    // All execution tasks emitted that must execute after |open_barrier|.
-    iree_task_list_t open_tasks;
+    // Index of the current barrier scope; incremented on each barrier.
+    iree_host_size_t scope_index;
 
     // A flattened list of all available descriptor set bindings.
     // As descriptor sets are pushed/bound the bindings will be updated to
@@ -88,6 +158,10 @@ typedef struct {
     iree_device_size_t
         binding_lengths[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
                         IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
+    // Buffer ranges referenced by each binding used to build the DAG.
+    iree_hal_task_access_t
+        binding_accesses[IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT *
+                         IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT];
 
     // All available push constants updated each time push_constants is called.
     // Reset only with the command buffer and otherwise will maintain its values
@@ -114,18 +188,10 @@ iree_status_t iree_hal_task_command_buffer_create(
   IREE_ASSERT_ARGUMENT(device);
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
-  if (mode != IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
+  if (iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+                                  IREE_HAL_COMMAND_BUFFER_MODE_REUSABLE)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "one-shot and reusable modes are exclusive");
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -143,7 +209,9 @@ iree_status_t iree_hal_task_command_buffer_create(
     command_buffer->allowed_categories = command_categories;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
-    iree_task_list_initialize(&command_buffer->leaf_tasks);
+    command_buffer->leaf_task_count = 0;
+    command_buffer->leaf_tasks = NULL;
+    memset(&command_buffer->replay, 0, sizeof(command_buffer->replay));
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
     *out_command_buffer = (iree_hal_command_buffer_t*)command_buffer;
   }
@@ -155,7 +223,9 @@ iree_status_t iree_hal_task_command_buffer_create(
 static void iree_hal_task_command_buffer_reset(
     iree_hal_task_command_buffer_t* command_buffer) {
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
-  iree_task_list_discard(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
+  memset(&command_buffer->replay, 0, sizeof(command_buffer->replay));
   iree_task_list_discard(&command_buffer->root_tasks);
   iree_arena_reset(&command_buffer->arena);
 }
@@ -186,7 +256,7 @@ iree_hal_task_command_buffer_allowed_categories(
 // iree_hal_task_command_buffer_t recording
 //===----------------------------------------------------------------------===//
 
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
+static iree_status_t iree_hal_task_command_buffer_build_dag(
     iree_hal_task_command_buffer_t* command_buffer);
 
 static iree_status_t iree_hal_task_command_buffer_begin(
@@ -201,134 +271,225 @@ static iree_status_t iree_hal_task_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
+  return iree_hal_task_command_buffer_build_dag(command_buffer);
+}
 
-  // Flush any open barriers.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
+// Initializes |out_access| to the range of the allocated buffer referenced by
+// |buffer| at |offset| with |length| (which may be IREE_WHOLE_BUFFER).
+static void iree_hal_task_access_initialize(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_device_size_t length, iree_hal_memory_access_t access,
+    iree_hal_task_access_t* out_access) {
+  if (length == IREE_WHOLE_BUFFER) {
+    iree_device_size_t byte_length = iree_hal_buffer_byte_length(buffer);
+    length = offset < byte_length ? byte_length - offset : 0;
   }
+  out_access->buffer = iree_hal_buffer_allocated_buffer(buffer);
+  out_access->offset = iree_hal_buffer_byte_offset(buffer) + offset;
+  out_access->length = length;
+  // Unspecified access is treated as read-write as we can't know otherwise.
+  if (!(access &
+        (IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE))) {
+    access = IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE;
+  }
+  out_access->access = access;
+  out_access->superseded = false;
+}
 
-  return iree_ok_status();
+// Returns true if |lhs| and |rhs| overlap and at least one of them writes.
+static bool iree_hal_task_access_conflicts(const iree_hal_task_access_t* lhs,
+                                           const iree_hal_task_access_t* rhs) {
+  if (lhs->buffer != rhs->buffer) return false;
+  if (!((lhs->access | rhs->access) & IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    return false;
+  }
+  return lhs->offset < rhs->offset + rhs->length &&
+         rhs->offset < lhs->offset + lhs->length;
 }
 
-// Flushes all open tasks to the previous barrier and prepares for more
-// recording. The root tasks are also populated here when required as this is
-// the one place where we can see both halves of the most recent synchronization
-// event: those tasks recorded prior (if any) and the task that marks the set of
-// tasks that will be recorded after (if any).
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
+// Returns true if |writer| overwrites the entire range of |access|.
+static bool iree_hal_task_access_covers(const iree_hal_task_access_t* writer,
+                                        const iree_hal_task_access_t* access) {
+  return (writer->access & IREE_HAL_MEMORY_ACCESS_WRITE) &&
+         writer->buffer == access->buffer && writer->offset <= access->offset &&
+         writer->offset + writer->length >= access->offset + access->length;
+}
+
+// Emits a barrier, splitting execution into all prior recorded tasks and all
+// subsequent recorded tasks. Only those subsequent tasks that have a hazard
+// with prior tasks will wait on them.
+static iree_status_t iree_hal_task_command_buffer_emit_barrier(
     iree_hal_task_command_buffer_t* command_buffer) {
-  iree_task_barrier_t* open_barrier = command_buffer->state.open_barrier;
-  if (open_barrier != NULL) {
-    // There is an open barrier we need to fixup the fork out to all of the open
-    // tasks that were recorded after it.
-    iree_task_t* task_head =
-        iree_task_list_front(&command_buffer->state.open_tasks);
-    iree_host_size_t dependent_task_count =
-        command_buffer->state.open_task_count;
-    if (dependent_task_count == 1) {
-      // Special-case: only one open task so we can avoid the additional barrier
-      // overhead by reusing the completion task.
-      iree_task_set_completion_task(&open_barrier->header, task_head);
-    } else if (dependent_task_count > 1) {
-      // Allocate the list of tasks we'll stash back on the previous barrier.
-      // Since we couldn't know at the time how many tasks would end up in the
-      // barrier we had to defer it until now.
-      iree_task_t** dependent_tasks = NULL;
-      IREE_RETURN_IF_ERROR(iree_arena_allocate(
-          &command_buffer->arena, dependent_task_count * sizeof(iree_task_t*),
-          (void**)&dependent_tasks));
-      iree_task_t* task = task_head;
-      for (iree_host_size_t i = 0; i < dependent_task_count; ++i) {
-        dependent_tasks[i] = task;
-        task = task->next_task;
+  // Barriers with nothing recorded since the last barrier are no-ops.
+  if (command_buffer->state.node_tail &&
+      command_buffer->state.node_tail->scope_index ==
+          command_buffer->state.scope_index) {
+    ++command_buffer->state.scope_index;
+  }
+  return iree_ok_status();
+}
+
+// Emits the given execution |task| into the current barrier scope. The task
+// will depend on all tasks from prior barrier scopes that have a hazard with
+// any of its |accesses|.
+//
+// NOTE: each call scans back through all nodes recorded in prior barrier
+// scopes and compares their accesses against those of |task|; recording n
+// commands is therefore O(n^2) in the worst case. Accesses that have been fully
+// overwritten are skipped without comparing against them such that in the
+// common case of chained producer->consumer dispatches the per-node cost is
+// small, but every prior node is still visited.
+static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t access_count, const iree_hal_task_access_t* accesses) {
+  iree_hal_task_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena,
+      sizeof(*node) + access_count * sizeof(node->accesses[0]),
+      (void**)&node));
+  node->next = NULL;
+  node->task = task;
+  node->scope_index = command_buffer->state.scope_index;
+  node->producer_count = 0;
+  node->consumer_count = 0;
+  node->consumers = NULL;
+  node->access_count = access_count;
+  memcpy(node->accesses, accesses, access_count * sizeof(node->accesses[0]));
+
+  // Add an edge from each prior node we have a hazard with.
+  for (iree_hal_task_node_t* producer = command_buffer->state.node_head;
+       producer != NULL; producer = producer->next) {
+    if (producer->scope_index == node->scope_index) break;
+    bool has_hazard = false;
+    for (iree_host_size_t i = 0; i < producer->access_count; ++i) {
+      iree_hal_task_access_t* producer_access = &producer->accesses[i];
+      if (producer_access->superseded) continue;
+      for (iree_host_size_t j = 0; j < node->access_count; ++j) {
+        const iree_hal_task_access_t* access = &node->accesses[j];
+        if (!iree_hal_task_access_conflicts(producer_access, access)) continue;
+        has_hazard = true;
+        if (iree_hal_task_access_covers(access, producer_access)) {
+          producer_access->superseded = true;
+        }
       }
-      iree_task_barrier_set_dependent_tasks(open_barrier, dependent_task_count,
-                                            dependent_tasks);
     }
-  }
-  command_buffer->state.open_barrier = NULL;
-
-  // Move the open tasks to the tail as they represent the first half of the
-  // *next* barrier that will be inserted.
-  if (command_buffer->state.open_task_count > 0) {
-    iree_task_list_move(&command_buffer->state.open_tasks,
-                        &command_buffer->leaf_tasks);
-    command_buffer->state.open_task_count = 0;
+    if (!has_hazard) continue;
+    iree_hal_task_edge_t* edge = NULL;
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                             sizeof(*edge), (void**)&edge));
+    edge->consumer = node;
+    edge->next = producer->consumers;
+    producer->consumers = edge;
+    ++producer->consumer_count;
+    ++node->producer_count;
   }
 
+  if (command_buffer->state.node_tail) {
+    command_buffer->state.node_tail->next = node;
+  } else {
+    command_buffer->state.node_head = node;
+  }
+  command_buffer->state.node_tail = node;
   return iree_ok_status();
 }
 
-// Emits a global barrier, splitting execution into all prior recorded tasks
-// and all subsequent recorded tasks. This is currently the critical piece that
-// limits our concurrency: changing to fine-grained barriers (via barrier
-// buffers or events) will allow more work to overlap at the cost of more brain
-// to build out the proper task graph.
-static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
+// Translates the recorded nodes and edges into task dependencies.
+// Tasks with no producers are the roots of the DAG and tasks with no consumers
+// are the leaves. Producers with a single consumer directly use it as their
+// completion task while producers with multiple consumers fork out to them via
+// a barrier task.
+static iree_status_t iree_hal_task_command_buffer_build_dag(
     iree_hal_task_command_buffer_t* command_buffer) {
-  // Flush open tasks to the previous barrier. This resets our state such that
-  // we can assign the new open barrier and start recording tasks for it.
-  // Previous tasks will be moved into the leaf_tasks list.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Allocate the new open barrier.
-  // As we are recording forward we can't yet assign the dependent tasks (the
-  // second half of the synchronization domain) and instead are just inserting
-  // it so we can setup the join from previous tasks (the first half of the
-  // synchronization domain).
-  iree_task_barrier_t* barrier = NULL;
-  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
-                                           sizeof(*barrier), (void**)&barrier));
-  iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
-
-  // If there were previous tasks then join them to the barrier.
-  for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
-       task != NULL; task = task->next_task) {
-    iree_task_set_completion_task(task, &barrier->header);
+  iree_host_size_t leaf_task_count = 0;
+  iree_host_size_t root_task_count = 0;
+  iree_host_size_t task_count = 0;
+  for (iree_hal_task_node_t* node = command_buffer->state.node_head;
+       node != NULL; node = node->next) {
+    if (node->consumer_count == 0) ++leaf_task_count;
+    if (node->producer_count == 0) ++root_task_count;
+    // Nodes with multiple consumers have an additional barrier task.
+    task_count += node->consumer_count > 1 ? 2 : 1;
   }
-
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
+  iree_task_t** leaf_tasks = NULL;
+  if (leaf_task_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, leaf_task_count * sizeof(iree_task_t*),
+        (void**)&leaf_tasks));
+  }
+  const bool reusable = !iree_all_bits_set(
+      command_buffer->mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+  iree_task_t** root_tasks = NULL;
+  iree_hal_task_rearm_t* rearm_tasks = NULL;
+  if (reusable && task_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, root_task_count * sizeof(iree_task_t*),
+        (void**)&root_tasks));
+    IREE_RETURN_IF_ERROR(iree_arena_allocate(
+        &command_buffer->arena, task_count * sizeof(iree_hal_task_rearm_t),
+        (void**)&rearm_tasks));
   }
 
-  // Reset the tail of the command buffer to the barrier. This leaves us in a
-  // consistent state if the recording ends immediate after this (the barrier
-  // will be the last task).
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
-  iree_task_list_push_back(&command_buffer->leaf_tasks, &barrier->header);
-
-  // NOTE: all new tasks emitted will be executed after this barrier.
-  command_buffer->state.open_barrier = barrier;
-  command_buffer->state.open_task_count = 0;
+  iree_host_size_t leaf_index = 0;
+  iree_host_size_t rearm_index = 0;
+  for (iree_hal_task_node_t* node = command_buffer->state.node_head;
+       node != NULL; node = node->next) {
+    if (rearm_tasks) rearm_tasks[rearm_index++].task = node->task;
+    if (node->consumer_count == 0) {
+      leaf_tasks[leaf_index++] = node->task;
+    } else if (node->consumer_count == 1) {
+      iree_task_set_completion_task(node->task,
+                                    node->consumers->consumer->task);
+    } else {
+      iree_task_barrier_t* barrier = NULL;
+      iree_task_t** dependent_tasks = NULL;
+      IREE_RETURN_IF_ERROR(iree_arena_allocate(
+          &command_buffer->arena, sizeof(*barrier), (void**)&barrier));
+      IREE_RETURN_IF_ERROR(iree_arena_allocate(
+          &command_buffer->arena, node->consumer_count * sizeof(iree_task_t*),
+          (void**)&dependent_tasks));
+      iree_host_size_t dependent_index = 0;
+      for (iree_hal_task_edge_t* edge = node->consumers; edge != NULL;
+           edge = edge->next) {
+        dependent_tasks[dependent_index++] = edge->consumer->task;
+      }
+      iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+      iree_task_barrier_set_dependent_tasks(barrier, node->consumer_count,
+                                            dependent_tasks);
+      iree_task_set_completion_task(node->task, &barrier->header);
+      if (rearm_tasks) rearm_tasks[rearm_index++].task = &barrier->header;
+    }
+  }
 
-  return iree_ok_status();
-}
+  // Snapshot the fully-wired dependency state for re-arming on replay.
+  for (iree_host_size_t i = 0; i < rearm_index; ++i) {
+    iree_hal_task_rearm_t* rearm_task = &rearm_tasks[i];
+    rearm_task->completion_task = rearm_task->task->completion_task;
+    rearm_task->pending_dependency_count = iree_atomic_load_int32(
+        &rearm_task->task->pending_dependency_count, iree_memory_order_relaxed);
+    rearm_task->flags = rearm_task->task->flags;
+  }
 
-// Emits a the given execution |task| into the current open synchronization
-// scope (after state.open_barrier and before the next barrier).
-static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
-    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
-  if (command_buffer->state.open_barrier == NULL) {
-    // If there is no open barrier then we are at the head and going right into
-    // the task DAG.
-    iree_task_list_push_back(&command_buffer->leaf_tasks, task);
-  } else {
-    // Append to the open task list that will be flushed to the open barrier.
-    iree_task_list_push_back(&command_buffer->state.open_tasks, task);
-    ++command_buffer->state.open_task_count;
+  // Roots are added after all edges have been set so that a failure above
+  // doesn't leave partially-wired tasks in the list we'd then discard.
+  iree_host_size_t root_index = 0;
+  for (iree_hal_task_node_t* node = command_buffer->state.node_head;
+       node != NULL; node = node->next) {
+    if (node->producer_count != 0) continue;
+    if (root_tasks) {
+      root_tasks[root_index++] = node->task;
+    } else {
+      iree_task_list_push_back(&command_buffer->root_tasks, node->task);
+    }
   }
+  command_buffer->leaf_task_count = leaf_task_count;
+  command_buffer->leaf_tasks = leaf_tasks;
+  command_buffer->replay.root_task_count = root_index;
+  command_buffer->replay.root_tasks = root_tasks;
+  command_buffer->replay.task_count = rearm_index;
+  command_buffer->replay.tasks = rearm_tasks;
+
+  command_buffer->state.node_head = NULL;
+  command_buffer->state.node_tail = NULL;
   return iree_ok_status();
 }
 
@@ -336,6 +497,41 @@ static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Restores the dependency state of all tasks in a reusable command buffer to
+// what it was when recording ended and enqueues the roots for execution.
+// Requires that any prior execution of the command buffer has completed.
+static void iree_hal_task_command_buffer_replay(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* retire_task,
+    iree_task_submission_t* pending_submission) {
+  for (iree_host_size_t i = 0; i < command_buffer->replay.task_count; ++i) {
+    const iree_hal_task_rearm_t* rearm_task = &command_buffer->replay.tasks[i];
+    iree_task_t* task = rearm_task->task;
+    task->next_task = NULL;
+    task->completion_task = rearm_task->completion_task;
+    iree_atomic_store_int32(&task->pending_dependency_count,
+                            rearm_task->pending_dependency_count,
+                            iree_memory_order_relaxed);
+    task->flags = rearm_task->flags;
+    if (task->type == IREE_TASK_TYPE_DISPATCH) {
+      // Statistics are merged into the scope when the dispatch retires.
+      iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+      memset(&dispatch_task->statistics, 0, sizeof(dispatch_task->statistics));
+    }
+  }
+
+  for (iree_host_size_t i = 0; i < command_buffer->leaf_task_count; ++i) {
+    iree_task_set_completion_task(command_buffer->leaf_tasks[i], retire_task);
+  }
+
+  iree_task_list_t root_tasks;
+  iree_task_list_initialize(&root_tasks);
+  for (iree_host_size_t i = 0; i < command_buffer->replay.root_task_count;
+       ++i) {
+    iree_task_list_push_back(&root_tasks, command_buffer->replay.root_tasks[i]);
+  }
+  iree_task_submission_enqueue_list(pending_submission, &root_tasks);
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
@@ -343,27 +539,29 @@ iree_status_t iree_hal_task_command_buffer_issue(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
+  if (command_buffer->replay.tasks) {
+    int32_t expected = 0;
+    if (!iree_atomic_compare_exchange_strong_int32(
+            &command_buffer->replay.in_flight, &expected, 1,
+            iree_memory_order_acq_rel, iree_memory_order_acquire)) {
+      return iree_make_status(
+          IREE_STATUS_FAILED_PRECONDITION,
+          "reusable command buffer issued while a prior issue is in-flight");
+    }
+    iree_hal_task_command_buffer_replay(command_buffer, retire_task,
+                                        pending_submission);
+    return iree_ok_status();
+  }
+
   // If the command buffer is empty (valid!) then we are a no-op.
-  bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
-  if (!has_root_tasks) {
+  if (iree_task_list_is_empty(&command_buffer->root_tasks)) {
     return iree_ok_status();
   }
 
-  bool has_leaf_tasks = !iree_task_list_is_empty(&command_buffer->leaf_tasks);
-  if (has_leaf_tasks) {
-    // Chain the retire task onto the leaf tasks as their completion indicates
-    // that all commands have completed.
-    for (iree_task_t* task = command_buffer->leaf_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
-  } else {
-    // If we have no leaf tasks it means that this is a single layer DAG and
-    // after the root tasks complete the entire command buffer has completed.
-    for (iree_task_t* task = command_buffer->root_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
+  // Chain the retire task onto the leaf tasks as their completion indicates
+  // that all commands have completed.
+  for (iree_host_size_t i = 0; i < command_buffer->leaf_task_count; ++i) {
+    iree_task_set_completion_task(command_buffer->leaf_tasks[i], retire_task);
   }
 
   // Enqueue all root tasks that are ready to run immediately.
@@ -371,11 +569,20 @@ iree_status_t iree_hal_task_command_buffer_issue(
   // we need to ensure the command buffer doesn't try to discard them.
   iree_task_submission_enqueue_list(pending_submission,
                                     &command_buffer->root_tasks);
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
 
   return iree_ok_status();
 }
 
+void iree_hal_task_command_buffer_retire(
+    iree_hal_command_buffer_t* base_command_buffer) {
+  iree_hal_task_command_buffer_t* command_buffer =
+      iree_hal_task_command_buffer_cast(base_command_buffer);
+  iree_atomic_store_int32(&command_buffer->replay.in_flight, 0,
+                          iree_memory_order_release);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_command_buffer_execution_barrier
 //===----------------------------------------------------------------------===//
@@ -391,9 +598,9 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // TODO(benvanik): actual DAG construction. Right now we are just doing simple
-  // global barriers each time and forcing a join-fork point.
-  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+  // NOTE: memory and buffer barriers are treated the same: tasks recorded after
+  // the barrier wait only on the prior tasks they have a hazard with.
+  return iree_hal_task_command_buffer_emit_barrier(command_buffer);
 }
 
 //===----------------------------------------------------------------------===//
@@ -403,7 +610,8 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
 static iree_status_t iree_hal_task_command_buffer_signal_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  // TODO(#4518): implement events. For now waits are treated as barriers so
+  // there's nothing to track at the signal/reset site.
   return iree_ok_status();
 }
 
@@ -414,7 +622,8 @@ static iree_status_t iree_hal_task_command_buffer_signal_event(
 static iree_status_t iree_hal_task_command_buffer_reset_event(
     iree_hal_command_buffer_t* base_command_buffer, iree_hal_event_t* event,
     iree_hal_execution_stage_t source_stage_mask) {
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  // TODO(#4518): implement events. For now waits are treated as barriers so
+  // there's nothing to track at the signal/reset site.
   return iree_ok_status();
 }
 
@@ -433,8 +642,9 @@ static iree_status_t iree_hal_task_command_buffer_wait_events(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  // TODO(#4518): implement events. For now we just insert global barriers.
-  return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
+  // TODO(#4518): implement events. For now we just insert barriers; as they
+  // only order tasks with hazards this is usually as good as an event would be.
+  return iree_hal_task_command_buffer_emit_barrier(command_buffer);
 }
 
 //===----------------------------------------------------------------------===//
@@ -446,15 +656,134 @@ static iree_status_t iree_hal_task_command_buffer_discard_buffer(
   return iree_ok_status();
 }
 
+//===----------------------------------------------------------------------===//
+// Tiled transfers
+//===----------------------------------------------------------------------===//
+// Large fill/update/copy commands are issued as dispatch grids with one tile
+// per IREE_HAL_TASK_TRANSFER_TILE_LENGTH bytes so that they are spread across
+// all workers instead of being memset/memcpy'd by a single one. Smaller
+// transfers don't make up for the dispatch overhead (and the extra worker
+// wakes) and are issued as single calls.
+
+// Transfers of at least this many bytes are split into tiles.
+#if !defined(IREE_HAL_TASK_TRANSFER_TILING_THRESHOLD)
+#define IREE_HAL_TASK_TRANSFER_TILING_THRESHOLD (1 * 1024 * 1024)
+#endif  // !IREE_HAL_TASK_TRANSFER_TILING_THRESHOLD
+
+// Length in bytes of each tile of a tiled transfer. Must be a power of two so
+// that tile boundaries remain aligned to any fill pattern.
+#if !defined(IREE_HAL_TASK_TRANSFER_TILE_LENGTH)
+#define IREE_HAL_TASK_TRANSFER_TILE_LENGTH (256 * 1024)
+#endif  // !IREE_HAL_TASK_TRANSFER_TILE_LENGTH
+
+// Tiled copies of at least this many bytes use non-temporal stores. Copies this
+// large overflow the last level cache and caching the target would only evict
+// the working set of the workers (and anything else sharing the cache) for
+// data that won't be read back soon. Smaller copies are better off cached.
+#if !defined(IREE_HAL_TASK_TRANSFER_STREAMING_THRESHOLD)
+#define IREE_HAL_TASK_TRANSFER_STREAMING_THRESHOLD (32 * 1024 * 1024)
+#endif  // !IREE_HAL_TASK_TRANSFER_STREAMING_THRESHOLD
+
+// Task storage for a transfer command that may be issued either way.
+typedef union {
+  iree_task_t header;
+  iree_task_call_t call;
+  iree_task_dispatch_t dispatch;
+} iree_hal_task_transfer_task_t;
+
+// Resolves a transfer |length| of IREE_WHOLE_BUFFER to the remaining bytes in
+// |buffer| after |offset|. Invalid ranges are returned unmodified so that they
+// fail validation during execution just as they would if issued directly.
+static iree_device_size_t iree_hal_task_transfer_resolve_length(
+    iree_hal_buffer_t* buffer, iree_device_size_t offset,
+    iree_device_size_t length) {
+  if (length != IREE_WHOLE_BUFFER) return length;
+  iree_device_size_t byte_length = iree_hal_buffer_byte_length(buffer);
+  return offset <= byte_length ? byte_length - offset : length;
+}
+
+// Initializes |out_task| to perform a transfer of |length| bytes. Small
+// transfers call |call_fn| once and large ones call |tile_fn| once per tile.
+// Both receive |user_context|.
+static void iree_hal_task_command_buffer_initialize_transfer(
+    iree_hal_task_command_buffer_t* command_buffer, iree_device_size_t length,
+    iree_task_call_closure_fn_t call_fn,
+    iree_task_dispatch_closure_fn_t tile_fn, uintptr_t user_context,
+    iree_hal_task_transfer_task_t* out_task) {
+  if (length == IREE_WHOLE_BUFFER ||
+      length < IREE_HAL_TASK_TRANSFER_TILING_THRESHOLD) {
+    iree_task_call_initialize(
+        command_buffer->scope,
+        iree_task_make_call_closure(call_fn, user_context), &out_task->call);
+    return;
+  }
+  uint32_t workgroup_count[3] = {
+      (uint32_t)((length + IREE_HAL_TASK_TRANSFER_TILE_LENGTH - 1) /
+                 IREE_HAL_TASK_TRANSFER_TILE_LENGTH),
+      1,
+      1,
+  };
+  uint32_t workgroup_size[3] = {1, 1, 1};
+  iree_task_dispatch_initialize(
+      command_buffer->scope,
+      iree_task_make_dispatch_closure(tile_fn, user_context), workgroup_size,
+      workgroup_count, &out_task->dispatch);
+}
+
+// Returns the byte offset of the tile processed by |tile_context| within a
+// transfer of |length| bytes and its length in |out_tile_length|.
+static iree_device_size_t iree_hal_task_transfer_tile_range(
+    const iree_task_tile_context_t* tile_context, iree_device_size_t length,
+    iree_device_size_t* out_tile_length) {
+  iree_device_size_t tile_offset =
+      (iree_device_size_t)tile_context->workgroup_xyz[0] *
+      IREE_HAL_TASK_TRANSFER_TILE_LENGTH;
+  *out_tile_length = iree_min(
+      (iree_device_size_t)IREE_HAL_TASK_TRANSFER_TILE_LENGTH,
+      length - tile_offset);
+  return tile_offset;
+}
+
+// Copies |length| bytes from |source| to |target| using non-temporal stores
+// where available. See IREE_HAL_TASK_TRANSFER_STREAMING_THRESHOLD.
+static void iree_hal_task_transfer_copy_streaming(
+    void* IREE_RESTRICT target, const void* IREE_RESTRICT source,
+    iree_host_size_t length) {
+#if defined(IREE_ARCH_X86_64)
+  uint8_t* target_ptr = (uint8_t*)target;
+  const uint8_t* source_ptr = (const uint8_t*)source;
+  // Stream stores must be 16-byte aligned; the source may be unaligned.
+  iree_host_size_t head_length =
+      iree_min((16 - ((uintptr_t)target_ptr & 15)) & 15, length);
+  memcpy(target_ptr, source_ptr, head_length);
+  target_ptr += head_length;
+  source_ptr += head_length;
+  length -= head_length;
+  for (; length >= 64; length -= 64, target_ptr += 64, source_ptr += 64) {
+    __m128i v0 = _mm_loadu_si128((const __m128i*)(source_ptr + 0));
+    __m128i v1 = _mm_loadu_si128((const __m128i*)(source_ptr + 16));
+    __m128i v2 = _mm_loadu_si128((const __m128i*)(source_ptr + 32));
+    __m128i v3 = _mm_loadu_si128((const __m128i*)(source_ptr + 48));
+    _mm_stream_si128((__m128i*)(target_ptr + 0), v0);
+    _mm_stream_si128((__m128i*)(target_ptr + 16), v1);
+    _mm_stream_si128((__m128i*)(target_ptr + 32), v2);
+    _mm_stream_si128((__m128i*)(target_ptr + 48), v3);
+  }
+  memcpy(target_ptr, source_ptr, length);
+  // Non-temporal stores are weakly ordered; fence so that they are visible to
+  // whichever worker observes the completion of this tile.
+  _mm_sfence();
+#else
+  memcpy(target, source, length);
+#endif  // IREE_ARCH_X86_64
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_command_buffer_fill_buffer
 //===----------------------------------------------------------------------===//
-// NOTE: for large fills we could dispatch this as tiles for parallelism.
-// We'd want to do some measurement for when it's worth it; filling a 200KB
-// buffer: maybe not, filling a 200MB buffer: yeah.
 
 typedef struct {
-  iree_task_call_t task;
+  iree_hal_task_transfer_task_t task;
   iree_hal_buffer_t* target_buffer;
   iree_device_size_t target_offset;
   iree_device_size_t length;
@@ -475,6 +804,22 @@ static iree_status_t iree_hal_cmd_fill_buffer(
   return status;
 }
 
+static iree_status_t iree_hal_cmd_fill_buffer_tile(
+    uintptr_t user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_cmd_fill_buffer_t* cmd =
+      (const iree_hal_cmd_fill_buffer_t*)user_context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_device_size_t tile_length = 0;
+  iree_device_size_t tile_offset = iree_hal_task_transfer_tile_range(
+      tile_context, cmd->length, &tile_length);
+  iree_status_t status = iree_hal_buffer_fill(
+      cmd->target_buffer, cmd->target_offset + tile_offset, tile_length,
+      cmd->pattern, cmd->pattern_length);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_task_command_buffer_fill_buffer(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
@@ -487,18 +832,22 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   IREE_RETURN_IF_ERROR(
       iree_arena_allocate(&command_buffer->arena, sizeof(*cmd), (void**)&cmd));
 
-  iree_task_call_initialize(
-      command_buffer->scope,
-      iree_task_make_call_closure(iree_hal_cmd_fill_buffer, (uintptr_t)cmd),
-      &cmd->task);
+  length = iree_hal_task_transfer_resolve_length(target_buffer, target_offset,
+                                                 length);
+  iree_hal_task_command_buffer_initialize_transfer(
+      command_buffer, length, iree_hal_cmd_fill_buffer,
+      iree_hal_cmd_fill_buffer_tile, (uintptr_t)cmd, &cmd->task);
   cmd->target_buffer = target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_access_t access;
+  iree_hal_task_access_initialize(target_buffer, target_offset, length,
+                                  IREE_HAL_MEMORY_ACCESS_WRITE, &access);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, 1, &access);
 }
 
 //===----------------------------------------------------------------------===//
@@ -506,7 +855,7 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
 //===----------------------------------------------------------------------===//
 
 typedef struct {
-  iree_task_call_t task;
+  iree_hal_task_transfer_task_t task;
   iree_hal_buffer_t* target_buffer;
   iree_device_size_t target_offset;
   iree_device_size_t length;
@@ -525,6 +874,22 @@ static iree_status_t iree_hal_cmd_update_buffer(
   return status;
 }
 
+static iree_status_t iree_hal_cmd_update_buffer_tile(
+    uintptr_t user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_cmd_update_buffer_t* cmd =
+      (const iree_hal_cmd_update_buffer_t*)user_context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_device_size_t tile_length = 0;
+  iree_device_size_t tile_offset = iree_hal_task_transfer_tile_range(
+      tile_context, cmd->length, &tile_length);
+  iree_status_t status = iree_hal_buffer_write_data(
+      cmd->target_buffer, cmd->target_offset + tile_offset,
+      cmd->source_buffer + tile_offset, tile_length);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_task_command_buffer_update_buffer(
     iree_hal_command_buffer_t* base_command_buffer, const void* source_buffer,
     iree_host_size_t source_offset, iree_hal_buffer_t* target_buffer,
@@ -539,10 +904,9 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
                                            total_cmd_size, (void**)&cmd));
 
-  iree_task_call_initialize(
-      command_buffer->scope,
-      iree_task_make_call_closure(iree_hal_cmd_update_buffer, (uintptr_t)cmd),
-      &cmd->task);
+  iree_hal_task_command_buffer_initialize_transfer(
+      command_buffer, length, iree_hal_cmd_update_buffer,
+      iree_hal_cmd_update_buffer_tile, (uintptr_t)cmd, &cmd->task);
   cmd->target_buffer = (iree_hal_buffer_t*)target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
@@ -550,19 +914,19 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->length);
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_access_t access;
+  iree_hal_task_access_initialize(target_buffer, target_offset, length,
+                                  IREE_HAL_MEMORY_ACCESS_WRITE, &access);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, 1, &access);
 }
 
 //===----------------------------------------------------------------------===//
 // iree_hal_command_buffer_copy_buffer
 //===----------------------------------------------------------------------===//
-// NOTE: for large copies we could dispatch this as tiles for parallelism.
-// We'd want to do some measurement for when it's worth it; copying a 200KB
-// buffer: maybe not, copying a 200MB buffer: yeah.
 
 typedef struct {
-  iree_task_call_t task;
+  iree_hal_task_transfer_task_t task;
   iree_hal_buffer_t* source_buffer;
   iree_device_size_t source_offset;
   iree_hal_buffer_t* target_buffer;
@@ -583,6 +947,46 @@ static iree_status_t iree_hal_cmd_copy_buffer(
   return status;
 }
 
+static iree_status_t iree_hal_cmd_copy_buffer_tile(
+    uintptr_t user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  const iree_hal_cmd_copy_buffer_t* cmd =
+      (const iree_hal_cmd_copy_buffer_t*)user_context;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_device_size_t tile_length = 0;
+  iree_device_size_t tile_offset = iree_hal_task_transfer_tile_range(
+      tile_context, cmd->length, &tile_length);
+
+  iree_hal_buffer_mapping_t source_mapping;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_buffer_map_range(
+              cmd->source_buffer, IREE_HAL_MEMORY_ACCESS_READ,
+              cmd->source_offset + tile_offset, tile_length, &source_mapping));
+  iree_hal_buffer_mapping_t target_mapping;
+  iree_status_t status = iree_hal_buffer_map_range(
+      cmd->target_buffer, IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE,
+      cmd->target_offset + tile_offset, tile_length, &target_mapping);
+  if (iree_status_is_ok(status)) {
+    if (cmd->length >= IREE_HAL_TASK_TRANSFER_STREAMING_THRESHOLD) {
+      iree_hal_task_transfer_copy_streaming(target_mapping.contents.data,
+                                            source_mapping.contents.data,
+                                            (iree_host_size_t)tile_length);
+    } else {
+      memcpy(target_mapping.contents.data, source_mapping.contents.data,
+             (iree_host_size_t)tile_length);
+    }
+    if (!iree_all_bits_set(iree_hal_buffer_memory_type(cmd->target_buffer),
+                           IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+      status = iree_hal_buffer_flush_range(&target_mapping, 0, tile_length);
+    }
+    iree_hal_buffer_unmap_range(&target_mapping);
+  }
+  iree_hal_buffer_unmap_range(&source_mapping);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_task_command_buffer_copy_buffer(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
@@ -591,22 +995,43 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
+  length = iree_min(
+      iree_hal_task_transfer_resolve_length(source_buffer, source_offset,
+                                            length),
+      iree_hal_task_transfer_resolve_length(target_buffer, target_offset,
+                                            length));
+
+  // Tiles of a copy run concurrently and in any order so unlike a single
+  // memcpy an overlapping copy would not even be deterministic; reject it here
+  // instead of when executing.
+  if (iree_hal_buffer_test_overlap(source_buffer, source_offset, length,
+                                   target_buffer, target_offset, length) !=
+      IREE_HAL_BUFFER_OVERLAP_DISJOINT) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "source and target ranges must not overlap within the same buffer");
+  }
+
   iree_hal_cmd_copy_buffer_t* cmd = NULL;
   IREE_RETURN_IF_ERROR(
       iree_arena_allocate(&command_buffer->arena, sizeof(*cmd), (void**)&cmd));
 
-  iree_task_call_initialize(
-      command_buffer->scope,
-      iree_task_make_call_closure(iree_hal_cmd_copy_buffer, (uintptr_t)cmd),
-      &cmd->task);
+  iree_hal_task_command_buffer_initialize_transfer(
+      command_buffer, length, iree_hal_cmd_copy_buffer,
+      iree_hal_cmd_copy_buffer_tile, (uintptr_t)cmd, &cmd->task);
   cmd->source_buffer = (iree_hal_buffer_t*)source_buffer;
   cmd->source_offset = source_offset;
   cmd->target_buffer = (iree_hal_buffer_t*)target_buffer;
   cmd->target_offset = target_offset;
   cmd->length = length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_access_t accesses[2];
+  iree_hal_task_access_initialize(source_buffer, source_offset, length,
+                                  IREE_HAL_MEMORY_ACCESS_READ, &accesses[0]);
+  iree_hal_task_access_initialize(target_buffer, target_offset, length,
+                                  IREE_HAL_MEMORY_ACCESS_WRITE, &accesses[1]);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, IREE_ARRAYSIZE(accesses), accesses);
 }
 
 //===----------------------------------------------------------------------===//
@@ -647,36 +1072,51 @@ static iree_status_t iree_hal_task_command_buffer_push_descriptor_set(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  if (IREE_UNLIKELY(set >= IREE_HAL_LOCAL_MAX_DESCRIPTOR_SET_COUNT)) {
-    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "set %u out of bounds", set);
-  }
-
   iree_hal_local_executable_layout_t* local_executable_layout =
       iree_hal_local_executable_layout_cast(executable_layout);
+  if (IREE_UNLIKELY(set >= local_executable_layout->set_layout_count)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "set %u out of bounds (layout has %zu sets)", set,
+                            local_executable_layout->set_layout_count);
+  }
   iree_hal_local_descriptor_set_layout_t* local_set_layout =
       iree_hal_local_descriptor_set_layout_cast(
           local_executable_layout->set_layouts[set]);
 
+  // Bindings are stored in the flat state table by their index in the set
+  // layout as that is how the executable layout assigns its used bindings.
+  // Binding numbers may be sparse and in any order so they are looked up.
   iree_host_size_t binding_base =
       set * IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT;
   for (iree_host_size_t i = 0; i < binding_count; ++i) {
-    if (IREE_UNLIKELY(bindings[i].binding >=
-                      IREE_HAL_LOCAL_MAX_DESCRIPTOR_BINDING_COUNT)) {
+    iree_host_size_t layout_index = 0;
+    while (layout_index < local_set_layout->binding_count &&
+           local_set_layout->bindings[layout_index].binding !=
+               bindings[i].binding) {
+      ++layout_index;
+    }
+    if (IREE_UNLIKELY(layout_index == local_set_layout->binding_count)) {
       return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                              "buffer binding index out of bounds");
+                              "set %u has no binding %u", set,
+                              bindings[i].binding);
     }
-    iree_host_size_t binding_ordinal = binding_base + bindings[i].binding;
+    const iree_hal_descriptor_set_layout_binding_t* layout_binding =
+        &local_set_layout->bindings[layout_index];
+    iree_host_size_t binding_ordinal = binding_base + layout_index;
 
     // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
     iree_hal_buffer_mapping_t buffer_mapping;
     IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
-        bindings[i].buffer, local_set_layout->bindings[binding_ordinal].access,
-        bindings[i].offset, bindings[i].length, &buffer_mapping));
+        bindings[i].buffer, layout_binding->access, bindings[i].offset,
+        bindings[i].length, &buffer_mapping));
     command_buffer->state.bindings[binding_ordinal] =
         buffer_mapping.contents.data;
     command_buffer->state.binding_lengths[binding_ordinal] =
         buffer_mapping.contents.data_length;
+    iree_hal_task_access_initialize(
+        bindings[i].buffer, bindings[i].offset,
+        buffer_mapping.contents.data_length, layout_binding->access,
+        &command_buffer->state.binding_accesses[binding_ordinal]);
   }
 
   return iree_ok_status();
@@ -744,6 +1184,7 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_executable_t* executable, int32_t entry_point,
     uint32_t workgroup_x, uint32_t workgroup_y, uint32_t workgroup_z,
+    const iree_hal_task_access_t* workgroups_access,
     iree_hal_cmd_dispatch_t** out_cmd) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
@@ -776,6 +1217,14 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
                                     iree_hal_cmd_dispatch_tile, (uintptr_t)cmd),
                                 workgroup_size, workgroup_count, &cmd->task);
 
+  // Have the executor measure the tile cost of the entry point so that future
+  // dispatches of it (from this or any other command buffer) are sliced based
+  // on how expensive its tiles are. The key uses the executable id rather than
+  // its address so that a new executable allocated where a released one lived
+  // does not inherit its measurements.
+  cmd->task.timing_key = ((uint64_t)local_executable->executable_id << 32) |
+                         (uint32_t)(entry_point + 1);
+
   // Copy only the push constant range used by the executable.
   uint8_t* cmd_ptr = (uint8_t*)cmd + sizeof(*cmd);
   cmd->push_constants = (uint32_t*)cmd_ptr;
@@ -795,6 +1244,8 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
   cmd_ptr += used_binding_count * sizeof(*cmd->bindings);
   cmd->binding_lengths = (iree_device_size_t*)cmd_ptr;
   cmd_ptr += used_binding_count * sizeof(*cmd->binding_lengths);
+  iree_hal_task_access_t accesses[IREE_HAL_LOCAL_BINDING_MASK_BITS + 1];
+  iree_host_size_t access_count = 0;
   iree_host_size_t binding_base = 0;
   for (iree_host_size_t i = 0; i < used_binding_count; ++i) {
     int mask_offset = iree_math_count_trailing_zeros_u64(used_binding_mask);
@@ -808,11 +1259,16 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
       return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                               "(flat) binding %d is NULL", binding_ordinal);
     }
+    accesses[access_count++] =
+        command_buffer->state.binding_accesses[binding_ordinal];
+  }
+  if (workgroups_access) {
+    accesses[access_count++] = *workgroups_access;
   }
 
   *out_cmd = cmd;
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  return iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, access_count, accesses);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch(
@@ -822,7 +1278,7 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
   iree_hal_cmd_dispatch_t* cmd = NULL;
   return iree_hal_task_command_buffer_build_dispatch(
       base_command_buffer, executable, entry_point, workgroup_x, workgroup_y,
-      workgroup_z, &cmd);
+      workgroup_z, /*workgroups_access=*/NULL, &cmd);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
@@ -836,9 +1292,16 @@ static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
       workgroups_buffer, IREE_HAL_MEMORY_ACCESS_READ, workgroups_offset,
       3 * sizeof(uint32_t), &buffer_mapping));
 
+  iree_hal_task_access_t workgroups_access;
+  iree_hal_task_access_initialize(workgroups_buffer, workgroups_offset,
+                                  3 * sizeof(uint32_t),
+                                  IREE_HAL_MEMORY_ACCESS_READ,
+                                  &workgroups_access);
+
   iree_hal_cmd_dispatch_t* cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_build_dispatch(
-      base_command_buffer, executable, entry_point, 0, 0, 0, &cmd));
+      base_command_buffer, executable, entry_point, 0, 0, 0, &workgroups_access,
+      &cmd));
   cmd->task.workgroup_count.ptr = (const uint32_t*)buffer_mapping.contents.data;
   cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_INDIRECT;
   return iree_ok_status();
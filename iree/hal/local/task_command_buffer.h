@@ -48,11 +48,23 @@ iree_status_t iree_hal_task_command_buffer_create(
 //
 // |pending_submission| will receive the ready list of commands and must be
 // submitted to the executor (or discarded on failure) by the caller.
+//
+// One-shot command buffers transfer their tasks to the submission and may only
+// be issued once. Reusable command buffers re-arm their tasks on each issue and
+// may be issued again only after iree_hal_task_command_buffer_retire has been
+// called for the prior issue; issuing while in-flight fails with
+// IREE_STATUS_FAILED_PRECONDITION.
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* command_buffer,
     iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
     iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission);
 
+// Marks a successful iree_hal_task_command_buffer_issue as retired once all of
+// the issued commands have completed, allowing reusable command buffers to be
+// issued again.
+void iree_hal_task_command_buffer_retire(
+    iree_hal_command_buffer_t* command_buffer);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
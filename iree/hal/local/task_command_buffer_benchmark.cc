@@ -0,0 +1,252 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/logging.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/task_device.h"
+#include "iree/task/executor.h"
+#include "iree/task/topology.h"
+
+namespace {
+
+//==============================================================================
+// Transfer throughput
+//==============================================================================
+// Compares large fill/copy transfers issued through task command buffers (which
+// tile them across all workers) against the equivalent single synchronous call
+// on the benchmark thread. Small transfers are included to show the overhead of
+// submission when transfers are below the tiling threshold.
+
+// Device and pair of buffers shared by all iterations of a benchmark.
+class TransferContext {
+ public:
+  explicit TransferContext(iree_device_size_t buffer_size) {
+    iree_allocator_t allocator = iree_allocator_system();
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(
+        std::min<iree_host_size_t>(std::thread::hardware_concurrency(),
+                                   IREE_TASK_EXECUTOR_MAX_WORKER_COUNT),
+        &topology);
+    iree_task_executor_t* executor = NULL;
+    IREE_CHECK_OK(iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
+                                            &topology, allocator, &executor));
+    iree_task_topology_deinitialize(&topology);
+
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    IREE_CHECK_OK(iree_hal_task_device_create(
+        iree_make_cstring_view("task"), &params, executor,
+        /*loader_count=*/0, /*loaders=*/NULL, allocator, &device_));
+    iree_task_executor_release(executor);
+
+    iree_hal_allocator_t* device_allocator = iree_hal_device_allocator(device_);
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator,
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+        IREE_HAL_BUFFER_USAGE_ALL, buffer_size, &source_buffer_));
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator,
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+        IREE_HAL_BUFFER_USAGE_ALL, buffer_size, &target_buffer_));
+    uint8_t pattern = 0xCD;
+    IREE_CHECK_OK(iree_hal_buffer_fill(source_buffer_, 0, IREE_WHOLE_BUFFER,
+                                       &pattern, sizeof(pattern)));
+
+    IREE_CHECK_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_));
+  }
+
+  ~TransferContext() {
+    iree_hal_semaphore_release(semaphore_);
+    iree_hal_buffer_release(target_buffer_);
+    iree_hal_buffer_release(source_buffer_);
+    iree_hal_device_release(device_);
+  }
+
+  iree_hal_buffer_t* source_buffer() const { return source_buffer_; }
+  iree_hal_buffer_t* target_buffer() const { return target_buffer_; }
+
+  // Records a command buffer in |mode| with |record_fn|.
+  template <typename F>
+  iree_hal_command_buffer_t* Record(iree_hal_command_buffer_mode_t mode,
+                                    F record_fn) {
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    IREE_CHECK_OK(iree_hal_command_buffer_create(
+        device_, mode, IREE_HAL_COMMAND_CATEGORY_TRANSFER, &command_buffer));
+    IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer));
+    record_fn(command_buffer);
+    IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer));
+    return command_buffer;
+  }
+
+  // Records a one-shot command buffer with |record_fn|, submits it, and waits
+  // for it to complete.
+  template <typename F>
+  void SubmitAndWait(F record_fn) {
+    iree_hal_command_buffer_t* command_buffer =
+        Record(IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT, record_fn);
+    SubmitAndWait(command_buffer);
+    iree_hal_command_buffer_release(command_buffer);
+  }
+
+  // Submits a recorded |command_buffer| and waits for it to complete.
+  void SubmitAndWait(iree_hal_command_buffer_t* command_buffer) {
+    uint64_t signal_value = ++semaphore_value_;
+    iree_hal_submission_batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.command_buffer_count = 1;
+    batch.command_buffers = &command_buffer;
+    batch.signal_semaphores.count = 1;
+    batch.signal_semaphores.semaphores = &semaphore_;
+    batch.signal_semaphores.payload_values = &signal_value;
+    IREE_CHECK_OK(iree_hal_device_queue_submit(
+        device_, IREE_HAL_COMMAND_CATEGORY_TRANSFER, /*queue_affinity=*/0,
+        /*batch_count=*/1, &batch));
+    IREE_CHECK_OK(iree_hal_semaphore_wait_with_deadline(
+        semaphore_, signal_value, IREE_TIME_INFINITE_FUTURE));
+  }
+
+ private:
+  iree_hal_device_t* device_ = NULL;
+  iree_hal_buffer_t* source_buffer_ = NULL;
+  iree_hal_buffer_t* target_buffer_ = NULL;
+  iree_hal_semaphore_t* semaphore_ = NULL;
+  uint64_t semaphore_value_ = 0;
+};
+
+void BM_FillSingleCall(benchmark::State& state) {
+  iree_device_size_t length = (iree_device_size_t)state.range(0);
+  TransferContext context(length);
+  uint32_t pattern = 0xAB12CD34u;
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_hal_buffer_fill(context.target_buffer(), 0, length,
+                                       &pattern, sizeof(pattern)));
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_FillSingleCall)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024)
+    ->Arg(64 * 1024 * 1024)
+    ->UseRealTime();
+
+void BM_FillCommandBuffer(benchmark::State& state) {
+  iree_device_size_t length = (iree_device_size_t)state.range(0);
+  TransferContext context(length);
+  uint32_t pattern = 0xAB12CD34u;
+  for (auto _ : state) {
+    context.SubmitAndWait([&](iree_hal_command_buffer_t* command_buffer) {
+      IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+          command_buffer, context.target_buffer(), 0, length, &pattern,
+          sizeof(pattern)));
+    });
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_FillCommandBuffer)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024)
+    ->Arg(64 * 1024 * 1024)
+    ->UseRealTime();
+
+void BM_CopySingleCall(benchmark::State& state) {
+  iree_device_size_t length = (iree_device_size_t)state.range(0);
+  TransferContext context(length);
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_hal_buffer_copy_data(
+        context.source_buffer(), 0, context.target_buffer(), 0, length));
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_CopySingleCall)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024)
+    ->Arg(64 * 1024 * 1024)
+    ->UseRealTime();
+
+void BM_CopyCommandBuffer(benchmark::State& state) {
+  iree_device_size_t length = (iree_device_size_t)state.range(0);
+  TransferContext context(length);
+  for (auto _ : state) {
+    context.SubmitAndWait([&](iree_hal_command_buffer_t* command_buffer) {
+      IREE_CHECK_OK(iree_hal_command_buffer_copy_buffer(
+          command_buffer, context.source_buffer(), 0, context.target_buffer(),
+          0, length));
+    });
+  }
+  state.SetBytesProcessed(state.iterations() * length);
+}
+BENCHMARK(BM_CopyCommandBuffer)
+    ->Arg(64 * 1024)
+    ->Arg(4 * 1024 * 1024)
+    ->Arg(64 * 1024 * 1024)
+    ->UseRealTime();
+
+//==============================================================================
+// Submission overhead
+//==============================================================================
+// Models an inference loop on a static model: the same sequence of small
+// commands is submitted over and over. One-shot command buffers have to be
+// recorded for each submission while reusable ones are recorded once and then
+// replayed.
+
+// Records |command_count| small fills into |context|'s target buffer with a
+// barrier between each such that every fill depends on the one before it.
+void RecordFillChain(TransferContext& context, int command_count,
+                     iree_hal_command_buffer_t* command_buffer) {
+  for (int i = 0; i < command_count; ++i) {
+    uint8_t pattern = (uint8_t)i;
+    IREE_CHECK_OK(iree_hal_command_buffer_fill_buffer(
+        command_buffer, context.target_buffer(), 0, 256, &pattern,
+        sizeof(pattern)));
+    IREE_CHECK_OK(iree_hal_command_buffer_execution_barrier(
+        command_buffer, IREE_HAL_EXECUTION_STAGE_TRANSFER,
+        IREE_HAL_EXECUTION_STAGE_TRANSFER, 0, NULL, 0, NULL));
+  }
+}
+
+void BM_SubmitRecorded(benchmark::State& state) {
+  const int command_count = (int)state.range(0);
+  TransferContext context(256);
+  for (auto _ : state) {
+    context.SubmitAndWait([&](iree_hal_command_buffer_t* command_buffer) {
+      RecordFillChain(context, command_count, command_buffer);
+    });
+  }
+  state.SetItemsProcessed(state.iterations() * command_count);
+}
+BENCHMARK(BM_SubmitRecorded)->Arg(1)->Arg(16)->Arg(128)->UseRealTime();
+
+void BM_SubmitReplayed(benchmark::State& state) {
+  const int command_count = (int)state.range(0);
+  TransferContext context(256);
+  iree_hal_command_buffer_t* command_buffer = context.Record(
+      IREE_HAL_COMMAND_BUFFER_MODE_REUSABLE,
+      [&](iree_hal_command_buffer_t* command_buffer) {
+        RecordFillChain(context, command_count, command_buffer);
+      });
+  for (auto _ : state) {
+    context.SubmitAndWait(command_buffer);
+  }
+  iree_hal_command_buffer_release(command_buffer);
+  state.SetItemsProcessed(state.iterations() * command_count);
+}
+BENCHMARK(BM_SubmitReplayed)->Arg(1)->Arg(16)->Arg(128)->UseRealTime();
+
+}  // namespace
@@ -0,0 +1,416 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the task command buffer behavior that the CTS cannot reach: how
+// pushed descriptor sets are bound to dispatches and how reusable command
+// buffers are issued.
+
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/arena.h"
+#include "iree/hal/local/local_descriptor_set_layout.h"
+#include "iree/hal/local/local_executable.h"
+#include "iree/hal/local/local_executable_layout.h"
+#include "iree/hal/local/task_command_buffer.h"
+#include "iree/hal/local/task_device.h"
+#include "iree/hal/local/task_queue_state.h"
+#include "iree/task/executor.h"
+#include "iree/task/scope.h"
+#include "iree/task/submission.h"
+#include "iree/task/task.h"
+#include "iree/task/topology.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+//===----------------------------------------------------------------------===//
+// Copying executable
+//===----------------------------------------------------------------------===//
+// Loads an executable for any data in kTestFormat whose only entry point
+// records the bindings it was called with and copies the first byte of its last
+// binding into its first binding.
+
+static const iree_hal_executable_format_t kTestFormat =
+    iree_hal_make_executable_format("TEST");
+
+typedef struct {
+  iree_hal_local_executable_t base;
+  iree_host_size_t binding_count;
+  const void* bindings[4];
+  iree_hal_local_executable_layout_t* layouts[];
+} test_executable_t;
+
+static void test_executable_destroy(iree_hal_executable_t* base_executable) {
+  test_executable_t* executable = (test_executable_t*)base_executable;
+  iree_allocator_t host_allocator = executable->base.host_allocator;
+  iree_hal_local_executable_deinitialize(&executable->base);
+  iree_allocator_free(host_allocator, executable);
+}
+
+static iree_status_t test_executable_issue_call(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    const iree_hal_local_executable_call_t* call) {
+  test_executable_t* executable = (test_executable_t*)base_executable;
+  iree_host_size_t binding_count = iree_math_count_ones_u64(
+      base_executable->executable_layouts[ordinal]->used_bindings);
+  if (binding_count < 1 ||
+      binding_count > IREE_ARRAYSIZE(executable->bindings)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unexpected binding count %zu", binding_count);
+  }
+  executable->binding_count = binding_count;
+  memcpy(executable->bindings, call->bindings,
+         binding_count * sizeof(call->bindings[0]));
+  ((uint8_t*)call->bindings[0])[0] =
+      ((const uint8_t*)call->bindings[binding_count - 1])[0];
+  return iree_ok_status();
+}
+
+static const iree_hal_local_executable_vtable_t test_executable_vtable = {
+    /*.base=*/{
+        /*.destroy=*/test_executable_destroy,
+    },
+    /*.issue_call=*/test_executable_issue_call,
+};
+
+static void test_loader_destroy(iree_hal_executable_loader_t* base_loader) {}
+
+static bool test_loader_query_support(
+    iree_hal_executable_loader_t* base_loader,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_hal_executable_format_t executable_format) {
+  return executable_format == kTestFormat;
+}
+
+static iree_status_t test_loader_try_load(
+    iree_hal_executable_loader_t* base_loader,
+    const iree_hal_executable_spec_t* executable_spec,
+    iree_hal_executable_t** out_executable) {
+  test_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      iree_allocator_system(),
+      sizeof(*executable) + executable_spec->executable_layout_count *
+                                sizeof(executable->layouts[0]),
+      (void**)&executable));
+  iree_hal_local_executable_initialize(
+      &test_executable_vtable, executable_spec->executable_layout_count,
+      executable_spec->executable_layouts, executable->layouts,
+      iree_allocator_system(), &executable->base);
+  *out_executable = (iree_hal_executable_t*)executable;
+  return iree_ok_status();
+}
+
+static const iree_hal_executable_loader_vtable_t test_loader_vtable = {
+    /*.destroy=*/test_loader_destroy,
+    /*.query_support=*/test_loader_query_support,
+    /*.try_load=*/test_loader_try_load,
+};
+
+class TaskCommandBufferTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    iree_hal_executable_loader_initialize(&test_loader_vtable, &loader_);
+
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(2, &topology);
+    iree_task_executor_t* executor = NULL;
+    IREE_ASSERT_OK(iree_task_executor_create(
+        IREE_TASK_SCHEDULING_MODE_RESERVED, &topology, iree_allocator_system(),
+        &executor));
+    iree_task_topology_deinitialize(&topology);
+
+    iree_hal_task_device_params_t params;
+    iree_hal_task_device_params_initialize(&params);
+    iree_hal_executable_loader_t* loaders[] = {&loader_};
+    IREE_ASSERT_OK(iree_hal_task_device_create(
+        iree_make_cstring_view("task"), &params, executor,
+        IREE_ARRAYSIZE(loaders), loaders, iree_allocator_system(), &device_));
+    iree_task_executor_release(executor);
+
+    IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore_));
+  }
+
+  void TearDown() override {
+    iree_hal_semaphore_release(semaphore_);
+    iree_hal_device_release(device_);
+  }
+
+  // Creates a descriptor set layout with one storage buffer binding for each
+  // (binding number, access) pair.
+  iree_hal_descriptor_set_layout_t* CreateSetLayout(
+      std::vector<std::pair<uint32_t, iree_hal_memory_access_t>> bindings) {
+    std::vector<iree_hal_descriptor_set_layout_binding_t> layout_bindings;
+    for (const auto& binding : bindings) {
+      layout_bindings.push_back({binding.first,
+                                 IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER,
+                                 binding.second});
+    }
+    iree_hal_descriptor_set_layout_t* set_layout = NULL;
+    IREE_CHECK_OK(iree_hal_descriptor_set_layout_create(
+        device_, IREE_HAL_DESCRIPTOR_SET_LAYOUT_USAGE_TYPE_PUSH_ONLY,
+        layout_bindings.size(), layout_bindings.data(), &set_layout));
+    return set_layout;
+  }
+
+  // Prepares the copying executable with a single entry point using
+  // |executable_layout|.
+  iree_hal_executable_t* PrepareExecutable(
+      iree_hal_executable_layout_t* executable_layout) {
+    iree_hal_executable_cache_t* executable_cache = NULL;
+    IREE_CHECK_OK(iree_hal_executable_cache_create(
+        device_, iree_make_cstring_view("test"), &executable_cache));
+    static const uint8_t kData[] = {0};
+    iree_hal_executable_spec_t spec;
+    iree_hal_executable_spec_initialize(&spec);
+    spec.executable_format = kTestFormat;
+    spec.executable_data = iree_make_const_byte_span(kData, sizeof(kData));
+    spec.executable_layout_count = 1;
+    spec.executable_layouts = &executable_layout;
+    iree_hal_executable_t* executable = NULL;
+    IREE_CHECK_OK(iree_hal_executable_cache_prepare_executable(
+        executable_cache, &spec, &executable));
+    iree_hal_executable_cache_release(executable_cache);
+    return executable;
+  }
+
+  // Allocates a host-visible buffer of |length| bytes filled with |value|.
+  iree_hal_buffer_t* AllocateBuffer(iree_device_size_t length, uint8_t value) {
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device_),
+        IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+        IREE_HAL_BUFFER_USAGE_ALL, length, &buffer));
+    IREE_CHECK_OK(iree_hal_buffer_fill(buffer, 0, IREE_WHOLE_BUFFER, &value,
+                                       sizeof(value)));
+    return buffer;
+  }
+
+  // Returns the host pointer of the contents of |buffer|.
+  void* MapContents(iree_hal_buffer_t* buffer) {
+    iree_hal_buffer_mapping_t mapping;
+    IREE_CHECK_OK(iree_hal_buffer_map_range(buffer, IREE_HAL_MEMORY_ACCESS_READ,
+                                            0, IREE_WHOLE_BUFFER, &mapping));
+    void* contents = mapping.contents.data;
+    iree_hal_buffer_unmap_range(&mapping);
+    return contents;
+  }
+
+  // Submits |command_buffer| and waits for it to complete.
+  void SubmitAndWait(iree_hal_command_buffer_t* command_buffer) {
+    uint64_t signal_value = ++semaphore_value_;
+    iree_hal_submission_batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.command_buffer_count = 1;
+    batch.command_buffers = &command_buffer;
+    batch.signal_semaphores.count = 1;
+    batch.signal_semaphores.semaphores = &semaphore_;
+    batch.signal_semaphores.payload_values = &signal_value;
+    IREE_CHECK_OK(iree_hal_device_queue_submit(
+        device_, IREE_HAL_COMMAND_CATEGORY_DISPATCH, /*queue_affinity=*/0,
+        /*batch_count=*/1, &batch));
+    IREE_CHECK_OK(iree_hal_semaphore_wait_with_deadline(
+        semaphore_, signal_value, IREE_TIME_INFINITE_FUTURE));
+  }
+
+  iree_hal_executable_loader_t loader_;
+  iree_hal_device_t* device_ = NULL;
+  iree_hal_semaphore_t* semaphore_ = NULL;
+  uint64_t semaphore_value_ = 0;
+};
+
+// Tests that bindings pushed to a set other than 0 with sparse binding numbers
+// reach the dispatch in layout order.
+TEST_F(TaskCommandBufferTest, PushDescriptorSetSparseBindings) {
+  iree_hal_descriptor_set_layout_t* set_layouts[2] = {
+      CreateSetLayout({{0, IREE_HAL_MEMORY_ACCESS_WRITE}}),
+      CreateSetLayout({{7, IREE_HAL_MEMORY_ACCESS_READ},
+                       {5, IREE_HAL_MEMORY_ACCESS_READ}}),
+  };
+  iree_hal_executable_layout_t* executable_layout = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_layout_create(
+      device_, IREE_ARRAYSIZE(set_layouts), set_layouts,
+      /*push_constants=*/0, &executable_layout));
+  iree_hal_executable_t* executable = PrepareExecutable(executable_layout);
+
+  iree_hal_buffer_t* target_buffer = AllocateBuffer(4, 0x00);
+  iree_hal_buffer_t* unused_buffer = AllocateBuffer(4, 0x00);
+  iree_hal_buffer_t* source_buffer = AllocateBuffer(4, 0xAB);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, &command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  iree_hal_descriptor_set_binding_t set0_bindings[] = {
+      {/*binding=*/0, target_buffer, 0, IREE_WHOLE_BUFFER},
+  };
+  IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+      command_buffer, executable_layout, /*set=*/0,
+      IREE_ARRAYSIZE(set0_bindings), set0_bindings));
+  // Pushed in a different order than the layout declares them.
+  iree_hal_descriptor_set_binding_t set1_bindings[] = {
+      {/*binding=*/5, source_buffer, 0, IREE_WHOLE_BUFFER},
+      {/*binding=*/7, unused_buffer, 0, IREE_WHOLE_BUFFER},
+  };
+  IREE_ASSERT_OK(iree_hal_command_buffer_push_descriptor_set(
+      command_buffer, executable_layout, /*set=*/1,
+      IREE_ARRAYSIZE(set1_bindings), set1_bindings));
+  IREE_ASSERT_OK(
+      iree_hal_command_buffer_dispatch(command_buffer, executable, 0, 1, 1, 1));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+  SubmitAndWait(command_buffer);
+
+  test_executable_t* test_executable = (test_executable_t*)executable;
+  ASSERT_EQ(3, test_executable->binding_count);
+  EXPECT_EQ(MapContents(target_buffer), test_executable->bindings[0]);
+  EXPECT_EQ(MapContents(unused_buffer), test_executable->bindings[1]);
+  EXPECT_EQ(MapContents(source_buffer), test_executable->bindings[2]);
+  EXPECT_EQ(0xAB, ((const uint8_t*)MapContents(target_buffer))[0]);
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(source_buffer);
+  iree_hal_buffer_release(unused_buffer);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_executable_release(executable);
+  iree_hal_executable_layout_release(executable_layout);
+  iree_hal_descriptor_set_layout_release(set_layouts[0]);
+  iree_hal_descriptor_set_layout_release(set_layouts[1]);
+}
+
+// Tests that pushing binding numbers or sets the layout does not declare fails.
+TEST_F(TaskCommandBufferTest, PushDescriptorSetRejectsUnknownBindings) {
+  iree_hal_descriptor_set_layout_t* set_layouts[2] = {
+      CreateSetLayout({{0, IREE_HAL_MEMORY_ACCESS_WRITE}}),
+      CreateSetLayout({{5, IREE_HAL_MEMORY_ACCESS_READ}}),
+  };
+  iree_hal_executable_layout_t* executable_layout = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_layout_create(
+      device_, IREE_ARRAYSIZE(set_layouts), set_layouts,
+      /*push_constants=*/0, &executable_layout));
+  iree_hal_buffer_t* buffer = AllocateBuffer(4, 0x00);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH, &command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  iree_hal_descriptor_set_binding_t dense_binding = {
+      /*binding=*/1, buffer, 0, IREE_WHOLE_BUFFER};
+  EXPECT_THAT(iree::Status(iree_hal_command_buffer_push_descriptor_set(
+                  command_buffer, executable_layout, /*set=*/1, 1,
+                  &dense_binding)),
+              StatusIs(iree::StatusCode::kInvalidArgument));
+  iree_hal_descriptor_set_binding_t out_of_range_binding = {
+      /*binding=*/40, buffer, 0, IREE_WHOLE_BUFFER};
+  EXPECT_THAT(iree::Status(iree_hal_command_buffer_push_descriptor_set(
+                  command_buffer, executable_layout, /*set=*/1, 1,
+                  &out_of_range_binding)),
+              StatusIs(iree::StatusCode::kInvalidArgument));
+  iree_hal_descriptor_set_binding_t undeclared_set_binding = {
+      /*binding=*/0, buffer, 0, IREE_WHOLE_BUFFER};
+  EXPECT_THAT(iree::Status(iree_hal_command_buffer_push_descriptor_set(
+                  command_buffer, executable_layout, /*set=*/2, 1,
+                  &undeclared_set_binding)),
+              StatusIs(iree::StatusCode::kInvalidArgument));
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(buffer);
+  iree_hal_executable_layout_release(executable_layout);
+  iree_hal_descriptor_set_layout_release(set_layouts[0]);
+  iree_hal_descriptor_set_layout_release(set_layouts[1]);
+}
+
+// Tests that a reusable command buffer cannot be issued again until its prior
+// issue has retired.
+TEST_F(TaskCommandBufferTest, ReusableIssueWhileInFlight) {
+  iree_hal_buffer_t* buffer = AllocateBuffer(4, 0x00);
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_REUSABLE,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, &command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  uint8_t pattern = 0xCD;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer, 0, IREE_WHOLE_BUFFER, &pattern, sizeof(pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  // Issued tasks are never submitted; the submission is only inspected.
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"), &scope);
+  iree_task_nop_t retire_task;
+  iree_task_nop_initialize(&scope, &retire_task);
+  iree_hal_task_queue_state_t queue_state;
+  iree_hal_task_queue_state_initialize(&queue_state);
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, iree_allocator_system(), &block_pool);
+  iree_arena_allocator_t arena;
+  iree_arena_initialize(&block_pool, &arena);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  IREE_EXPECT_OK(iree_hal_task_command_buffer_issue(
+      command_buffer, &queue_state, &retire_task.header, &arena, &submission));
+  EXPECT_FALSE(iree_task_submission_is_empty(&submission));
+
+  iree_task_submission_initialize(&submission);
+  EXPECT_THAT(iree::Status(iree_hal_task_command_buffer_issue(
+                  command_buffer, &queue_state, &retire_task.header, &arena,
+                  &submission)),
+              StatusIs(iree::StatusCode::kFailedPrecondition));
+  EXPECT_TRUE(iree_task_submission_is_empty(&submission));
+
+  iree_hal_task_command_buffer_retire(command_buffer);
+  IREE_EXPECT_OK(iree_hal_task_command_buffer_issue(
+      command_buffer, &queue_state, &retire_task.header, &arena, &submission));
+  EXPECT_FALSE(iree_task_submission_is_empty(&submission));
+  iree_hal_task_command_buffer_retire(command_buffer);
+
+  iree_arena_deinitialize(&arena);
+  iree_arena_block_pool_deinitialize(&block_pool);
+  iree_hal_task_queue_state_deinitialize(&queue_state);
+  iree_task_scope_deinitialize(&scope);
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(buffer);
+}
+
+// Tests that a reusable command buffer can be resubmitted as soon as the
+// semaphore signaled by its prior submission is reached.
+TEST_F(TaskCommandBufferTest, ReusableResubmitAfterSignal) {
+  iree_hal_buffer_t* buffer = AllocateBuffer(4, 0x00);
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_REUSABLE,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, &command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  uint8_t pattern = 0xCD;
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer, buffer, 0, IREE_WHOLE_BUFFER, &pattern, sizeof(pattern)));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  for (int i = 0; i < 8; ++i) {
+    SubmitAndWait(command_buffer);
+  }
+  EXPECT_EQ(0xCD, ((const uint8_t*)MapContents(buffer))[3]);
+
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(buffer);
+}
+
+}  // namespace
@@ -40,6 +40,9 @@ typedef struct {
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t large_block_pool;
 
+  // Number of unused blocks retained in each block pool when idle.
+  iree_host_size_t arena_block_idle_retention_count;
+
   // iree_event_t pool for semaphore wait operations.
   iree_hal_local_event_pool_t* event_pool;
 
@@ -48,6 +51,10 @@ typedef struct {
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t** loaders;
 
+  // Executable cache shared by all iree_hal_executable_cache_t instances
+  // created from the device.
+  iree_hal_executable_cache_t* executable_cache;
+
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
@@ -66,7 +73,11 @@ static iree_hal_task_device_t* iree_hal_task_device_cast(
 void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
+  out_params->arena_block_idle_retention_count = 32;
+  out_params->arena_block_max_retained_count = IREE_ARENA_BLOCK_POOL_NO_LIMIT;
   out_params->queue_count = 8;
+  out_params->executable_cache_capacity = 64;
+  out_params->max_cached_buffer_bytes = 0;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
@@ -115,6 +126,18 @@ iree_status_t iree_hal_task_device_create(
                                      &device->small_block_pool);
     iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                      &device->large_block_pool);
+    device->arena_block_idle_retention_count =
+        params->arena_block_idle_retention_count;
+    device->small_block_pool.max_available_count =
+        params->arena_block_max_retained_count;
+    device->large_block_pool.max_available_count =
+        params->arena_block_max_retained_count;
+    device->small_block_pool.trace_plot_name = "task_device_small_blocks";
+    device->large_block_pool.trace_plot_name = "task_device_large_blocks";
+    IREE_TRACE_SET_PLOT_TYPE(device->small_block_pool.trace_plot_name,
+                             IREE_TRACING_PLOT_TYPE_MEMORY);
+    IREE_TRACE_SET_PLOT_TYPE(device->large_block_pool.trace_plot_name,
+                             IREE_TRACING_PLOT_TYPE_MEMORY);
     device->event_pool = NULL;
 
     device->executor = executor;
@@ -132,15 +155,25 @@ iree_status_t iree_hal_task_device_create(
     device->queue_count = params->queue_count;
     for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
       // TODO(benvanik): add a number to each queue ID.
-      iree_hal_task_queue_initialize(device->identifier, device->executor,
-                                     &device->small_block_pool,
-                                     &device->queues[i]);
+      iree_hal_task_queue_initialize(
+          device->identifier, device->executor, &device->small_block_pool,
+          device->arena_block_idle_retention_count, &device->queues[i]);
     }
   }
 
   if (iree_status_is_ok(status)) {
-    status = iree_hal_allocator_create_heap(identifier, host_allocator,
-                                            &device->device_allocator);
+    iree_hal_heap_allocator_params_t allocator_params;
+    iree_hal_heap_allocator_params_initialize(&allocator_params);
+    allocator_params.max_cached_bytes = params->max_cached_buffer_bytes;
+    status = iree_hal_allocator_create_heap_with_params(
+        identifier, &allocator_params, host_allocator,
+        &device->device_allocator);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_local_executable_cache_create(
+        identifier, params->executable_cache_capacity, device->loader_count,
+        device->loaders, host_allocator, &device->executable_cache);
   }
 
   if (iree_status_is_ok(status)) {
@@ -166,6 +199,7 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
+  iree_hal_executable_cache_release(device->executable_cache);
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -241,9 +275,11 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
-  return iree_hal_local_executable_cache_create(
-      identifier, device->loader_count, device->loaders,
-      iree_hal_device_host_allocator(base_device), out_executable_cache);
+  // All callers share the device cache; |identifier| only partitions
+  // persistent caches, which we don't have.
+  iree_hal_executable_cache_retain(device->executable_cache);
+  *out_executable_cache = device->executable_cache;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_device_create_executable_layout(
@@ -260,8 +296,9 @@ static iree_status_t iree_hal_task_device_create_semaphore(
     iree_hal_device_t* base_device, uint64_t initial_value,
     iree_hal_semaphore_t** out_semaphore) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
-  return iree_hal_task_semaphore_create(device->event_pool, initial_value,
-                                        device->host_allocator, out_semaphore);
+  return iree_hal_task_semaphore_create(device->executor, device->event_pool,
+                                        initial_value, device->host_allocator,
+                                        out_semaphore);
 }
 
 // Returns the queue index to submit work to based on the |queue_affinity|.
@@ -316,6 +353,14 @@ static iree_status_t iree_hal_task_device_wait_idle_with_deadline(
                                                          deadline_ns);
     if (!iree_status_is_ok(status)) break;
   }
+  if (iree_status_is_ok(status)) {
+    // With the device idle any blocks in the pools are only being retained for
+    // future work; drop all but a few to release burst memory.
+    iree_arena_block_pool_trim_to(&device->small_block_pool,
+                                  device->arena_block_idle_retention_count);
+    iree_arena_block_pool_trim_to(&device->large_block_pool,
+                                  device->arena_block_idle_retention_count);
+  }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -36,6 +36,29 @@ typedef struct {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Number of unused blocks retained in each device block pool when idle.
+  // Blocks beyond this are returned to the host allocator so that memory used
+  // during bursts of work is not held forever. The pool used for submission
+  // transients is trimmed whenever a queue retires its last pending submission
+  // while the pool used for recording command buffers is only trimmed when the
+  // device is waited on until idle.
+  iree_host_size_t arena_block_idle_retention_count;
+
+  // Maximum number of unused blocks retained in each device block pool at any
+  // time. Defaults to IREE_ARENA_BLOCK_POOL_NO_LIMIT.
+  iree_host_size_t arena_block_max_retained_count;
+
+  // Maximum number of prepared executables retained by the device executable
+  // cache. The cache is shared by all executable caches created from the
+  // device so that contexts loading the same module share executables.
+  // Set to 0 to load executables anew for each preparation.
+  iree_host_size_t executable_cache_capacity;
+
+  // Maximum total size in bytes of freed buffer storage retained by the device
+  // allocator for reuse by subsequent allocations of similar sizes.
+  // Set to 0 to always return freed storage to the host allocator.
+  iree_device_size_t max_cached_buffer_bytes;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
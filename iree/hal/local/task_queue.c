@@ -187,6 +187,10 @@ typedef struct {
   // if we are the last issue pending.
   iree_hal_task_queue_t* queue;
 
+  // Number of leading |command_buffers| that were successfully issued and must
+  // be retired along with the submission.
+  iree_host_size_t issued_command_buffer_count;
+
   // Command buffers to be issued in the order the appeared in the submission.
   iree_host_size_t command_buffer_count;
   iree_hal_command_buffer_t* command_buffers[];
@@ -209,6 +213,7 @@ static iree_status_t iree_hal_task_queue_issue_cmd(
           cmd->command_buffers[i], &cmd->queue->state,
           cmd->task.header.completion_task, cmd->arena, pending_submission);
       if (IREE_UNLIKELY(!iree_status_is_ok(status))) break;
+      ++cmd->issued_command_buffer_count;
     }
   }
 
@@ -250,6 +255,7 @@ static iree_status_t iree_hal_task_queue_issue_cmd_allocate(
   cmd->arena = arena;
   cmd->queue = queue;
 
+  cmd->issued_command_buffer_count = 0;
   cmd->command_buffer_count = command_buffer_count;
   memcpy(cmd->command_buffers, command_buffers,
          cmd->command_buffer_count * sizeof(*cmd->command_buffers));
@@ -277,8 +283,29 @@ typedef struct {
 
   // A list of semaphores to signal upon retiring.
   iree_hal_semaphore_list_t signal_semaphores;
+
+  // Queue the submission was made to.
+  iree_hal_task_queue_t* queue;
+
+  // Issue command of the submission, allocated from |arena|. The command
+  // buffers it issued are retired before any semaphores are signaled so that
+  // waiters may immediately reissue them.
+  iree_hal_task_queue_issue_cmd_t* issue_cmd;
 } iree_hal_task_queue_retire_cmd_t;
 
+// Retires all command buffers successfully issued by the submission.
+// Safe to call multiple times.
+static void iree_hal_task_queue_retire_cmd_retire_command_buffers(
+    iree_hal_task_queue_retire_cmd_t* cmd) {
+  iree_hal_task_queue_issue_cmd_t* issue_cmd = cmd->issue_cmd;
+  if (!issue_cmd) return;
+  for (iree_host_size_t i = 0; i < issue_cmd->issued_command_buffer_count;
+       ++i) {
+    iree_hal_task_command_buffer_retire(issue_cmd->command_buffers[i]);
+  }
+  issue_cmd->issued_command_buffer_count = 0;
+}
+
 // Retires a submission by signaling semaphores to their desired value and
 // disposing of the temporary arena memory used for the submission.
 static iree_status_t iree_hal_task_queue_retire_cmd(
@@ -288,6 +315,8 @@ static iree_status_t iree_hal_task_queue_retire_cmd(
       (iree_hal_task_queue_retire_cmd_t*)task;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_task_queue_retire_cmd_retire_command_buffers(cmd);
+
   // Signal all semaphores to their new values.
   // Note that if any signal fails then the whole command will fail and all
   // semaphores will be signaled to the failure state.
@@ -311,6 +340,9 @@ static void iree_hal_task_queue_retire_cmd_cleanup(iree_task_t* task,
   iree_hal_task_queue_retire_cmd_t* cmd =
       (iree_hal_task_queue_retire_cmd_t*)task;
 
+  // The retire command itself does not run if the submission was discarded.
+  iree_hal_task_queue_retire_cmd_retire_command_buffers(cmd);
+
   // If the command failed then fail all semaphores to ensure future
   // submissions fail as well (including those on other queues).
   if (!iree_status_is_ok(status)) {
@@ -324,22 +356,31 @@ static void iree_hal_task_queue_retire_cmd_cleanup(iree_task_t* task,
   iree_hal_semaphore_list_release(&cmd->signal_semaphores);
 
   // Drop all memory used by the submission (**including cmd**).
+  iree_hal_task_queue_t* queue = cmd->queue;
   iree_arena_allocator_t arena = cmd->arena;
   cmd = NULL;
   iree_arena_deinitialize(&arena);
+
+  // If this was the last pending submission then the queue is idle and any
+  // blocks in the pool are only being retained for future work; drop all but a
+  // few to release burst memory.
+  if (iree_atomic_fetch_sub_int32(&queue->pending_submission_count, 1,
+                                  iree_memory_order_acq_rel) == 1) {
+    iree_arena_block_pool_trim_to(queue->block_pool,
+                                  queue->idle_block_retention_count);
+  }
 }
 
 // Allocates and initializes a iree_hal_task_queue_retire_cmd_t task.
 // The command will own an arena that can be used for other submission-related
 // allocations.
 static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
-    iree_task_scope_t* scope,
+    iree_task_scope_t* scope, iree_hal_task_queue_t* queue,
     const iree_hal_semaphore_list_t* signal_semaphores,
-    iree_arena_block_pool_t* block_pool,
     iree_hal_task_queue_retire_cmd_t** out_cmd) {
   // Make an arena we'll use for allocating the command itself.
   iree_arena_allocator_t arena;
-  iree_arena_initialize(block_pool, &arena);
+  iree_arena_initialize(queue->block_pool, &arena);
 
   // Allocate the command from the arena.
   iree_hal_task_queue_retire_cmd_t* cmd = NULL;
@@ -351,6 +392,8 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
         &cmd->task);
     iree_task_set_cleanup_fn(&cmd->task.header,
                              iree_hal_task_queue_retire_cmd_cleanup);
+    cmd->queue = queue;
+    cmd->issue_cmd = NULL;
   }
 
   // Clone the signal semaphores from the batch - we retain them and their
@@ -377,6 +420,7 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
+                                    iree_host_size_t idle_block_retention_count,
                                     iree_hal_task_queue_t* out_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, identifier.data, identifier.size);
@@ -386,6 +430,9 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
   out_queue->executor = executor;
   iree_task_executor_retain(out_queue->executor);
   out_queue->block_pool = block_pool;
+  out_queue->idle_block_retention_count = idle_block_retention_count;
+  iree_atomic_store_int32(&out_queue->pending_submission_count, 0,
+                          iree_memory_order_relaxed);
 
   iree_task_scope_initialize(identifier, &out_queue->scope);
 
@@ -421,8 +468,7 @@ static iree_status_t iree_hal_task_queue_submit_batch(
   // arena which we will use to allocate all other commands.
   iree_hal_task_queue_retire_cmd_t* retire_cmd = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_queue_retire_cmd_allocate(
-      &queue->scope, &batch->signal_semaphores, queue->block_pool,
-      &retire_cmd));
+      &queue->scope, queue, &batch->signal_semaphores, &retire_cmd));
 
   // NOTE: if we fail from here on we must drop the retire_cmd arena.
   iree_status_t status = iree_ok_status();
@@ -453,6 +499,9 @@ static iree_status_t iree_hal_task_queue_submit_batch(
         batch->command_buffer_count, batch->command_buffers, &retire_cmd->arena,
         &issue_cmd);
   }
+  if (iree_status_is_ok(status)) {
+    retire_cmd->issue_cmd = issue_cmd;
+  }
 
   // Last chance for failure - from here on we are submitting.
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
@@ -460,6 +509,11 @@ static iree_status_t iree_hal_task_queue_submit_batch(
     return status;
   }
 
+  // Balanced by the retire command cleanup, which runs even if the submission
+  // fails.
+  iree_atomic_fetch_add_int32(&queue->pending_submission_count, 1,
+                              iree_memory_order_acq_rel);
+
   iree_task_submission_t submission;
   iree_task_submission_initialize(&submission);
 
@@ -517,6 +571,9 @@ iree_status_t iree_hal_task_queue_submit(
 iree_status_t iree_hal_task_queue_wait_idle_with_deadline(
     iree_hal_task_queue_t* queue, iree_time_t deadline_ns) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  // Ensure all pending work has been scheduled; threadless executors only make
+  // progress while being flushed or donated to.
+  iree_task_executor_flush(queue->executor);
   iree_status_t status = iree_task_scope_wait_idle(&queue->scope, deadline_ns);
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -34,6 +34,13 @@ typedef struct {
   // Shared block pool for allocating submission transients (tasks/events/etc).
   iree_arena_block_pool_t* block_pool;
 
+  // Number of unused blocks left in |block_pool| when the last pending
+  // submission of the queue retires.
+  iree_host_size_t idle_block_retention_count;
+
+  // Number of submissions that have been submitted but not yet retired.
+  iree_atomic_int32_t pending_submission_count;
+
   // Scope used for all tasks in the queue.
   // This allows for easy waits on all outstanding queue tasks as well as
   // differentiation of tasks within the executor.
@@ -57,9 +64,14 @@ typedef struct {
   iree_task_t* tail_issue_task;
 } iree_hal_task_queue_t;
 
+// Initializes a queue that submits to |executor| and allocates submission
+// transients from |block_pool|. Whenever the queue goes idle (its last pending
+// submission retires) |block_pool| is trimmed to |idle_block_retention_count|
+// unused blocks so that bursts of work do not keep their peak memory alive.
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* block_pool,
+                                    iree_host_size_t idle_block_retention_count,
                                     iree_hal_task_queue_t* out_queue);
 
 void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue);
@@ -140,6 +140,9 @@ typedef struct {
   iree_allocator_t host_allocator;
   iree_hal_local_event_pool_t* event_pool;
 
+  // Executor that waiting threads are donated to while they wait.
+  iree_task_executor_t* executor;
+
   // Guards all mutable fields. We expect low contention on semaphores and since
   // iree_slim_mutex_t is (effectively) just a CAS this keeps things simpler
   // than trying to make the entire structure lock-free.
@@ -172,8 +175,10 @@ static iree_hal_task_semaphore_t* iree_hal_task_semaphore_cast(
 }
 
 iree_status_t iree_hal_task_semaphore_create(
-    iree_hal_local_event_pool_t* event_pool, uint64_t initial_value,
-    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
+    iree_task_executor_t* executor, iree_hal_local_event_pool_t* event_pool,
+    uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore) {
+  IREE_ASSERT_ARGUMENT(executor);
   IREE_ASSERT_ARGUMENT(event_pool);
   IREE_ASSERT_ARGUMENT(out_semaphore);
   *out_semaphore = NULL;
@@ -187,6 +192,8 @@ iree_status_t iree_hal_task_semaphore_create(
                                  &semaphore->resource);
     semaphore->host_allocator = host_allocator;
     semaphore->event_pool = event_pool;
+    semaphore->executor = executor;
+    iree_task_executor_retain(semaphore->executor);
 
     iree_slim_mutex_initialize(&semaphore->mutex);
     semaphore->current_value = initial_value;
@@ -210,6 +217,7 @@ static void iree_hal_task_semaphore_destroy(
 
   iree_status_free(semaphore->failure_status);
   iree_notification_deinitialize(&semaphore->notification);
+  iree_task_executor_release(semaphore->executor);
   iree_allocator_free(host_allocator, semaphore);
 
   IREE_TRACE_ZONE_END(z0);
@@ -402,10 +410,13 @@ static iree_status_t iree_hal_task_semaphore_wait_with_deadline(
   iree_slim_mutex_unlock(&semaphore->mutex);
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) return status;
 
-  // Wait until the timepoint resolves.
+  // Wait until the timepoint resolves. Rather than immediately blocking in the
+  // kernel we donate the calling thread to the executor so that it can help
+  // complete the work that will eventually signal the semaphore.
   // If satisfied the timepoint is automatically cleaned up and we are done. If
   // the deadline is reached before satisfied then we have to clean it up.
-  status = iree_wait_one(&timepoint.event, deadline_ns);
+  status = iree_task_executor_donate_caller(semaphore->executor,
+                                            &timepoint.event, deadline_ns);
   if (!iree_status_is_ok(status)) {
     iree_slim_mutex_lock(&semaphore->mutex);
     iree_hal_task_timepoint_list_erase(&semaphore->timepoint_list, &timepoint);
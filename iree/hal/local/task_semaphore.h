@@ -19,6 +19,7 @@
 #include "iree/hal/api.h"
 #include "iree/hal/local/arena.h"
 #include "iree/hal/local/event_pool.h"
+#include "iree/task/executor.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 
@@ -28,8 +29,11 @@ extern "C" {
 
 // Creates a semaphore that integrates with the task system to allow for
 // pipelined wait and signal operations.
+// Threads synchronously waiting on the semaphore will be donated to |executor|
+// so that they can help make progress on the work they are waiting for.
 iree_status_t iree_hal_task_semaphore_create(
-    iree_hal_local_event_pool_t* event_pool, uint64_t initial_value,
+    iree_task_executor_t* executor, iree_hal_local_event_pool_t* event_pool,
+    uint64_t initial_value,
     iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore);
 
 // Reserves a new timepoint in the timeline for the given minimum payload value.
@@ -14,6 +14,7 @@
 
 #include "iree/hal/vulkan/vma_allocator.h"
 
+#include "iree/base/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/vulkan/status_util.h"
 #include "iree/hal/vulkan/vma_buffer.h"
@@ -24,6 +25,10 @@ typedef struct iree_hal_vulkan_vma_allocator_s {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   VmaAllocator vma;
+
+  // Guards |statistics|; VMA itself is internally synchronized.
+  iree_slim_mutex_t mutex;
+  iree_hal_allocator_statistics_t statistics;
 } iree_hal_vulkan_vma_allocator_t;
 
 extern const iree_hal_allocator_vtable_t iree_hal_vulkan_vma_allocator_vtable;
@@ -96,6 +101,8 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
                                  &allocator->resource);
     allocator->host_allocator = host_allocator;
     allocator->vma = vma;
+    iree_slim_mutex_initialize(&allocator->mutex);
+    memset(&allocator->statistics, 0, sizeof(allocator->statistics));
     *out_allocator = (iree_hal_allocator_t*)allocator;
   } else {
     vmaDestroyAllocator(vma);
@@ -113,6 +120,7 @@ static void iree_hal_vulkan_vma_allocator_destroy(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   vmaDestroyAllocator(allocator->vma);
+  iree_slim_mutex_deinitialize(&allocator->mutex);
   iree_allocator_free(host_allocator, allocator);
 
   IREE_TRACE_ZONE_END(z0);
@@ -125,6 +133,26 @@ static iree_allocator_t iree_hal_vulkan_vma_allocator_host_allocator(
   return allocator->host_allocator;
 }
 
+static void iree_hal_vulkan_vma_allocator_query_statistics(
+    iree_hal_allocator_t* base_allocator,
+    iree_hal_allocator_statistics_t* out_statistics) {
+  iree_hal_vulkan_vma_allocator_t* allocator =
+      iree_hal_vulkan_vma_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->mutex);
+  *out_statistics = allocator->statistics;
+  iree_slim_mutex_unlock(&allocator->mutex);
+}
+
+void iree_hal_vulkan_vma_allocator_record_free(
+    iree_hal_allocator_t* base_allocator, iree_device_size_t allocation_size) {
+  iree_hal_vulkan_vma_allocator_t* allocator =
+      iree_hal_vulkan_vma_allocator_cast(base_allocator);
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_hal_allocator_statistics_record_free(&allocator->statistics,
+                                            allocation_size);
+  iree_slim_mutex_unlock(&allocator->mutex);
+}
+
 static iree_hal_buffer_compatibility_t
 iree_hal_vulkan_vma_allocator_query_buffer_compatibility(
     iree_hal_allocator_t* base_allocator, iree_hal_memory_type_t memory_type,
@@ -249,12 +277,20 @@ static iree_status_t iree_hal_vulkan_vma_allocator_allocate_internal(
                                      &allocation, &allocation_info),
                      "vmaCreateBuffer");
 
-  return iree_hal_vulkan_vma_buffer_wrap(
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_vma_buffer_wrap(
       (iree_hal_allocator_t*)allocator, memory_type, allowed_access,
       allowed_usage, allocation_size,
       /*byte_offset=*/0,
       /*byte_length=*/allocation_size, allocator->vma, handle, allocation,
-      allocation_info, out_buffer);
+      allocation_info, out_buffer));
+
+  // Track the actual size VMA allocated, which includes any padding required
+  // by the implementation. The buffer records the free when destroyed.
+  iree_slim_mutex_lock(&allocator->mutex);
+  iree_hal_allocator_statistics_record_alloc(&allocator->statistics,
+                                             allocation_info.size);
+  iree_slim_mutex_unlock(&allocator->mutex);
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_vulkan_vma_allocator_allocate_buffer(
@@ -286,6 +322,7 @@ static iree_status_t iree_hal_vulkan_vma_allocator_wrap_buffer(
 const iree_hal_allocator_vtable_t iree_hal_vulkan_vma_allocator_vtable = {
     /*.destroy=*/iree_hal_vulkan_vma_allocator_destroy,
     /*.host_allocator=*/iree_hal_vulkan_vma_allocator_host_allocator,
+    /*.query_statistics=*/iree_hal_vulkan_vma_allocator_query_statistics,
     /*.query_buffer_compatibility = */
     iree_hal_vulkan_vma_allocator_query_buffer_compatibility,
     /*.allocate_buffer=*/iree_hal_vulkan_vma_allocator_allocate_buffer,
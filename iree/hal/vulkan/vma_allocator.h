@@ -45,6 +45,12 @@ iree_status_t iree_hal_vulkan_vma_allocator_create(
     iree::hal::vulkan::VkDeviceHandle* logical_device,
     VmaRecordSettings record_settings, iree_hal_allocator_t** out_allocator);
 
+// Records the release of an allocation of |allocation_size| bytes made from
+// the VMA |allocator| for statistics tracking.
+// Called by VMA buffers when they are destroyed.
+void iree_hal_vulkan_vma_allocator_record_free(
+    iree_hal_allocator_t* allocator, iree_device_size_t allocation_size);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -16,6 +16,10 @@
 
 #include "iree/base/tracing.h"
 #include "iree/hal/vulkan/status_util.h"
+#include "iree/hal/vulkan/vma_allocator.h"
+
+// Name of the memory pool used for tracing VMA buffer allocations.
+#define IREE_HAL_VULKAN_VMA_BUFFER_TRACE_ID "iree-hal-vulkan-vma"
 
 typedef struct iree_hal_vulkan_vma_buffer_s {
   iree_hal_buffer_t base;
@@ -72,13 +76,18 @@ iree_status_t iree_hal_vulkan_vma_buffer_wrap(
     //     VMA_ALLOCATION_CREATE_USER_DATA_COPY_STRING_BIT flag.
     vmaSetAllocationUserData(buffer->vma, buffer->allocation, buffer);
 
+    // The VmaAllocation handle is used as the allocation identity as multiple
+    // allocations may share the same device memory.
+    IREE_TRACE_ALLOC_NAMED(IREE_HAL_VULKAN_VMA_BUFFER_TRACE_ID,
+                           buffer->allocation, allocation_info.size);
+
     *out_buffer = &buffer->base;
   } else {
     vmaDestroyBuffer(vma, handle, allocation);
   }
 
   IREE_TRACE_ZONE_END(z0);
-  return iree_ok_status();
+  return status;
 }
 
 static void iree_hal_vulkan_vma_buffer_destroy(iree_hal_buffer_t* base_buffer) {
@@ -88,6 +97,10 @@ static void iree_hal_vulkan_vma_buffer_destroy(iree_hal_buffer_t* base_buffer) {
       iree_hal_allocator_host_allocator(iree_hal_buffer_allocator(base_buffer));
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  IREE_TRACE_FREE_NAMED(IREE_HAL_VULKAN_VMA_BUFFER_TRACE_ID,
+                        buffer->allocation);
+  iree_hal_vulkan_vma_allocator_record_free(
+      iree_hal_buffer_allocator(base_buffer), buffer->allocation_info.size);
   vmaDestroyBuffer(buffer->vma, buffer->handle, buffer->allocation);
   iree_allocator_free(host_allocator, buffer);
 
@@ -133,6 +133,17 @@ class HALModuleState final {
   }
 
   ~HALModuleState() {
+    // Submissions may still be in-flight and using the resources they retain.
+    // Failed semaphores return immediately and we release their resources
+    // anyway as the work they guarded will never run.
+    for (auto& pending : pending_releases_) {
+      iree_status_ignore(iree_hal_semaphore_wait_with_deadline(
+          pending.semaphore.get(), pending.value, IREE_TIME_INFINITE_FUTURE));
+      for (auto& ref : pending.refs) {
+        iree_vm_ref_release(&ref);
+      }
+    }
+    pending_releases_.clear();
     for (auto& ref : deferred_releases_) {
       iree_vm_ref_release(&ref);
     }
@@ -198,6 +209,94 @@ class HALModuleState final {
       }
       deferred_releases_.clear();
     }
+    ReclaimPendingReleases();
+
+    return OkStatus();
+  }
+
+  // Submits |command_buffers| to the device queue without waiting for them to
+  // complete. Execution begins once each of |wait_semaphores| reaches the
+  // corresponding |wait_values| and each of |signal_semaphores| is signaled to
+  // the corresponding |signal_values| when the command buffers have completed.
+  //
+  // The command buffers and all resources deferred while recording them are
+  // retained until the first signal semaphore reaches its value. Callers that
+  // need the results on the host must wait on one of the signal semaphores.
+  Status ExSubmit(
+      const vm::ref<iree_hal_device_t>& device,
+      absl::Span<const vm::ref<iree_hal_semaphore_t>> wait_semaphores,
+      absl::Span<const uint32_t> wait_values,
+      absl::Span<const vm::ref<iree_hal_command_buffer_t>> command_buffers,
+      absl::Span<const vm::ref<iree_hal_semaphore_t>> signal_semaphores,
+      absl::Span<const uint32_t> signal_values) {
+    IREE_TRACE_SCOPE0("HALModuleState::ExSubmit");
+    if (wait_semaphores.size() != wait_values.size() ||
+        signal_semaphores.size() != signal_values.size()) {
+      return InvalidArgumentErrorBuilder(IREE_LOC)
+             << "Semaphore and value list sizes must match (wait="
+             << wait_semaphores.size() << "/" << wait_values.size()
+             << ", signal=" << signal_semaphores.size() << "/"
+             << signal_values.size() << ")";
+    }
+
+    // Release whatever prior submissions have finished with before adding
+    // more work to the pending list.
+    ReclaimPendingReleases();
+
+    absl::InlinedVector<iree_hal_semaphore_t*, 4> wait_semaphore_ptrs(
+        wait_semaphores.size());
+    absl::InlinedVector<uint64_t, 4> wait_payload_values(wait_values.size());
+    for (int i = 0; i < wait_semaphores.size(); ++i) {
+      wait_semaphore_ptrs[i] = wait_semaphores[i].get();
+      wait_payload_values[i] = wait_values[i];
+    }
+    absl::InlinedVector<iree_hal_command_buffer_t*, 4> command_buffer_ptrs(
+        command_buffers.size());
+    for (int i = 0; i < command_buffers.size(); ++i) {
+      command_buffer_ptrs[i] = command_buffers[i].get();
+      ExDeferRelease(command_buffers[i]);
+    }
+    absl::InlinedVector<iree_hal_semaphore_t*, 4> signal_semaphore_ptrs(
+        signal_semaphores.size());
+    absl::InlinedVector<uint64_t, 4> signal_payload_values(
+        signal_values.size());
+    for (int i = 0; i < signal_semaphores.size(); ++i) {
+      signal_semaphore_ptrs[i] = signal_semaphores[i].get();
+      signal_payload_values[i] = signal_values[i];
+    }
+
+    // Without a signal semaphore from the caller we have nothing to tell us
+    // when the deferred resources are unused so we signal our own.
+    vm::ref<iree_hal_semaphore_t> release_semaphore;
+    uint64_t release_value = 1ull;
+    if (!signal_semaphores.empty()) {
+      release_semaphore = vm::retain_ref(signal_semaphores[0].get());
+      release_value = signal_values[0];
+    } else {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_create(device.get(), 0ull, &release_semaphore));
+      signal_semaphore_ptrs.push_back(release_semaphore.get());
+      signal_payload_values.push_back(release_value);
+    }
+
+    iree_hal_submission_batch_t batch;
+    memset(&batch, 0, sizeof(batch));
+    batch.wait_semaphores.count = wait_semaphore_ptrs.size();
+    batch.wait_semaphores.semaphores = wait_semaphore_ptrs.data();
+    batch.wait_semaphores.payload_values = wait_payload_values.data();
+    batch.command_buffer_count = command_buffer_ptrs.size();
+    batch.command_buffers = command_buffer_ptrs.data();
+    batch.signal_semaphores.count = signal_semaphore_ptrs.size();
+    batch.signal_semaphores.semaphores = signal_semaphore_ptrs.data();
+    batch.signal_semaphores.payload_values = signal_payload_values.data();
+    IREE_RETURN_IF_ERROR(iree_hal_device_queue_submit(
+        device.get(), IREE_HAL_COMMAND_CATEGORY_ANY, 0, 1, &batch));
+
+    pending_releases_.emplace_back();
+    auto& pending = pending_releases_.back();
+    pending.semaphore = std::move(release_semaphore);
+    pending.value = release_value;
+    pending.refs.swap(deferred_releases_);
 
     return OkStatus();
   }
@@ -217,6 +316,14 @@ class HALModuleState final {
     return std::move(buffer);
   }
 
+  // iree_allocator_t free function releasing the byte buffer that backs a
+  // wrapped HAL buffer.
+  static void ReleaseWrappedByteBuffer(void* self, void* ptr) {
+    iree_vm_ref_t source_ref = iree_vm_ro_byte_buffer_move_ref(
+        static_cast<iree_vm_ro_byte_buffer_t*>(self));
+    iree_vm_ref_release(&source_ref);
+  }
+
   StatusOr<vm::ref<iree_hal_buffer_t>> AllocatorWrapByteBuffer(
       const vm::ref<iree_hal_allocator_t>& allocator,
       iree_hal_memory_type_t memory_types, iree_hal_buffer_usage_t buffer_usage,
@@ -224,8 +331,6 @@ class HALModuleState final {
       int32_t length) {
     IREE_TRACE_SCOPE0("HALModuleState::AllocatorWrapByteBuffer");
 
-    // TODO(benvanik): wrap when supported.
-
     buffer_usage |= IREE_HAL_BUFFER_USAGE_MAPPING;
 
     size_t buffer_length = source->data.data_length;
@@ -240,7 +345,37 @@ class HALModuleState final {
              << ")";
     }
 
+    // Try to reference the source data in place. For module rodata this
+    // serves the constants directly out of the (possibly mmapped) module
+    // instead of duplicating them in a new allocation. The source stays
+    // retained until the buffer is destroyed, even if that is after the
+    // context is: bytecode rodata byte buffers are allocated apart from the
+    // module state and retain the module owning the flatbuffer they point
+    // into.
     vm::ref<iree_hal_buffer_t> buffer;
+    if (length > 0) {
+      iree_vm_ref_t source_ref =
+          iree_vm_ro_byte_buffer_retain_ref(source.get());
+      iree_allocator_t source_allocator = {
+          /*self=*/source.get(),
+          /*alloc=*/NULL,
+          /*free=*/ReleaseWrappedByteBuffer,
+      };
+      iree_status_t wrap_status = iree_hal_allocator_wrap_buffer(
+          allocator.get(), memory_types, IREE_HAL_MEMORY_ACCESS_READ,
+          buffer_usage,
+          iree_make_byte_span(
+              const_cast<uint8_t*>(source->data.data + offset), length),
+          source_allocator, &buffer);
+      if (iree_status_is_ok(wrap_status)) {
+        return buffer;
+      }
+      // Allocators that cannot wrap host memory (such as those managing
+      // device-local memory) fall back to a copy.
+      iree_status_ignore(wrap_status);
+      iree_vm_ref_release(&source_ref);
+    }
+
     IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
         allocator.get(), memory_types, buffer_usage, length, &buffer))
         << "Failed to allocate buffer";
@@ -766,6 +901,7 @@ class HALModuleState final {
     iree_status_t status = iree_hal_semaphore_wait_with_deadline(
         semaphore.get(), new_value, IREE_TIME_INFINITE_FUTURE);
     if (iree_status_is_ok(status)) {
+      ReclaimPendingReleases();
       return 0;
     } else if (iree_status_is_deadline_exceeded(status)) {
       // Propagate deadline exceeded back to the VM.
@@ -779,7 +915,38 @@ class HALModuleState final {
   iree_hal_device_t* shared_device_ = NULL;
   iree_hal_executable_cache_t* executable_cache_ = NULL;
 
+  // Releases the resources of all pending submissions whose semaphores have
+  // reached their values (or failed).
+  void ReclaimPendingReleases() {
+    auto it = pending_releases_.begin();
+    while (it != pending_releases_.end()) {
+      uint64_t value = 0ull;
+      iree_status_t status =
+          iree_hal_semaphore_query(it->semaphore.get(), &value);
+      if (iree_status_is_ok(status) && value < it->value) {
+        ++it;
+        continue;
+      }
+      iree_status_ignore(status);
+      for (auto& ref : it->refs) {
+        iree_vm_ref_release(&ref);
+      }
+      it = pending_releases_.erase(it);
+    }
+  }
+
+  // Resources retained by an asynchronous submission until |semaphore|
+  // reaches |value|.
+  struct PendingRelease {
+    vm::ref<iree_hal_semaphore_t> semaphore;
+    uint64_t value = 0ull;
+    std::vector<iree_vm_ref_t> refs;
+  };
+
+  // Resources deferred while recording that are not yet tied to a submission.
   std::vector<iree_vm_ref_t> deferred_releases_;
+  // In-flight submissions in the order they were made.
+  std::vector<PendingRelease> pending_releases_;
 };
 
 //===----------------------------------------------------------------------===//
@@ -788,6 +955,7 @@ class HALModuleState final {
 
 static const vm::NativeFunction<HALModuleState> kHALModuleFunctions[] = {
     vm::MakeNativeFunction("ex.shared_device", &HALModuleState::ExSharedDevice),
+    vm::MakeNativeFunction("ex.submit", &HALModuleState::ExSubmit),
     vm::MakeNativeFunction("ex.submit_and_wait",
                            &HALModuleState::ExSubmitAndWait),
 
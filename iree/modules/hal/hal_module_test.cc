@@ -0,0 +1,485 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests the HAL module functions whose resource lifetimes are not visible to
+// compiled programs: that hal.ex.submit orders work against semaphores and
+// only releases the resources retained while recording once the submission has
+// completed, and that buffers wrapping byte buffers keep them alive.
+
+#include "iree/modules/hal/hal_module.h"
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/base/status.h"
+#include "iree/hal/api.h"
+#include "iree/hal/vmla/registration/driver_module.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/ref_cc.h"
+
+namespace iree {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+// Argument buffer in the VM calling convention used by native functions.
+// Refs are moved into the buffer and ownership passes to the callee.
+class Arguments {
+ public:
+  Arguments& I32(int32_t value) {
+    Append(&value, sizeof(value));
+    return *this;
+  }
+
+  Arguments& Ref(iree_vm_ref_t ref) {
+    Append(&ref, sizeof(ref));
+    return *this;
+  }
+
+  // Begins a variadic span of |count| elements; the elements must follow.
+  Arguments& Span(int32_t count) { return I32(count); }
+
+  iree_byte_span_t data() {
+    return iree_make_byte_span(storage_.data(), storage_.size());
+  }
+
+ private:
+  void Append(const void* value, size_t length) {
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(value);
+    storage_.insert(storage_.end(), bytes, bytes + length);
+  }
+
+  std::vector<uint8_t> storage_;
+};
+
+// Returns the current reference count of |buffer|.
+static int32_t ReadRefCount(iree_hal_buffer_t* buffer) {
+  return iree_atomic_load_int32(
+      (iree_atomic_ref_count_t*)(((uintptr_t)buffer) +
+                                 iree_hal_buffer_get_descriptor()
+                                     ->offsetof_counter),
+      iree_memory_order_seq_cst);
+}
+
+// Returns the current payload value of |semaphore|.
+static uint64_t QuerySemaphore(iree_hal_semaphore_t* semaphore) {
+  uint64_t value = 0ull;
+  IREE_CHECK_OK(iree_hal_semaphore_query(semaphore, &value));
+  return value;
+}
+
+// A heap-allocated byte buffer that records when it is destroyed.
+struct TrackedByteBuffer {
+  iree_vm_ro_byte_buffer_t base;
+  uint8_t contents[16];
+  bool* destroyed;
+
+  static vm::ref<iree_vm_ro_byte_buffer_t> Create(bool* destroyed) {
+    auto* byte_buffer = new TrackedByteBuffer();
+    iree_atomic_ref_count_init(&byte_buffer->base.ref_object.counter);
+    for (size_t i = 0; i < sizeof(byte_buffer->contents); ++i) {
+      byte_buffer->contents[i] = static_cast<uint8_t>(i);
+    }
+    byte_buffer->base.data = iree_make_const_byte_span(
+        byte_buffer->contents, sizeof(byte_buffer->contents));
+    byte_buffer->base.destroy = Destroy;
+    byte_buffer->destroyed = destroyed;
+    *destroyed = false;
+    return vm::assign_ref(&byte_buffer->base);
+  }
+
+  static void Destroy(void* ptr) {
+    auto* byte_buffer = reinterpret_cast<TrackedByteBuffer*>(ptr);
+    *byte_buffer->destroyed = true;
+    delete byte_buffer;
+  }
+};
+
+// An allocator that allocates from a heap allocator but cannot wrap host
+// memory, like allocators managing device-local memory.
+struct NonWrappingAllocator {
+  iree_hal_resource_t resource;
+  iree_hal_allocator_t* heap_allocator;
+
+  static vm::ref<iree_hal_allocator_t> Create() {
+    auto* allocator = new NonWrappingAllocator();
+    iree_hal_resource_initialize(&kVTable, &allocator->resource);
+    IREE_CHECK_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("non_wrapping"), iree_allocator_system(),
+        &allocator->heap_allocator));
+    return vm::assign_ref(reinterpret_cast<iree_hal_allocator_t*>(allocator));
+  }
+
+  static NonWrappingAllocator* Cast(const iree_hal_allocator_t* allocator) {
+    return reinterpret_cast<NonWrappingAllocator*>(
+        const_cast<iree_hal_allocator_t*>(allocator));
+  }
+
+  static void Destroy(iree_hal_allocator_t* allocator) {
+    iree_hal_allocator_release(Cast(allocator)->heap_allocator);
+    delete Cast(allocator);
+  }
+
+  static iree_allocator_t HostAllocator(const iree_hal_allocator_t* allocator) {
+    return iree_hal_allocator_host_allocator(Cast(allocator)->heap_allocator);
+  }
+
+  static iree_hal_buffer_compatibility_t QueryBufferCompatibility(
+      iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
+      iree_hal_buffer_usage_t allowed_usage,
+      iree_hal_buffer_usage_t intended_usage,
+      iree_device_size_t allocation_size) {
+    return iree_hal_allocator_query_buffer_compatibility(
+        Cast(allocator)->heap_allocator, memory_type, allowed_usage,
+        intended_usage, allocation_size);
+  }
+
+  static iree_status_t AllocateBuffer(iree_hal_allocator_t* allocator,
+                                      iree_hal_memory_type_t memory_type,
+                                      iree_hal_buffer_usage_t allowed_usage,
+                                      iree_host_size_t allocation_size,
+                                      iree_hal_buffer_t** out_buffer) {
+    return iree_hal_allocator_allocate_buffer(Cast(allocator)->heap_allocator,
+                                              memory_type, allowed_usage,
+                                              allocation_size, out_buffer);
+  }
+
+  static iree_status_t WrapBuffer(iree_hal_allocator_t* allocator,
+                                  iree_hal_memory_type_t memory_type,
+                                  iree_hal_memory_access_t allowed_access,
+                                  iree_hal_buffer_usage_t allowed_usage,
+                                  iree_byte_span_t data,
+                                  iree_allocator_t data_allocator,
+                                  iree_hal_buffer_t** out_buffer) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "wrapping host memory is not supported");
+  }
+
+  static const iree_hal_allocator_vtable_t kVTable;
+};
+const iree_hal_allocator_vtable_t NonWrappingAllocator::kVTable = {
+    /*.destroy=*/NonWrappingAllocator::Destroy,
+    /*.host_allocator=*/NonWrappingAllocator::HostAllocator,
+    /*.query_statistics=*/nullptr,
+    /*.query_buffer_compatibility=*/
+    NonWrappingAllocator::QueryBufferCompatibility,
+    /*.allocate_buffer=*/NonWrappingAllocator::AllocateBuffer,
+    /*.wrap_buffer=*/NonWrappingAllocator::WrapBuffer,
+};
+
+class HALModuleTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+    IREE_CHECK_OK(iree_hal_vmla_driver_module_register(
+        iree_hal_driver_registry_default()));
+    // TODO(benvanik): move to instance-based registration.
+    IREE_ASSERT_OK(iree_hal_module_register_types());
+
+    iree_hal_driver_t* hal_driver = nullptr;
+    IREE_ASSERT_OK(iree_hal_driver_registry_try_create_by_name(
+        iree_hal_driver_registry_default(), iree_make_cstring_view("vmla"),
+        iree_allocator_system(), &hal_driver));
+    IREE_ASSERT_OK(iree_hal_driver_create_default_device(
+        hal_driver, iree_allocator_system(), &device_));
+    IREE_ASSERT_OK(
+        iree_hal_module_create(device_, iree_allocator_system(), &hal_module_));
+    iree_hal_driver_release(hal_driver);
+
+    IREE_ASSERT_OK(
+        iree_vm_instance_create(iree_allocator_system(), &instance_));
+  }
+
+  static void TearDownTestSuite() {
+    iree_hal_device_release(device_);
+    iree_vm_module_release(hal_module_);
+    iree_vm_instance_release(instance_);
+  }
+
+  void SetUp() override {
+    std::vector<iree_vm_module_t*> modules = {hal_module_};
+    IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+        instance_, modules.data(), modules.size(), iree_allocator_system(),
+        &context_));
+  }
+
+  void TearDown() override { iree_vm_context_release(context_); }
+
+  // Calls the native HAL module function |function_name| with |arguments|.
+  // |results| must be large enough to hold the results of the function.
+  Status Call(const char* function_name, Arguments* arguments,
+              iree_byte_span_t results = iree_make_byte_span(nullptr, 0)) {
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(hal_module_->lookup_function(
+        hal_module_->self, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_make_cstring_view(function_name), &function))
+        << "Exported function '" << function_name << "' not found";
+    // TODO(#2075): don't directly invoke native functions like this.
+    // iree_vm_invoke does not yet support the variadic arguments ex.submit
+    // takes so we marshal the call ourselves. The callee takes ownership of
+    // the refs in |arguments| as it unpacks them.
+    iree_vm_function_call_t call;
+    memset(&call, 0, sizeof(call));
+    call.function = function;
+    call.arguments = arguments->data();
+    call.results = results;
+    iree_vm_execution_result_t result;
+    memset(&result, 0, sizeof(result));
+    IREE_VM_INLINE_STACK_INITIALIZE(
+        stack, iree_vm_context_state_resolver(context_),
+        iree_allocator_system());
+    iree_status_t status = function.module->begin_call(function.module->self,
+                                                       stack, &call, &result);
+    iree_vm_stack_deinitialize(stack);
+    return status;
+  }
+
+  // Allocates a host-visible buffer of |length| bytes.
+  vm::ref<iree_hal_buffer_t> AllocateBuffer(iree_device_size_t length) {
+    vm::ref<iree_hal_buffer_t> buffer;
+    IREE_CHECK_OK(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(device_),
+        static_cast<iree_hal_memory_type_t>(
+            IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+            IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE),
+        IREE_HAL_BUFFER_USAGE_ALL, length, &buffer));
+    return buffer;
+  }
+
+  // Records a command buffer that fills |buffer| with |pattern| through the
+  // module so that the module retains |buffer| until the work completes.
+  vm::ref<iree_hal_command_buffer_t> RecordFill(iree_hal_buffer_t* buffer,
+                                                uint32_t pattern) {
+    vm::ref<iree_hal_command_buffer_t> command_buffer;
+    IREE_CHECK_OK(iree_hal_command_buffer_create(
+        device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_ANY, &command_buffer));
+    IREE_CHECK_OK(iree_hal_command_buffer_begin(command_buffer.get()));
+    Arguments arguments;
+    arguments.Ref(iree_hal_command_buffer_retain_ref(command_buffer.get()))
+        .Ref(iree_hal_buffer_retain_ref(buffer))
+        .I32(0)
+        .I32(static_cast<int32_t>(iree_hal_buffer_byte_length(buffer)))
+        .I32(static_cast<int32_t>(pattern));
+    IREE_CHECK_OK(Call("command_buffer.fill_buffer", &arguments));
+    IREE_CHECK_OK(iree_hal_command_buffer_end(command_buffer.get()));
+    return command_buffer;
+  }
+
+  // Calls hal.allocator.wrap.byte_buffer on the bytes [4, 12) of |source|.
+  vm::ref<iree_hal_buffer_t> WrapByteBuffer(iree_hal_allocator_t* allocator,
+                                            iree_vm_ro_byte_buffer_t* source) {
+    Arguments arguments;
+    arguments.Ref(iree_hal_allocator_retain_ref(allocator))
+        .I32(IREE_HAL_MEMORY_TYPE_HOST_LOCAL |
+             IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE)
+        .I32(IREE_HAL_BUFFER_USAGE_ALL)
+        .Ref(iree_vm_ro_byte_buffer_retain_ref(source))
+        .I32(4)
+        .I32(8);
+    iree_vm_ref_t result = {0};
+    IREE_CHECK_OK(Call("allocator.wrap.byte_buffer", &arguments,
+                       iree_make_byte_span(&result, sizeof(result))));
+    iree_hal_buffer_t* buffer = nullptr;
+    IREE_CHECK_OK(iree_hal_buffer_check_deref(&result, &buffer));
+    return vm::assign_ref(buffer);
+  }
+
+  // Maps all of |buffer| for reading and returns its host pointer.
+  const uint8_t* MapContents(iree_hal_buffer_t* buffer) {
+    iree_hal_buffer_mapping_t mapping;
+    IREE_CHECK_OK(iree_hal_buffer_map_range(buffer, IREE_HAL_MEMORY_ACCESS_READ,
+                                            0, IREE_WHOLE_BUFFER, &mapping));
+    const uint8_t* contents = mapping.contents.data;
+    iree_hal_buffer_unmap_range(&mapping);
+    return contents;
+  }
+
+  // Reads back the first 32-bit word of |buffer|.
+  uint32_t ReadWord(iree_hal_buffer_t* buffer) {
+    uint32_t value = 0;
+    IREE_CHECK_OK(iree_hal_buffer_read_data(buffer, 0, &value, sizeof(value)));
+    return value;
+  }
+
+  static iree_hal_device_t* device_;
+  static iree_vm_instance_t* instance_;
+  static iree_vm_module_t* hal_module_;
+
+  iree_vm_context_t* context_ = nullptr;
+};
+iree_hal_device_t* HALModuleTest::device_ = nullptr;
+iree_vm_instance_t* HALModuleTest::instance_ = nullptr;
+iree_vm_module_t* HALModuleTest::hal_module_ = nullptr;
+
+// Submits work that waits on one semaphore and signals another and verifies
+// the work and the release of its resources follow the semaphores.
+TEST_F(HALModuleTest, SubmitWaitsAndSignals) {
+  vm::ref<iree_hal_semaphore_t> wait_semaphore;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &wait_semaphore));
+  vm::ref<iree_hal_semaphore_t> signal_semaphore;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &signal_semaphore));
+
+  auto buffer = AllocateBuffer(16);
+  IREE_ASSERT_OK(iree_hal_buffer_fill(buffer.get(), 0, IREE_WHOLE_BUFFER,
+                                      "\0\0\0\0", 4));
+  auto command_buffer = RecordFill(buffer.get(), 0xCAFEF00Du);
+  EXPECT_EQ(2, ReadRefCount(buffer.get()));
+
+  Arguments arguments;
+  arguments.Ref(iree_hal_device_retain_ref(device_))
+      .Span(1)
+      .Ref(iree_hal_semaphore_retain_ref(wait_semaphore.get()))
+      .Span(1)
+      .I32(1)
+      .Span(1)
+      .Ref(iree_hal_command_buffer_retain_ref(command_buffer.get()))
+      .Span(1)
+      .Ref(iree_hal_semaphore_retain_ref(signal_semaphore.get()))
+      .Span(1)
+      .I32(1);
+  IREE_ASSERT_OK(Call("ex.submit", &arguments));
+
+  // Nothing may run until the wait semaphore is signaled and the buffer must
+  // remain retained by the module while the submission is pending.
+  EXPECT_EQ(0ull, QuerySemaphore(signal_semaphore.get()));
+  EXPECT_EQ(2, ReadRefCount(buffer.get()));
+  EXPECT_EQ(0u, ReadWord(buffer.get()));
+
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(wait_semaphore.get(), 1ull));
+
+  // Awaiting through the module blocks until the work completes and then
+  // reclaims the resources of all completed submissions.
+  Arguments await_arguments;
+  await_arguments.Ref(iree_hal_semaphore_retain_ref(signal_semaphore.get()))
+      .I32(1);
+  int32_t await_result = -1;
+  IREE_ASSERT_OK(Call("semaphore.await", &await_arguments,
+                      iree_make_byte_span(&await_result,
+                                          sizeof(await_result))));
+  EXPECT_EQ(0, await_result);
+  EXPECT_EQ(1ull, QuerySemaphore(signal_semaphore.get()));
+  EXPECT_EQ(0xCAFEF00Du, ReadWord(buffer.get()));
+  EXPECT_EQ(1, ReadRefCount(buffer.get()));
+}
+
+// Submits work without a signal semaphore; the module signals its own to track
+// completion and releases the resources on a later submission.
+TEST_F(HALModuleTest, SubmitWithoutSignalReclaimsOnNextSubmit) {
+  auto buffer = AllocateBuffer(16);
+  auto command_buffer = RecordFill(buffer.get(), 0x12345678u);
+  EXPECT_EQ(2, ReadRefCount(buffer.get()));
+
+  Arguments arguments;
+  arguments.Ref(iree_hal_device_retain_ref(device_))
+      .Span(0)
+      .Span(0)
+      .Span(1)
+      .Ref(iree_hal_command_buffer_retain_ref(command_buffer.get()))
+      .Span(0)
+      .Span(0);
+  IREE_ASSERT_OK(Call("ex.submit", &arguments));
+
+  IREE_ASSERT_OK(iree_hal_device_wait_idle_with_deadline(
+      device_, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(0x12345678u, ReadWord(buffer.get()));
+  // Nothing has asked the module to reclaim yet.
+  EXPECT_EQ(2, ReadRefCount(buffer.get()));
+
+  // An empty submission reclaims everything prior submissions have finished.
+  Arguments empty_arguments;
+  empty_arguments.Ref(iree_hal_device_retain_ref(device_))
+      .Span(0)
+      .Span(0)
+      .Span(0)
+      .Span(0)
+      .Span(0);
+  IREE_ASSERT_OK(Call("ex.submit", &empty_arguments));
+  EXPECT_EQ(1, ReadRefCount(buffer.get()));
+}
+
+// Mismatched semaphore and value lists are rejected without leaking.
+TEST_F(HALModuleTest, SubmitRejectsMismatchedValues) {
+  vm::ref<iree_hal_semaphore_t> semaphore;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(device_, 0ull, &semaphore));
+
+  Arguments arguments;
+  arguments.Ref(iree_hal_device_retain_ref(device_))
+      .Span(1)
+      .Ref(iree_hal_semaphore_retain_ref(semaphore.get()))
+      .Span(0)
+      .Span(0)
+      .Span(0)
+      .Span(0);
+  EXPECT_THAT(Call("ex.submit", &arguments),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(0ull, QuerySemaphore(semaphore.get()));
+}
+
+// Wrapping a byte buffer with an allocator that can access host memory
+// references the bytes in place and keeps the byte buffer alive.
+TEST_F(HALModuleTest, WrapByteBufferInPlace) {
+  bool destroyed = false;
+  auto source = TrackedByteBuffer::Create(&destroyed);
+  auto buffer =
+      WrapByteBuffer(iree_hal_device_allocator(device_), source.get());
+  EXPECT_EQ(8, iree_hal_buffer_byte_length(buffer.get()));
+  EXPECT_EQ(source->data.data + 4, MapContents(buffer.get()));
+  EXPECT_EQ(0x07060504u, ReadWord(buffer.get()));
+
+  source.reset();
+  EXPECT_FALSE(destroyed);
+  buffer.reset();
+  EXPECT_TRUE(destroyed);
+}
+
+// Allocators that cannot wrap host memory get a copy that does not retain the
+// byte buffer.
+TEST_F(HALModuleTest, WrapByteBufferCopiesWithoutHostWrapping) {
+  auto allocator = NonWrappingAllocator::Create();
+  bool destroyed = false;
+  auto source = TrackedByteBuffer::Create(&destroyed);
+  auto buffer = WrapByteBuffer(allocator.get(), source.get());
+  EXPECT_EQ(8, iree_hal_buffer_byte_length(buffer.get()));
+  EXPECT_NE(source->data.data + 4, MapContents(buffer.get()));
+  EXPECT_EQ(0x07060504u, ReadWord(buffer.get()));
+
+  source.reset();
+  EXPECT_TRUE(destroyed);
+  EXPECT_EQ(0x07060504u, ReadWord(buffer.get()));
+}
+
+// Buffers wrapping a byte buffer in place may outlive the context that
+// created them.
+TEST_F(HALModuleTest, WrapByteBufferOutlivesContext) {
+  bool destroyed = false;
+  auto source = TrackedByteBuffer::Create(&destroyed);
+  auto buffer =
+      WrapByteBuffer(iree_hal_device_allocator(device_), source.get());
+  source.reset();
+
+  iree_vm_context_release(context_);
+  context_ = nullptr;
+  EXPECT_FALSE(destroyed);
+  EXPECT_EQ(0x07060504u, ReadWord(buffer.get()));
+
+  buffer.reset();
+  EXPECT_TRUE(destroyed);
+}
+
+}  // namespace
+}  // namespace iree
@@ -33,20 +33,20 @@ iree_status_t iree_task_executor_create(
         IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
   }
 
-  // TODO(benvanik): support a threadless mode where we have one dummy worker
-  // that just holds the lists but is pumped from donate_caller.
-  if (worker_count == 0) {
-    return iree_make_status(
-        IREE_STATUS_UNIMPLEMENTED,
-        "threadless donate-only executor mode not yet implemented");
-  }
+  // A topology with no groups creates a threadless executor. We still have one
+  // dummy worker that holds the task lists but it has no thread of its own and
+  // is instead pumped inline by threads flushing or donating to the executor.
+  bool threadless = worker_count == 0;
+  if (threadless) worker_count = 1;
 
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
+  // NOTE: there's at most one dispatch task pool per worker.
   iree_host_size_t executor_size =
-      sizeof(iree_task_executor_t) + worker_count * sizeof(iree_task_worker_t);
+      sizeof(iree_task_executor_t) + worker_count * sizeof(iree_task_worker_t) +
+      worker_count * sizeof(iree_task_pool_t);
 
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -55,10 +55,16 @@ iree_status_t iree_task_executor_create(
   iree_atomic_ref_count_init(&executor->ref_count);
   executor->allocator = allocator;
   executor->scheduling_mode = scheduling_mode;
+  executor->threadless = threadless;
+  iree_atomic_store_int64(&executor->worker_spin_ns,
+                          IREE_TASK_EXECUTOR_DEFAULT_WORKER_SPIN_NS,
+                          iree_memory_order_relaxed);
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
   iree_atomic_task_slist_initialize(&executor->incoming_waiting_slist);
   iree_slim_mutex_initialize(&executor->coordinator_mutex);
   iree_slim_mutex_initialize(&executor->wait_mutex);
+  iree_slim_mutex_initialize(&executor->inline_pump_mutex);
+  iree_notification_group_initialize(&executor->worker_wake_group);
 
   // Simple PRNG used to generate seeds for the per-worker PRNGs used to
   // distribute work. This isn't strong (and doesn't need to be); it's just
@@ -69,8 +75,6 @@ iree_status_t iree_task_executor_create(
   iree_prng_splitmix64_state_t seed_prng;
   iree_prng_splitmix64_initialize(/*seed=*/(uint64_t)(out_executor),
                                   &seed_prng);
-  iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(&seed_prng),
-                                  &executor->donation_theft_prng);
 
   iree_status_t status = iree_ok_status();
 
@@ -82,29 +86,74 @@ iree_status_t iree_task_executor_create(
                                     allocator, &executor->wait_set);
   }
 
-  // Pool used for all dispatch->slice fanout tasks. These only live within the
-  // executor and since we know the precise lifetime of them we can keep them
-  // entirely within the system here.
+  // Pools used for fences and all dispatch->slice/shard fanout tasks. These
+  // only live within the executor and since we know the precise lifetime of
+  // them we can keep them entirely within the system here.
   if (iree_status_is_ok(status)) {
     status = iree_task_pool_initialize(allocator, sizeof(iree_task_fence_t), 8,
                                        &executor->fence_task_pool);
   }
-  if (iree_status_is_ok(status)) {
+
+  // Assign each worker the dispatch task pool of its NUMA node and the set of
+  // workers on the same node that it should prefer stealing from. Workers with
+  // an unknown node (including the dummy threadless worker) are considered to
+  // be on the same node as all others.
+  executor->workers = (iree_task_worker_t*)(executor + 1);
+  executor->dispatch_task_pools =
+      (iree_task_pool_t*)(executor->workers + worker_count);
+  uint32_t worker_numa_nodes[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  iree_host_size_t worker_pool_indices[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  iree_task_affinity_set_t worker_local_node_masks
+      [IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  for (iree_host_size_t i = 0; i < worker_count; ++i) {
+    worker_numa_nodes[i] =
+        threadless ? IREE_TASK_TOPOLOGY_NUMA_NODE_ANY
+                   : iree_task_topology_get_group(topology, i)->numa_node;
+  }
+  uint32_t pool_numa_nodes[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  iree_host_size_t pool_worker_counts[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
+  iree_host_size_t pool_count = 0;
+  for (iree_host_size_t i = 0; i < worker_count; ++i) {
+    worker_local_node_masks[i] = 0;
+    for (iree_host_size_t j = 0; j < worker_count; ++j) {
+      if (worker_numa_nodes[i] == IREE_TASK_TOPOLOGY_NUMA_NODE_ANY ||
+          worker_numa_nodes[j] == IREE_TASK_TOPOLOGY_NUMA_NODE_ANY ||
+          worker_numa_nodes[i] == worker_numa_nodes[j]) {
+        worker_local_node_masks[i] |= iree_task_affinity_for_worker(j);
+      }
+    }
+    iree_host_size_t pool_index = 0;
+    while (pool_index < pool_count &&
+           pool_numa_nodes[pool_index] != worker_numa_nodes[i]) {
+      ++pool_index;
+    }
+    if (pool_index == pool_count) {
+      pool_numa_nodes[pool_index] = worker_numa_nodes[i];
+      pool_worker_counts[pool_index] = 0;
+      ++pool_count;
+    }
+    ++pool_worker_counts[pool_index];
+    worker_pool_indices[i] = pool_index;
+  }
+  // Only pools that were successfully initialized are counted so that destroy
+  // does not deinitialize the remainder if we fail partway through.
+  for (iree_host_size_t i = 0; i < pool_count && iree_status_is_ok(status);
+       ++i) {
     status = iree_task_pool_initialize(
-        allocator,
+        iree_task_topology_numa_node_allocator(pool_numa_nodes[i], allocator),
         iree_max(sizeof(iree_task_dispatch_shard_t),
                  sizeof(iree_task_dispatch_slice_t)),
-        worker_count *
+        pool_worker_counts[i] *
             iree_max(IREE_TASK_EXECUTOR_INITIAL_SHARD_RESERVATION_PER_WORKER,
                      IREE_TASK_EXECUTOR_INITIAL_SLICE_RESERVATION_PER_WORKER),
-        &executor->dispatch_task_pool);
+        &executor->dispatch_task_pools[i]);
+    if (iree_status_is_ok(status)) ++executor->dispatch_task_pool_count;
   }
 
   // Bring up the workers; the threads will be created here but be suspended
   // (if the platform supports it) awaiting the first tasks getting scheduled.
   if (iree_status_is_ok(status)) {
     executor->worker_count = worker_count;
-    executor->workers = (iree_task_worker_t*)(executor + 1);
     iree_task_affinity_set_t worker_idle_mask = 0;
     iree_task_affinity_set_t worker_live_mask = 0;
     iree_task_affinity_set_t worker_suspend_mask = 0;
@@ -112,14 +161,25 @@ iree_status_t iree_task_executor_create(
       iree_task_affinity_set_t worker_bit = iree_task_affinity_for_worker(i);
       worker_idle_mask |= worker_bit;
       worker_live_mask |= worker_bit;
-      if (executor->scheduling_mode &
-          IREE_TASK_SCHEDULING_MODE_DEFER_WORKER_STARTUP) {
+      if (!executor->threadless &&
+          (executor->scheduling_mode &
+           IREE_TASK_SCHEDULING_MODE_DEFER_WORKER_STARTUP)) {
         worker_suspend_mask |= worker_bit;
       }
 
+      iree_task_topology_group_t threadless_group;
+      const iree_task_topology_group_t* group = NULL;
+      if (executor->threadless) {
+        iree_task_topology_group_initialize(i, &threadless_group);
+        group = &threadless_group;
+      } else {
+        group = iree_task_topology_get_group(topology, i);
+      }
+
       iree_task_worker_t* worker = &executor->workers[i];
       status = iree_task_worker_initialize(
-          executor, i, iree_task_topology_get_group(topology, i), &seed_prng,
+          executor, i, group, worker_local_node_masks[i],
+          &executor->dispatch_task_pools[worker_pool_indices[i]], &seed_prng,
           worker);
       if (!iree_status_is_ok(status)) break;
     }
@@ -166,13 +226,17 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
     iree_task_worker_deinitialize(worker);
   }
 
+  iree_notification_group_deinitialize(&executor->worker_wake_group);
   iree_wait_set_free(executor->wait_set);
+  iree_slim_mutex_deinitialize(&executor->inline_pump_mutex);
   iree_slim_mutex_deinitialize(&executor->wait_mutex);
   iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
   iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
   iree_atomic_task_slist_deinitialize(&executor->incoming_waiting_slist);
   iree_task_pool_deinitialize(&executor->fence_task_pool);
-  iree_task_pool_deinitialize(&executor->dispatch_task_pool);
+  for (iree_host_size_t i = 0; i < executor->dispatch_task_pool_count; ++i) {
+    iree_task_pool_deinitialize(&executor->dispatch_task_pools[i]);
+  }
   iree_allocator_free(executor->allocator, executor);
 
   IREE_TRACE_ZONE_END(z0);
@@ -203,6 +267,12 @@ iree_status_t iree_task_executor_acquire_fence(iree_task_executor_t* executor,
   return iree_ok_status();
 }
 
+void iree_task_executor_set_worker_spin_ns(iree_task_executor_t* executor,
+                                           iree_duration_t spin_ns) {
+  iree_atomic_store_int64(&executor->worker_spin_ns, iree_max(0, spin_ns),
+                          iree_memory_order_relaxed);
+}
+
 // Schedules a generic task to a worker matching its affinity.
 // The task will be posted to the worker mailbox and available for the worker to
 // begin processing as soon as the |post_batch| is submitted.
@@ -216,6 +286,31 @@ static void iree_task_executor_relay_to_worker(
   iree_task_post_batch_enqueue(post_batch, worker_index, task);
 }
 
+// Returns the timing entry tracking dispatches with |timing_key| or NULL if
+// the dispatch is not measured. Keys that map to the same entry evict each
+// other: the entry is reset when claimed by a different key. Shards and slices
+// of an evicted key that are still in-flight may fold their samples into the
+// new key's estimate but that only perturbs a single scheduling decision.
+static iree_task_dispatch_timing_t* iree_task_executor_lookup_dispatch_timing(
+    iree_task_executor_t* executor, uint64_t timing_key) {
+  if (!timing_key) return NULL;
+  // Fibonacci hashing to spread keys that differ only in a few bits (such as
+  // the entry point ordinals of the same executable) across the table.
+  uint64_t hash = timing_key * 0x9E3779B97F4A7C15ull;
+  iree_host_size_t index =
+      (iree_host_size_t)(hash >> 32) &
+      (IREE_TASK_EXECUTOR_DISPATCH_TIMING_CAPACITY - 1);
+  iree_task_dispatch_timing_t* timing = &executor->dispatch_timings[index];
+  if (iree_atomic_load_int64(&timing->key, iree_memory_order_relaxed) !=
+      (int64_t)timing_key) {
+    iree_atomic_store_int64(&timing->tile_duration_ns, 0,
+                            iree_memory_order_relaxed);
+    iree_atomic_store_int64(&timing->key, (int64_t)timing_key,
+                            iree_memory_order_relaxed);
+  }
+  return timing;
+}
+
 // Schedules all ready tasks in the |pending_submission| list.
 // Task may enqueue zero or more new tasks (or newly-ready/waiting tasks) to
 // |pending_submission| or queue work for posting to workers via the
@@ -275,13 +370,15 @@ void iree_task_executor_schedule_ready_tasks(
           iree_task_dispatch_retire((iree_task_dispatch_t*)task,
                                     pending_submission);
         } else {
+          iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+          iree_task_dispatch_timing_t* timing =
+              iree_task_executor_lookup_dispatch_timing(
+                  executor, dispatch_task->timing_key);
           if (task->flags & IREE_TASK_FLAG_DISPATCH_SLICED) {
-            iree_task_dispatch_issue_sliced((iree_task_dispatch_t*)task,
-                                            &executor->dispatch_task_pool,
+            iree_task_dispatch_issue_sliced(dispatch_task, timing,
                                             pending_submission, post_batch);
           } else {
-            iree_task_dispatch_issue_sharded((iree_task_dispatch_t*)task,
-                                             &executor->dispatch_task_pool,
+            iree_task_dispatch_issue_sharded(dispatch_task, timing,
                                              pending_submission, post_batch);
           }
         }
@@ -321,14 +418,42 @@ void iree_task_executor_submit(iree_task_executor_t* executor,
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Runs all ready tasks inline on the calling thread by acting as both the
+// coordinator and the sole worker of a threadless executor. Returns true if any
+// tasks were executed. Waiting tasks are only polled and the caller is never
+// blocked on them.
+//
+// Expects the inline_pump_mutex to be held by the caller.
+static bool iree_task_executor_run_inline(iree_task_executor_t* executor) {
+  iree_task_worker_t* worker = &executor->workers[0];
+  bool did_work = false;
+  while (true) {
+    // Coordinating as the worker routes all ready tasks directly into its local
+    // queue; any tasks readied by execution are picked up on the next pass.
+    iree_task_executor_coordinate(executor, worker, /*wait_on_idle=*/false);
+    if (!iree_task_worker_pump_inline(worker)) break;
+    did_work = true;
+  }
+  return did_work;
+}
+
 void iree_task_executor_flush(iree_task_executor_t* executor) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Mostly a no-op today as we aren't deferring submission with the scheduling
-  // mode. Instead, we'll just run the coordinator inline to ensure all tasks
-  // are pushed to workers.
-  iree_task_executor_coordinate(executor, /*current_worker=*/NULL,
-                                /*wait_on_idle=*/false);
+  if (executor->threadless) {
+    // No workers to hand the tasks off to; run them on the caller. If another
+    // thread is pumping we wait for it to finish running what is ready (which
+    // will not block on waits) and then run anything it missed.
+    iree_slim_mutex_lock(&executor->inline_pump_mutex);
+    iree_task_executor_run_inline(executor);
+    iree_slim_mutex_unlock(&executor->inline_pump_mutex);
+  } else {
+    // Mostly a no-op today as we aren't deferring submission with the
+    // scheduling mode. Instead, we'll just run the coordinator inline to ensure
+    // all tasks are pushed to workers.
+    iree_task_executor_coordinate(executor, /*current_worker=*/NULL,
+                                  /*wait_on_idle=*/false);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -687,7 +812,8 @@ static iree_task_t* iree_task_executor_try_steal_task_from_affinity_set(
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t local_node_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -711,30 +837,256 @@ iree_task_t* iree_task_executor_try_steal_task(
   // helps to prevent cache invalidations/availability updates as it's likely
   // that we won't need to go back to main memory (or higher cache tiers) in the
   // event that the thief and victim are running close to each other in time.
+  // Caches are never shared across NUMA nodes but topologies without cache
+  // information default to sharing with all groups so we mask to be sure.
+  iree_task_affinity_set_t local_victim_mask = victim_mask & local_node_mask;
   iree_task_t* task = iree_task_executor_try_steal_task_from_affinity_set(
-      executor, victim_mask & constructive_sharing_mask, max_theft_attempts,
-      rotation_offset, local_task_queue);
+      executor, local_victim_mask & constructive_sharing_mask,
+      max_theft_attempts, rotation_offset, local_task_queue);
   if (task) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "local");
   } else {
+    // Then with the remaining workers on the same NUMA node. Their tasks and
+    // the memory they touch are likely on our node and cheaper to reach than
+    // those of workers on remote nodes.
     task = iree_task_executor_try_steal_task_from_affinity_set(
-        executor, victim_mask & ~constructive_sharing_mask, max_theft_attempts,
-        rotation_offset, local_task_queue);
+        executor, local_victim_mask & ~constructive_sharing_mask,
+        max_theft_attempts, rotation_offset, local_task_queue);
     if (task) {
       IREE_TRACE_ZONE_APPEND_TEXT(z0, "non-local");
     }
   }
+  if (!task) {
+    // Last resort: the remote nodes. Better to pay for remote memory access
+    // than to leave the worker idle while there's work to do.
+    task = iree_task_executor_try_steal_task_from_affinity_set(
+        executor, victim_mask & ~local_node_mask, max_theft_attempts,
+        rotation_offset, local_task_queue);
+    if (task) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "remote");
+    }
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return task;
 }
 
+// Returns any tasks the donated caller stole but did not get to back to the
+// workers. This happens when the wait resolves while the caller still has tasks
+// queued; we don't want to hold the caller hostage to run unrelated work.
+static void iree_task_executor_relinquish_donated_tasks(
+    iree_task_executor_t* executor, iree_task_queue_t* donation_queue) {
+  iree_task_post_batch_t* post_batch =
+      iree_alloca(sizeof(iree_task_post_batch_t) +
+                  executor->worker_count * sizeof(iree_task_list_t));
+  iree_task_post_batch_initialize(executor, /*current_worker=*/NULL,
+                                  post_batch);
+  iree_task_t* task = NULL;
+  while ((task = iree_task_queue_pop_front(donation_queue))) {
+    iree_task_executor_relay_to_worker(executor, post_batch, task);
+  }
+  iree_task_post_batch_submit(post_batch);
+}
+
+// Pumps tasks on the calling thread until |wait_handle| resolves or there is
+// no more work that can be stolen. Returns OK if the wait resolved,
+// DEADLINE_EXCEEDED if it did not resolve before the caller ran out of work (or
+// |deadline_ns| elapsed), and any other status if the wait failed.
+//
+// The caller acts like a worker without a mailbox: it first runs coordination
+// so that any tasks pending submission are posted and then steals from the
+// workers. Unlike workers we steal from any live worker (including idle ones)
+// as the tasks we're most interested in are the ones just posted to workers
+// that have yet to wake up.
+static iree_status_t iree_task_executor_pump_donated(
+    iree_task_executor_t* executor, iree_wait_handle_t* wait_handle,
+    iree_time_t deadline_ns, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_queue_t* donation_queue, int* out_executed_count) {
+  *out_executed_count = 0;
+  while (true) {
+    // Always check the wait first so that we return as soon as possible once
+    // the work the caller cares about has completed.
+    iree_status_t status = iree_wait_one(wait_handle, IREE_TIME_INFINITE_PAST);
+    if (!iree_status_is_deadline_exceeded(status)) return status;
+    iree_status_ignore(status);
+    if (deadline_ns != IREE_TIME_INFINITE_FUTURE &&
+        iree_time_now() >= deadline_ns) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+
+    iree_task_t* task = iree_task_queue_pop_front(donation_queue);
+    if (!task) {
+      // Schedule anything pending so that it's available for theft. Any work
+      // we produced on the previous iteration is picked up here as well.
+      iree_task_executor_coordinate(executor, /*current_worker=*/NULL,
+                                    /*wait_on_idle=*/false);
+      iree_task_affinity_set_t victim_mask = iree_atomic_task_affinity_set_load(
+          &executor->worker_live_mask, iree_memory_order_relaxed);
+      int rotation_offset = iree_prng_minilcg128_next_uint8(theft_prng) &
+                            (8 * sizeof(iree_task_affinity_set_t) - 1);
+      task = iree_task_executor_try_steal_task_from_affinity_set(
+          executor, victim_mask, /*max_theft_attempts=*/executor->worker_count,
+          rotation_offset, donation_queue);
+    }
+    if (!task) {
+      // No work available; the caller will need to wait.
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+
+    iree_task_submission_t pending_submission;
+    iree_task_submission_initialize(&pending_submission);
+    status = iree_task_execute_scheduled(task, &pending_submission);
+
+    // TODO(#4026): propagate failure to task scope.
+    // As with workers we drop the error on the floor; it should have already
+    // been propagated to the scope.
+    IREE_ASSERT_TRUE(iree_status_is_ok(status));
+    iree_status_ignore(status);
+    ++*out_executed_count;
+
+    // Hand off any newly-ready tasks; they'll be scheduled when we (or a
+    // worker) next coordinate.
+    if (!iree_task_submission_is_empty(&pending_submission)) {
+      iree_task_executor_merge_submission(executor, &pending_submission);
+    }
+  }
+}
+
+// Blocks a donated caller on |wait_handle| when it has no work it can run
+// itself. The wait is limited to IREE_TASK_EXECUTOR_DONATE_WAIT_SLICE_NS so
+// that the caller can retry running work in case its dependencies became ready
+// without anyone else picking them up. Returns OK if the wait resolved or the
+// slice elapsed without the wait resolving.
+static iree_status_t iree_task_executor_wait_slice(
+    iree_wait_handle_t* wait_handle, iree_time_t deadline_ns) {
+  iree_time_t slice_deadline_ns =
+      iree_time_now() + IREE_TASK_EXECUTOR_DONATE_WAIT_SLICE_NS;
+  if (deadline_ns <= slice_deadline_ns) {
+    return iree_wait_one(wait_handle, deadline_ns);
+  }
+  iree_status_t status = iree_wait_one(wait_handle, slice_deadline_ns);
+  if (iree_status_is_deadline_exceeded(status)) {
+    iree_status_ignore(status);
+    return iree_ok_status();
+  }
+  return status;
+}
+
+// Blocks the caller of a threadless executor until either |wait_handle| or any
+// of the executor waiting tasks resolve or |deadline_ns| elapses. There is no
+// one else to perform the waits so we fold the caller handle into the executor
+// wait set and let the next coordination pass pick up whichever woke. If
+// another thread is already waiting on the executor it will wake when the
+// waiting tasks resolve and we only wait on our own handle.
+static iree_status_t iree_task_executor_wait_inline(
+    iree_task_executor_t* executor, iree_wait_handle_t* wait_handle,
+    iree_time_t deadline_ns) {
+  if (!iree_slim_mutex_try_lock(&executor->wait_mutex)) {
+    return iree_task_executor_wait_slice(wait_handle, deadline_ns);
+  }
+  iree_status_t status = iree_wait_set_insert(executor->wait_set, *wait_handle);
+  if (iree_status_is_ok(status)) {
+    iree_wait_handle_t wake_handle;
+    status = iree_wait_any(executor->wait_set, deadline_ns, &wake_handle);
+    iree_wait_set_erase(executor->wait_set, *wait_handle);
+  }
+  iree_slim_mutex_unlock(&executor->wait_mutex);
+  return status;
+}
+
+// Pumps a threadless executor on the calling thread until |wait_handle|
+// resolves or |deadline_ns| elapses. Unlike donation to an executor with
+// workers the caller is the only thread making progress and as such must also
+// block on the executor waiting tasks when it runs out of ready work.
+//
+// Multiple threads may donate at the same time but only one at a time may pump
+// the worker or wait on the executor wait set. The others wait on their own
+// handles and retry until either their handle resolves or they get a turn.
+static iree_status_t iree_task_executor_donate_caller_inline(
+    iree_task_executor_t* executor, iree_wait_handle_t* wait_handle,
+    iree_time_t deadline_ns) {
+  while (true) {
+    iree_status_t status = iree_wait_one(wait_handle, IREE_TIME_INFINITE_PAST);
+    if (!iree_status_is_deadline_exceeded(status)) return status;
+    iree_status_ignore(status);
+    if (deadline_ns != IREE_TIME_INFINITE_FUTURE &&
+        iree_time_now() >= deadline_ns) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+
+    // Another thread is pumping and will run whatever is ready.
+    if (!iree_slim_mutex_try_lock(&executor->inline_pump_mutex)) {
+      IREE_RETURN_IF_ERROR(
+          iree_task_executor_wait_slice(wait_handle, deadline_ns));
+      continue;
+    }
+
+    // Run everything that is ready; this may end up resolving the wait.
+    // The pump is released before blocking so that other threads can flush
+    // new work while we wait; they'll run it themselves.
+    bool did_work = iree_task_executor_run_inline(executor);
+    iree_slim_mutex_unlock(&executor->inline_pump_mutex);
+    if (did_work) continue;
+
+    // Nothing ready: wait for the caller's handle or one of the tasks waiting
+    // on external handles to resolve.
+    IREE_RETURN_IF_ERROR(
+        iree_task_executor_wait_inline(executor, wait_handle, deadline_ns));
+  }
+}
+
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_handle_t* wait_handle,
                                                iree_time_t deadline_ns) {
-  // Not implemented; just wait. Unclear we want this yet and it's complex.
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_status_t status = iree_wait_one(wait_handle, deadline_ns);
+
+  if (executor->threadless) {
+    iree_status_t status = iree_task_executor_donate_caller_inline(
+        executor, wait_handle, deadline_ns);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Queue holding tasks the caller has stolen. Thieves may steal from any
+  // worker queue but only workers are registered as victims and as such no one
+  // will come looking in here.
+  iree_task_queue_t donation_queue;
+  iree_task_queue_initialize(&donation_queue);
+
+  // PRNG used to select theft victims. Multiple callers may donate at the same
+  // time and as such each gets its own seeded from its stack address.
+  iree_prng_splitmix64_state_t seed_prng;
+  iree_prng_splitmix64_initialize(/*seed=*/(uint64_t)(&donation_queue),
+                                  &seed_prng);
+  iree_prng_minilcg128_state_t theft_prng;
+  iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(&seed_prng),
+                                  &theft_prng);
+
+  int total_executed_count = 0;
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    int executed_count = 0;
+    status = iree_task_executor_pump_donated(executor, wait_handle, deadline_ns,
+                                             &theft_prng, &donation_queue,
+                                             &executed_count);
+    total_executed_count += executed_count;
+    if (!iree_status_is_deadline_exceeded(status)) break;
+    iree_status_ignore(status);
+
+    // Ran out of work to do (or hit the deadline). Tasks we depend on may still
+    // become ready as workers complete their predecessors so only wait a short
+    // slice before trying to steal again. If the deadline has elapsed this will
+    // act as a poll and return DEADLINE_EXCEEDED.
+    status = iree_task_executor_wait_slice(wait_handle, deadline_ns);
+    if (!iree_status_is_ok(status)) break;
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, total_executed_count);
+
+  if (!iree_task_queue_is_empty(&donation_queue)) {
+    iree_task_executor_relinquish_donated_tasks(executor, &donation_queue);
+  }
+  iree_task_queue_deinitialize(&donation_queue);
+
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -308,6 +308,13 @@ typedef struct iree_task_executor_s iree_task_executor_t;
 // Creates a task executor using the specified topology.
 // |topology| is only used during creation and need not live beyond this call.
 // |out_executor| must be released by the caller.
+//
+// A |topology| with no groups creates a threadless executor: no worker threads
+// are created and all tasks run inline on the threads calling
+// iree_task_executor_flush and iree_task_executor_donate_caller. This avoids
+// all cross-thread handoff and is useful on single-core systems or when the
+// caller needs fully synchronous execution. Work only makes progress while a
+// thread is flushing or donating; waiting on a scope alone will not pump it.
 iree_status_t iree_task_executor_create(
     iree_task_scheduling_mode_t scheduling_mode,
     const iree_task_topology_t* topology, iree_allocator_t allocator,
@@ -324,6 +331,16 @@ iree_status_t iree_task_executor_acquire_fence(iree_task_executor_t* executor,
                                                iree_task_scope_t* scope,
                                                iree_task_fence_t** out_fence);
 
+// Sets the maximum duration workers will spin waiting for new work after
+// running out of tasks before parking their threads in the kernel. Workers
+// adapt how long they actually spin up to this limit based on how quickly new
+// work has been arriving after they go idle. Pass 0 to always park immediately.
+//
+// Safe to call from any thread; workers pick up the new value the next time
+// they go idle.
+void iree_task_executor_set_worker_spin_ns(iree_task_executor_t* executor,
+                                           iree_duration_t spin_ns);
+
 // TODO(benvanik): scheduling mode mutation, compute quota control, etc.
 
 // Submits a batch of tasks for execution.
@@ -349,15 +366,19 @@ void iree_task_executor_submit(iree_task_executor_t* executor,
 //
 // NOTE: due to races it's possible for new work to arrive from other threads
 // after the flush has occurred but prior to this call returning.
+//
+// Threadless executors execute all ready tasks on the calling thread prior to
+// returning. Tasks waiting on external wait handles are polled but not waited
+// on.
 void iree_task_executor_flush(iree_task_executor_t* executor);
 
 // Donates the calling thread to the executor until either |wait_handle|
 // resolves or |deadline_ns| is exceeded.
 //
 // If there are no tasks available then the calling thread will block as if
-// iree_wait_one had been used on |wait_handle|. If tasks are ready then the
-// caller will not block prior to starting to perform work on behalf of the
-// executor.
+// iree_wait_one had been used on |wait_handle|, waking periodically to steal
+// any tasks that have since become ready. If tasks are ready then the caller
+// will not block prior to starting to perform work on behalf of the executor.
 //
 // Donation is intended as an optimization to elide context switches when the
 // caller would have waited anyway; now instead of performing a kernel wait and
@@ -377,6 +398,10 @@ void iree_task_executor_flush(iree_task_executor_t* executor);
 // Especially in large applications it's almost certainly better to do something
 // useful with the calling thread (even if that's go to sleep).
 //
+// Threadless executors rely on donation to make progress: the caller executes
+// all ready tasks and then blocks on either |wait_handle| or any of the
+// external wait handles the executor tasks are waiting on.
+//
 // Safe to call from any thread (though bad to reentrantly call from workers).
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_handle_t* wait_handle,
@@ -0,0 +1,135 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/logging.h"
+#include "iree/base/wait_handle.h"
+#include "iree/task/executor.h"
+#include "iree/task/scope.h"
+#include "iree/task/task.h"
+#include "iree/task/topology.h"
+
+namespace {
+
+//==============================================================================
+// Submit+wait round-trip latency
+//==============================================================================
+// Models a synchronous inference call on a small model: the caller submits a
+// dispatch with a handful of cheap tiles and then waits for it to complete.
+// The two variants differ only in how the caller waits: either blocking in the
+// kernel on the wait handle or donating itself to the executor.
+
+constexpr iree_host_size_t kWorkerCount = 4;
+
+// Emulates a small amount of work per tile (a few hundred nanoseconds).
+static void SimulateTileWork(const iree_task_tile_context_t* tile_context) {
+  uint32_t value = tile_context->workgroup_xyz[0];
+  for (int i = 0; i < 256; ++i) {
+    value = value * 1664525u + 1013904223u;
+    benchmark::DoNotOptimize(value);
+  }
+}
+
+class ExecutorFixture {
+ public:
+  ExecutorFixture() {
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(kWorkerCount, &topology);
+    iree_status_t status = iree_task_executor_create(
+        IREE_TASK_SCHEDULING_MODE_RESERVED, &topology, iree_allocator_system(),
+        &executor_);
+    iree_task_topology_deinitialize(&topology);
+    IREE_CHECK_OK(status);
+    iree_task_scope_initialize(iree_make_cstring_view("benchmark"), &scope_);
+    IREE_CHECK_OK(iree_event_initialize(/*initial_state=*/false, &event_));
+  }
+
+  ~ExecutorFixture() {
+    iree_event_deinitialize(&event_);
+    IREE_CHECK_OK(
+        iree_task_scope_wait_idle(&scope_, IREE_TIME_INFINITE_FUTURE));
+    iree_task_scope_deinitialize(&scope_);
+    iree_task_executor_release(executor_);
+  }
+
+  // Submits a dispatch of |tile_count| tiles followed by a call that signals
+  // the fixture event. Returns the event to wait on.
+  iree_event_t* SubmitDispatch(uint32_t tile_count) {
+    iree_event_reset(&event_);
+
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {tile_count, 1, 1};
+    iree_task_dispatch_initialize(
+        &scope_,
+        iree_task_make_dispatch_closure(
+            [](uintptr_t user_context,
+               const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              SimulateTileWork(tile_context);
+              return iree_ok_status();
+            },
+            0),
+        workgroup_size, workgroup_count, &dispatch_);
+
+    iree_task_call_initialize(
+        &scope_,
+        iree_task_make_call_closure(
+            [](uintptr_t user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              iree_event_set((iree_event_t*)user_context);
+              return iree_ok_status();
+            },
+            (uintptr_t)&event_),
+        &signal_call_);
+    iree_task_set_completion_task(&dispatch_.header, &signal_call_.header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch_.header);
+    iree_task_executor_submit(executor_, &submission);
+    iree_task_executor_flush(executor_);
+    return &event_;
+  }
+
+  iree_task_executor_t* executor() const { return executor_; }
+
+ private:
+  iree_task_executor_t* executor_ = NULL;
+  iree_task_scope_t scope_;
+  iree_event_t event_;
+  iree_task_dispatch_t dispatch_;
+  iree_task_call_t signal_call_;
+};
+
+void BM_DispatchSubmitAndWait(benchmark::State& state) {
+  ExecutorFixture fixture;
+  for (auto _ : state) {
+    iree_event_t* event = fixture.SubmitDispatch((uint32_t)state.range(0));
+    IREE_CHECK_OK(iree_wait_one(event, IREE_TIME_INFINITE_FUTURE));
+  }
+}
+BENCHMARK(BM_DispatchSubmitAndWait)->Arg(1)->Arg(16)->Arg(256)->UseRealTime();
+
+void BM_DispatchSubmitAndDonate(benchmark::State& state) {
+  ExecutorFixture fixture;
+  for (auto _ : state) {
+    iree_event_t* event = fixture.SubmitDispatch((uint32_t)state.range(0));
+    IREE_CHECK_OK(iree_task_executor_donate_caller(fixture.executor(), event,
+                                                   IREE_TIME_INFINITE_FUTURE));
+  }
+}
+BENCHMARK(BM_DispatchSubmitAndDonate)->Arg(1)->Arg(16)->Arg(256)->UseRealTime();
+
+}  // namespace
@@ -39,19 +39,33 @@ struct iree_task_executor_s {
   // TODO(benvanik): make mutable; currently always the same reserved value.
   iree_task_scheduling_mode_t scheduling_mode;
 
-  // State used by the work-stealing operations performed by donated threads.
-  // This is **NOT SYNCHRONIZED** and relies on the fact that we actually don't
-  // much care about the precise selection of workers enough to mind any tears
-  // we get in the PRNG state that lives inside. Cache write-back order and
-  // incidental cache line availability/visibility update frequency is like an
-  // extra layer of PRNG anyway ;)
-  iree_prng_minilcg128_state_t donation_theft_prng;
-
-  // Pools of transient dispatch tasks shared across all workers.
+  // True if the executor was created without any worker threads. A single
+  // worker holds the task lists and is pumped by threads flushing or donating.
+  bool threadless;
+  // Held by the thread pumping the sole worker of a threadless executor. Only
+  // one thread at a time may pop from the worker local task queue and pumping
+  // threads must release this before blocking on waits.
+  iree_slim_mutex_t inline_pump_mutex;
+
+  // Pool of transient fence tasks shared across all workers.
   // Depending on configuration the task pool may allocate after creation using
   // the allocator provided upon executor creation.
   iree_task_pool_t fence_task_pool;
-  iree_task_pool_t dispatch_task_pool;
+
+  // Pools of transient dispatch slice/shard tasks with one pool per NUMA node
+  // that workers are assigned to. Tasks are acquired from the pool of the
+  // worker they are posted to such that their memory is local to the node that
+  // (most likely) executes them. Workers with an unknown node share a pool
+  // using the executor allocator.
+  iree_host_size_t dispatch_task_pool_count;
+  iree_task_pool_t* dispatch_task_pools;  // [dispatch_task_pool_count]
+
+  // Measured tile costs of dispatches with a timing_key used to size the slices
+  // and shards of future issues of the same work. Direct-mapped by key and only
+  // (re)assigned by the coordinator while issuing dispatches; see
+  // iree_task_dispatch_timing_t for the update semantics.
+  iree_task_dispatch_timing_t
+      dispatch_timings[IREE_TASK_EXECUTOR_DISPATCH_TIMING_CAPACITY];
 
   // A list of incoming tasks that are ready to execute immediately.
   // The list is LIFO and we require that task lists are reversed by the
@@ -101,6 +115,24 @@ struct iree_task_executor_s {
   // on already woken workers.
   iree_atomic_task_affinity_set_t worker_idle_mask;
 
+  // Group containing each worker wake_notification so that a batch of workers
+  // can be woken with a single syscall.
+  iree_notification_group_t worker_wake_group;
+
+  // Maximum duration in nanoseconds workers spin waiting for new work before
+  // parking. See IREE_TASK_EXECUTOR_DEFAULT_WORKER_SPIN_NS.
+  iree_atomic_int64_t worker_spin_ns;
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  // Running totals of worker idle transitions plotted in traces:
+  // spins: idle periods ended by new work arriving while spinning.
+  // parks: idle periods where the worker blocked in the kernel.
+  // wakes: wake notifications posted to workers with new work.
+  iree_atomic_int64_t worker_spin_count;
+  iree_atomic_int64_t worker_park_count;
+  iree_atomic_int64_t worker_wake_count;
+#endif  // IREE_TRACING_FEATURE_INSTRUMENTATION
+
   // Specifies how many workers threads there are.
   // For now this number is fixed per executor however if we wanted to enable
   // live join/leave behavior we could change this to a registration mechanism.
@@ -135,12 +167,16 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
                                    bool wait_on_idle);
 
 // Tries to steal an entire task from a sibling worker (based on topology).
+// Victims sharing caches (|constructive_sharing_mask|) are preferred over those
+// on the same NUMA node (|local_node_mask|) and only then are workers on remote
+// nodes tried.
 // Returns a task that is available (has not yet begun processing at all).
 // May steal multiple tasks and add them to the |local_task_queue|.
 iree_task_t* iree_task_executor_try_steal_task(
     iree_task_executor_t* executor,
     iree_task_affinity_set_t constructive_sharing_mask,
-    uint32_t max_theft_attempts, iree_prng_minilcg128_state_t* theft_prng,
+    iree_task_affinity_set_t local_node_mask, uint32_t max_theft_attempts,
+    iree_prng_minilcg128_state_t* theft_prng,
     iree_task_queue_t* local_task_queue);
 
 #ifdef __cplusplus
@@ -15,6 +15,7 @@
 #include "iree/task/executor.h"
 
 #include <thread>
+#include <vector>
 
 #include "iree/base/math.h"
 #include "iree/testing/gtest.h"
@@ -178,4 +179,388 @@ TEST(ExecutorTest, Any) {
   iree_task_executor_release(executor);
 }
 
+// Tests that a caller donating itself to the executor both helps execute the
+// submitted work and returns once its wait handle has resolved.
+TEST(ExecutorTest, DonateCaller) {
+  IREE_TRACE_SCOPE0("ExecutorTest::DonateCaller");
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/2, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
+                                           &topology, iree_allocator_system(),
+                                           &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("donate"), &scope);
+
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+
+  struct DonateState {
+    iree_atomic_int32_t tile_count;
+    iree_event_t* event;
+  } state;
+  iree_atomic_store_int32(&state.tile_count, 0, iree_memory_order_relaxed);
+  state.event = &event;
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {64, 4, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](uintptr_t user_context,
+             const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            auto* state = (DonateState*)user_context;
+            simulate_work(tile_context);
+            iree_atomic_fetch_add_int32(&state->tile_count, 1,
+                                        iree_memory_order_relaxed);
+            return iree_ok_status();
+          },
+          (uintptr_t)&state),
+      workgroup_size, workgroup_count, &dispatch);
+  dispatch.header.flags |= IREE_TASK_FLAG_DISPATCH_SLICED;
+
+  iree_task_call_t signal_call;
+  iree_task_call_initialize(&scope,
+                            iree_task_make_call_closure(
+                                [](uintptr_t user_context, iree_task_t* task,
+                                   iree_task_submission_t* pending_submission) {
+                                  auto* state = (DonateState*)user_context;
+                                  iree_event_set(state->event);
+                                  return iree_ok_status();
+                                },
+                                (uintptr_t)&state),
+                            &signal_call);
+  iree_task_set_completion_task(&dispatch.header, &signal_call.header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  IREE_EXPECT_OK(iree_task_executor_donate_caller(executor, &event,
+                                                  IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(64 * 4, iree_atomic_load_int32(&state.tile_count,
+                                           iree_memory_order_relaxed));
+
+  // The event stays signaled and donation should return immediately.
+  IREE_EXPECT_OK(iree_task_executor_donate_caller(executor, &event,
+                                                  IREE_TIME_INFINITE_PAST));
+
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  iree_event_deinitialize(&event);
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests that donation with nothing to do and an unresolved wait handle times
+// out just as iree_wait_one would.
+TEST(ExecutorTest, DonateCallerDeadline) {
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
+                                           &topology, iree_allocator_system(),
+                                           &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_event_t event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &event));
+  EXPECT_TRUE(iree_status_is_deadline_exceeded(iree_task_executor_donate_caller(
+      executor, &event, IREE_TIME_INFINITE_PAST)));
+  EXPECT_TRUE(iree_status_is_deadline_exceeded(iree_task_executor_donate_caller(
+      executor, &event, iree_time_now() + 1000000)));
+  iree_event_deinitialize(&event);
+
+  iree_task_executor_release(executor);
+}
+
+// Tests that a threadless executor runs all ready work on the flushing thread.
+TEST(ExecutorTest, ThreadlessFlush) {
+  IREE_TRACE_SCOPE0("ExecutorTest::ThreadlessFlush");
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/0, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
+                                           &topology, iree_allocator_system(),
+                                           &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("threadless"), &scope);
+
+  struct ThreadlessState {
+    std::thread::id caller_id;
+    int tile_count;
+    int foreign_tile_count;
+  } state;
+  state.caller_id = std::this_thread::get_id();
+  state.tile_count = 0;
+  state.foreign_tile_count = 0;
+
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {64, 4, 1};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](uintptr_t user_context,
+             const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            auto* state = (ThreadlessState*)user_context;
+            ++state->tile_count;
+            if (std::this_thread::get_id() != state->caller_id) {
+              ++state->foreign_tile_count;
+            }
+            return iree_ok_status();
+          },
+          (uintptr_t)&state),
+      workgroup_size, workgroup_count, &dispatch);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  // All work should have completed on this thread prior to flush returning.
+  EXPECT_EQ(64 * 4, state.tile_count);
+  EXPECT_EQ(0, state.foreign_tile_count);
+  IREE_EXPECT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_PAST));
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests that workers spread across multiple NUMA nodes (which need not exist on
+// the host; placement is only a preference) each get their dispatch tasks from
+// their node pool and still cover the entire grid.
+TEST(ExecutorTest, NumaNodes) {
+  IREE_TRACE_SCOPE0("ExecutorTest::NumaNodes");
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  for (uint32_t i = 0; i < 4; ++i) {
+    iree_task_topology_group_t group;
+    iree_task_topology_group_initialize(i, &group);
+    group.numa_node = i / 2;
+    IREE_ASSERT_OK(iree_task_topology_push_group(&topology, &group));
+  }
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
+                                           &topology, iree_allocator_system(),
+                                           &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("numa"), &scope);
+
+  for (uint32_t dispatch_flags :
+       {0u, (uint32_t)IREE_TASK_FLAG_DISPATCH_SLICED}) {
+    iree_atomic_int32_t tile_count;
+    iree_atomic_store_int32(&tile_count, 0, iree_memory_order_relaxed);
+    const uint32_t workgroup_size[3] = {1, 1, 1};
+    const uint32_t workgroup_count[3] = {128, 4, 1};
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](uintptr_t user_context,
+               const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              iree_atomic_fetch_add_int32((iree_atomic_int32_t*)user_context,
+                                          1, iree_memory_order_relaxed);
+              return iree_ok_status();
+            },
+            (uintptr_t)&tile_count),
+        workgroup_size, workgroup_count, &dispatch);
+    dispatch.header.flags |= dispatch_flags;
+
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_ASSERT_OK(
+        iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+    EXPECT_EQ(128 * 4,
+              iree_atomic_load_int32(&tile_count, iree_memory_order_relaxed));
+  }
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests that donating to a threadless executor blocks on external waits and
+// resumes execution once they resolve.
+TEST(ExecutorTest, ThreadlessDonateWait) {
+  IREE_TRACE_SCOPE0("ExecutorTest::ThreadlessDonateWait");
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/0, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
+                                           &topology, iree_allocator_system(),
+                                           &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("threadless"), &scope);
+
+  iree_event_t external_event;
+  IREE_ASSERT_OK(
+      iree_event_initialize(/*initial_state=*/false, &external_event));
+  iree_event_t done_event;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &done_event));
+
+  iree_task_wait_t wait;
+  iree_task_wait_initialize(&scope, external_event, &wait);
+  iree_task_call_t signal_call;
+  iree_task_call_initialize(&scope,
+                            iree_task_make_call_closure(
+                                [](uintptr_t user_context, iree_task_t* task,
+                                   iree_task_submission_t* pending_submission) {
+                                  iree_event_set((iree_event_t*)user_context);
+                                  return iree_ok_status();
+                                },
+                                (uintptr_t)&done_event),
+                            &signal_call);
+  iree_task_set_completion_task(&wait.header, &signal_call.header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &wait.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  // The wait has not resolved and nothing else can make progress.
+  EXPECT_TRUE(iree_status_is_deadline_exceeded(iree_task_executor_donate_caller(
+      executor, &done_event, IREE_TIME_INFINITE_PAST)));
+
+  // Resolve the external wait from another thread while we are donating.
+  std::thread signal_thread([&]() {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    iree_event_set(&external_event);
+  });
+  IREE_EXPECT_OK(iree_task_executor_donate_caller(executor, &done_event,
+                                                  IREE_TIME_INFINITE_FUTURE));
+  signal_thread.join();
+
+  IREE_EXPECT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_PAST));
+  iree_event_deinitialize(&done_event);
+  iree_event_deinitialize(&external_event);
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+}
+
+// Tests that multiple threads donating to a threadless executor at the same
+// time each complete their work while only one at a time pumps the worker.
+TEST(ExecutorTest, ThreadlessConcurrentDonation) {
+  IREE_TRACE_SCOPE0("ExecutorTest::ThreadlessConcurrentDonation");
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/0, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(IREE_TASK_SCHEDULING_MODE_RESERVED,
+                                           &topology, iree_allocator_system(),
+                                           &executor));
+  iree_task_topology_deinitialize(&topology);
+
+  struct PumpState {
+    iree_atomic_int32_t active_count;
+    iree_atomic_int32_t max_active_count;
+    iree_atomic_int32_t tile_count;
+  } state;
+  iree_atomic_store_int32(&state.active_count, 0, iree_memory_order_relaxed);
+  iree_atomic_store_int32(&state.max_active_count, 0,
+                          iree_memory_order_relaxed);
+  iree_atomic_store_int32(&state.tile_count, 0, iree_memory_order_relaxed);
+
+  static const int kThreadCount = 4;
+  static const int kIterationCount = 32;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < kThreadCount; ++i) {
+    threads.emplace_back([&]() {
+      iree_task_scope_t scope;
+      iree_task_scope_initialize(iree_make_cstring_view("donor"), &scope);
+      iree_event_t done_event;
+      IREE_ASSERT_OK(
+          iree_event_initialize(/*initial_state=*/false, &done_event));
+      for (int j = 0; j < kIterationCount; ++j) {
+        iree_event_reset(&done_event);
+        const uint32_t workgroup_size[3] = {1, 1, 1};
+        const uint32_t workgroup_count[3] = {16, 1, 1};
+        iree_task_dispatch_t dispatch;
+        iree_task_dispatch_initialize(
+            &scope,
+            iree_task_make_dispatch_closure(
+                [](uintptr_t user_context,
+                   const iree_task_tile_context_t* tile_context,
+                   iree_task_submission_t* pending_submission) {
+                  auto* state = (PumpState*)user_context;
+                  int32_t active_count = iree_atomic_fetch_add_int32(
+                      &state->active_count, 1, iree_memory_order_seq_cst);
+                  int32_t max_active_count = iree_atomic_load_int32(
+                      &state->max_active_count, iree_memory_order_seq_cst);
+                  if (active_count + 1 > max_active_count) {
+                    iree_atomic_store_int32(&state->max_active_count,
+                                            active_count + 1,
+                                            iree_memory_order_seq_cst);
+                  }
+                  iree_atomic_fetch_add_int32(&state->tile_count, 1,
+                                              iree_memory_order_relaxed);
+                  std::this_thread::sleep_for(std::chrono::microseconds(10));
+                  iree_atomic_fetch_sub_int32(&state->active_count, 1,
+                                              iree_memory_order_seq_cst);
+                  return iree_ok_status();
+                },
+                (uintptr_t)&state),
+            workgroup_size, workgroup_count, &dispatch);
+        iree_task_call_t signal_call;
+        iree_task_call_initialize(
+            &scope,
+            iree_task_make_call_closure(
+                [](uintptr_t user_context, iree_task_t* task,
+                   iree_task_submission_t* pending_submission) {
+                  iree_event_set((iree_event_t*)user_context);
+                  return iree_ok_status();
+                },
+                (uintptr_t)&done_event),
+            &signal_call);
+        iree_task_set_completion_task(&dispatch.header, &signal_call.header);
+
+        iree_task_submission_t submission;
+        iree_task_submission_initialize(&submission);
+        iree_task_submission_enqueue(&submission, &dispatch.header);
+        iree_task_executor_submit(executor, &submission);
+        IREE_EXPECT_OK(iree_task_executor_donate_caller(
+            executor, &done_event, IREE_TIME_INFINITE_FUTURE));
+        IREE_EXPECT_OK(
+            iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+      }
+      iree_event_deinitialize(&done_event);
+      iree_task_scope_deinitialize(&scope);
+    });
+  }
+  for (auto& thread : threads) thread.join();
+
+  EXPECT_EQ(kThreadCount * kIterationCount * 16,
+            iree_atomic_load_int32(&state.tile_count,
+                                   iree_memory_order_relaxed));
+  EXPECT_EQ(1, iree_atomic_load_int32(&state.max_active_count,
+                                      iree_memory_order_relaxed));
+
+  iree_task_executor_release(executor);
+}
+
 }  // namespace
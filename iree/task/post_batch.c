@@ -35,6 +35,11 @@ iree_host_size_t iree_task_post_batch_worker_count(
   return post_batch->executor->worker_count;
 }
 
+iree_task_pool_t* iree_task_post_batch_dispatch_task_pool(
+    const iree_task_post_batch_t* post_batch, iree_host_size_t worker_index) {
+  return post_batch->executor->workers[worker_index].dispatch_task_pool;
+}
+
 static iree_host_size_t iree_task_post_batch_select_random_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
   iree_task_affinity_set_t worker_live_mask =
@@ -123,29 +128,31 @@ static void iree_task_post_batch_wake_workers(
     }
   }
 
-  // TODO(#4016): use a FUTEX_WAKE_BITSET here to wake all of the workers that
-  // have pending work in a single syscall (vs. popcnt(worker_pending_mask)
-  // syscalls). This will reduce wake latency for workers later in the set;
-  // for example today worker[31] will wait until workers[0-30] have had their
-  // syscalls performed before it's even requested to wake. This also loses
-  // information the kernel could use to avoid core migration as it knows when N
-  // threads will be needed simultaneously and can hopefully perform any needed
-  // migrations prior to beginning execution.
+  // Wake all of the workers that have pending work in a single syscall (vs.
+  // popcnt(worker_pending_mask) syscalls) by posting their notifications as a
+  // group. Otherwise worker[31] would wait until workers[0-30] have had their
+  // syscalls performed before it's even requested to wake. Workers that aren't
+  // waiting don't contribute to the wake and if none are waiting there's no
+  // syscall at all.
   int wake_count = iree_task_affinity_set_count_ones(wake_mask);
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  IREE_TRACE_PLOT_VALUE_I64(
+      "iree_task_worker_wakes",
+      iree_atomic_fetch_add_int64(&executor->worker_wake_count, wake_count,
+                                  iree_memory_order_relaxed) +
+          wake_count);
+#endif  // IREE_TRACING_FEATURE_INSTRUMENTATION
+  iree_notification_t* wake_notifications[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
   int worker_index = 0;
   for (int i = 0; i < wake_count; ++i) {
     int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
     int wake_index = worker_index + offset;
     worker_index += offset + 1;
     wake_mask = iree_shr(wake_mask, offset + 1);
-
-    // Wake workers if they are waiting - workers are the only thing that can
-    // wait on this notification so this should almost always be either free (an
-    // atomic load) if a particular worker isn't waiting or it's required to
-    // actually wake it and we can't avoid it.
-    iree_task_worker_t* worker = &executor->workers[wake_index];
-    iree_notification_post(&worker->wake_notification, 1);
+    wake_notifications[i] = &executor->workers[wake_index].wake_notification;
   }
+  iree_notification_group_post(&executor->worker_wake_group,
+                               wake_notifications, wake_count);
 
   IREE_TRACE_ZONE_END(z0);
 }
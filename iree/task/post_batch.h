@@ -18,6 +18,7 @@
 #include "iree/task/affinity_set.h"
 #include "iree/task/executor.h"
 #include "iree/task/list.h"
+#include "iree/task/pool.h"
 #include "iree/task/tuning.h"
 
 #ifdef __cplusplus
@@ -55,6 +56,11 @@ void iree_task_post_batch_initialize(iree_task_executor_t* executor,
 iree_host_size_t iree_task_post_batch_worker_count(
     const iree_task_post_batch_t* post_batch);
 
+// Returns the pool that dispatch tasks posted to |worker_index| should be
+// acquired from such that their memory is local to the worker's NUMA node.
+iree_task_pool_t* iree_task_post_batch_dispatch_task_pool(
+    const iree_task_post_batch_t* post_batch, iree_host_size_t worker_index);
+
 // Selects a random worker from the given affinity set.
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set);
@@ -16,6 +16,277 @@
 
 #include <assert.h>
 
+#if IREE_TASK_QUEUE_LOCK_FREE
+
+//===----------------------------------------------------------------------===//
+// Lock-free Chase-Lev deque with overflow list
+//===----------------------------------------------------------------------===//
+// Based on the C11 formulation in "Correct and Efficient Work-Stealing for
+// Weak Memory Models" (Le et al.): https://fzn.fr/readings/ppopp13.pdf
+//
+// The ring is ordered such that the task at |bottom - 1| is the next to run by
+// the owner and the task at |top| is the last. New tasks can only be added by
+// the owner at the bottom and as such the ring can only accept tasks that run
+// *before* everything else in it. Tasks appended to a non-empty queue go into
+// the overflow list instead and are moved into the ring when it drains.
+
+static_assert((IREE_TASK_QUEUE_LOCK_FREE_CAPACITY &
+               (IREE_TASK_QUEUE_LOCK_FREE_CAPACITY - 1)) == 0,
+              "ring capacity must be a power of two");
+
+#define IREE_TASK_QUEUE_RING_MASK (IREE_TASK_QUEUE_LOCK_FREE_CAPACITY - 1)
+
+static inline void iree_task_queue_ring_store(iree_task_queue_t* queue,
+                                              int64_t index,
+                                              iree_task_t* task) {
+  iree_atomic_store_intptr(&queue->ring[index & IREE_TASK_QUEUE_RING_MASK],
+                           (intptr_t)task, iree_memory_order_relaxed);
+}
+
+static inline iree_task_t* iree_task_queue_ring_load(iree_task_queue_t* queue,
+                                                     int64_t index) {
+  return (iree_task_t*)iree_atomic_load_intptr(
+      &queue->ring[index & IREE_TASK_QUEUE_RING_MASK],
+      iree_memory_order_relaxed);
+}
+
+// Pops the next task from the bottom of the ring (owner only).
+static iree_task_t* iree_task_queue_ring_pop_bottom(iree_task_queue_t* queue) {
+  int64_t b =
+      iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed) - 1;
+  iree_atomic_store_int64(&queue->bottom, b, iree_memory_order_relaxed);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t t = iree_atomic_load_int64(&queue->top, iree_memory_order_relaxed);
+  if (t > b) {
+    // Empty; restore bottom.
+    iree_atomic_store_int64(&queue->bottom, b + 1, iree_memory_order_relaxed);
+    return NULL;
+  }
+  iree_task_t* task = iree_task_queue_ring_load(queue, b);
+  if (t == b) {
+    // Last task in the ring; race any thieves for it.
+    if (!iree_atomic_compare_exchange_strong_int64(
+            &queue->top, &t, t + 1, iree_memory_order_seq_cst,
+            iree_memory_order_relaxed)) {
+      task = NULL;
+    }
+    iree_atomic_store_int64(&queue->bottom, b + 1, iree_memory_order_relaxed);
+  }
+  return task;
+}
+
+// Steals the task at the top of the ring. Returns NULL if the ring is empty or
+// the thief lost a race with another thief or the owner.
+static iree_task_t* iree_task_queue_ring_steal_top(iree_task_queue_t* queue) {
+  int64_t t = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  iree_atomic_thread_fence(iree_memory_order_seq_cst);
+  int64_t b = iree_atomic_load_int64(&queue->bottom, iree_memory_order_acquire);
+  if (t >= b) return NULL;
+  iree_task_t* task = iree_task_queue_ring_load(queue, t);
+  if (!iree_atomic_compare_exchange_strong_int64(&queue->top, &t, t + 1,
+                                                 iree_memory_order_seq_cst,
+                                                 iree_memory_order_relaxed)) {
+    return NULL;
+  }
+  return task;
+}
+
+// Moves tasks from the front of the FIFO |list| into the ring such that they
+// will be popped in order by the owner. Tasks that don't fit remain in |list|.
+// The ring must only contain tasks that run before those in |list|.
+static void iree_task_queue_ring_fill(iree_task_queue_t* queue,
+                                      iree_task_list_t* list) {
+  int64_t b = iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed);
+  int64_t t = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  int64_t available = IREE_TASK_QUEUE_LOCK_FREE_CAPACITY - (b - t);
+  if (available <= 0 || iree_task_list_is_empty(list)) return;
+
+  // Count how many tasks we'll be moving so that we can store them in reverse
+  // while walking the list forward.
+  int64_t count = 0;
+  for (iree_task_t* task = list->head; task && count < available;
+       task = task->next_task) {
+    ++count;
+  }
+  for (int64_t i = count - 1; i >= 0; --i) {
+    iree_task_queue_ring_store(queue, b + i, iree_task_list_pop_front(list));
+  }
+
+  // Publish the tasks to thieves.
+  iree_atomic_thread_fence(iree_memory_order_release);
+  iree_atomic_store_int64(&queue->bottom, b + count, iree_memory_order_relaxed);
+}
+
+// Returns true if the ring has no tasks. Only accurate from the owner.
+static bool iree_task_queue_ring_is_empty(iree_task_queue_t* queue) {
+  int64_t b = iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed);
+  int64_t t = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+  return b <= t;
+}
+
+// Appends a FIFO |list| of tasks to run after all others in the queue.
+static void iree_task_queue_append_fifo(iree_task_queue_t* queue,
+                                        iree_task_list_t* list) {
+  if (iree_task_list_is_empty(list)) return;
+  if (!iree_atomic_load_int32(&queue->overflow_pending,
+                              iree_memory_order_acquire) &&
+      iree_task_queue_ring_is_empty(queue)) {
+    // Fast path: nothing queued so the tasks can go right into the ring.
+    iree_task_queue_ring_fill(queue, list);
+    if (iree_task_list_is_empty(list)) return;
+  }
+  iree_slim_mutex_lock(&queue->overflow_mutex);
+  iree_task_list_append(&queue->overflow_list, list);
+  iree_atomic_store_int32(&queue->overflow_pending, 1,
+                          iree_memory_order_release);
+  iree_slim_mutex_unlock(&queue->overflow_mutex);
+}
+
+// Refills the empty ring from the overflow list (owner only).
+// Returns true if any tasks were moved into the ring.
+static bool iree_task_queue_refill(iree_task_queue_t* queue) {
+  if (!iree_atomic_load_int32(&queue->overflow_pending,
+                              iree_memory_order_acquire)) {
+    return false;
+  }
+  iree_slim_mutex_lock(&queue->overflow_mutex);
+  bool did_fill = !iree_task_list_is_empty(&queue->overflow_list);
+  iree_task_queue_ring_fill(queue, &queue->overflow_list);
+  iree_atomic_store_int32(&queue->overflow_pending,
+                          !iree_task_list_is_empty(&queue->overflow_list),
+                          iree_memory_order_release);
+  iree_slim_mutex_unlock(&queue->overflow_mutex);
+  return did_fill;
+}
+
+void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
+  memset(out_queue, 0, sizeof(*out_queue));
+  iree_slim_mutex_initialize(&out_queue->overflow_mutex);
+  iree_task_list_initialize(&out_queue->overflow_list);
+}
+
+void iree_task_queue_deinitialize(iree_task_queue_t* queue) {
+  // Move everything remaining in the ring into a list (in execution order) so
+  // that it can be discarded along with the overflow.
+  iree_task_list_t list;
+  iree_task_list_initialize(&list);
+  iree_task_t* task = NULL;
+  while ((task = iree_task_queue_ring_pop_bottom(queue))) {
+    iree_task_list_push_back(&list, task);
+  }
+  iree_task_list_append(&list, &queue->overflow_list);
+  iree_task_list_discard(&list);
+  iree_slim_mutex_deinitialize(&queue->overflow_mutex);
+}
+
+bool iree_task_queue_is_empty(iree_task_queue_t* queue) {
+  return iree_task_queue_ring_is_empty(queue) &&
+         !iree_atomic_load_int32(&queue->overflow_pending,
+                                 iree_memory_order_acquire);
+}
+
+void iree_task_queue_push_front(iree_task_queue_t* queue, iree_task_t* task) {
+  while (true) {
+    int64_t b =
+        iree_atomic_load_int64(&queue->bottom, iree_memory_order_relaxed);
+    int64_t t = iree_atomic_load_int64(&queue->top, iree_memory_order_acquire);
+    if (b - t < IREE_TASK_QUEUE_LOCK_FREE_CAPACITY) {
+      iree_task_queue_ring_store(queue, b, task);
+      iree_atomic_thread_fence(iree_memory_order_release);
+      iree_atomic_store_int64(&queue->bottom, b + 1,
+                              iree_memory_order_relaxed);
+      return;
+    }
+
+    // Ring is full: spill the task that would run last in the ring to the
+    // front of the overflow list to make room. If a thief beats us to it then
+    // there's room anyway.
+    iree_task_t* spilled_task = iree_task_queue_ring_steal_top(queue);
+    if (spilled_task) {
+      iree_slim_mutex_lock(&queue->overflow_mutex);
+      iree_task_list_push_front(&queue->overflow_list, spilled_task);
+      iree_atomic_store_int32(&queue->overflow_pending, 1,
+                              iree_memory_order_release);
+      iree_slim_mutex_unlock(&queue->overflow_mutex);
+    }
+  }
+}
+
+void iree_task_queue_append_from_lifo_list_unsafe(iree_task_queue_t* queue,
+                                                  iree_task_list_t* list) {
+  iree_task_list_reverse(list);
+  iree_task_queue_append_fifo(queue, list);
+}
+
+iree_task_t* iree_task_queue_flush_from_lifo_slist(
+    iree_task_queue_t* queue, iree_atomic_task_slist_t* source_slist) {
+  iree_task_list_t suffix;
+  iree_task_list_initialize(&suffix);
+  if (iree_atomic_task_slist_flush(
+          source_slist, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_FIFO,
+          &suffix.head, &suffix.tail)) {
+    iree_task_queue_append_fifo(queue, &suffix);
+  }
+  return iree_task_queue_pop_front(queue);
+}
+
+iree_task_t* iree_task_queue_pop_front(iree_task_queue_t* queue) {
+  do {
+    iree_task_t* task = iree_task_queue_ring_pop_bottom(queue);
+    if (task) return task;
+  } while (iree_task_queue_refill(queue));
+  return NULL;
+}
+
+iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
+                                       iree_task_queue_t* target_queue,
+                                       iree_host_size_t max_tasks) {
+  iree_task_list_t stolen_tasks;
+  iree_task_list_initialize(&stolen_tasks);
+
+  // The overflow list holds the tasks that will run last so prefer those.
+  // Thieves only take the lock when there's something there.
+  if (iree_atomic_load_int32(&source_queue->overflow_pending,
+                             iree_memory_order_acquire)) {
+    iree_slim_mutex_lock(&source_queue->overflow_mutex);
+    iree_task_list_split(&source_queue->overflow_list, max_tasks,
+                         &stolen_tasks);
+    iree_atomic_store_int32(
+        &source_queue->overflow_pending,
+        !iree_task_list_is_empty(&source_queue->overflow_list),
+        iree_memory_order_release);
+    iree_slim_mutex_unlock(&source_queue->overflow_mutex);
+  }
+
+  // Otherwise steal up to half of the ring one task at a time from the top.
+  // Each steal takes the task that would run last so we build the stolen list
+  // back to front to preserve the original execution order.
+  if (iree_task_list_is_empty(&stolen_tasks)) {
+    int64_t t =
+        iree_atomic_load_int64(&source_queue->top, iree_memory_order_acquire);
+    int64_t b = iree_atomic_load_int64(&source_queue->bottom,
+                                       iree_memory_order_acquire);
+    int64_t count = b - t;
+    int64_t steal_count = iree_min((int64_t)max_tasks, count - count / 2);
+    for (int64_t i = 0; i < steal_count; ++i) {
+      iree_task_t* task = iree_task_queue_ring_steal_top(source_queue);
+      if (!task) break;
+      iree_task_list_push_front(&stolen_tasks, task);
+    }
+  }
+
+  // Add any stolen tasks to the target queue and pop off the head for return.
+  if (iree_task_list_is_empty(&stolen_tasks)) return NULL;
+  iree_task_queue_append_fifo(target_queue, &stolen_tasks);
+  return iree_task_queue_pop_front(target_queue);
+}
+
+#else
+
+//===----------------------------------------------------------------------===//
+// Mutex-guarded linked list
+//===----------------------------------------------------------------------===//
+
 void iree_task_queue_initialize(iree_task_queue_t* out_queue) {
   memset(out_queue, 0, sizeof(*out_queue));
   iree_slim_mutex_initialize(&out_queue->mutex);
@@ -95,3 +366,5 @@ iree_task_t* iree_task_queue_try_steal(iree_task_queue_t* source_queue,
   }
   return next_task;
 }
+
+#endif  // IREE_TASK_QUEUE_LOCK_FREE
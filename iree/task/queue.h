@@ -19,6 +19,7 @@
 #include "iree/base/synchronization.h"
 #include "iree/task/list.h"
 #include "iree/task/task.h"
+#include "iree/task/tuning.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -108,6 +109,45 @@ extern "C" {
 // list we can't easily just walk backward and we don't want to be introducing
 // cache line contention as thieves start touching the same tasks as the worker
 // is while processing.
+//
+// When IREE_TASK_QUEUE_LOCK_FREE is set (see tuning.h) the queue is instead
+// implemented as an actual bounded Chase-Lev deque over a ring of
+// IREE_TASK_QUEUE_LOCK_FREE_CAPACITY task pointers. The owner pops from the
+// bottom and thieves CAS the top without taking any locks. The ring holds the
+// tasks the owner will run next and anything beyond that (tasks appended while
+// the ring is non-empty or that don't fit) goes into an overflow list guarded
+// by a mutex. The owner only touches the overflow lock when refilling an empty
+// ring and thieves only when the overflow is non-empty, which keeps theft
+// storms on wide dispatches off the lock entirely. The API and FIFO/steal
+// ordering semantics are identical between the two implementations.
+#if IREE_TASK_QUEUE_LOCK_FREE
+
+typedef struct {
+  // Index one past the next task the owner will pop. Only written by the owner.
+  iree_atomic_int64_t bottom;
+  uint8_t _bottom_padding[iree_hardware_destructive_interference_size -
+                         sizeof(iree_atomic_int64_t)];
+
+  // Index of the next task thieves will steal. Advanced via CAS by thieves and
+  // by the owner when racing them for the last task.
+  iree_atomic_int64_t top;
+  uint8_t _top_padding[iree_hardware_destructive_interference_size -
+                      sizeof(iree_atomic_int64_t)];
+
+  // Guards the overflow list holding tasks that will run after all of those in
+  // the ring.
+  iree_slim_mutex_t overflow_mutex;
+  // Nonzero when the overflow list has tasks; lets callers skip the lock.
+  iree_atomic_int32_t overflow_pending;
+  // FIFO task list of tasks that follow those in the ring.
+  iree_task_list_t overflow_list IREE_GUARDED_BY(overflow_mutex);
+
+  // Ring of iree_task_t* indexed by [top, bottom) modulo the capacity.
+  iree_atomic_intptr_t ring[IREE_TASK_QUEUE_LOCK_FREE_CAPACITY];
+} iree_task_queue_t;
+
+#else
+
 typedef struct {
   // Must be held when manipulating the queue. >90% accesses are by the owner.
   iree_slim_mutex_t mutex;
@@ -116,6 +156,8 @@ typedef struct {
   iree_task_list_t list IREE_GUARDED_BY(mutex);
 } iree_task_queue_t;
 
+#endif  // IREE_TASK_QUEUE_LOCK_FREE
+
 // Initializes a work-stealing task queue in-place.
 void iree_task_queue_initialize(iree_task_queue_t* out_queue);
 
@@ -0,0 +1,97 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/list.h"
+#include "iree/task/queue.h"
+#include "iree/task/tuning.h"
+
+namespace {
+
+//==============================================================================
+// Owner pop vs. concurrent theft
+//==============================================================================
+// Models a single busy worker with a deep local queue being raided by
+// |state.range(0)| idle siblings. Each iteration refills the owner queue and
+// then races the owner draining it against the thieves stealing from it. The
+// number of thieves controls the contention on the owner queue and is where
+// the lock-free and mutex-guarded implementations differ the most.
+
+constexpr size_t kTaskCount = 4096;
+
+void BM_QueueTheft(benchmark::State& state) {
+  const int thief_count = (int)state.range(0);
+
+  iree_task_queue_t owner_queue;
+  iree_task_queue_initialize(&owner_queue);
+  std::vector<iree_task_t> tasks(kTaskCount);
+
+  // Thieves persist across iterations and spin on |remaining_count| so that
+  // thread startup is not measured.
+  std::atomic<bool> exiting(false);
+  std::atomic<int64_t> remaining_count(0);
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < thief_count; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t thief_queue;
+      iree_task_queue_initialize(&thief_queue);
+      while (!exiting.load(std::memory_order_relaxed)) {
+        if (remaining_count.load(std::memory_order_relaxed) <= 0) {
+          std::this_thread::yield();
+          continue;
+        }
+        iree_task_t* task =
+            iree_task_queue_try_steal(&owner_queue, &thief_queue, 4);
+        while (task) {
+          benchmark::DoNotOptimize(task);
+          remaining_count.fetch_sub(1, std::memory_order_relaxed);
+          task = iree_task_queue_pop_front(&thief_queue);
+        }
+      }
+      iree_task_queue_deinitialize(&thief_queue);
+    });
+  }
+
+  for (auto _ : state) {
+    iree_task_list_t list;
+    iree_task_list_initialize(&list);
+    for (size_t i = 0; i < kTaskCount; ++i) {
+      iree_task_list_push_front(&list, &tasks[i]);
+    }
+    iree_task_queue_append_from_lifo_list_unsafe(&owner_queue, &list);
+    remaining_count.store(kTaskCount, std::memory_order_release);
+    while (remaining_count.load(std::memory_order_acquire) > 0) {
+      iree_task_t* task = iree_task_queue_pop_front(&owner_queue);
+      if (task) {
+        benchmark::DoNotOptimize(task);
+        remaining_count.fetch_sub(1, std::memory_order_relaxed);
+      }
+    }
+  }
+
+  exiting.store(true);
+  for (auto& thief : thieves) thief.join();
+  iree_task_queue_deinitialize(&owner_queue);
+
+  state.SetItemsProcessed(state.iterations() * kTaskCount);
+  state.SetLabel(IREE_TASK_QUEUE_LOCK_FREE ? "lock-free" : "mutex");
+}
+BENCHMARK(BM_QueueTheft)->Arg(0)->Arg(1)->Arg(3)->Arg(7)->UseRealTime();
+
+}  // namespace
@@ -14,6 +14,10 @@
 
 #include "iree/task/queue.h"
 
+#include <atomic>
+#include <thread>
+#include <vector>
+
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
 
@@ -328,4 +332,144 @@ TEST(QueueTest, TryStealAll) {
   iree_task_queue_deinitialize(&target_queue);
 }
 
+// Appends more tasks than fit in any fixed-size storage the queue may use to
+// ensure ordering is preserved across spills.
+TEST(QueueTest, AppendListLarge) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  std::vector<iree_task_t> tasks(1000);
+  for (size_t i = 0; i < tasks.size() / 2; ++i) {
+    iree_task_list_t list;
+    iree_task_list_initialize(&list);
+    iree_task_list_push_back(&list, &tasks[i * 2 + 0]);
+    iree_task_list_push_back(&list, &tasks[i * 2 + 1]);
+    iree_task_list_reverse(&list);
+    iree_task_queue_append_from_lifo_list_unsafe(&queue, &list);
+  }
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    ASSERT_EQ(&tasks[i], iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+// Pushes more tasks to the front than fit in any fixed-size storage.
+TEST(QueueTest, PushFrontLarge) {
+  iree_task_queue_t queue;
+  iree_task_queue_initialize(&queue);
+
+  std::vector<iree_task_t> tasks(1000);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    iree_task_queue_push_front(&queue, &tasks[tasks.size() - i - 1]);
+  }
+
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    ASSERT_EQ(&tasks[i], iree_task_queue_pop_front(&queue));
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&queue));
+
+  iree_task_queue_deinitialize(&queue);
+}
+
+// Steals from a large queue such that some tasks come from spill storage.
+TEST(QueueTest, TryStealLarge) {
+  iree_task_queue_t source_queue;
+  iree_task_queue_initialize(&source_queue);
+  iree_task_queue_t target_queue;
+  iree_task_queue_initialize(&target_queue);
+
+  std::vector<iree_task_t> tasks(1000);
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    iree_task_queue_push_front(&source_queue, &tasks[tasks.size() - i - 1]);
+  }
+
+  // Thieves take from the end of the queue; as long as the tasks come back in
+  // order we don't care how many were taken at a time.
+  std::vector<iree_task_t*> stolen_tasks;
+  iree_task_t* task = NULL;
+  while ((task = iree_task_queue_try_steal(&source_queue, &target_queue, 8))) {
+    std::vector<iree_task_t*> batch = {task};
+    while ((task = iree_task_queue_pop_front(&target_queue))) {
+      batch.push_back(task);
+    }
+    stolen_tasks.insert(stolen_tasks.begin(), batch.begin(), batch.end());
+  }
+  EXPECT_TRUE(iree_task_queue_is_empty(&source_queue));
+  ASSERT_EQ(tasks.size(), stolen_tasks.size());
+  for (size_t i = 0; i < tasks.size(); ++i) {
+    ASSERT_EQ(&tasks[i], stolen_tasks[i]);
+  }
+
+  iree_task_queue_deinitialize(&source_queue);
+  iree_task_queue_deinitialize(&target_queue);
+}
+
+// Races an owner popping tasks against thieves stealing them and ensures that
+// every task is taken exactly once.
+TEST(QueueTest, ConcurrentTheft) {
+  static constexpr int kThiefCount = 3;
+  static constexpr size_t kTaskCount = 10000;
+
+  iree_task_queue_t owner_queue;
+  iree_task_queue_initialize(&owner_queue);
+  std::vector<iree_task_t> tasks(kTaskCount);
+  std::vector<std::atomic<int>> task_counts(kTaskCount);
+  for (auto& count : task_counts) count.store(0);
+  auto record_task = [&](iree_task_t* task) {
+    task_counts[task - tasks.data()].fetch_add(1);
+  };
+
+  std::atomic<size_t> total_count(0);
+  std::vector<std::thread> thieves;
+  for (int i = 0; i < kThiefCount; ++i) {
+    thieves.emplace_back([&]() {
+      iree_task_queue_t thief_queue;
+      iree_task_queue_initialize(&thief_queue);
+      while (total_count.load() < kTaskCount) {
+        iree_task_t* task =
+            iree_task_queue_try_steal(&owner_queue, &thief_queue, 4);
+        if (!task) {
+          std::this_thread::yield();
+          continue;
+        }
+        do {
+          record_task(task);
+          total_count.fetch_add(1);
+        } while ((task = iree_task_queue_pop_front(&thief_queue)));
+      }
+      iree_task_queue_deinitialize(&thief_queue);
+    });
+  }
+
+  // Feed the queue in small batches interleaved with pops so that all of the
+  // owner paths race with the thieves.
+  size_t next_task = 0;
+  while (total_count.load() < kTaskCount) {
+    if (next_task < kTaskCount) {
+      iree_task_list_t list;
+      iree_task_list_initialize(&list);
+      for (int i = 0; i < 16 && next_task < kTaskCount; ++i) {
+        iree_task_list_push_front(&list, &tasks[next_task++]);
+      }
+      iree_task_queue_append_from_lifo_list_unsafe(&owner_queue, &list);
+    }
+    iree_task_t* task = iree_task_queue_pop_front(&owner_queue);
+    if (task) {
+      record_task(task);
+      total_count.fetch_add(1);
+    }
+  }
+  for (auto& thief : thieves) thief.join();
+
+  EXPECT_TRUE(iree_task_queue_is_empty(&owner_queue));
+  for (size_t i = 0; i < kTaskCount; ++i) {
+    ASSERT_EQ(1, task_counts[i].load()) << "task " << i;
+  }
+
+  iree_task_queue_deinitialize(&owner_queue);
+}
+
 }  // namespace
@@ -355,6 +355,33 @@ void iree_task_dispatch_statistics_merge(
   // TODO(benvanik): statistics.
 }
 
+// Returns the measured duration of a single tile in nanoseconds from |timing|
+// or 0 if the dispatch is not measured or has not yet been measured.
+static int64_t iree_task_dispatch_timing_query(
+    iree_task_dispatch_timing_t* timing) {
+  if (!timing) return 0;
+  return iree_atomic_load_int64(&timing->tile_duration_ns,
+                                iree_memory_order_relaxed);
+}
+
+// Folds the |duration_ns| it took to execute |tile_count| tiles into the
+// moving average tile duration in |timing|. Each sample moves the estimate a
+// quarter of the way to the sampled value so that a single slow slice (such as
+// one preempted by the OS) does not throw off future issues.
+static void iree_task_dispatch_timing_record(
+    iree_task_dispatch_timing_t* timing, uint32_t tile_count,
+    iree_time_t duration_ns) {
+  if (!timing || !tile_count) return;
+  int64_t sample_ns = iree_max(1, duration_ns / tile_count);
+  int64_t estimate_ns = iree_atomic_load_int64(&timing->tile_duration_ns,
+                                               iree_memory_order_relaxed);
+  if (estimate_ns > 0) {
+    sample_ns = iree_max(1, estimate_ns + (sample_ns - estimate_ns) / 4);
+  }
+  iree_atomic_store_int64(&timing->tile_duration_ns, sample_ns,
+                          iree_memory_order_relaxed);
+}
+
 //==============================================================================
 // IREE_TASK_TYPE_DISPATCH
 //==============================================================================
@@ -368,6 +395,7 @@ static void iree_task_dispatch_initialize_base(
          sizeof(out_task->workgroup_size));
   out_task->shared_memory_size = 0;
   memset(&out_task->statistics, 0, sizeof(out_task->statistics));
+  out_task->timing_key = 0;
 }
 
 void iree_task_dispatch_initialize(iree_task_scope_t* scope,
@@ -390,7 +418,7 @@ void iree_task_dispatch_initialize_indirect(
 }
 
 void iree_task_dispatch_issue_sliced(iree_task_dispatch_t* dispatch_task,
-                                     iree_task_pool_t* slice_task_pool,
+                                     iree_task_dispatch_timing_t* timing,
                                      iree_task_submission_t* pending_submission,
                                      iree_task_post_batch_t* post_batch) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -428,17 +456,45 @@ void iree_task_dispatch_issue_sliced(iree_task_dispatch_t* dispatch_task,
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
   // Divide up all tiles into slices, our finest-granularity scheduling task.
-  const uint32_t tiles_per_slice_x = IREE_TASK_DISPATCH_TILES_PER_SLICE_X;
+  iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
+  iree_host_size_t target_worker_count = worker_count;
+  uint32_t tiles_per_slice_x = IREE_TASK_DISPATCH_TILES_PER_SLICE_X;
   const uint32_t tiles_per_slice_y = IREE_TASK_DISPATCH_TILES_PER_SLICE_Y;
   const uint32_t tiles_per_slice_z = IREE_TASK_DISPATCH_TILES_PER_SLICE_Z;
-  uint32_t slice_count_x = iree_max(1, workgroup_count[0] / tiles_per_slice_x);
-  uint32_t slice_count_y = iree_max(1, workgroup_count[1] / tiles_per_slice_y);
-  uint32_t slice_count_z = iree_max(1, workgroup_count[2] / tiles_per_slice_z);
+  const int64_t tile_duration_ns = iree_task_dispatch_timing_query(timing);
+  if (tile_duration_ns > 0) {
+    // The tile cost is known from prior issues: only spread the dispatch
+    // across as many workers as it has work for and size the slices to the
+    // target duration. Slices are also kept small enough that each worker
+    // gets at least one so that the tail is not serialized on a single worker.
+    int64_t total_duration_ns = total_workgroup_count * tile_duration_ns;
+    int64_t useful_worker_count =
+        iree_max(1, total_duration_ns / IREE_TASK_DISPATCH_MIN_WORKER_NS);
+    if (useful_worker_count < (int64_t)worker_count) {
+      target_worker_count = (iree_host_size_t)useful_worker_count;
+    }
+    int64_t tiles_per_slice =
+        iree_min(IREE_TASK_DISPATCH_TARGET_RESERVATION_NS / tile_duration_ns,
+                 total_workgroup_count / (int64_t)target_worker_count);
+    tiles_per_slice /= tiles_per_slice_y * tiles_per_slice_z;
+    tiles_per_slice_x = (uint32_t)iree_min(
+        (int64_t)workgroup_count[0], iree_max(1, tiles_per_slice));
+  }
+  uint32_t slice_count_x =
+      (workgroup_count[0] + tiles_per_slice_x - 1) / tiles_per_slice_x;
+  uint32_t slice_count_y =
+      (workgroup_count[1] + tiles_per_slice_y - 1) / tiles_per_slice_y;
+  uint32_t slice_count_z =
+      (workgroup_count[2] + tiles_per_slice_z - 1) / tiles_per_slice_z;
 
   // Compute how many slices each worker will process.
   uint32_t slice_count = slice_count_x * slice_count_y * slice_count_z;
-  iree_host_size_t worker_count = iree_task_post_batch_worker_count(post_batch);
-  uint32_t slices_per_worker = iree_max(1, slice_count / worker_count);
+  uint32_t slices_per_worker =
+      (slice_count + target_worker_count - 1) / target_worker_count;
+
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, tile_duration_ns);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, tiles_per_slice_x);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, slice_count);
 
   // Randomize starting worker.
   iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
@@ -469,14 +525,18 @@ void iree_task_dispatch_issue_sliced(iree_task_dispatch_t* dispatch_task,
                                       workgroup_base[2] + tiles_per_slice_z) -
                              1;
 
-        // Allocate and initialize the slice.
+        // Allocate and initialize the slice from memory local to the worker
+        // selected for the task.
+        iree_host_size_t target_worker_index = worker_index % worker_count;
         iree_task_dispatch_slice_t* slice_task =
-            iree_task_dispatch_slice_allocate(dispatch_task, workgroup_base,
-                                              workgroup_range, workgroup_count,
-                                              slice_task_pool);
+            iree_task_dispatch_slice_allocate(
+                dispatch_task, workgroup_base, workgroup_range, workgroup_count,
+                iree_task_post_batch_dispatch_task_pool(post_batch,
+                                                        target_worker_index));
+        slice_task->timing = timing;
 
         // Enqueue on the worker selected for the task.
-        iree_task_post_batch_enqueue(post_batch, worker_index % worker_count,
+        iree_task_post_batch_enqueue(post_batch, target_worker_index,
                                      &slice_task->header);
         if (++worker_slice_count >= slices_per_worker) {
           ++worker_index;
@@ -501,7 +561,7 @@ void iree_task_dispatch_issue_sliced(iree_task_dispatch_t* dispatch_task,
 }
 
 void iree_task_dispatch_issue_sharded(
-    iree_task_dispatch_t* dispatch_task, iree_task_pool_t* shard_task_pool,
+    iree_task_dispatch_t* dispatch_task, iree_task_dispatch_timing_t* timing,
     iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -513,6 +573,7 @@ void iree_task_dispatch_issue_sharded(
   iree_task_dispatch_shard_state_t* shared_state =
       &dispatch_task->shared.shard_state;
   shared_state->dispatch_task = dispatch_task;
+  shared_state->timing = timing;
 
   // Fetch the workgroup count (directly or indirectly).
   // By the task being ready to execute we know any dependencies on the
@@ -555,8 +616,26 @@ void iree_task_dispatch_issue_sharded(
   // Compute how many tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
   // a lower number reduces maximum worst-case latency (coarser work stealing).
-  if (shared_state->tile_count <
-      worker_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
+  const int64_t tile_duration_ns = iree_task_dispatch_timing_query(timing);
+  if (tile_duration_ns > 0 && shard_count > 0) {
+    // The tile cost is known from prior issues: only wake as many workers as
+    // there is work for and reserve enough tiles to fill the target duration.
+    // Reservations are kept small enough that each shard makes at least two so
+    // that shards finishing early can pick up the slack of slower ones.
+    int64_t total_duration_ns = shared_state->tile_count * tile_duration_ns;
+    int64_t useful_worker_count =
+        iree_max(1, total_duration_ns / IREE_TASK_DISPATCH_MIN_WORKER_NS);
+    if (useful_worker_count < (int64_t)shard_count) {
+      shard_count = (iree_host_size_t)useful_worker_count;
+    }
+    int64_t tiles_per_reservation =
+        iree_min(IREE_TASK_DISPATCH_TARGET_RESERVATION_NS / tile_duration_ns,
+                 shared_state->tile_count / (int64_t)(shard_count * 2));
+    shared_state->tiles_per_reservation =
+        (uint32_t)iree_max(1, tiles_per_reservation);
+  } else if (shared_state->tile_count <
+             worker_count *
+                 IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
     // Grid is small - allow it to be eagerly sliced up.
     shared_state->tiles_per_reservation = 1;
   } else {
@@ -564,18 +643,26 @@ void iree_task_dispatch_issue_sharded(
         IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
   }
 
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, tile_duration_ns);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, shared_state->tiles_per_reservation);
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, shard_count);
+
   // Randomize starting worker.
   iree_host_size_t worker_offset = iree_task_post_batch_select_worker(
       post_batch, dispatch_task->header.affinity_set);
   iree_host_size_t worker_index = worker_offset;
 
   for (iree_host_size_t i = 0; i < shard_count; ++i) {
-    // Allocate and initialize the shard.
+    // Allocate and initialize the shard from memory local to the worker
+    // selected for the task.
+    iree_host_size_t target_worker_index = worker_index % worker_count;
     iree_task_dispatch_shard_t* shard_task = iree_task_dispatch_shard_allocate(
-        dispatch_task, shared_state, shard_task_pool);
+        dispatch_task, shared_state,
+        iree_task_post_batch_dispatch_task_pool(post_batch,
+                                                target_worker_index));
 
     // Enqueue on the worker selected for the task.
-    iree_task_post_batch_enqueue(post_batch, worker_index % worker_count,
+    iree_task_post_batch_enqueue(post_batch, target_worker_index,
                                  &shard_task->header);
     ++worker_index;
   }
@@ -642,6 +729,10 @@ void iree_task_dispatch_slice_initialize(iree_task_dispatch_t* dispatch_task,
   // then the per-slice statistics will roll up into the dispatch statistics.
   out_task->dispatch_statistics = &dispatch_task->statistics;
   memset(&out_task->slice_statistics, 0, sizeof(out_task->slice_statistics));
+
+  // Slices issued by the executor have this set to the executor-owned timing
+  // entry of the dispatch.
+  out_task->timing = NULL;
 }
 
 iree_task_dispatch_slice_t* iree_task_dispatch_slice_allocate(
@@ -686,6 +777,7 @@ iree_status_t iree_task_dispatch_slice_execute(
   const uint32_t range_x = task->workgroup_range[0];
   const uint32_t range_y = task->workgroup_range[1];
   const uint32_t range_z = task->workgroup_range[2];
+  const iree_time_t start_time_ns = task->timing ? iree_time_now() : 0;
   for (uint32_t z = base_z; z <= range_z; ++z) {
     tile_context.workgroup_xyz[2] = z;
     for (uint32_t y = base_y; y <= range_y; ++y) {
@@ -718,6 +810,13 @@ iree_status_t iree_task_dispatch_slice_execute(
     }
   }
 
+  if (task->timing) {
+    uint32_t tile_count = (range_x - base_x + 1) * (range_y - base_y + 1) *
+                          (range_z - base_z + 1);
+    iree_task_dispatch_timing_record(task->timing, tile_count,
+                                     iree_time_now() - start_time_ns);
+  }
+
   // Push aggregate statistics up to the dispatch.
   if (task->dispatch_statistics) {
     iree_task_dispatch_statistics_merge(&task->slice_statistics,
@@ -787,6 +886,8 @@ iree_status_t iree_task_dispatch_shard_execute(
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = shared_state->tile_count;
   const uint32_t tiles_per_reservation = shared_state->tiles_per_reservation;
+  const iree_time_t start_time_ns = shared_state->timing ? iree_time_now() : 0;
+  uint32_t executed_tile_count = 0;
   uint32_t tile_base = iree_atomic_fetch_add_int32(&shared_state->tile_index,
                                                    tiles_per_reservation,
                                                    iree_memory_order_relaxed);
@@ -832,9 +933,16 @@ iree_status_t iree_task_dispatch_shard_execute(
       }
     }
 
+    executed_tile_count += tile_range - tile_base;
     tile_base = next_tile_base;
   }
 
+  if (shared_state->timing) {
+    iree_task_dispatch_timing_record(shared_state->timing, executed_tile_count,
+                                     iree_time_now() - start_time_ns);
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, executed_tile_count);
+
   // Push aggregate statistics up to the dispatch.
   iree_task_dispatch_statistics_merge(&shard_statistics,
                                       &dispatch_task->statistics);
@@ -843,3 +951,25 @@ iree_status_t iree_task_dispatch_shard_execute(
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
 }
+
+//==============================================================================
+// Scheduled task execution
+//==============================================================================
+
+iree_status_t iree_task_execute_scheduled(
+    iree_task_t* task, iree_task_submission_t* pending_submission) {
+  switch (task->type) {
+    case IREE_TASK_TYPE_CALL:
+      return iree_task_call_execute((iree_task_call_t*)task,
+                                    pending_submission);
+    case IREE_TASK_TYPE_DISPATCH_SLICE:
+      return iree_task_dispatch_slice_execute((iree_task_dispatch_slice_t*)task,
+                                              pending_submission);
+    case IREE_TASK_TYPE_DISPATCH_SHARD:
+      return iree_task_dispatch_shard_execute((iree_task_dispatch_shard_t*)task,
+                                              pending_submission);
+    default:
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "incorrect task type for scheduled execution");
+  }
+}
@@ -443,6 +443,20 @@ typedef iree_alignas(iree_max_align_t) struct {
 
 typedef struct iree_task_dispatch_s iree_task_dispatch_t;
 
+// Measured execution cost of dispatches sharing the same timing key.
+// Owned by the executor and updated by slices and shards as they complete so
+// that future issues of the same work can be sized to the tile cost.
+//
+// Updates are made in a relaxed memory order without synchronization: a torn
+// update only perturbs the estimate used for scheduling decisions.
+typedef struct {
+  // iree_task_dispatch_t::timing_key of the dispatches being measured.
+  iree_atomic_int64_t key;
+  // Moving average of the duration of a single tile in nanoseconds or 0 if no
+  // tiles have been measured yet.
+  iree_atomic_int64_t tile_duration_ns;
+} iree_task_dispatch_timing_t;
+
 // Shared state for all shards processing a dispatch.
 typedef iree_alignas(iree_max_align_t) struct {
   // Direct reference to the parent dispatch that all shards are processing.
@@ -467,6 +481,10 @@ typedef iree_alignas(iree_max_align_t) struct {
   // Aligned to at least the natural pointer size of the machine. Functions must
   // use atomic operations to ensure proper memory ordering.
   iree_byte_span_t shared_memory;
+
+  // Executor-owned timing entry updated with the measured tile cost of each
+  // shard or NULL if the dispatch is not being measured.
+  iree_task_dispatch_timing_t* timing;
 } iree_task_dispatch_shard_state_t;
 
 //==============================================================================
@@ -550,6 +568,13 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_s {
   // Statistics storage used for aggregating counters across all slices.
   iree_task_dispatch_statistics_t statistics;
 
+  // Optional key identifying dispatches that perform the same work, such as
+  // those of the same executable entry point. When nonzero the executor
+  // measures the cost of the tiles executed and uses it to choose the slice,
+  // shard, and reservation sizes of future dispatches with the same key.
+  // Defaults to 0 (unmeasured) and must be set prior to submission.
+  uint64_t timing_key;
+
   // Shared state across all slices/shards/etc.
   // Stored once per dispatch and then referenced by all subtasks.
   union {
@@ -629,6 +654,10 @@ typedef iree_alignas(iree_max_align_t) struct {
   // contention on the shared dispatch statistics across multiple threads.
   iree_task_dispatch_statistics_t slice_statistics;
 
+  // Executor-owned timing entry updated with the measured tile cost of the
+  // slice or NULL if the dispatch is not being measured.
+  iree_task_dispatch_timing_t* timing;
+
   // Per-tile initialized coroutine storage for all tiles in the range
   // initialized as each tile begins execution.
   // TODO(benvanik): coroutine storage as iree_task_tile_storage_t.
@@ -87,26 +87,33 @@ void iree_task_wait_retire(iree_task_wait_t* task,
 //==============================================================================
 
 // Schedules a dispatch by forking out to zero or more slices that will be
-// executed on workers. The slices are allocated from an executor-owned pool
-// and are generally not user-visible - they'll just see their dispatch begin
-// execution prior to the slices and end execution after the last slice
-// finishes.
+// executed on workers. The slices are allocated from the executor-owned pool
+// of the worker they are posted to and are generally not user-visible -
+// they'll just see their dispatch begin execution prior to the slices and end
+// execution after the last slice finishes.
+//
+// If |timing| is provided the slices are sized based on the measured tile cost
+// and each slice will update it upon completion.
 //
 // Only called during coordination and expects the coordinator lock to be held.
 void iree_task_dispatch_issue_sliced(iree_task_dispatch_t* dispatch_task,
-                                     iree_task_pool_t* slice_task_pool,
+                                     iree_task_dispatch_timing_t* timing,
                                      iree_task_submission_t* pending_submission,
                                      iree_task_post_batch_t* post_batch);
 
 // Schedules a dispatch by forking out to zero or more shards that will be
-// executed on workers. The shards are allocated from an executor-owned pool
-// and are generally not user-visible - they'll just see their dispatch begin
-// execution prior to the slices and end execution after the last shard
-// finishes.
+// executed on workers. The shards are allocated from the executor-owned pool
+// of the worker they are posted to and are generally not user-visible -
+// they'll just see their dispatch begin execution prior to the slices and end
+// execution after the last shard finishes.
+//
+// If |timing| is provided the shard count and tile reservation size are chosen
+// based on the measured tile cost and each shard will update it upon
+// completion.
 //
 // Only called during coordination and expects the coordinator lock to be held.
 void iree_task_dispatch_issue_sharded(
-    iree_task_dispatch_t* dispatch_task, iree_task_pool_t* shard_task_pool,
+    iree_task_dispatch_t* dispatch_task, iree_task_dispatch_timing_t* timing,
     iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch);
 
@@ -157,6 +164,18 @@ iree_status_t iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task,
     iree_task_submission_t* pending_submission);
 
+//==============================================================================
+// Scheduled task execution
+//==============================================================================
+
+// Executes and retires a task that was scheduled to run on a worker.
+// Only task types that are scheduled to workers are handled; all others must be
+// handled by the coordinator during scheduling.
+// May block the caller for an indeterminate amount of time and should only be
+// called from threads owned by or donated to the executor.
+iree_status_t iree_task_execute_scheduled(
+    iree_task_t* task, iree_task_submission_t* pending_submission);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
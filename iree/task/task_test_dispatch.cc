@@ -22,9 +22,13 @@ namespace {
 
 class GridCoverage {
  public:
-  explicit GridCoverage(const uint32_t workgroup_count[3])
+  // |tile_duration_ns| is how long each tile will busy-wait to model dispatches
+  // with expensive tiles.
+  explicit GridCoverage(const uint32_t workgroup_count[3],
+                        iree_duration_t tile_duration_ns = 0)
       : workgroup_count_(workgroup_count[0] * workgroup_count[1] *
                          workgroup_count[2]),
+        tile_duration_ns_(tile_duration_ns),
         storage_(new iree_atomic_int32_t[workgroup_count_]) {
     for (iree_host_size_t i = 0; i < workgroup_count_; ++i) {
       storage_[i] = IREE_ATOMIC_VAR_INIT(0);
@@ -54,6 +58,12 @@ class GridCoverage {
     iree_atomic_fetch_add_int32(&coverage->storage_[slot], 1,
                                 iree_memory_order_seq_cst);
 
+    if (coverage->tile_duration_ns_ > 0) {
+      iree_time_t deadline_ns = iree_time_now() + coverage->tile_duration_ns_;
+      while (iree_time_now() < deadline_ns) {
+      }
+    }
+
     // Useful when testing large grids:
     // printf("%u, %u, %u\n", tile_context->workgroup_xyz[0],
     //        tile_context->workgroup_xyz[1], tile_context->workgroup_xyz[2]);
@@ -63,6 +73,7 @@ class GridCoverage {
 
  private:
   size_t workgroup_count_;
+  iree_duration_t tile_duration_ns_;
   std::unique_ptr<iree_atomic_int32_t[]> storage_;
 };
 
@@ -70,14 +81,16 @@ class TaskDispatchTest : public TaskTest {
  public:
   void DispatchAndVerifyGrid(const uint32_t workgroup_size[3],
                              const uint32_t workgroup_count[3],
-                             uint32_t dispatch_flags) {
-    GridCoverage coverage(workgroup_count);
+                             uint32_t dispatch_flags, uint64_t timing_key = 0,
+                             iree_duration_t tile_duration_ns = 0) {
+    GridCoverage coverage(workgroup_count, tile_duration_ns);
     iree_task_dispatch_t task;
     iree_task_dispatch_initialize(&scope_,
                                   iree_task_make_dispatch_closure(
                                       GridCoverage::Tile, (uintptr_t)&coverage),
                                   workgroup_size, workgroup_count, &task);
     task.header.flags |= dispatch_flags;
+    task.timing_key = timing_key;
     IREE_ASSERT_OK(SubmitTasksAndWaitIdle(&task.header, &task.header));
     EXPECT_TRUE(coverage.Verify());
   }
@@ -135,6 +148,58 @@ TEST_F(TaskDispatchTest, Issue345Sliced) {
                         IREE_TASK_FLAG_DISPATCH_SLICED);
 }
 
+// Grids that are not a multiple of the slice size must have their trailing
+// tiles covered by partial slices.
+TEST_F(TaskDispatchTest, IssueUnevenSliced) {
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {19, 3, 2};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                        IREE_TASK_FLAG_DISPATCH_SLICED);
+}
+
+// Repeatedly issues the same measured dispatch such that the first issue uses
+// the static tuning and subsequent issues are sized from the measured cost.
+TEST_F(TaskDispatchTest, IssueMeasuredSharded) {
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {37, 5, 3};
+  for (int i = 0; i < 4; ++i) {
+    DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, 0,
+                          /*timing_key=*/0x1234);
+  }
+}
+
+TEST_F(TaskDispatchTest, IssueMeasuredSliced) {
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {37, 5, 3};
+  for (int i = 0; i < 4; ++i) {
+    DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                          IREE_TASK_FLAG_DISPATCH_SLICED,
+                          /*timing_key=*/0x1234);
+  }
+}
+
+// Expensive tiles should be spread across workers one tile at a time.
+TEST_F(TaskDispatchTest, IssueMeasuredExpensiveSharded) {
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {17, 1, 1};
+  for (int i = 0; i < 3; ++i) {
+    DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, 0,
+                          /*timing_key=*/0x5678,
+                          /*tile_duration_ns=*/100 * 1000);
+  }
+}
+
+TEST_F(TaskDispatchTest, IssueMeasuredExpensiveSliced) {
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {17, 1, 1};
+  for (int i = 0; i < 3; ++i) {
+    DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount,
+                          IREE_TASK_FLAG_DISPATCH_SLICED,
+                          /*timing_key=*/0x5678,
+                          /*tile_duration_ns=*/100 * 1000);
+  }
+}
+
 TEST_F(TaskDispatchTest, IssueIndirect) {
   static const uint32_t kWorkgroupSize[3] = {1, 1, 1};
   static const uint32_t kWorkgroupCount[3] = {3, 4, 5};
@@ -168,4 +233,34 @@ TEST_F(TaskDispatchTest, IssueIndirect) {
   EXPECT_TRUE(coverage.Verify());
 }
 
+// Indirect dispatches sharing a timing key may have a different grid each time
+// they are issued; the measured tile cost must be applied to the grid read at
+// issue time.
+TEST_F(TaskDispatchTest, IssueMeasuredIndirect) {
+  static const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  static const uint32_t kWorkgroupCounts[][3] = {
+      {64, 1, 1}, {1, 1, 1}, {7, 9, 2}, {0, 3, 1}, {129, 2, 1},
+  };
+  static const uint32_t kDispatchFlags[] = {0, IREE_TASK_FLAG_DISPATCH_SLICED};
+  for (uint32_t dispatch_flags : kDispatchFlags) {
+    for (const auto& workgroup_count : kWorkgroupCounts) {
+      uint32_t indirect_workgroup_count[3];
+      memcpy(indirect_workgroup_count, workgroup_count,
+             sizeof(indirect_workgroup_count));
+      GridCoverage coverage(workgroup_count);
+      iree_task_dispatch_t dispatch_task;
+      iree_task_dispatch_initialize_indirect(
+          &scope_,
+          iree_task_make_dispatch_closure(GridCoverage::Tile,
+                                          (uintptr_t)&coverage),
+          kWorkgroupSize, indirect_workgroup_count, &dispatch_task);
+      dispatch_task.header.flags |= dispatch_flags;
+      dispatch_task.timing_key = 0x9ABC;
+      IREE_ASSERT_OK(
+          SubmitTasksAndWaitIdle(&dispatch_task.header, &dispatch_task.header));
+      EXPECT_TRUE(coverage.Verify());
+    }
+  }
+}
+
 }  // namespace
@@ -20,15 +20,26 @@
 
 #include "iree/base/debugging.h"
 #include "iree/base/math.h"
+#include "iree/base/target_platform.h"
 #include "iree/base/tracing.h"
 #include "iree/task/tuning.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <linux/mempolicy.h>
+#include <stdlib.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define IREE_TASK_TOPOLOGY_HAVE_SYSFS 1
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
 void iree_task_topology_group_initialize(
     uint8_t group_index, iree_task_topology_group_t* out_group) {
   memset(out_group, 0, sizeof(*out_group));
   out_group->group_index = group_index;
   snprintf(out_group->name, IREE_ARRAYSIZE(out_group->name), "worker[%u]",
            group_index);
+  out_group->numa_node = IREE_TASK_TOPOLOGY_NUMA_NODE_ANY;
   iree_thread_affinity_set_any(&out_group->ideal_thread_affinity);
   out_group->constructive_sharing_mask = IREE_TASK_TOPOLOGY_GROUP_MASK_ALL;
 }
@@ -102,6 +113,152 @@ void iree_task_topology_initialize_from_group_count(
   IREE_TRACE_ZONE_END(z0);
 }
 
+//==============================================================================
+// Linux sysfs queries
+//==============================================================================
+
+#if defined(IREE_TASK_TOPOLOGY_HAVE_SYSFS)
+
+// Maximum Linux CPU/NUMA node number (exclusive) that we track. Anything
+// larger is ignored as if it were not present in the system.
+#define IREE_TASK_TOPOLOGY_SYSFS_MAX_ID (1024)
+
+// Marks a CPU whose NUMA node is unknown in a CPU->node table.
+#define IREE_TASK_TOPOLOGY_SYSFS_NODE_UNKNOWN UINT16_MAX
+
+// A set of Linux CPU or NUMA node numbers as used in sysfs lists.
+typedef struct {
+  uint64_t bits[IREE_TASK_TOPOLOGY_SYSFS_MAX_ID / 64];
+} iree_task_topology_sysfs_set_t;
+
+static bool iree_task_topology_sysfs_set_test(
+    const iree_task_topology_sysfs_set_t* set, uint32_t id) {
+  if (id >= IREE_TASK_TOPOLOGY_SYSFS_MAX_ID) return false;
+  return (set->bits[id / 64] >> (id % 64)) & 1;
+}
+
+// Returns the first ID in |set| that is >= |start_id| or
+// IREE_TASK_TOPOLOGY_SYSFS_MAX_ID if there are none.
+static uint32_t iree_task_topology_sysfs_set_next(
+    const iree_task_topology_sysfs_set_t* set, uint32_t start_id) {
+  for (uint32_t id = start_id; id < IREE_TASK_TOPOLOGY_SYSFS_MAX_ID;
+       id = (id | 63) + 1) {
+    uint64_t word = set->bits[id / 64] >> (id % 64);
+    if (word) return id + iree_math_count_trailing_zeros_u64(word);
+  }
+  return IREE_TASK_TOPOLOGY_SYSFS_MAX_ID;
+}
+
+#define IREE_TASK_TOPOLOGY_SYSFS_SET_FOR_EACH(set, id)         \
+  for (uint32_t id = iree_task_topology_sysfs_set_next(set, 0); \
+       id < IREE_TASK_TOPOLOGY_SYSFS_MAX_ID;                    \
+       id = iree_task_topology_sysfs_set_next(set, id + 1))
+
+// Reads the sysfs file at |path| into a NUL-terminated |buffer|.
+// Returns false if the file could not be read.
+static bool iree_task_topology_sysfs_read_file(const char* path,
+                                               iree_host_size_t buffer_capacity,
+                                               char* buffer) {
+  FILE* file = fopen(path, "r");
+  if (!file) return false;
+  size_t length = fread(buffer, 1, buffer_capacity - 1, file);
+  fclose(file);
+  buffer[length] = 0;
+  return length > 0;
+}
+
+// Reads a sysfs list file such as "0-3,8,10-11" from |path| into |out_set|.
+// Returns false if the file could not be read.
+static bool iree_task_topology_sysfs_read_list(
+    const char* path, iree_task_topology_sysfs_set_t* out_set) {
+  memset(out_set, 0, sizeof(*out_set));
+  char buffer[4096];
+  if (!iree_task_topology_sysfs_read_file(path, sizeof(buffer), buffer)) {
+    return false;
+  }
+  const char* p = buffer;
+  while (*p >= '0' && *p <= '9') {
+    char* end = NULL;
+    unsigned long first_id = strtoul(p, &end, 10);
+    unsigned long last_id = first_id;
+    p = end;
+    if (*p == '-') {
+      last_id = strtoul(p + 1, &end, 10);
+      p = end;
+    }
+    for (unsigned long id = first_id;
+         id <= last_id && id < IREE_TASK_TOPOLOGY_SYSFS_MAX_ID; ++id) {
+      out_set->bits[id / 64] |= 1ull << (id % 64);
+    }
+    if (*p != ',') break;
+    ++p;
+  }
+  return true;
+}
+
+// Reads a single unsigned integer from the sysfs file at |path|.
+static bool iree_task_topology_sysfs_read_uint32(const char* path,
+                                                 uint32_t* out_value) {
+  char buffer[32];
+  if (!iree_task_topology_sysfs_read_file(path, sizeof(buffer), buffer)) {
+    return false;
+  }
+  char* end = NULL;
+  *out_value = (uint32_t)strtoul(buffer, &end, 10);
+  return end != buffer;
+}
+
+// Populates |out_cpu_nodes| with the NUMA node of each Linux CPU number.
+// Returns false if the NUMA topology could not be queried or the system only
+// has a single node (in which case there's no point tracking it).
+static bool iree_task_topology_sysfs_query_cpu_nodes(
+    uint16_t out_cpu_nodes[IREE_TASK_TOPOLOGY_SYSFS_MAX_ID]) {
+  for (uint32_t i = 0; i < IREE_TASK_TOPOLOGY_SYSFS_MAX_ID; ++i) {
+    out_cpu_nodes[i] = IREE_TASK_TOPOLOGY_SYSFS_NODE_UNKNOWN;
+  }
+  iree_task_topology_sysfs_set_t node_set;
+  if (!iree_task_topology_sysfs_read_list("/sys/devices/system/node/online",
+                                          &node_set)) {
+    return false;
+  }
+  iree_host_size_t node_count = 0;
+  IREE_TASK_TOPOLOGY_SYSFS_SET_FOR_EACH(&node_set, node_id) {
+    char path[64];
+    snprintf(path, sizeof(path), "/sys/devices/system/node/node%u/cpulist",
+             node_id);
+    iree_task_topology_sysfs_set_t cpu_set;
+    if (!iree_task_topology_sysfs_read_list(path, &cpu_set)) continue;
+    IREE_TASK_TOPOLOGY_SYSFS_SET_FOR_EACH(&cpu_set, cpu_id) {
+      out_cpu_nodes[cpu_id] = (uint16_t)node_id;
+    }
+    ++node_count;
+  }
+  return node_count > 1;
+}
+
+#endif  // IREE_TASK_TOPOLOGY_HAVE_SYSFS
+
+// Assigns the NUMA node of each group with a specified affinity based on the
+// processor it is pinned to. Groups are left as
+// IREE_TASK_TOPOLOGY_NUMA_NODE_ANY if the node cannot be determined or the
+// system only has a single node.
+static void iree_task_topology_fixup_numa_nodes(
+    iree_task_topology_t* topology) {
+#if defined(IREE_TASK_TOPOLOGY_HAVE_SYSFS)
+  uint16_t cpu_nodes[IREE_TASK_TOPOLOGY_SYSFS_MAX_ID];
+  if (!iree_task_topology_sysfs_query_cpu_nodes(cpu_nodes)) return;
+  for (iree_host_size_t i = 0; i < topology->group_count; ++i) {
+    iree_task_topology_group_t* group = &topology->groups[i];
+    if (!group->ideal_thread_affinity.specified) continue;
+    uint32_t cpu_id = group->ideal_thread_affinity.id;
+    if (cpu_id < IREE_TASK_TOPOLOGY_SYSFS_MAX_ID &&
+        cpu_nodes[cpu_id] != IREE_TASK_TOPOLOGY_SYSFS_NODE_UNKNOWN) {
+      group->numa_node = cpu_nodes[cpu_id];
+    }
+  }
+#endif  // IREE_TASK_TOPOLOGY_HAVE_SYSFS
+}
+
 // Runs the cpuinfo initializer which caches its result on the first call.
 // Returns a failure if cpuinfo does not support the CPU/platform.
 static iree_status_t iree_task_topology_ensure_cpuinfo_available() {
@@ -341,6 +498,7 @@ void iree_task_topology_initialize_from_physical_cores_with_filter(
   }
 
   iree_task_topology_fixup_constructive_sharing_masks(out_topology);
+  iree_task_topology_fixup_numa_nodes(out_topology);
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -380,5 +538,218 @@ void iree_task_topology_initialize_from_unique_l2_cache_groups(
   }
 
   iree_task_topology_fixup_constructive_sharing_masks(out_topology);
+  iree_task_topology_fixup_numa_nodes(out_topology);
   IREE_TRACE_ZONE_END(z0);
 }
+
+void iree_task_topology_initialize_from_sysfs(
+    iree_host_size_t max_group_count, iree_task_topology_t* out_topology) {
+#if defined(IREE_TASK_TOPOLOGY_HAVE_SYSFS)
+  max_group_count =
+      iree_min(max_group_count, IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT);
+  iree_task_topology_sysfs_set_t online_set;
+  if (!iree_task_topology_sysfs_read_list("/sys/devices/system/cpu/online",
+                                          &online_set)) {
+    iree_task_topology_initialize_from_physical_cores(max_group_count,
+                                                      out_topology);
+    return;
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  uint16_t cpu_nodes[IREE_TASK_TOPOLOGY_SYSFS_MAX_ID];
+  bool has_numa_nodes = iree_task_topology_sysfs_query_cpu_nodes(cpu_nodes);
+
+  // Pick one CPU per physical core: the first online CPU of each set of SMT
+  // siblings. The SMT siblings are still used by the workers via the group
+  // affinity.
+  typedef struct {
+    uint32_t cpu_id;
+    uint16_t numa_node;
+    bool smt;
+  } iree_task_topology_sysfs_core_t;
+  iree_task_topology_sysfs_core_t cores[IREE_TASK_TOPOLOGY_SYSFS_MAX_ID];
+  iree_host_size_t core_count = 0;
+  IREE_TASK_TOPOLOGY_SYSFS_SET_FOR_EACH(&online_set, cpu_id) {
+    char path[96];
+    snprintf(path, sizeof(path),
+             "/sys/devices/system/cpu/cpu%u/topology/thread_siblings_list",
+             cpu_id);
+    iree_task_topology_sysfs_set_t sibling_set;
+    bool smt = false;
+    if (iree_task_topology_sysfs_read_list(path, &sibling_set)) {
+      uint32_t first_sibling_id = IREE_TASK_TOPOLOGY_SYSFS_MAX_ID;
+      iree_host_size_t sibling_count = 0;
+      IREE_TASK_TOPOLOGY_SYSFS_SET_FOR_EACH(&sibling_set, sibling_id) {
+        if (!iree_task_topology_sysfs_set_test(&online_set, sibling_id)) {
+          continue;
+        }
+        if (first_sibling_id == IREE_TASK_TOPOLOGY_SYSFS_MAX_ID) {
+          first_sibling_id = sibling_id;
+        }
+        ++sibling_count;
+      }
+      if (first_sibling_id != cpu_id) continue;  // not the first sibling
+      smt = sibling_count > 1;
+    }
+    iree_task_topology_sysfs_core_t* core = &cores[core_count++];
+    core->cpu_id = cpu_id;
+    core->numa_node = has_numa_nodes ? cpu_nodes[cpu_id]
+                                     : IREE_TASK_TOPOLOGY_SYSFS_NODE_UNKNOWN;
+    core->smt = smt;
+  }
+
+  // Order the cores node by node (keeping the CPU order within each node) so
+  // that a limited number of groups are packed onto as few nodes as possible.
+  // Cores with unknown nodes sort last.
+  for (iree_host_size_t i = 1; i < core_count; ++i) {
+    iree_task_topology_sysfs_core_t core = cores[i];
+    iree_host_size_t j = i;
+    for (; j > 0 && cores[j - 1].numa_node > core.numa_node; --j) {
+      cores[j] = cores[j - 1];
+    }
+    cores[j] = core;
+  }
+
+  iree_task_topology_initialize(out_topology);
+  out_topology->group_count = iree_min(core_count, max_group_count);
+  for (iree_host_size_t i = 0; i < out_topology->group_count; ++i) {
+    const iree_task_topology_sysfs_core_t* core = &cores[i];
+    iree_task_topology_group_t* group = &out_topology->groups[i];
+    iree_task_topology_group_initialize(i, group);
+    group->processor_index = core->cpu_id;
+    if (core->numa_node != IREE_TASK_TOPOLOGY_SYSFS_NODE_UNKNOWN) {
+      group->numa_node = core->numa_node;
+    }
+    memset(&group->ideal_thread_affinity, 0,
+           sizeof(group->ideal_thread_affinity));
+    group->ideal_thread_affinity.specified = 1;
+    group->ideal_thread_affinity.smt = core->smt ? 1 : 0;
+    group->ideal_thread_affinity.id = core->cpu_id;
+  }
+
+  // Groups whose CPUs share an L2 cache may constructively share. If the cache
+  // information is unavailable the groups keep the default of sharing with all.
+  for (iree_host_size_t i = 0; i < out_topology->group_count; ++i) {
+    iree_task_topology_group_t* group = &out_topology->groups[i];
+    for (uint32_t cache_index = 0; cache_index < 8; ++cache_index) {
+      char path[96];
+      snprintf(path, sizeof(path),
+               "/sys/devices/system/cpu/cpu%u/cache/index%u/level",
+               group->processor_index, cache_index);
+      uint32_t level = 0;
+      if (!iree_task_topology_sysfs_read_uint32(path, &level)) break;
+      if (level != 2) continue;
+      snprintf(path, sizeof(path),
+               "/sys/devices/system/cpu/cpu%u/cache/index%u/shared_cpu_list",
+               group->processor_index, cache_index);
+      iree_task_topology_sysfs_set_t shared_set;
+      if (!iree_task_topology_sysfs_read_list(path, &shared_set)) break;
+      iree_task_topology_group_mask_t group_mask = 0;
+      for (iree_host_size_t j = 0; j < out_topology->group_count; ++j) {
+        if (i == j) continue;
+        const iree_task_topology_group_t* other_group =
+            &out_topology->groups[j];
+        if (iree_task_topology_sysfs_set_test(&shared_set,
+                                              other_group->processor_index)) {
+          group_mask |= 1ull << other_group->group_index;
+        }
+      }
+      group->constructive_sharing_mask = group_mask;
+      break;
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+#else
+  iree_task_topology_initialize_from_physical_cores(max_group_count,
+                                                    out_topology);
+#endif  // IREE_TASK_TOPOLOGY_HAVE_SYSFS
+}
+
+#if defined(IREE_TASK_TOPOLOGY_HAVE_SYSFS)
+
+// Size of the header preceding each NUMA node allocation that stores the size
+// of the mapping. Keeps the returned pointers cache line aligned.
+#define IREE_TASK_TOPOLOGY_NUMA_ALLOCATION_HEADER_SIZE (64)
+
+static void iree_task_topology_numa_node_free(void* self, void* ptr) {
+  if (!ptr) return;
+  uint8_t* base =
+      (uint8_t*)ptr - IREE_TASK_TOPOLOGY_NUMA_ALLOCATION_HEADER_SIZE;
+  IREE_TRACE_FREE(ptr);
+  munmap(base, *(iree_host_size_t*)base);
+}
+
+static iree_status_t iree_task_topology_numa_node_allocate(
+    void* self, iree_allocation_mode_t mode, iree_host_size_t byte_length,
+    void** out_ptr) {
+  IREE_ASSERT_ARGUMENT(out_ptr);
+  if (byte_length == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "allocations must be >0 bytes");
+  }
+  uint32_t numa_node = (uint32_t)((uintptr_t)self - 1);
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Fresh anonymous mappings are zeroed and not yet backed by pages. Setting
+  // the policy prior to touching the memory ensures that the pages are faulted
+  // in on the requested node. We only express a preference so that the kernel
+  // can fall back to other nodes under memory pressure, and failures (kernels
+  // without NUMA support, seccomp filters, etc) are ignored as placement is
+  // purely an optimization.
+  iree_host_size_t page_size = (iree_host_size_t)sysconf(_SC_PAGESIZE);
+  iree_host_size_t mapping_size = iree_math_align(
+      IREE_TASK_TOPOLOGY_NUMA_ALLOCATION_HEADER_SIZE + byte_length, page_size);
+  uint8_t* base = (uint8_t*)mmap(NULL, mapping_size, PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (base == MAP_FAILED) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "failed to map %zu bytes for NUMA node %u",
+                            byte_length, numa_node);
+  }
+  unsigned long node_mask[IREE_TASK_TOPOLOGY_SYSFS_MAX_ID /
+                          (8 * sizeof(unsigned long))];
+  memset(node_mask, 0, sizeof(node_mask));
+  node_mask[numa_node / (8 * sizeof(unsigned long))] |=
+      1ul << (numa_node % (8 * sizeof(unsigned long)));
+  syscall(SYS_mbind, base, mapping_size, MPOL_PREFERRED, node_mask,
+          IREE_TASK_TOPOLOGY_SYSFS_MAX_ID + 1, 0);
+  *(iree_host_size_t*)base = mapping_size;
+  void* ptr = base + IREE_TASK_TOPOLOGY_NUMA_ALLOCATION_HEADER_SIZE;
+
+  // Emulate realloc by copying the existing contents over.
+  void* existing_ptr = *out_ptr;
+  if (existing_ptr && (mode & IREE_ALLOCATION_MODE_TRY_REUSE_EXISTING)) {
+    if (!(mode & IREE_ALLOCATION_MODE_ZERO_CONTENTS)) {
+      iree_host_size_t existing_length =
+          *(iree_host_size_t*)((uint8_t*)existing_ptr -
+                               IREE_TASK_TOPOLOGY_NUMA_ALLOCATION_HEADER_SIZE) -
+          IREE_TASK_TOPOLOGY_NUMA_ALLOCATION_HEADER_SIZE;
+      memcpy(ptr, existing_ptr, iree_min(existing_length, byte_length));
+    }
+    iree_task_topology_numa_node_free(self, existing_ptr);
+  }
+
+  IREE_TRACE_ALLOC(ptr, byte_length);
+  *out_ptr = ptr;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+#endif  // IREE_TASK_TOPOLOGY_HAVE_SYSFS
+
+iree_allocator_t iree_task_topology_numa_node_allocator(
+    uint32_t numa_node, iree_allocator_t base_allocator) {
+#if defined(IREE_TASK_TOPOLOGY_HAVE_SYSFS)
+  if (numa_node < IREE_TASK_TOPOLOGY_SYSFS_MAX_ID) {
+    iree_allocator_t allocator = {(void*)((uintptr_t)numa_node + 1),
+                                  iree_task_topology_numa_node_allocate,
+                                  iree_task_topology_numa_node_free};
+    return allocator;
+  }
+#endif  // IREE_TASK_TOPOLOGY_HAVE_SYSFS
+  return base_allocator;
+}
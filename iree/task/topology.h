@@ -35,6 +35,10 @@ typedef uint64_t iree_task_topology_group_mask_t;
 #define IREE_TASK_TOPOLOGY_GROUP_BIT_COUNT \
   (sizeof(iree_task_topology_group_mask_t) * 8)
 
+// NUMA node ID indicating that the node of a group is unknown. Groups with an
+// unknown node are treated as being local to all other groups.
+#define IREE_TASK_TOPOLOGY_NUMA_NODE_ANY UINT32_MAX
+
 // Information about a particular group within the topology.
 // Groups may be of varying levels of granularity even within the same topology
 // based on how the topology is defined.
@@ -46,9 +50,16 @@ typedef struct {
   // A name assigned to executor workers used for logging/tracing.
   char name[16];
 
-  // Processor index in the cpuinfo set.
+  // Processor index in the cpuinfo set (or the Linux CPU number for groups
+  // derived from sysfs).
   uint32_t processor_index;
 
+  // NUMA node the processors of the group are attached to or
+  // IREE_TASK_TOPOLOGY_NUMA_NODE_ANY if unknown. Workers prefer stealing from
+  // other workers on the same node and allocate their task pools from memory
+  // local to the node.
+  uint32_t numa_node;
+
   // Ideal thread affinity for threads within this group.
   // All threads within the group share the same affinity and this is what
   // allows us to model Simultaneous Multi-Threading (SMT) (aka hyperthreading).
@@ -169,6 +180,28 @@ void iree_task_topology_initialize_from_physical_cores_with_filter(
 void iree_task_topology_initialize_from_unique_l2_cache_groups(
     iree_host_size_t max_group_count, iree_task_topology_t* out_topology);
 
+// Initializes a topology with one group for each physical core in the machine
+// as described by the Linux sysfs (/sys/devices/system/). Groups are assigned
+// the NUMA node of their core and are ordered node by node such that when
+// |max_group_count| is less than the total core count the workers are packed
+// onto as few nodes as possible. Constructive sharing masks are derived from
+// the L2 cache shared CPU lists.
+//
+// This works on architectures not supported by cpuinfo. If sysfs is not
+// available (non-Linux platforms, restricted containers, etc) this falls back
+// to the same behavior as iree_task_topology_initialize_from_physical_cores.
+void iree_task_topology_initialize_from_sysfs(
+    iree_host_size_t max_group_count, iree_task_topology_t* out_topology);
+
+// Returns an allocator that places the memory it allocates on |numa_node|.
+// Allocations are made directly from the system in whole pages and are best
+// suited to large and long-lived blocks such as those backing task pools.
+//
+// If |numa_node| is IREE_TASK_TOPOLOGY_NUMA_NODE_ANY or memory placement is not
+// supported on the platform then |base_allocator| is returned.
+iree_allocator_t iree_task_topology_numa_node_allocator(
+    uint32_t numa_node, iree_allocator_t base_allocator);
+
 // TODO(#4654): more helpers and better defaults for the platforms we support.
 // Users can always make their own but just using these is the common path.
 // Ideas:
@@ -151,4 +151,39 @@ TEST(TopologyTest, FromPhysicalCores) {
   iree_task_topology_deinitialize(&topology);
 }
 
+TEST(TopologyTest, FromSysfs) {
+  static constexpr iree_host_size_t kMaxGroupCount = 4;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_topology_initialize_from_sysfs(kMaxGroupCount, &topology);
+  EnsureTopologyValid(kMaxGroupCount, &topology);
+  iree_task_topology_deinitialize(&topology);
+}
+
+TEST(TopologyTest, NumaNodeAllocator) {
+  // Node 0 always exists when NUMA is supported and otherwise the allocator
+  // falls back to the base allocator; either way allocations must work.
+  iree_allocator_t allocator =
+      iree_task_topology_numa_node_allocator(0, iree_allocator_system());
+  uint8_t* ptr = NULL;
+  IREE_ASSERT_OK(iree_allocator_malloc(allocator, 100, (void**)&ptr));
+  for (int i = 0; i < 100; ++i) {
+    EXPECT_EQ(0, ptr[i]);
+    ptr[i] = (uint8_t)i;
+  }
+  IREE_ASSERT_OK(iree_allocator_realloc(allocator, 64 * 1024, (void**)&ptr));
+  for (int i = 0; i < 100; ++i) EXPECT_EQ(i, ptr[i]);
+  iree_allocator_free(allocator, ptr);
+}
+
+TEST(TopologyTest, NumaNodeAllocatorAny) {
+  // Memory that can be placed on any node comes from the base allocator.
+  iree_allocator_t base_allocator = iree_allocator_system();
+  iree_allocator_t allocator = iree_task_topology_numa_node_allocator(
+      IREE_TASK_TOPOLOGY_NUMA_NODE_ANY, base_allocator);
+  EXPECT_EQ(base_allocator.self, allocator.self);
+  EXPECT_EQ(base_allocator.alloc, allocator.alloc);
+  EXPECT_EQ(base_allocator.free, allocator.free);
+}
+
 }  // namespace
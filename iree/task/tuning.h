@@ -60,6 +60,20 @@ extern "C" {
 // sources.
 #define IREE_TASK_EXECUTOR_MAX_OUTSTANDING_WAITS (64 - 1)
 
+// Selects the implementation of the worker-local iree_task_queue_t:
+//   0: linked list guarded by a futex-backed slim mutex (default).
+//   1: lock-free bounded Chase-Lev deque with a mutex-guarded overflow list.
+// The lock-free variant avoids lock contention when many workers are stealing
+// from the same victim at the cost of a fixed ring allocation per queue.
+// Override by defining IREE_TASK_QUEUE_LOCK_FREE=1 when building.
+#if !defined(IREE_TASK_QUEUE_LOCK_FREE)
+#define IREE_TASK_QUEUE_LOCK_FREE 0
+#endif  // !IREE_TASK_QUEUE_LOCK_FREE
+
+// Number of task pointers held in the ring of each lock-free queue; tasks
+// beyond this spill into the overflow list. Must be a power of two.
+#define IREE_TASK_QUEUE_LOCK_FREE_CAPACITY (256)
+
 // Allows for dividing the total number of attempts that a worker will make to
 // steal tasks from other workers. By default all other workers will be
 // attempted while setting this to 2, for example, will try for only half of
@@ -86,6 +100,24 @@ extern "C" {
 #define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
   IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
+// Default maximum duration in nanoseconds that a worker will spin waiting for
+// new work after running out of tasks before parking itself in the kernel.
+// The actual duration is adapted per worker based on the measured gap between
+// going idle and receiving new work: workloads with short gaps between
+// dispatches (such as those separated by barriers) will spin and avoid the
+// tens of microseconds wake latency while workloads with long gaps will park
+// immediately and not burn CPU time.
+//
+// Can be changed per executor with iree_task_executor_set_worker_spin_ns and
+// set to zero to disable spinning entirely.
+#define IREE_TASK_EXECUTOR_DEFAULT_WORKER_SPIN_NS (50 * 1000)
+
+// Maximum duration in nanoseconds a donated caller will wait on its own wait
+// handle when it has no work it can run itself. After each slice the caller
+// retries stealing (or pumping, for threadless executors) in case work it
+// depends on became ready without being picked up by anyone else.
+#define IREE_TASK_EXECUTOR_DONATE_WAIT_SLICE_NS (1000 * 1000)
+
 // Number of tiles that will be batched into a single slice along each XYZ dim.
 //
 // Larger numbers reduce overhead and ensure that more tiles are executed
@@ -118,6 +150,28 @@ extern "C" {
 // memory).
 #define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
 
+// Number of dispatch timing entries tracked by each executor. Dispatches with a
+// timing_key are mapped into this direct-mapped table and dispatches that
+// collide will evict each other's measurements. Must be a power of two.
+#define IREE_TASK_EXECUTOR_DISPATCH_TIMING_CAPACITY (256)
+
+// Target duration in nanoseconds of a single slice or shard reservation when
+// the tile cost of a dispatch has been measured. Dispatches with microsecond
+// tiles will batch many tiles together to amortize scheduling overhead while
+// dispatches with millisecond tiles will hand out one tile at a time so that
+// work stealing can balance the load.
+//
+// The static IREE_TASK_DISPATCH_TILES_PER_SLICE_* and
+// IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION values are used until a
+// dispatch has been measured.
+#define IREE_TASK_DISPATCH_TARGET_RESERVATION_NS (50 * 1000)
+
+// Minimum estimated duration in nanoseconds of work required for a measured
+// dispatch to be issued to an additional worker. Waking a worker has a latency
+// of tens of microseconds and spreading a tiny dispatch across all workers is
+// often slower than running it on one.
+#define IREE_TASK_DISPATCH_MIN_WORKER_NS (25 * 1000)
+
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
 // TODO(#4017): make per-tile color tracing fast enough to always have on.
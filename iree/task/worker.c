@@ -24,6 +24,8 @@ static int iree_task_worker_main(iree_task_worker_t* worker);
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
+    iree_task_affinity_set_t local_node_mask,
+    iree_task_pool_t* dispatch_task_pool,
     iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -32,14 +34,20 @@ iree_status_t iree_task_worker_initialize(
   out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
   out_worker->constructive_sharing_mask =
       topology_group->constructive_sharing_mask;
+  out_worker->local_node_mask = local_node_mask;
+  out_worker->dispatch_task_pool = dispatch_task_pool;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
+  // Start out assuming work arrives quickly so that we spin on the first idle
+  // and measure the real gap instead of the wake latency.
+  out_worker->idle_gap_ns = 0;
 
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
-  if (executor->scheduling_mode &
-      IREE_TASK_SCHEDULING_MODE_DEFER_WORKER_STARTUP) {
+  if (!executor->threadless &&
+      (executor->scheduling_mode &
+       IREE_TASK_SCHEDULING_MODE_DEFER_WORKER_STARTUP)) {
     // User is favoring startup latency vs. initial scheduling latency. Our
     // thread will be created suspended and not first scheduled until work
     // arrives for it, (almost) ensuring no context switches and 10x+ lower
@@ -49,11 +57,20 @@ iree_status_t iree_task_worker_initialize(
   iree_atomic_store_int32(&out_worker->state, initial_state,
                           iree_memory_order_seq_cst);
 
-  iree_notification_initialize(&out_worker->wake_notification);
+  iree_notification_initialize_in_group(&out_worker->wake_notification,
+                                        &executor->worker_wake_group,
+                                        worker_index);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
   iree_task_queue_initialize(&out_worker->local_task_queue);
 
+  // Threadless executors pump their worker from whichever thread is flushing or
+  // donating to the executor.
+  if (executor->threadless) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
   iree_thread_create_params_t thread_params;
   memset(&thread_params, 0, sizeof(thread_params));
   thread_params.name = iree_make_cstring_view(topology_group->name);
@@ -97,7 +114,6 @@ void iree_task_worker_deinitialize(iree_task_worker_t* worker) {
   // get anything more posted to it) and then discarding everything we still
   // have a reference to.
   iree_atomic_task_slist_discard(&worker->mailbox_slist);
-  iree_task_list_discard(&worker->local_task_queue.list);
 
   iree_notification_deinitialize(&worker->wake_notification);
   iree_notification_deinitialize(&worker->state_notification);
@@ -163,47 +179,6 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
   return NULL;
 }
 
-// Executes a task on a worker.
-// Only task types that are scheduled to workers are handled; all others must be
-// handled by the coordinator during scheduling.
-static iree_status_t iree_task_worker_execute(
-    iree_task_worker_t* worker, iree_task_t* task,
-    iree_task_submission_t* pending_submission) {
-  // Execute the task and resolve the task and gather any tasks that are now
-  // ready for submission to the executor. They'll be scheduled the next time
-  // the coordinator runs.
-  //
-  // TODO(benvanik): think a bit more about this timing; this ensures we have
-  // BFS behavior at the cost of the additional merge overhead - it's probably
-  // worth it?
-  // TODO(benvanik): handle partial tasks and re-queuing.
-  switch (task->type) {
-    case IREE_TASK_TYPE_CALL: {
-      IREE_RETURN_IF_ERROR(
-          iree_task_call_execute((iree_task_call_t*)task, pending_submission));
-      break;
-    }
-    case IREE_TASK_TYPE_DISPATCH_SLICE: {
-      IREE_RETURN_IF_ERROR(iree_task_dispatch_slice_execute(
-          (iree_task_dispatch_slice_t*)task, pending_submission));
-      break;
-    }
-    case IREE_TASK_TYPE_DISPATCH_SHARD: {
-      IREE_RETURN_IF_ERROR(iree_task_dispatch_shard_execute(
-          (iree_task_dispatch_shard_t*)task, pending_submission));
-      break;
-    }
-    default:
-      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                              "incorrect task type for worker execution");
-  }
-
-  // NOTE: task is invalidated here!
-  task = NULL;
-
-  return iree_ok_status();
-}
-
 // Pumps the worker thread once, processing a single task.
 // Returns true if pumping should continue as there are more tasks remaining or
 // false if the caller should wait for more tasks to be posted.
@@ -237,8 +212,8 @@ static bool iree_task_worker_pump_once(
   if (!task) {
     task = iree_task_executor_try_steal_task(
         worker->executor, worker->constructive_sharing_mask,
-        worker->max_theft_attempts, &worker->theft_prng,
-        &worker->local_task_queue);
+        worker->local_node_mask, worker->max_theft_attempts,
+        &worker->theft_prng, &worker->local_task_queue);
   }
 
   // No tasks to run; let the caller know we want to wait for more.
@@ -248,9 +223,15 @@ static bool iree_task_worker_pump_once(
   }
 
   // Execute the task (may call out to arbitrary user code and may submit more
-  // tasks for execution).
-  iree_status_t status =
-      iree_task_worker_execute(worker, task, pending_submission);
+  // tasks for execution). Any tasks that are now ready are gathered into the
+  // |pending_submission| and will be scheduled the next time the coordinator
+  // runs.
+  //
+  // TODO(benvanik): think a bit more about this timing; this ensures we have
+  // BFS behavior at the cost of the additional merge overhead - it's probably
+  // worth it?
+  // TODO(benvanik): handle partial tasks and re-queuing.
+  iree_status_t status = iree_task_execute_scheduled(task, pending_submission);
 
   // TODO(#4026): propagate failure to task scope.
   // We currently drop the error on the floor here; that's because the error
@@ -267,6 +248,93 @@ static bool iree_task_worker_pump_once(
   return true;  // try again
 }
 
+bool iree_task_worker_pump_inline(iree_task_worker_t* worker) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_task_submission_t pending_submission;
+  iree_task_submission_initialize(&pending_submission);
+
+  int executed_count = 0;
+  while (iree_task_worker_pump_once(worker, &pending_submission)) {
+    ++executed_count;
+  }
+
+  if (!iree_task_submission_is_empty(&pending_submission)) {
+    iree_task_executor_merge_submission(worker->executor, &pending_submission);
+  }
+
+  IREE_TRACE_ZONE_APPEND_VALUE(z0, executed_count);
+  IREE_TRACE_ZONE_END(z0);
+  return executed_count > 0;
+}
+
+// Returns how long the worker should spin waiting for new work before parking.
+// We only spin if the recent gaps between going idle and receiving new work
+// fit within the executor spin limit and then only for a bit longer than the
+// average gap; if work isn't arriving that fast spinning just burns CPU.
+static iree_duration_t iree_task_worker_select_spin_ns(
+    iree_task_worker_t* worker, iree_duration_t max_spin_ns) {
+  if (worker->idle_gap_ns >= max_spin_ns) return 0;
+  return iree_min(max_spin_ns, 2 * worker->idle_gap_ns + 1000);
+}
+
+// Folds a measured idle gap into the moving average used to size spins.
+// Samples are clamped so that a single long idle period (such as between
+// unrelated requests) doesn't disable spinning for the next burst of work.
+static void iree_task_worker_record_idle_gap(iree_task_worker_t* worker,
+                                             iree_duration_t max_spin_ns,
+                                             iree_duration_t idle_gap_ns) {
+  idle_gap_ns = iree_min(idle_gap_ns, 2 * max_spin_ns);
+  worker->idle_gap_ns += (idle_gap_ns - worker->idle_gap_ns) / 4;
+}
+
+// Waits for the worker to be woken by a post to its wake notification.
+// Depending on the executor configuration and recent history the worker may
+// spin for a short time prior to parking in the kernel.
+static void iree_task_worker_wait_for_work(iree_task_worker_t* worker,
+                                           iree_wait_token_t wait_token) {
+  iree_task_executor_t* executor = worker->executor;
+  iree_duration_t max_spin_ns = (iree_duration_t)iree_atomic_load_int64(
+      &executor->worker_spin_ns, iree_memory_order_relaxed);
+  if (max_spin_ns <= 0) {
+    // Spinning disabled; park immediately.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_main_pump_wake_wait");
+    iree_notification_commit_wait(&worker->wake_notification, wait_token);
+    IREE_TRACE_ZONE_END(z_wait);
+    return;
+  }
+
+  iree_duration_t spin_ns =
+      iree_task_worker_select_spin_ns(worker, max_spin_ns);
+  IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_main_pump_wake_wait");
+  IREE_TRACE_ZONE_APPEND_VALUE(z_wait, spin_ns);
+  iree_time_t idle_start_ns = iree_time_now();
+  bool did_spin = iree_notification_commit_wait_with_spin(
+      &worker->wake_notification, wait_token, spin_ns);
+  iree_task_worker_record_idle_gap(worker, max_spin_ns,
+                                   iree_time_now() - idle_start_ns);
+  IREE_TRACE_ZONE_APPEND_TEXT(z_wait, did_spin ? "spin" : "park");
+  IREE_TRACE_ZONE_END(z_wait);
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
+  if (did_spin) {
+    IREE_TRACE_PLOT_VALUE_I64(
+        "iree_task_worker_spins",
+        iree_atomic_fetch_add_int64(&executor->worker_spin_count, 1,
+                                    iree_memory_order_relaxed) +
+            1);
+  } else {
+    IREE_TRACE_PLOT_VALUE_I64(
+        "iree_task_worker_parks",
+        iree_atomic_fetch_add_int64(&executor->worker_park_count, 1,
+                                    iree_memory_order_relaxed) +
+            1);
+  }
+#else
+  (void)did_spin;
+#endif  // IREE_TRACING_FEATURE_INSTRUMENTATION
+}
+
 // Alternates between pumping ready tasks in the worker queue and waiting
 // for more tasks to arrive. Only returns when the worker has been asked by
 // the executor to exit.
@@ -333,10 +401,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
       // Have more work to do; loop around to try another pump.
       iree_notification_cancel_wait(&worker->wake_notification);
     } else {
-      IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
-                                  "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(&worker->wake_notification, wait_token);
-      IREE_TRACE_ZONE_END(z_wait);
+      iree_task_worker_wait_for_work(worker, wait_token);
     }
 
     // Wait completed.
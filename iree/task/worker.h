@@ -21,6 +21,7 @@
 #include "iree/task/affinity_set.h"
 #include "iree/task/executor.h"
 #include "iree/task/list.h"
+#include "iree/task/pool.h"
 #include "iree/task/queue.h"
 #include "iree/task/tuning.h"
 
@@ -99,6 +100,15 @@ typedef struct iree_task_worker_s {
   // all share the same L3 cache.
   iree_task_affinity_set_t constructive_sharing_mask;
 
+  // A bitmask of workers on the same NUMA node as this worker (including
+  // itself). Stealing from these is preferred over workers on remote nodes.
+  iree_task_affinity_set_t local_node_mask;
+
+  // Executor-owned pool of dispatch slice/shard tasks whose memory is placed on
+  // the NUMA node of this worker. Tasks posted to this worker should be
+  // acquired from here.
+  iree_task_pool_t* dispatch_task_pool;
+
   // Maximum number of attempts to make when trying to steal tasks from other
   // workers. This could be 64 (try stealing from all workers) or just a handful
   // (try stealing from these 3 other cores that share your L3 cache).
@@ -108,6 +118,11 @@ typedef struct iree_task_worker_s {
   // Only ever touched by the worker thread as it steals work.
   iree_prng_minilcg128_state_t theft_prng;
 
+  // Exponential moving average of how long the worker has been idle between
+  // running out of tasks and new work arriving. Used to size how long the
+  // worker spins before parking. Only ever touched by the worker thread.
+  iree_duration_t idle_gap_ns;
+
   // Thread handle of the worker. If the thread has exited the handle will
   // remain valid so that the executor can query its state.
   iree_thread_t* thread;
@@ -140,9 +155,17 @@ static_assert(offsetof(iree_task_worker_t, local_task_queue) >=
 // tasks. Where supported the worker will be created in a suspended state so
 // that we aren't creating a thundering herd on startup:
 // https://en.wikipedia.org/wiki/Thundering_herd_problem
+//
+// Workers of threadless executors are not given a thread and are instead
+// pumped with iree_task_worker_pump_inline.
+//
+// |local_node_mask| and |dispatch_task_pool| are derived by the executor from
+// the NUMA nodes of all groups in the topology.
 iree_status_t iree_task_worker_initialize(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
     const iree_task_topology_group_t* topology_group,
+    iree_task_affinity_set_t local_node_mask,
+    iree_task_pool_t* dispatch_task_pool,
     iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
 
 // Deinitializes a worker that has successfully exited. The worker must be in
@@ -163,6 +186,14 @@ void iree_task_worker_request_exit(iree_task_worker_t* worker);
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list);
 
+// Executes tasks in the worker queue and mailbox on the calling thread until
+// none remain and merges any newly-ready tasks back into the executor.
+// Only valid for the thread-less worker of a threadless executor as otherwise
+// the worker thread owns its local task queue. Callers must hold the executor
+// inline_pump_mutex so that only one thread pops from the queue at a time.
+// Returns true if any tasks were executed.
+bool iree_task_worker_pump_inline(iree_task_worker_t* worker);
+
 // Tries to steal up to |max_tasks| from the back of the queue.
 // Returns NULL if no tasks are available and otherwise up to |max_tasks| tasks
 // that were at the tail of the worker FIFO will be moved to the |target_queue|
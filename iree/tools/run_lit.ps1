@@ -64,6 +64,9 @@ $env:Path = $test_dirs -join ";"
 Write-Debug "Test PATH:"
 Write-Debug "$env:PATH"
 
+# Scratch file path unique to this test for any embedded '%t'.
+$tmp_file = [System.IO.Path]::GetTempFileName()
+
 $test_lines = Get-Content -Path $test_file
 foreach ($test_line in $test_lines) {
   if (!$test_line.StartsWith("// RUN:")) {
@@ -71,15 +74,18 @@ foreach ($test_line in $test_lines) {
   }
   $test_line = $test_line.Substring("// RUN: ".Length)
   $test_line = $test_line -replace "%s", $test_file
+  $test_line = $test_line -replace "%t", $tmp_file
   Write-Host -ForegroundColor Blue "Running test command:"
   Write-Host -ForegroundColor Yellow "$test_line"
   & $bashExe -c $test_line | Out-Default
   if ($LASTEXITCODE -gt 0) {
     Write-Host -ForegroundColor Red "Test failed with $LASTEXITCODE, command:"
     Write-Host -ForegroundColor Yellow "$test_line"
+    Remove-Item -Path $tmp_file -ErrorAction Ignore
     exit $LASTEXITCODE
   }
 }
 
 Write-Debug "All run commands completed successfully"
+Remove-Item -Path $tmp_file -ErrorAction Ignore
 exit 0
@@ -88,6 +88,11 @@ echo "PWD=$(pwd)"
 echo "EXPLICIT_PATH=$EXPLICIT_PATH"
 echo "IMPLICIT_PATH=$IMPLICIT_PATH"
 
+# Scratch file path unique to this test for any embedded '%t'.
+test_tmpdir="$(mktemp -d)"
+trap 'rm -rf "${test_tmpdir}"' EXIT
+tmp_file="${test_tmpdir}/$(basename "${src_file}").tmp"
+
 # For each "// RUN:" line, run the command.
 runline_matches="$(egrep "^// RUN: " "$src_file")"
 if [ -z "$runline_matches" ]; then
@@ -105,8 +110,10 @@ do
     exit 1
   fi
 
-  # Substitute any embedded '%s' with the file name.
+  # Substitute any embedded '%s' with the file name and '%t' with the scratch
+  # file path.
   full_command="${command//\%s/$src_file}"
+  full_command="${full_command//\%t/$tmp_file}"
 
   # Run it.
   export PATH="$EXPLICIT_PATH:$IMPLICIT_PATH:$PATH"
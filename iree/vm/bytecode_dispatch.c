@@ -12,6 +12,7 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+#include <math.h>
 #include <string.h>
 
 #include "iree/base/math.h"
@@ -30,21 +31,25 @@
 // This assumes that the remapping list is properly ordered such that there are
 // no swapping hazards (such as 0->1,1->0). The register allocator in the
 // compiler should ensure this is the case when it can occur.
+//
+// |remap_list| contains the i32 remappings and is followed by the ref
+// remappings; as the banks are disjoint they can be processed independently.
 static void iree_vm_bytecode_dispatch_remap_branch_registers(
     const iree_vm_registers_t regs,
     const iree_vm_register_remap_list_t* IREE_RESTRICT remap_list) {
   for (int i = 0; i < remap_list->size; ++i) {
-    // TODO(benvanik): change encoding to avoid this branching.
-    // Could write two arrays: one for prims and one for refs.
     uint16_t src_reg = remap_list->pairs[i].src_reg;
     uint16_t dst_reg = remap_list->pairs[i].dst_reg;
-    if (src_reg & IREE_REF_REGISTER_TYPE_BIT) {
-      iree_vm_ref_retain_or_move(src_reg & IREE_REF_REGISTER_MOVE_BIT,
-                                 &regs.ref[src_reg & regs.ref_mask],
-                                 &regs.ref[dst_reg & regs.ref_mask]);
-    } else {
-      regs.i32[dst_reg & regs.i32_mask] = regs.i32[src_reg & regs.i32_mask];
-    }
+    regs.i32[dst_reg & regs.i32_mask] = regs.i32[src_reg & regs.i32_mask];
+  }
+  const iree_vm_register_remap_list_t* IREE_RESTRICT ref_remap_list =
+      iree_vm_register_remap_list_next(remap_list);
+  for (int i = 0; i < ref_remap_list->size; ++i) {
+    uint16_t src_reg = ref_remap_list->pairs[i].src_reg;
+    uint16_t dst_reg = ref_remap_list->pairs[i].dst_reg;
+    iree_vm_ref_retain_or_move(src_reg & IREE_REF_REGISTER_MOVE_BIT,
+                               &regs.ref[src_reg & regs.ref_mask],
+                               &regs.ref[dst_reg & regs.ref_mask]);
   }
 }
 
@@ -64,6 +69,28 @@ static void iree_vm_bytecode_dispatch_discard_registers(
   }
 }
 
+//===----------------------------------------------------------------------===//
+// Floating-point conversion utilities
+//===----------------------------------------------------------------------===//
+
+// Converts |value| to a signed 32-bit integer rounding toward zero. NaN maps to
+// 0 and out of range values saturate; C leaves both undefined for plain casts.
+// f32 operands widen to double exactly and share this path.
+static inline int32_t iree_vm_cast_f64_si32(double value) {
+  if (isnan(value)) return 0;
+  if (value <= (double)INT32_MIN) return INT32_MIN;
+  if (value >= (double)INT32_MAX) return INT32_MAX;
+  return (int32_t)value;
+}
+
+// Converts |value| to an unsigned 32-bit integer rounding toward zero. NaN and
+// negative values map to 0 and values above UINT32_MAX saturate.
+static inline uint32_t iree_vm_cast_f64_ui32(double value) {
+  if (isnan(value) || value <= 0.0) return 0;
+  if (value >= (double)UINT32_MAX) return UINT32_MAX;
+  return (uint32_t)value;
+}
+
 //===----------------------------------------------------------------------===//
 // Stack management
 //===----------------------------------------------------------------------===//
@@ -199,13 +226,15 @@ static iree_status_t iree_vm_bytecode_external_enter(
   const uint8_t* p = arguments.data;
   for (iree_host_size_t i = 0; i < cconv_arguments.size; ++i) {
     switch (cconv_arguments.data[i]) {
-      case IREE_VM_CCONV_TYPE_INT32: {
+      case IREE_VM_CCONV_TYPE_INT32:
+      case IREE_VM_CCONV_TYPE_FLOAT32: {
         uint16_t dst_reg = i32_reg++;
         memcpy(&callee_registers.i32[dst_reg & callee_registers.i32_mask], p,
                sizeof(int32_t));
         p += sizeof(int32_t);
       } break;
-      case IREE_VM_CCONV_TYPE_INT64: {
+      case IREE_VM_CCONV_TYPE_INT64:
+      case IREE_VM_CCONV_TYPE_FLOAT64: {
         uint16_t dst_reg = i32_reg;
         i32_reg += 2;
         memcpy(&callee_registers.i32[dst_reg & callee_registers.i32_mask], p,
@@ -240,12 +269,14 @@ static iree_status_t iree_vm_bytecode_external_leave(
   for (iree_host_size_t i = 0; i < cconv_results.size; ++i) {
     uint16_t src_reg = src_reg_list->registers[i];
     switch (cconv_results.data[i]) {
-      case IREE_VM_CCONV_TYPE_INT32: {
+      case IREE_VM_CCONV_TYPE_INT32:
+      case IREE_VM_CCONV_TYPE_FLOAT32: {
         memcpy(p, &callee_registers->i32[src_reg & callee_registers->i32_mask],
                sizeof(int32_t));
         p += sizeof(int32_t);
       } break;
-      case IREE_VM_CCONV_TYPE_INT64: {
+      case IREE_VM_CCONV_TYPE_INT64:
+      case IREE_VM_CCONV_TYPE_FLOAT64: {
         memcpy(
             p,
             &callee_registers->i32[src_reg & (callee_registers->i32_mask & ~1)],
@@ -379,14 +410,16 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
   for (iree_host_size_t i = 0, seg_i = 0, reg_i = 0; i < cconv_arguments.size;
        ++i, ++seg_i) {
     switch (cconv_arguments.data[i]) {
-      case IREE_VM_CCONV_TYPE_INT32: {
+      case IREE_VM_CCONV_TYPE_INT32:
+      case IREE_VM_CCONV_TYPE_FLOAT32: {
         memcpy(p,
                &caller_registers.i32[src_reg_list->registers[reg_i++] &
                                      caller_registers.i32_mask],
                sizeof(int32_t));
         p += sizeof(int32_t);
       } break;
-      case IREE_VM_CCONV_TYPE_INT64: {
+      case IREE_VM_CCONV_TYPE_INT64:
+      case IREE_VM_CCONV_TYPE_FLOAT64: {
         memcpy(p,
                &caller_registers.i32[src_reg_list->registers[reg_i++] &
                                      (caller_registers.i32_mask & ~1)],
@@ -422,14 +455,16 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
                ++i) {
             // TODO(benvanik): share with switch above.
             switch (cconv_arguments.data[i]) {
-              case IREE_VM_CCONV_TYPE_INT32: {
+              case IREE_VM_CCONV_TYPE_INT32:
+              case IREE_VM_CCONV_TYPE_FLOAT32: {
                 memcpy(p,
                        &caller_registers.i32[src_reg_list->registers[reg_i++] &
                                              caller_registers.i32_mask],
                        sizeof(int32_t));
                 p += sizeof(int32_t);
               } break;
-              case IREE_VM_CCONV_TYPE_INT64: {
+              case IREE_VM_CCONV_TYPE_INT64:
+              case IREE_VM_CCONV_TYPE_FLOAT64: {
                 memcpy(p,
                        &caller_registers.i32[src_reg_list->registers[reg_i++] &
                                              (caller_registers.i32_mask & ~1)],
@@ -469,9 +504,14 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
                                 iree_make_cstring_view("while calling import"));
   }
 
-  // NOTE: we don't support yielding within imported functions right now so it's
-  // safe to assume the stack is still valid here. If the called function can
-  // yield then we'll need to requery all pointers here.
+  // NOTE: we don't support yielding within imported functions right now as the
+  // ABI argument/result buffers live on the host stack of this dispatch. Once
+  // they are moved into the VM stack we can propagate the yield to our caller
+  // and requery all pointers here on resume.
+  if (IREE_UNLIKELY(iree_vm_execution_result_is_yielded(out_result))) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "yielding within imported functions unsupported");
+  }
   *out_caller_frame = iree_vm_stack_current_frame(stack);
   *out_caller_registers =
       iree_vm_bytecode_get_register_storage(*out_caller_frame);
@@ -484,11 +524,13 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
     uint16_t dst_reg = dst_reg_list->registers[i];
     switch (cconv_results.data[i]) {
       case IREE_VM_CCONV_TYPE_INT32:
+      case IREE_VM_CCONV_TYPE_FLOAT32:
         memcpy(&caller_registers.i32[dst_reg & caller_registers.i32_mask], p,
                sizeof(int32_t));
         p += sizeof(int32_t);
         break;
       case IREE_VM_CCONV_TYPE_INT64:
+      case IREE_VM_CCONV_TYPE_FLOAT64:
         memcpy(
             &caller_registers.i32[dst_reg & (caller_registers.i32_mask & ~1)],
             p, sizeof(int64_t));
@@ -597,25 +639,18 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
 // Main interpreter dispatch routine
 //===----------------------------------------------------------------------===//
 
-iree_status_t iree_vm_bytecode_dispatch(
+// Continues dispatch of the |current_frame| on the top of |stack| until either
+// a yield or the return from the entry frame at |entry_frame_depth|, upon which
+// the results are marshaled into |results| for the external caller.
+static iree_status_t iree_vm_bytecode_dispatch_frames(
     iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
-    const iree_vm_function_call_t* call, iree_string_view_t cconv_arguments,
-    iree_string_view_t cconv_results, iree_vm_execution_result_t* out_result) {
-  memset(out_result, 0, sizeof(*out_result));
-
+    iree_vm_stack_frame_t* current_frame, iree_vm_registers_t regs,
+    const int32_t entry_frame_depth, iree_string_view_t cconv_results,
+    iree_byte_span_t results, iree_vm_execution_result_t* out_result) {
   // When required emit the dispatch tables here referencing the labels we are
   // defining below.
   DEFINE_DISPATCH_TABLES();
 
-  // Enter function (as this is the initial call).
-  // The callee's return will take care of storing the output registers when it
-  // actually does return, either immediately or in the future via a resume.
-  iree_vm_stack_frame_t* current_frame = NULL;
-  iree_vm_registers_t regs;
-  IREE_RETURN_IF_ERROR(
-      iree_vm_bytecode_external_enter(stack, call->function, cconv_arguments,
-                                      call->arguments, &current_frame, &regs));
-
   // Primary dispatch state. This is our 'native stack frame' and really
   // just enough to make dereferencing common addresses (like the current
   // offset) faster. You can think of this like CPU state (like PC).
@@ -630,7 +665,6 @@ iree_status_t iree_vm_bytecode_dispatch(
       module->function_descriptor_table[current_frame->function.ordinal]
           .bytecode_offset;
   iree_vm_source_offset_t pc = current_frame->pc;
-  const int32_t entry_frame_depth = current_frame->depth;
 
   BEGIN_DISPATCH_CORE() {
     //===------------------------------------------------------------------===//
@@ -793,7 +827,7 @@ iree_status_t iree_vm_bytecode_dispatch(
       bool result_is_move;
       iree_vm_ref_t* result = VM_DecResultRegRef("value", &result_is_move);
       IREE_RETURN_IF_ERROR(iree_vm_ref_wrap_retain(
-          &module_state->rodata_ref_table[rodata_ordinal],
+          &module_state->rodata_ref_table[rodata_ordinal].ref,
           iree_vm_ro_byte_buffer_type_id(), result));
     });
 
@@ -1002,6 +1036,14 @@ iree_status_t iree_vm_bytecode_dispatch(
     DISPATCH_OP_CORE_BINARY_ALU_I32(OrI32, uint32_t, |);
     DISPATCH_OP_CORE_BINARY_ALU_I32(XorI32, uint32_t, ^);
 
+    // Superinstruction for an add with a constant operand.
+    DISPATCH_OP(CORE, AddI32Imm, {
+      int32_t lhs = VM_DecOperandRegI32("lhs");
+      int32_t rhs = VM_DecIntAttr32("rhs");
+      int32_t* result = VM_DecResultRegI32("result");
+      *result = (int32_t)(((int32_t)lhs) + ((int32_t)rhs));
+    });
+
     //===------------------------------------------------------------------===//
     // Casting and type conversion/emulation
     //===------------------------------------------------------------------===//
@@ -1116,6 +1158,51 @@ iree_status_t iree_vm_bytecode_dispatch(
       }
     });
 
+    // Superinstructions for a comparison feeding a conditional branch.
+    // The comparison result is only used by the branch and is not stored.
+#define DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(op_name, type, op)             \
+  DISPATCH_OP(CORE, op_name, {                                              \
+    int32_t lhs = VM_DecOperandRegI32("lhs");                               \
+    int32_t rhs = VM_DecOperandRegI32("rhs");                               \
+    int32_t true_block_pc = VM_DecBranchTarget("true_dest");                \
+    const iree_vm_register_remap_list_t* true_remap_list =                  \
+        VM_DecBranchOperands("true_operands");                              \
+    int32_t false_block_pc = VM_DecBranchTarget("false_dest");              \
+    const iree_vm_register_remap_list_t* false_remap_list =                 \
+        VM_DecBranchOperands("false_operands");                             \
+    if (((type)lhs)op((type)rhs)) {                                         \
+      pc = true_block_pc;                                                   \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs,                \
+                                                       true_remap_list);    \
+    } else {                                                                \
+      pc = false_block_pc;                                                  \
+      iree_vm_bytecode_dispatch_remap_branch_registers(regs,                \
+                                                       false_remap_list);   \
+    }                                                                       \
+  });
+
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchEQI32, int32_t, ==);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchNEI32, int32_t, !=);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchLTI32S, int32_t, <);
+    DISPATCH_OP_CORE_COND_BRANCH_CMP_I32(CondBranchLTI32U, uint32_t, <);
+    DISPATCH_OP(CORE, CondBranchNZI32, {
+      int32_t operand = VM_DecOperandRegI32("operand");
+      int32_t true_block_pc = VM_DecBranchTarget("true_dest");
+      const iree_vm_register_remap_list_t* true_remap_list =
+          VM_DecBranchOperands("true_operands");
+      int32_t false_block_pc = VM_DecBranchTarget("false_dest");
+      const iree_vm_register_remap_list_t* false_remap_list =
+          VM_DecBranchOperands("false_operands");
+      if (operand != 0) {
+        pc = true_block_pc;
+        iree_vm_bytecode_dispatch_remap_branch_registers(regs, true_remap_list);
+      } else {
+        pc = false_block_pc;
+        iree_vm_bytecode_dispatch_remap_branch_registers(regs,
+                                                         false_remap_list);
+      }
+    });
+
     DISPATCH_OP(CORE, Call, {
       int32_t function_ordinal = VM_DecFuncAttr("callee");
       const iree_vm_register_list_t* src_reg_list =
@@ -1182,7 +1269,7 @@ iree_status_t iree_vm_bytecode_dispatch(
         // Return from the top-level entry frame - return back to call().
         return iree_vm_bytecode_external_leave(stack, current_frame, &regs,
                                                src_reg_list, cconv_results,
-                                               call->results);
+                                               results);
       }
 
       // Store results into the caller frame and pop back to the parent.
@@ -1212,7 +1299,17 @@ iree_status_t iree_vm_bytecode_dispatch(
     //===------------------------------------------------------------------===//
 
     DISPATCH_OP(CORE, Yield, {
-      // TODO(benvanik): yield with execution results.
+      // Suspend with all frames left on the stack. The entry state is stashed
+      // in the top frame so that iree_vm_bytecode_resume can continue from the
+      // instruction following the yield.
+      current_frame->pc = pc;
+      iree_vm_bytecode_frame_storage_t* stack_storage =
+          (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
+              current_frame);
+      stack_storage->entry_frame_depth = entry_frame_depth;
+      stack_storage->cconv_results = cconv_results;
+      stack_storage->results = results;
+      out_result->flags |= IREE_VM_EXECUTION_RESULT_FLAG_YIELDED;
       return iree_ok_status();
     });
 
@@ -1491,14 +1588,499 @@ iree_status_t iree_vm_bytecode_dispatch(
     }
     END_DISPATCH_PREFIX();
 
-    DISPATCH_OP(CORE, PrefixExtF32,
-                { return iree_make_status(IREE_STATUS_UNIMPLEMENTED); });
+    BEGIN_DISPATCH_PREFIX(PrefixExtF32, EXT_F32) {
+#if IREE_VM_EXT_F32_ENABLE
+      //===----------------------------------------------------------------===//
+      // ExtF32: Globals
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F32, GlobalLoadF32, {
+        uint32_t byte_offset = VM_DecGlobalAttr("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        float* value = VM_DecResultRegF32("value");
+        const float* global_ptr =
+            (const float*)(module_state->rwdata_storage.data + byte_offset);
+        *value = *global_ptr;
+      });
 
-    DISPATCH_OP(CORE, PrefixExtF64,
-                { return iree_make_status(IREE_STATUS_UNIMPLEMENTED); });
+      DISPATCH_OP(EXT_F32, GlobalStoreF32, {
+        uint32_t byte_offset = VM_DecGlobalAttr("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        float value = VM_DecOperandRegF32("value");
+        float* global_ptr =
+            (float*)(module_state->rwdata_storage.data + byte_offset);
+        *global_ptr = value;
+      });
+
+      DISPATCH_OP(EXT_F32, GlobalLoadIndirectF32, {
+        uint32_t byte_offset = VM_DecOperandRegI32("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        float* value = VM_DecResultRegF32("value");
+        const float* global_ptr =
+            (const float*)(module_state->rwdata_storage.data + byte_offset);
+        *value = *global_ptr;
+      });
+
+      DISPATCH_OP(EXT_F32, GlobalStoreIndirectF32, {
+        uint32_t byte_offset = VM_DecOperandRegI32("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        float value = VM_DecOperandRegF32("value");
+        float* global_ptr =
+            (float*)(module_state->rwdata_storage.data + byte_offset);
+        *global_ptr = value;
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF32: Constants
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F32, ConstF32, {
+        float value = VM_DecFloatAttr32("value");
+        float* result = VM_DecResultRegF32("result");
+        *result = value;
+      });
+
+      DISPATCH_OP(EXT_F32, ConstF32Zero, {
+        float* result = VM_DecResultRegF32("result");
+        *result = 0;
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF32: Lists
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F32, ListGetF32, {
+        bool list_is_move;
+        iree_vm_ref_t* list_ref = VM_DecOperandRegRef("list", &list_is_move);
+        iree_vm_list_t* list = iree_vm_list_deref(list_ref);
+        if (IREE_UNLIKELY(!list)) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "list is null");
+        }
+        uint32_t index = VM_DecOperandRegI32("index");
+        float* result = VM_DecResultRegF32("result");
+        iree_vm_value_t value;
+        IREE_RETURN_IF_ERROR(iree_vm_list_get_value_as(
+            list, index, IREE_VM_VALUE_TYPE_F32, &value));
+        *result = value.f32;
+      });
+
+      DISPATCH_OP(EXT_F32, ListSetF32, {
+        bool list_is_move;
+        iree_vm_ref_t* list_ref = VM_DecOperandRegRef("list", &list_is_move);
+        iree_vm_list_t* list = iree_vm_list_deref(list_ref);
+        if (IREE_UNLIKELY(!list)) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "list is null");
+        }
+        uint32_t index = VM_DecOperandRegI32("index");
+        float raw_value = VM_DecOperandRegF32("value");
+        iree_vm_value_t value = iree_vm_value_make_f32(raw_value);
+        IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, index, &value));
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF32: Conditional assignment
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F32, SelectF32, {
+        int32_t condition = VM_DecOperandRegI32("condition");
+        float true_value = VM_DecOperandRegF32("true_value");
+        float false_value = VM_DecOperandRegF32("false_value");
+        float* result = VM_DecResultRegF32("result");
+        *result = condition ? true_value : false_value;
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF32: Native floating-point arithmetic
+      //===----------------------------------------------------------------===//
+
+#define DISPATCH_OP_EXT_F32_UNARY_ALU_F32(op_name, op) \
+  DISPATCH_OP(EXT_F32, op_name, {                      \
+    float operand = VM_DecOperandRegF32("operand");    \
+    float* result = VM_DecResultRegF32("result");      \
+    *result = op(operand);                             \
+  });
+
+#define DISPATCH_OP_EXT_F32_BINARY_ALU_F32(op_name, op) \
+  DISPATCH_OP(EXT_F32, op_name, {                       \
+    float lhs = VM_DecOperandRegF32("lhs");             \
+    float rhs = VM_DecOperandRegF32("rhs");             \
+    float* result = VM_DecResultRegF32("result");       \
+    *result = lhs op rhs;                               \
+  });
+
+#define DISPATCH_OP_EXT_F32_BINARY_FN_F32(op_name, fn) \
+  DISPATCH_OP(EXT_F32, op_name, {                      \
+    float lhs = VM_DecOperandRegF32("lhs");            \
+    float rhs = VM_DecOperandRegF32("rhs");            \
+    float* result = VM_DecResultRegF32("result");      \
+    *result = fn(lhs, rhs);                            \
+  });
+
+      DISPATCH_OP_EXT_F32_BINARY_ALU_F32(AddF32, +);
+      DISPATCH_OP_EXT_F32_BINARY_ALU_F32(SubF32, -);
+      DISPATCH_OP_EXT_F32_BINARY_ALU_F32(MulF32, *);
+      DISPATCH_OP_EXT_F32_BINARY_ALU_F32(DivF32, /);
+      DISPATCH_OP_EXT_F32_BINARY_FN_F32(RemF32, fmodf);
+      DISPATCH_OP_EXT_F32_UNARY_ALU_F32(AbsF32, fabsf);
+      DISPATCH_OP_EXT_F32_UNARY_ALU_F32(NegF32, -);
+      DISPATCH_OP_EXT_F32_UNARY_ALU_F32(CeilF32, ceilf);
+      DISPATCH_OP_EXT_F32_UNARY_ALU_F32(FloorF32, floorf);
+
+      //===----------------------------------------------------------------===//
+      // ExtF32: Casting and type conversion/emulation
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F32, CastSI32F32, {
+        int32_t operand = VM_DecOperandRegI32("operand");
+        float* result = VM_DecResultRegF32("result");
+        *result = (float)operand;
+      });
+
+      DISPATCH_OP(EXT_F32, CastUI32F32, {
+        int32_t operand = VM_DecOperandRegI32("operand");
+        float* result = VM_DecResultRegF32("result");
+        *result = (float)(uint32_t)operand;
+      });
+
+      DISPATCH_OP(EXT_F32, CastF32SI32, {
+        float operand = VM_DecOperandRegF32("operand");
+        int32_t* result = VM_DecResultRegI32("result");
+        *result = iree_vm_cast_f64_si32(operand);
+      });
+
+      DISPATCH_OP(EXT_F32, CastF32UI32, {
+        float operand = VM_DecOperandRegF32("operand");
+        int32_t* result = VM_DecResultRegI32("result");
+        *result = (int32_t)iree_vm_cast_f64_ui32(operand);
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF32: Comparison ops
+      //===----------------------------------------------------------------===//
+
+#define DISPATCH_OP_EXT_F32_CMP_F32(op_name, op)    \
+  DISPATCH_OP(EXT_F32, op_name, {                   \
+    float lhs = VM_DecOperandRegF32("lhs");         \
+    float rhs = VM_DecOperandRegF32("rhs");         \
+    int32_t* result = VM_DecResultRegI32("result"); \
+    *result = ((lhs)op(rhs)) ? 1 : 0;               \
+  });
+
+      DISPATCH_OP_EXT_F32_CMP_F32(CmpEQF32, ==);
+      DISPATCH_OP_EXT_F32_CMP_F32(CmpNEF32, !=);
+      DISPATCH_OP_EXT_F32_CMP_F32(CmpLTF32, <);
+      DISPATCH_OP_EXT_F32_CMP_F32(CmpLTEF32, <=);
+      DISPATCH_OP(EXT_F32, CmpNZF32, {
+        float operand = VM_DecOperandRegF32("operand");
+        int32_t* result = VM_DecResultRegI32("result");
+        *result = (operand != 0) ? 1 : 0;
+      });
+#else
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+#endif  // IREE_VM_EXT_F32_ENABLE
+    }
+    END_DISPATCH_PREFIX();
+
+    BEGIN_DISPATCH_PREFIX(PrefixExtF64, EXT_F64) {
+#if IREE_VM_EXT_F64_ENABLE
+      //===----------------------------------------------------------------===//
+      // ExtF64: Globals
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F64, GlobalLoadF64, {
+        uint32_t byte_offset = VM_DecGlobalAttr("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        double* value = VM_DecResultRegF64("value");
+        const double* global_ptr =
+            (const double*)(module_state->rwdata_storage.data + byte_offset);
+        *value = *global_ptr;
+      });
+
+      DISPATCH_OP(EXT_F64, GlobalStoreF64, {
+        uint32_t byte_offset = VM_DecGlobalAttr("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        double value = VM_DecOperandRegF64("value");
+        double* global_ptr =
+            (double*)(module_state->rwdata_storage.data + byte_offset);
+        *global_ptr = value;
+      });
+
+      DISPATCH_OP(EXT_F64, GlobalLoadIndirectF64, {
+        uint32_t byte_offset = VM_DecOperandRegI32("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        double* value = VM_DecResultRegF64("value");
+        const double* global_ptr =
+            (const double*)(module_state->rwdata_storage.data + byte_offset);
+        *value = *global_ptr;
+      });
+
+      DISPATCH_OP(EXT_F64, GlobalStoreIndirectF64, {
+        uint32_t byte_offset = VM_DecOperandRegI32("global");
+        if (IREE_UNLIKELY(byte_offset >=
+                          module_state->rwdata_storage.data_length)) {
+          return iree_make_status(
+              IREE_STATUS_OUT_OF_RANGE,
+              "global byte_offset out of range: %d (rwdata=%zu)", byte_offset,
+              module_state->rwdata_storage.data_length);
+        }
+        double value = VM_DecOperandRegF64("value");
+        double* global_ptr =
+            (double*)(module_state->rwdata_storage.data + byte_offset);
+        *global_ptr = value;
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF64: Constants
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F64, ConstF64, {
+        double value = VM_DecFloatAttr64("value");
+        double* result = VM_DecResultRegF64("result");
+        *result = value;
+      });
+
+      DISPATCH_OP(EXT_F64, ConstF64Zero, {
+        double* result = VM_DecResultRegF64("result");
+        *result = 0;
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF64: Lists
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F64, ListGetF64, {
+        bool list_is_move;
+        iree_vm_ref_t* list_ref = VM_DecOperandRegRef("list", &list_is_move);
+        iree_vm_list_t* list = iree_vm_list_deref(list_ref);
+        if (IREE_UNLIKELY(!list)) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "list is null");
+        }
+        uint32_t index = VM_DecOperandRegI32("index");
+        double* result = VM_DecResultRegF64("result");
+        iree_vm_value_t value;
+        IREE_RETURN_IF_ERROR(iree_vm_list_get_value_as(
+            list, index, IREE_VM_VALUE_TYPE_F64, &value));
+        *result = value.f64;
+      });
+
+      DISPATCH_OP(EXT_F64, ListSetF64, {
+        bool list_is_move;
+        iree_vm_ref_t* list_ref = VM_DecOperandRegRef("list", &list_is_move);
+        iree_vm_list_t* list = iree_vm_list_deref(list_ref);
+        if (IREE_UNLIKELY(!list)) {
+          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "list is null");
+        }
+        uint32_t index = VM_DecOperandRegI32("index");
+        double raw_value = VM_DecOperandRegF64("value");
+        iree_vm_value_t value = iree_vm_value_make_f64(raw_value);
+        IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, index, &value));
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF64: Conditional assignment
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F64, SelectF64, {
+        int32_t condition = VM_DecOperandRegI32("condition");
+        double true_value = VM_DecOperandRegF64("true_value");
+        double false_value = VM_DecOperandRegF64("false_value");
+        double* result = VM_DecResultRegF64("result");
+        *result = condition ? true_value : false_value;
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF64: Native floating-point arithmetic
+      //===----------------------------------------------------------------===//
+
+#define DISPATCH_OP_EXT_F64_UNARY_ALU_F64(op_name, op) \
+  DISPATCH_OP(EXT_F64, op_name, {                      \
+    double operand = VM_DecOperandRegF64("operand");   \
+    double* result = VM_DecResultRegF64("result");     \
+    *result = op(operand);                             \
+  });
+
+#define DISPATCH_OP_EXT_F64_BINARY_ALU_F64(op_name, op) \
+  DISPATCH_OP(EXT_F64, op_name, {                       \
+    double lhs = VM_DecOperandRegF64("lhs");            \
+    double rhs = VM_DecOperandRegF64("rhs");            \
+    double* result = VM_DecResultRegF64("result");      \
+    *result = lhs op rhs;                               \
+  });
+
+#define DISPATCH_OP_EXT_F64_BINARY_FN_F64(op_name, fn) \
+  DISPATCH_OP(EXT_F64, op_name, {                      \
+    double lhs = VM_DecOperandRegF64("lhs");           \
+    double rhs = VM_DecOperandRegF64("rhs");           \
+    double* result = VM_DecResultRegF64("result");     \
+    *result = fn(lhs, rhs);                            \
+  });
+
+      DISPATCH_OP_EXT_F64_BINARY_ALU_F64(AddF64, +);
+      DISPATCH_OP_EXT_F64_BINARY_ALU_F64(SubF64, -);
+      DISPATCH_OP_EXT_F64_BINARY_ALU_F64(MulF64, *);
+      DISPATCH_OP_EXT_F64_BINARY_ALU_F64(DivF64, /);
+      DISPATCH_OP_EXT_F64_BINARY_FN_F64(RemF64, fmod);
+      DISPATCH_OP_EXT_F64_UNARY_ALU_F64(AbsF64, fabs);
+      DISPATCH_OP_EXT_F64_UNARY_ALU_F64(NegF64, -);
+      DISPATCH_OP_EXT_F64_UNARY_ALU_F64(CeilF64, ceil);
+      DISPATCH_OP_EXT_F64_UNARY_ALU_F64(FloorF64, floor);
+
+      //===----------------------------------------------------------------===//
+      // ExtF64: Casting and type conversion/emulation
+      //===----------------------------------------------------------------===//
+
+      DISPATCH_OP(EXT_F64, CastSI32F64, {
+        int32_t operand = VM_DecOperandRegI32("operand");
+        double* result = VM_DecResultRegF64("result");
+        *result = (double)operand;
+      });
+
+      DISPATCH_OP(EXT_F64, CastUI32F64, {
+        int32_t operand = VM_DecOperandRegI32("operand");
+        double* result = VM_DecResultRegF64("result");
+        *result = (double)(uint32_t)operand;
+      });
+
+      DISPATCH_OP(EXT_F64, CastF64SI32, {
+        double operand = VM_DecOperandRegF64("operand");
+        int32_t* result = VM_DecResultRegI32("result");
+        *result = iree_vm_cast_f64_si32(operand);
+      });
+
+      DISPATCH_OP(EXT_F64, CastF64UI32, {
+        double operand = VM_DecOperandRegF64("operand");
+        int32_t* result = VM_DecResultRegI32("result");
+        *result = (int32_t)iree_vm_cast_f64_ui32(operand);
+      });
+
+      DISPATCH_OP(EXT_F64, ExtF32F64, {
+        float operand = VM_DecOperandRegF32("operand");
+        double* result = VM_DecResultRegF64("result");
+        *result = (double)operand;
+      });
+
+      DISPATCH_OP(EXT_F64, TruncF64F32, {
+        double operand = VM_DecOperandRegF64("operand");
+        float* result = VM_DecResultRegF32("result");
+        *result = (float)operand;
+      });
+
+      //===----------------------------------------------------------------===//
+      // ExtF64: Comparison ops
+      //===----------------------------------------------------------------===//
+
+#define DISPATCH_OP_EXT_F64_CMP_F64(op_name, op)    \
+  DISPATCH_OP(EXT_F64, op_name, {                   \
+    double lhs = VM_DecOperandRegF64("lhs");        \
+    double rhs = VM_DecOperandRegF64("rhs");        \
+    int32_t* result = VM_DecResultRegI32("result"); \
+    *result = ((lhs)op(rhs)) ? 1 : 0;               \
+  });
+
+      DISPATCH_OP_EXT_F64_CMP_F64(CmpEQF64, ==);
+      DISPATCH_OP_EXT_F64_CMP_F64(CmpNEF64, !=);
+      DISPATCH_OP_EXT_F64_CMP_F64(CmpLTF64, <);
+      DISPATCH_OP_EXT_F64_CMP_F64(CmpLTEF64, <=);
+      DISPATCH_OP(EXT_F64, CmpNZF64, {
+        double operand = VM_DecOperandRegF64("operand");
+        int32_t* result = VM_DecResultRegI32("result");
+        *result = (operand != 0) ? 1 : 0;
+      });
+#else
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED);
+#endif  // IREE_VM_EXT_F64_ENABLE
+    }
+    END_DISPATCH_PREFIX();
 
     // NOLINTNEXTLINE(misc-static-assert)
     DISPATCH_UNHANDLED_CORE();
   }
   END_DISPATCH_CORE();
 }
+
+iree_status_t iree_vm_bytecode_dispatch(
+    iree_vm_stack_t* stack, iree_vm_bytecode_module_t* module,
+    const iree_vm_function_call_t* call, iree_string_view_t cconv_arguments,
+    iree_string_view_t cconv_results, iree_vm_execution_result_t* out_result) {
+  memset(out_result, 0, sizeof(*out_result));
+
+  // Enter function (as this is the initial call).
+  // The callee's return will take care of storing the output registers when it
+  // actually does return, either immediately or in the future via a resume.
+  iree_vm_stack_frame_t* current_frame = NULL;
+  iree_vm_registers_t regs;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_bytecode_external_enter(stack, call->function, cconv_arguments,
+                                      call->arguments, &current_frame, &regs));
+
+  return iree_vm_bytecode_dispatch_frames(
+      stack, module, current_frame, regs, current_frame->depth, cconv_results,
+      call->results, out_result);
+}
+
+iree_status_t iree_vm_bytecode_resume(iree_vm_stack_t* stack,
+                                      iree_vm_bytecode_module_t* module,
+                                      iree_vm_execution_result_t* out_result) {
+  memset(out_result, 0, sizeof(*out_result));
+
+  // Only the frames of an internal call chain are left on the stack when
+  // yielding and the top frame will always belong to the yielding module.
+  iree_vm_stack_frame_t* current_frame = iree_vm_stack_current_frame(stack);
+  if (IREE_UNLIKELY(!current_frame) ||
+      IREE_UNLIKELY(current_frame->function.module != &module->interface)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "no yielded frame from this module to resume");
+  }
+
+  // Reload the dispatch state stashed by the yield and continue execution.
+  const iree_vm_bytecode_frame_storage_t* stack_storage =
+      (const iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
+          current_frame);
+  return iree_vm_bytecode_dispatch_frames(
+      stack, module, current_frame,
+      iree_vm_bytecode_get_register_storage(current_frame),
+      stack_storage->entry_frame_depth, stack_storage->cconv_results,
+      stack_storage->results, out_result);
+}
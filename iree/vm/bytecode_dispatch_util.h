@@ -25,8 +25,8 @@
 
 // TODO(benvanik): make a compiler setting.
 #define IREE_VM_EXT_I64_ENABLE 1
-#define IREE_VM_EXT_F32_ENABLE 0
-#define IREE_VM_EXT_F64_ENABLE 0
+#define IREE_VM_EXT_F32_ENABLE 1
+#define IREE_VM_EXT_F64_ENABLE 1
 
 //===----------------------------------------------------------------------===//
 // Shared data structures
@@ -102,9 +102,19 @@ typedef struct {
   // Relative byte offsets from the head of this struct.
   iree_host_size_t i32_register_offset;
   iree_host_size_t ref_register_offset;
+
+  // Dispatch state of the external entry call stashed when this frame yields.
+  // Only valid in the top frame of a yielded stack and used to continue
+  // dispatch and marshal results back to the external caller upon resume.
+  int32_t entry_frame_depth;
+  iree_string_view_t cconv_results;
+  iree_byte_span_t results;
 } iree_vm_bytecode_frame_storage_t;
 
 // Interleaved src-dst register sets for branch register remapping.
+// Branch operands are encoded as two of these lists back to back: the first
+// containing only i32 register pairs and the second only ref register pairs.
+// This lets each bank be remapped without inspecting the type of each register.
 // This structure is an overlay for the bytecode that is serialized in a
 // matching format.
 typedef struct {
@@ -119,6 +129,25 @@ static_assert(iree_alignof(iree_vm_register_remap_list_t) == 2,
 static_assert(offsetof(iree_vm_register_remap_list_t, pairs) == 2,
               "Expect no padding in the struct");
 
+// Returns the remap list immediately following |remap_list| in the bytecode.
+static inline const iree_vm_register_remap_list_t*
+iree_vm_register_remap_list_next(
+    const iree_vm_register_remap_list_t* remap_list) {
+  return (const iree_vm_register_remap_list_t*)&remap_list
+      ->pairs[remap_list->size];
+}
+
+// Returns the total byte length of the i32 |remap_list| and the ref remap list
+// that follows it.
+static inline iree_host_size_t iree_vm_register_remap_lists_byte_length(
+    const iree_vm_register_remap_list_t* remap_list) {
+  const iree_vm_register_remap_list_t* ref_remap_list =
+      iree_vm_register_remap_list_next(remap_list);
+  return (iree_host_size_t)(
+      (const uint8_t*)iree_vm_register_remap_list_next(ref_remap_list) -
+      (const uint8_t*)remap_list);
+}
+
 // Maps a type ID to a type def with clamping for out of bounds values.
 static inline const iree_vm_type_def_t* iree_vm_map_type(
     iree_vm_bytecode_module_t* module, int32_t type_id) {
@@ -170,6 +199,8 @@ static const int kRegSize = sizeof(uint16_t);
 #define OP_I16(i) *((uint16_t*)&bytecode_data[pc + (i)])
 #define OP_I32(i) *((uint32_t*)&bytecode_data[pc + (i)])
 #define OP_I64(i) *((uint64_t*)&bytecode_data[pc + (i)])
+#define OP_F32(i) *((float*)&bytecode_data[pc + (i)])
+#define OP_F64(i) *((double*)&bytecode_data[pc + (i)])
 #else
 #define OP_I8(i) bytecode_data[pc + (i)]
 #define OP_I16(i)                           \
@@ -189,6 +220,18 @@ static const int kRegSize = sizeof(uint16_t);
       ((uint64_t)bytecode_data[pc + 5 + (i)] << 40) | \
       ((uint64_t)bytecode_data[pc + 6 + (i)] << 48) | \
       ((uint64_t)bytecode_data[pc + 7 + (i)] << 56)
+static inline float iree_vm_bytecode_f32_from_bits(uint32_t bits) {
+  float value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+static inline double iree_vm_bytecode_f64_from_bits(uint64_t bits) {
+  double value;
+  memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+#define OP_F32(i) iree_vm_bytecode_f32_from_bits(OP_I32(i))
+#define OP_F64(i) iree_vm_bytecode_f64_from_bits(OP_I64(i))
 #endif  // IREE_ENDIANNESS_LITTLE
 
 //===----------------------------------------------------------------------===//
@@ -209,6 +252,12 @@ static const int kRegSize = sizeof(uint16_t);
 #define VM_DecConstI64(name) \
   OP_I64(0);                 \
   pc += 8;
+#define VM_DecConstF32(name) \
+  OP_F32(0);                 \
+  pc += 4;
+#define VM_DecConstF64(name) \
+  OP_F64(0);                 \
+  pc += 8;
 #define VM_DecOpcode(opcode) VM_DecConstI8(#opcode)
 #define VM_DecFuncAttr(name) VM_DecConstI32(name)
 #define VM_DecGlobalAttr(name) VM_DecConstI32(name)
@@ -219,22 +268,29 @@ static const int kRegSize = sizeof(uint16_t);
 #define VM_DecTypeOf(name) VM_DecType(name)
 #define VM_DecIntAttr32(name) VM_DecConstI32(name)
 #define VM_DecIntAttr64(name) VM_DecConstI64(name)
+#define VM_DecFloatAttr32(name) VM_DecConstF32(name)
+#define VM_DecFloatAttr64(name) VM_DecConstF64(name)
 #define VM_DecStrAttr(name, out_str)                     \
   (out_str)->size = (iree_host_size_t)OP_I16(0);         \
   (out_str)->data = (const char*)&bytecode_data[pc + 2]; \
   pc += 2 + (out_str)->size;
 #define VM_DecBranchTarget(block_name) VM_DecConstI32(name)
-#define VM_DecBranchOperands(operands_name)                                   \
-  (const iree_vm_register_remap_list_t*)&bytecode_data[pc];                   \
-  pc +=                                                                       \
-      kRegSize + ((const iree_vm_register_list_t*)&bytecode_data[pc])->size * \
-                     2 * kRegSize;
+#define VM_DecBranchOperands(operands_name)                 \
+  (const iree_vm_register_remap_list_t*)&bytecode_data[pc]; \
+  pc += iree_vm_register_remap_lists_byte_length(           \
+      (const iree_vm_register_remap_list_t*)&bytecode_data[pc]);
 #define VM_DecOperandRegI32(name)      \
   regs.i32[OP_I16(0) & regs.i32_mask]; \
   pc += kRegSize;
 #define VM_DecOperandRegI64(name)                           \
   *((int64_t*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
   pc += kRegSize;
+#define VM_DecOperandRegF32(name)                  \
+  *((float*)&regs.i32[OP_I16(0) & regs.i32_mask]); \
+  pc += kRegSize;
+#define VM_DecOperandRegF64(name)                          \
+  *((double*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+  pc += kRegSize;
 #define VM_DecOperandRegRef(name, out_is_move)             \
   &regs.ref[OP_I16(0) & regs.ref_mask];                    \
   *(out_is_move) = OP_I16(0) & IREE_REF_REGISTER_MOVE_BIT; \
@@ -249,6 +305,12 @@ static const int kRegSize = sizeof(uint16_t);
 #define VM_DecResultRegI64(name)                           \
   ((int64_t*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
   pc += kRegSize;
+#define VM_DecResultRegF32(name)                  \
+  ((float*)&regs.i32[OP_I16(0) & regs.i32_mask]); \
+  pc += kRegSize;
+#define VM_DecResultRegF64(name)                          \
+  ((double*)&regs.i32[OP_I16(0) & (regs.i32_mask & ~1)]); \
+  pc += kRegSize;
 #define VM_DecResultRegRef(name, out_is_move)              \
   &regs.ref[OP_I16(0) & regs.ref_mask];                    \
   *(out_is_move) = OP_I16(0) & IREE_REF_REGISTER_MOVE_BIT; \
@@ -298,10 +360,28 @@ static const int kRegSize = sizeof(uint16_t);
 #else
 #define DEFINE_DISPATCH_TABLE_EXT_I64()
 #endif  // IREE_VM_EXT_I64_ENABLE
-
-#define DEFINE_DISPATCH_TABLES() \
-  DEFINE_DISPATCH_TABLE_CORE();  \
-  DEFINE_DISPATCH_TABLE_EXT_I64();
+#if IREE_VM_EXT_F32_ENABLE
+#define DECLARE_DISPATCH_EXT_F32_OPC(ordinal, name) &&_dispatch_EXT_F32_##name,
+#define DEFINE_DISPATCH_TABLE_EXT_F32()                                       \
+  static const void* kDispatchTable_EXT_F32[256] = {IREE_VM_OP_EXT_F32_TABLE( \
+      DECLARE_DISPATCH_EXT_F32_OPC, DECLARE_DISPATCH_EXT_RSV)};
+#else
+#define DEFINE_DISPATCH_TABLE_EXT_F32()
+#endif  // IREE_VM_EXT_F32_ENABLE
+#if IREE_VM_EXT_F64_ENABLE
+#define DECLARE_DISPATCH_EXT_F64_OPC(ordinal, name) &&_dispatch_EXT_F64_##name,
+#define DEFINE_DISPATCH_TABLE_EXT_F64()                                       \
+  static const void* kDispatchTable_EXT_F64[256] = {IREE_VM_OP_EXT_F64_TABLE( \
+      DECLARE_DISPATCH_EXT_F64_OPC, DECLARE_DISPATCH_EXT_RSV)};
+#else
+#define DEFINE_DISPATCH_TABLE_EXT_F64()
+#endif  // IREE_VM_EXT_F64_ENABLE
+
+#define DEFINE_DISPATCH_TABLES()    \
+  DEFINE_DISPATCH_TABLE_CORE();     \
+  DEFINE_DISPATCH_TABLE_EXT_I64();  \
+  DEFINE_DISPATCH_TABLE_EXT_F32();  \
+  DEFINE_DISPATCH_TABLE_EXT_F64();
 
 #define DISPATCH_UNHANDLED_CORE()                                           \
   _dispatch_unhandled : {                                                   \
@@ -55,6 +55,12 @@ static iree_vm_type_def_t iree_vm_bytecode_module_resolve_type(
   } else if (iree_vm_flatbuffer_strcmp(full_name,
                                        iree_make_cstring_view("i64")) == 0) {
     result.value_type = IREE_VM_VALUE_TYPE_I64;
+  } else if (iree_vm_flatbuffer_strcmp(full_name,
+                                       iree_make_cstring_view("f32")) == 0) {
+    result.value_type = IREE_VM_VALUE_TYPE_F32;
+  } else if (iree_vm_flatbuffer_strcmp(full_name,
+                                       iree_make_cstring_view("f64")) == 0) {
+    result.value_type = IREE_VM_VALUE_TYPE_F64;
   } else if (full_name[0] == '!') {
     // Note that we drop the ! prefix:
     iree_string_view_t type_name = {full_name + 1,
@@ -127,6 +133,15 @@ static iree_status_t iree_vm_bytecode_module_flatbuffer_verify(
                             "module missing name field");
   }
 
+  uint32_t bytecode_version =
+      iree_vm_BytecodeModuleDef_bytecode_version(module_def);
+  if (bytecode_version != IREE_VM_BYTECODE_VERSION) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "module bytecode version %u is not supported by "
+                            "this runtime (expected %u); recompile the module",
+                            bytecode_version, IREE_VM_BYTECODE_VERSION);
+  }
+
   iree_vm_TypeDef_vec_t types = iree_vm_BytecodeModuleDef_types(module_def);
   for (size_t i = 0; i < iree_vm_TypeDef_vec_len(types); ++i) {
     iree_vm_TypeDef_table_t type_def = iree_vm_TypeDef_vec_at(types, i);
@@ -528,9 +543,8 @@ static iree_host_size_t iree_vm_bytecode_module_layout_state(
 
   if (state) {
     state->rodata_ref_count = rodata_ref_count;
-    state->rodata_ref_table = (iree_vm_ro_byte_buffer_t*)(base_ptr + offset);
+    state->rodata_ref_table = NULL;
   }
-  offset += iree_align(rodata_ref_count * sizeof(iree_vm_ro_byte_buffer_t), 16);
 
   if (state) {
     state->import_count = import_function_count;
@@ -542,6 +556,56 @@ static iree_host_size_t iree_vm_bytecode_module_layout_state(
   return offset;
 }
 
+static void iree_vm_bytecode_rodata_ref_destroy(void* ptr) {
+  iree_vm_bytecode_rodata_table_t* table =
+      ((iree_vm_bytecode_rodata_ref_t*)ptr)->table;
+  if (iree_atomic_ref_count_dec(&table->live_count) == 1) {
+    iree_vm_module_t* module = table->module;
+    iree_allocator_free(table->allocator, table);
+    iree_vm_module_release(module);
+  }
+}
+
+// Allocates the rodata references of |state| pointing directly at the
+// flatbuffer memory. The references are released by
+// iree_vm_bytecode_module_free_state but live on while retained elsewhere.
+static iree_status_t iree_vm_bytecode_module_alloc_rodata_table(
+    iree_vm_bytecode_module_t* module, iree_allocator_t allocator,
+    iree_vm_bytecode_module_state_t* state) {
+  if (state->rodata_ref_count == 0) return iree_ok_status();
+
+  iree_vm_bytecode_rodata_table_t* table = NULL;
+  iree_host_size_t table_header_size =
+      iree_align(sizeof(*table), iree_max_align_t);
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      allocator,
+      table_header_size +
+          state->rodata_ref_count * sizeof(iree_vm_bytecode_rodata_ref_t),
+      (void**)&table));
+  iree_atomic_store_int32(&table->live_count, (int32_t)state->rodata_ref_count,
+                          iree_memory_order_relaxed);
+  table->module = &module->interface;
+  iree_vm_module_retain(table->module);
+  table->allocator = allocator;
+  state->rodata_ref_table =
+      (iree_vm_bytecode_rodata_ref_t*)((uint8_t*)table + table_header_size);
+
+  iree_vm_RodataSegmentDef_vec_t rodata_segments =
+      iree_vm_BytecodeModuleDef_rodata_segments(module->def);
+  for (int i = 0; i < state->rodata_ref_count; ++i) {
+    iree_vm_RodataSegmentDef_table_t segment =
+        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
+    iree_vm_bytecode_rodata_ref_t* rodata_ref = &state->rodata_ref_table[i];
+    iree_atomic_ref_count_init(&rodata_ref->ref.ref_object.counter);
+    rodata_ref->ref.data.data = iree_vm_RodataSegmentDef_data(segment);
+    rodata_ref->ref.data.data_length =
+        flatbuffers_uint8_vec_len(iree_vm_RodataSegmentDef_data(segment));
+    rodata_ref->ref.destroy = iree_vm_bytecode_rodata_ref_destroy;
+    rodata_ref->table = table;
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_bytecode_module_alloc_state(
     void* self, iree_allocator_t allocator,
     iree_vm_module_state_t** out_module_state) {
@@ -567,16 +631,12 @@ static iree_status_t iree_vm_bytecode_module_alloc_state(
   iree_vm_bytecode_module_layout_state(module_def, state);
 
   // Setup rodata segments to point directly at the flatbuffer memory.
-  iree_vm_RodataSegmentDef_vec_t rodata_segments =
-      iree_vm_BytecodeModuleDef_rodata_segments(module_def);
-  for (int i = 0; i < state->rodata_ref_count; ++i) {
-    iree_vm_RodataSegmentDef_table_t segment =
-        iree_vm_RodataSegmentDef_vec_at(rodata_segments, i);
-    iree_vm_ro_byte_buffer_t* ref = &state->rodata_ref_table[i];
-    iree_atomic_ref_count_init(&ref->ref_object.counter);
-    ref->data.data = iree_vm_RodataSegmentDef_data(segment);
-    ref->data.data_length =
-        flatbuffers_uint8_vec_len(iree_vm_RodataSegmentDef_data(segment));
+  iree_status_t status =
+      iree_vm_bytecode_module_alloc_rodata_table(module, allocator, state);
+  if (!iree_status_is_ok(status)) {
+    iree_allocator_free(allocator, state);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
   }
 
   *out_module_state = (iree_vm_module_state_t*)state;
@@ -597,6 +657,14 @@ static void iree_vm_bytecode_module_free_state(
     iree_vm_ref_release(&state->global_ref_table[i]);
   }
 
+  // Drop the state's references to rodata segments; the table is freed once
+  // any references retained elsewhere are released.
+  for (int i = 0; i < state->rodata_ref_count; ++i) {
+    iree_vm_ref_t rodata_ref =
+        iree_vm_ro_byte_buffer_move_ref(&state->rodata_ref_table[i].ref);
+    iree_vm_ref_release(&rodata_ref);
+  }
+
   iree_allocator_free(state->allocator, module_state);
 
   IREE_TRACE_ZONE_END(z0);
@@ -713,6 +781,20 @@ static iree_status_t iree_vm_bytecode_module_begin_call(
   return status;
 }
 
+static iree_status_t iree_vm_bytecode_module_resume_call(
+    void* self, iree_vm_stack_t* stack,
+    iree_vm_execution_result_t* out_result) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(out_result);
+
+  // Jump back into the dispatch routine to continue executing bytecode from the
+  // yielded frames until the function either returns or yields again.
+  iree_vm_bytecode_module_t* module = (iree_vm_bytecode_module_t*)self;
+  iree_status_t status = iree_vm_bytecode_resume(stack, module, out_result);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_bytecode_module_create(
     iree_const_byte_span_t flatbuffer_data,
     iree_allocator_t flatbuffer_allocator, iree_allocator_t allocator,
@@ -788,6 +870,7 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_bytecode_module_create(
   module->interface.free_state = iree_vm_bytecode_module_free_state;
   module->interface.resolve_import = iree_vm_bytecode_module_resolve_import;
   module->interface.begin_call = iree_vm_bytecode_module_begin_call;
+  module->interface.resume_call = iree_vm_bytecode_module_resume_call;
   module->interface.get_function_reflection_attr =
       iree_vm_bytecode_module_get_function_reflection_attr;
 
@@ -22,6 +22,7 @@
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode_module.h"
 #include "iree/vm/bytecode_module_benchmark_module.h"
+#include "iree/vm/bytecode_module_benchmark_unfused_module.h"
 
 namespace {
 
@@ -74,11 +75,12 @@ static iree_status_t native_import_module_create(
       &interface, &native_import_module_descriptor_, allocator, out_module);
 }
 
-// Benchmarks the given exported function, optionally passing in arguments.
-static iree_status_t RunFunction(benchmark::State& state,
-                                 absl::string_view function_name,
-                                 absl::Span<const int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
+// Benchmarks the given exported function in the module embedded as
+// |module_file_toc|, optionally passing in arguments.
+static iree_status_t RunModuleFunction(
+    benchmark::State& state, const struct iree::FileToc* module_file_toc,
+    absl::string_view function_name, absl::Span<const int32_t> i32_args,
+    int result_count, int64_t batch_size = 1) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance));
 
@@ -86,8 +88,6 @@ static iree_status_t RunFunction(benchmark::State& state,
   IREE_CHECK_OK(
       native_import_module_create(iree_allocator_system(), &import_module));
 
-  const auto* module_file_toc =
-      iree::vm::bytecode_module_benchmark_module_create();
   iree_vm_module_t* bytecode_module = nullptr;
   IREE_CHECK_OK(iree_vm_bytecode_module_create(
       iree_const_byte_span_t{
@@ -138,6 +138,16 @@ static iree_status_t RunFunction(benchmark::State& state,
   return iree_ok_status();
 }
 
+// Benchmarks the given exported function, optionally passing in arguments.
+static iree_status_t RunFunction(benchmark::State& state,
+                                 absl::string_view function_name,
+                                 absl::Span<const int32_t> i32_args,
+                                 int result_count, int64_t batch_size = 1) {
+  return RunModuleFunction(state,
+                           iree::vm::bytecode_module_benchmark_module_create(),
+                           function_name, i32_args, result_count, batch_size);
+}
+
 static void BM_ModuleCreate(benchmark::State& state) {
   while (state.KeepRunning()) {
     const auto* module_file_toc =
@@ -305,4 +315,16 @@ static void BM_LoopSumBytecode(benchmark::State& state) {
 }
 BENCHMARK(BM_LoopSumBytecode)->Arg(100000);
 
+// As BM_LoopSumBytecode but with the module compiled without superinstructions
+// to show the benefit of fusing the loop compare-and-branch and increment.
+static void BM_LoopSumBytecodeUnfused(benchmark::State& state) {
+  IREE_CHECK_OK(RunModuleFunction(
+      state, iree::vm::bytecode_module_benchmark_unfused_module_create(),
+      "bytecode_module_benchmark.loop_sum",
+      {static_cast<int32_t>(state.range(0))},
+      /*result_count=*/1,
+      /*batch_size=*/state.range(0)));
+}
+BENCHMARK(BM_LoopSumBytecodeUnfused)->Arg(100000);
+
 }  // namespace
@@ -35,6 +35,10 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Version of the bytecode encoding executed by this runtime. Modules recording
+// any other BytecodeModuleDef.bytecode_version fail to load.
+#define IREE_VM_BYTECODE_VERSION iree_vm_BytecodeVersion_V1
+
 #define VMMAX(a, b) (((a) > (b)) ? (a) : (b))
 #define VMMIN(a, b) (((a) < (b)) ? (a) : (b))
 
@@ -100,6 +104,29 @@ typedef struct {
   uint16_t result_buffer_size;
 } iree_vm_bytecode_import_t;
 
+struct iree_vm_bytecode_rodata_table_s;
+
+// A reference to a rodata segment in the module flatbuffer.
+// References are allocated apart from the module state so that any handed out
+// (such as to HAL buffers wrapping the segment contents in place) may outlive
+// it. The table they are allocated from retains the module, and with it the
+// flatbuffer they point into, until the last reference is released.
+typedef struct {
+  iree_vm_ro_byte_buffer_t ref;
+  struct iree_vm_bytecode_rodata_table_s* table;
+} iree_vm_bytecode_rodata_ref_t;
+
+// Per-instance table of rodata references as a single flat allocation.
+// The |live_count| references follow the header.
+typedef struct iree_vm_bytecode_rodata_table_s {
+  // Number of references in the table that have not yet been destroyed.
+  iree_atomic_ref_count_t live_count;
+  // Module retained while any reference remains live.
+  iree_vm_module_t* module;
+  // Allocator used for the table and that it must be freed with.
+  iree_allocator_t allocator;
+} iree_vm_bytecode_rodata_table_t;
+
 // Per-instance module state.
 // This is allocated with a provided allocator as a single flat allocation.
 // This struct is a prefix to the allocation pointing into the dynamic offsets
@@ -114,11 +141,12 @@ typedef struct {
   iree_vm_ref_t* global_ref_table;
 
   // TODO(benvanik): move to iree_vm_bytecode_module_t if always static.
-  // Initialized references to rodata segments.
+  // Initialized references to rodata segments, stored in a separately
+  // allocated iree_vm_bytecode_rodata_table_t.
   // Right now these don't do much, however we can perform lazy caching and
   // on-the-fly decompression using this information.
   iree_host_size_t rodata_ref_count;
-  iree_vm_ro_byte_buffer_t* rodata_ref_table;
+  iree_vm_bytecode_rodata_ref_t* rodata_ref_table;
 
   // Resolved function imports.
   iree_host_size_t import_count;
@@ -128,9 +156,9 @@ typedef struct {
   iree_allocator_t allocator;
 } iree_vm_bytecode_module_state_t;
 
-// Begins (or resumes) execution of the current frame and continues until
-// either a yield or return. |out_result| will contain the result status for
-// continuation, if needed.
+// Begins execution of the |call| function and continues until either a yield
+// or return. |out_result| will indicate whether the call yielded and must be
+// continued with iree_vm_bytecode_resume.
 iree_status_t iree_vm_bytecode_dispatch(iree_vm_stack_t* stack,
                                         iree_vm_bytecode_module_t* module,
                                         const iree_vm_function_call_t* call,
@@ -138,6 +166,14 @@ iree_status_t iree_vm_bytecode_dispatch(iree_vm_stack_t* stack,
                                         iree_string_view_t cconv_results,
                                         iree_vm_execution_result_t* out_result);
 
+// Resumes execution of the yielded frames at the top of |stack| and continues
+// until either another yield or the return from the original entry function.
+// Results are marshaled into the results buffer of the call that was passed to
+// iree_vm_bytecode_dispatch when it first began execution.
+iree_status_t iree_vm_bytecode_resume(iree_vm_stack_t* stack,
+                                      iree_vm_bytecode_module_t* module,
+                                      iree_vm_execution_result_t* out_result);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -18,10 +18,81 @@
 
 #include "iree/vm/bytecode_module.h"
 
+#include <cstdlib>
+#include <cstring>
+
+#include "iree/base/api.h"
 #include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode_module_test_module.h"
 
 namespace {
 
 // TODO(benvanik): bytecode_module_test.cc for flatbuffer/module implementation.
 
+// iree_allocator_t free function recording that the module flatbuffer has been
+// freed.
+static void FreeFlatbuffer(void* self, void* ptr) {
+  *static_cast<bool*>(self) = true;
+  free(ptr);
+}
+
+// Tests that rodata references handed out by a module keep the module and its
+// flatbuffer alive after the context and the caller's module are released.
+TEST(BytecodeModuleTest, RodataOutlivesContext) {
+  IREE_ASSERT_OK(iree_vm_register_builtin_types());
+  iree_vm_instance_t* instance = nullptr;
+  IREE_ASSERT_OK(iree_vm_instance_create(iree_allocator_system(), &instance));
+
+  // Load the module from a copy of its flatbuffer that the module owns so we
+  // can observe when it is freed.
+  const auto* module_file_toc = iree::vm::bytecode_module_test_module_create();
+  void* flatbuffer_data = malloc(module_file_toc->size);
+  memcpy(flatbuffer_data, module_file_toc->data, module_file_toc->size);
+  bool flatbuffer_freed = false;
+  iree_allocator_t flatbuffer_allocator = {
+      /*self=*/&flatbuffer_freed,
+      /*alloc=*/nullptr,
+      /*free=*/FreeFlatbuffer,
+  };
+  iree_vm_module_t* module = nullptr;
+  IREE_ASSERT_OK(iree_vm_bytecode_module_create(
+      iree_const_byte_span_t{reinterpret_cast<uint8_t*>(flatbuffer_data),
+                             module_file_toc->size},
+      flatbuffer_allocator, iree_allocator_system(), &module));
+
+  iree_vm_context_t* context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance, &module, 1, iree_allocator_system(), &context));
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(module->lookup_function(
+      module->self, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      iree_make_cstring_view("return_rodata"), &function));
+  iree_vm_list_t* outputs = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &outputs));
+  IREE_ASSERT_OK(iree_vm_invoke(context, function, /*policy=*/nullptr,
+                                /*inputs=*/nullptr, outputs,
+                                iree_allocator_system()));
+  iree_vm_ref_t rodata_ref = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_ref_retain(outputs, 0, &rodata_ref));
+  iree_vm_list_release(outputs);
+
+  iree_vm_context_release(context);
+  iree_vm_module_release(module);
+  EXPECT_FALSE(flatbuffer_freed);
+
+  iree_vm_ro_byte_buffer_t* rodata = nullptr;
+  IREE_ASSERT_OK(iree_vm_ro_byte_buffer_check_deref(&rodata_ref, &rodata));
+  ASSERT_EQ(4, rodata->data.data_length);
+  const uint8_t expected[] = {1, 2, 3, 4};
+  EXPECT_EQ(0, memcmp(expected, rodata->data.data, sizeof(expected)));
+
+  iree_vm_ref_release(&rodata_ref);
+  EXPECT_TRUE(flatbuffer_freed);
+
+  iree_vm_instance_release(instance);
+}
+
 }  // namespace
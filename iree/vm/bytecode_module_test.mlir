@@ -0,0 +1,10 @@
+vm.module @bytecode_module_test {
+  vm.rodata @blob dense<[1, 2, 3, 4]> : tensor<4xi8>
+
+  // Returns a reference to the @blob rodata segment.
+  vm.export @return_rodata
+  vm.func @return_rodata() -> !vm.ref<!iree.byte_buffer> {
+    %0 = vm.const.ref.rodata @blob : !vm.ref<!iree.byte_buffer>
+    vm.return %0 : !vm.ref<!iree.byte_buffer>
+  }
+}
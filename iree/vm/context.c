@@ -59,9 +59,14 @@ static iree_status_t iree_vm_context_run_function(
   }
 
   iree_vm_execution_result_t result;
+  memset(&result, 0, sizeof(result));
   status = module->begin_call(module->self, stack, &call, &result);
 
-  // TODO(benvanik): ensure completed synchronously.
+  // Initialization is synchronous so any yields are resumed immediately.
+  while (iree_status_is_ok(status) &&
+         iree_vm_execution_result_is_yielded(&result)) {
+    status = module->resume_call(module->self, stack, &result);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
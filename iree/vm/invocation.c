@@ -15,6 +15,7 @@
 #include "iree/vm/invocation.h"
 
 #include "iree/base/api.h"
+#include "iree/base/debugging.h"
 #include "iree/base/tracing.h"
 
 // Marshals caller arguments from the variant list to the ABI convention.
@@ -55,6 +56,20 @@ static iree_status_t iree_vm_invoke_marshal_inputs(
         memcpy(p, &value.i64, sizeof(int64_t));
         p += sizeof(int64_t);
       } break;
+      case IREE_VM_CCONV_TYPE_FLOAT32: {
+        iree_vm_value_t value;
+        IREE_RETURN_IF_ERROR(iree_vm_list_get_value_as(
+            inputs, arg_i, IREE_VM_VALUE_TYPE_F32, &value));
+        memcpy(p, &value.f32, sizeof(float));
+        p += sizeof(float);
+      } break;
+      case IREE_VM_CCONV_TYPE_FLOAT64: {
+        iree_vm_value_t value;
+        IREE_RETURN_IF_ERROR(iree_vm_list_get_value_as(
+            inputs, arg_i, IREE_VM_VALUE_TYPE_F64, &value));
+        memcpy(p, &value.f64, sizeof(double));
+        p += sizeof(double);
+      } break;
       case IREE_VM_CCONV_TYPE_REF: {
         // TODO(benvanik): see if we can't remove this retain by instead relying
         // on the caller still owning the list.
@@ -99,6 +114,16 @@ static iree_status_t iree_vm_invoke_marshal_outputs(
         IREE_RETURN_IF_ERROR(iree_vm_list_set_value(outputs, arg_i, &value));
         p += sizeof(int64_t);
       } break;
+      case IREE_VM_CCONV_TYPE_FLOAT32: {
+        iree_vm_value_t value = iree_vm_value_make_f32(*(float*)p);
+        IREE_RETURN_IF_ERROR(iree_vm_list_set_value(outputs, arg_i, &value));
+        p += sizeof(float);
+      } break;
+      case IREE_VM_CCONV_TYPE_FLOAT64: {
+        iree_vm_value_t value = iree_vm_value_make_f64(*(double*)p);
+        IREE_RETURN_IF_ERROR(iree_vm_list_set_value(outputs, arg_i, &value));
+        p += sizeof(double);
+      } break;
       case IREE_VM_CCONV_TYPE_REF: {
         IREE_RETURN_IF_ERROR(
             iree_vm_list_set_ref_move(outputs, arg_i, (iree_vm_ref_t*)p));
@@ -109,7 +134,29 @@ static iree_status_t iree_vm_invoke_marshal_outputs(
   return iree_ok_status();
 }
 
-// TODO(benvanik): implement this as an iree_vm_invocation_t sequence.
+// Queries the calling convention fragments of |function| and computes the sizes
+// of the ABI argument and result buffers required to call it.
+static iree_status_t iree_vm_invoke_compute_buffer_sizes(
+    iree_vm_function_t function, iree_string_view_t* out_cconv_arguments,
+    iree_string_view_t* out_cconv_results,
+    iree_host_size_t* out_argument_buffer_size,
+    iree_host_size_t* out_result_buffer_size) {
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  *out_cconv_arguments = iree_string_view_empty();
+  *out_cconv_results = iree_string_view_empty();
+  IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
+      &signature, out_cconv_arguments, out_cconv_results));
+
+  // NOTE: today we don't support variadic arguments through this interface.
+  IREE_RETURN_IF_ERROR(iree_vm_function_call_compute_cconv_fragment_size(
+      *out_cconv_arguments, /*segment_size_list=*/NULL,
+      out_argument_buffer_size));
+  IREE_RETURN_IF_ERROR(iree_vm_function_call_compute_cconv_fragment_size(
+      *out_cconv_results, /*segment_size_list=*/NULL, out_result_buffer_size));
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_invoke_within(
     iree_vm_context_t* context, iree_vm_stack_t* stack,
     iree_vm_function_t function, const iree_vm_invocation_policy_t* policy,
@@ -121,37 +168,39 @@ static iree_status_t iree_vm_invoke_within(
       iree_vm_function_signature(&function);
   iree_string_view_t cconv_arguments = iree_string_view_empty();
   iree_string_view_t cconv_results = iree_string_view_empty();
-  IREE_RETURN_IF_ERROR(iree_vm_function_call_get_cconv_fragments(
-      &signature, &cconv_arguments, &cconv_results));
+  iree_byte_span_t arguments = iree_make_byte_span(NULL, 0);
+  iree_byte_span_t results = iree_make_byte_span(NULL, 0);
+  IREE_RETURN_IF_ERROR(iree_vm_invoke_compute_buffer_sizes(
+      function, &cconv_arguments, &cconv_results, &arguments.data_length,
+      &results.data_length));
 
   // Marshal the input arguments into the VM ABI and preallocate the result
   // buffer.
-  // NOTE: today we don't support variadic arguments through this interface.
-  iree_byte_span_t arguments = iree_make_byte_span(NULL, 0);
-  IREE_RETURN_IF_ERROR(iree_vm_function_call_compute_cconv_fragment_size(
-      cconv_arguments, /*segment_size_list=*/NULL, &arguments.data_length));
   arguments.data = iree_alloca(arguments.data_length);
   memset(arguments.data, 0, arguments.data_length);
   IREE_RETURN_IF_ERROR(
       iree_vm_invoke_marshal_inputs(cconv_arguments, inputs, arguments));
 
   // Allocate the result output that will be populated by the callee.
-  iree_byte_span_t results = iree_make_byte_span(NULL, 0);
-  IREE_RETURN_IF_ERROR(iree_vm_function_call_compute_cconv_fragment_size(
-      cconv_results, /*segment_size_list=*/NULL, &results.data_length));
   results.data = iree_alloca(results.data_length);
   memset(results.data, 0, results.data_length);
 
-  // Perform execution. Note that for synchronous execution we expect this to
-  // complete without yielding.
+  // Perform execution. As this is a synchronous invocation any yields are
+  // immediately resumed until the call completes.
   iree_vm_function_call_t call;
   memset(&call, 0, sizeof(call));
   call.function = function;
   call.arguments = arguments;
   call.results = results;
   iree_vm_execution_result_t result;
+  memset(&result, 0, sizeof(result));
   iree_status_t status =
       function.module->begin_call(function.module->self, stack, &call, &result);
+  while (iree_status_is_ok(status) &&
+         iree_vm_execution_result_is_yielded(&result)) {
+    status =
+        function.module->resume_call(function.module->self, stack, &result);
+  }
   if (!iree_status_is_ok(status)) {
     iree_vm_function_call_release(&call, &signature);
     return status;
@@ -180,3 +229,236 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoke(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// iree_vm_invocation_t
+//===----------------------------------------------------------------------===//
+
+struct iree_vm_invocation {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t allocator;
+
+  // Context the invocation executes within. Retained for as long as the
+  // invocation is live as the suspended frames reference module state.
+  iree_vm_context_t* context;
+  iree_vm_function_t function;
+
+  // Dynamically-allocated stack holding the suspended frames while the call
+  // is in-flight. Freed as soon as the call completes.
+  iree_vm_stack_t* stack;
+
+  // ABI results buffer populated by the callee when the call completes.
+  // Stored inline after the invocation structure.
+  iree_string_view_t cconv_results;
+  iree_byte_span_t results;
+
+  // Completion status of the call: IREE_STATUS_UNAVAILABLE while in-flight.
+  iree_status_t status;
+
+  // Variant list containing the call results after successful completion.
+  iree_vm_list_t* outputs;
+};
+
+static bool iree_vm_invocation_is_pending(iree_vm_invocation_t* invocation) {
+  return iree_status_code(invocation->status) == IREE_STATUS_UNAVAILABLE;
+}
+
+// Processes the result of beginning or resuming the invocation call. If the
+// call yielded the invocation remains pending and otherwise the stack is torn
+// down and the outputs are read back from the results buffer.
+static void iree_vm_invocation_process_result(
+    iree_vm_invocation_t* invocation, iree_status_t call_status,
+    const iree_vm_execution_result_t* result) {
+  if (iree_status_is_ok(call_status) &&
+      iree_vm_execution_result_is_yielded(result)) {
+    return;
+  }
+
+  if (iree_status_is_ok(call_status)) {
+    iree_vm_type_def_t element_type = iree_vm_type_def_make_variant_type();
+    call_status = iree_vm_list_create(&element_type,
+                                      invocation->cconv_results.size,
+                                      invocation->allocator,
+                                      &invocation->outputs);
+    if (iree_status_is_ok(call_status)) {
+      call_status = iree_vm_invoke_marshal_outputs(
+          invocation->cconv_results, invocation->results, invocation->outputs);
+    }
+  }
+
+  // Tearing down the stack releases any registers still held by frames that
+  // did not complete (such as when the call failed).
+  iree_vm_stack_free(invocation->stack);
+  invocation->stack = NULL;
+  invocation->status = call_status;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_create(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    iree_allocator_t allocator, iree_vm_invocation_t** out_invocation) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_invocation);
+  // Scheduling policies are reserved for future use.
+  IREE_ASSERT(!policy);
+  *out_invocation = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  iree_byte_span_t arguments = iree_make_byte_span(NULL, 0);
+  iree_host_size_t result_buffer_size = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_invoke_compute_buffer_sizes(
+              function, &cconv_arguments, &cconv_results,
+              &arguments.data_length, &result_buffer_size));
+
+  // Marshal the input arguments into the VM ABI. These are consumed when the
+  // call begins and need not outlive this function.
+  arguments.data = iree_alloca(arguments.data_length);
+  memset(arguments.data, 0, arguments.data_length);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_invoke_marshal_inputs(cconv_arguments,
+                                        (iree_vm_list_t*)inputs, arguments));
+
+  // Allocate the invocation with the results buffer stored inline as it must
+  // remain valid across yields.
+  iree_vm_invocation_t* invocation = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      allocator, sizeof(*invocation) + result_buffer_size,
+      (void**)&invocation);
+  if (iree_status_is_ok(status)) {
+    memset(invocation, 0, sizeof(*invocation) + result_buffer_size);
+    iree_atomic_ref_count_init(&invocation->ref_count);
+    invocation->allocator = allocator;
+    invocation->context = context;
+    iree_vm_context_retain(context);
+    invocation->function = function;
+    invocation->cconv_results = cconv_results;
+    invocation->results = iree_make_byte_span(
+        (uint8_t*)invocation + sizeof(*invocation), result_buffer_size);
+    invocation->status = iree_status_from_code(IREE_STATUS_UNAVAILABLE);
+    status = iree_vm_stack_allocate(iree_vm_context_state_resolver(context),
+                                    allocator, &invocation->stack);
+  }
+
+  // Begin execution and run until the call either completes or first yields.
+  // Failures during execution are captured in the invocation status.
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = function;
+  call.arguments = arguments;
+  if (iree_status_is_ok(status)) {
+    call.results = invocation->results;
+    iree_vm_execution_result_t result;
+    memset(&result, 0, sizeof(result));
+    iree_status_t call_status = function.module->begin_call(
+        function.module->self, invocation->stack, &call, &result);
+    if (!iree_status_is_ok(call_status)) {
+      iree_vm_function_signature_t signature =
+          iree_vm_function_signature(&function);
+      iree_vm_function_call_release(&call, &signature);
+    }
+    iree_vm_invocation_process_result(invocation, call_status, &result);
+  } else {
+    // The call never began and the marshaled arguments still hold their refs.
+    // Release walks the (empty) results as well so they need valid storage.
+    call.results.data_length = result_buffer_size;
+    call.results.data = iree_alloca(result_buffer_size);
+    memset(call.results.data, 0, result_buffer_size);
+    iree_vm_function_signature_t signature =
+        iree_vm_function_signature(&function);
+    iree_vm_function_call_release(&call, &signature);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_invocation = invocation;
+  } else {
+    iree_vm_invocation_release(invocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_vm_invocation_destroy(iree_vm_invocation_t* invocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (invocation->stack) iree_vm_stack_free(invocation->stack);
+  iree_vm_list_release(invocation->outputs);
+  iree_status_ignore(invocation->status);
+  iree_vm_context_release(invocation->context);
+  iree_allocator_free(invocation->allocator, invocation);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void IREE_API_CALL
+iree_vm_invocation_retain(iree_vm_invocation_t* invocation) {
+  if (invocation) {
+    iree_atomic_ref_count_inc(&invocation->ref_count);
+  }
+}
+
+IREE_API_EXPORT void IREE_API_CALL
+iree_vm_invocation_release(iree_vm_invocation_t* invocation) {
+  if (invocation && iree_atomic_ref_count_dec(&invocation->ref_count) == 1) {
+    iree_vm_invocation_destroy(invocation);
+  }
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_query_status(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  return iree_status_clone(invocation->status);
+}
+
+IREE_API_EXPORT const iree_vm_list_t* IREE_API_CALL
+iree_vm_invocation_output(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  return iree_status_is_ok(invocation->status) ? invocation->outputs : NULL;
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_resume(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_pending(invocation)) {
+    return iree_vm_invocation_query_status(invocation);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_vm_module_t* module = invocation->function.module;
+  iree_vm_execution_result_t result;
+  memset(&result, 0, sizeof(result));
+  iree_status_t call_status =
+      module->resume_call(module->self, invocation->stack, &result);
+  iree_vm_invocation_process_result(invocation, call_status, &result);
+  IREE_TRACE_ZONE_END(z0);
+  return iree_vm_invocation_query_status(invocation);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_await(
+    iree_vm_invocation_t* invocation, iree_time_t deadline) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // NOTE: this spins on resume without waiting between yields. The deadline is
+  // only checked between yields; a call that never yields cannot be
+  // interrupted.
+  while (iree_vm_invocation_is_pending(invocation)) {
+    if (deadline != IREE_TIME_INFINITE_FUTURE && iree_time_now() >= deadline) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+    iree_status_ignore(iree_vm_invocation_resume(invocation));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return iree_vm_invocation_query_status(invocation);
+}
+
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_abort(iree_vm_invocation_t* invocation) {
+  IREE_ASSERT_ARGUMENT(invocation);
+  if (!iree_vm_invocation_is_pending(invocation)) return iree_ok_status();
+  // Freeing the stack runs the frame cleanup routines that release any refs
+  // held in the suspended frames.
+  iree_vm_stack_free(invocation->stack);
+  invocation->stack = NULL;
+  invocation->status = iree_status_from_code(IREE_STATUS_ABORTED);
+  return iree_ok_status();
+}
@@ -47,18 +47,35 @@ IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invoke(
     const iree_vm_invocation_policy_t* policy, iree_vm_list_t* inputs,
     iree_vm_list_t* outputs, iree_allocator_t allocator);
 
-// TODO(benvanik): document and implement.
+// Creates an invocation of |function| in |context| that may be suspended and
+// resumed across yields (such as those issued by the vm.yield instruction).
+//
+// Execution begins immediately and runs until the function either completes or
+// first yields. A yielded invocation retains its stack frames and can be
+// continued with iree_vm_invocation_resume, allowing a host scheduler to park
+// the invocation (for example on a semaphore) and run others in the meantime.
+// Errors raised during execution are captured in the invocation status and
+// only setup failures (such as mismatched |inputs|) are returned here.
+//
+// |policy| is reserved for future scheduling policies and must be NULL.
+//
+// |inputs| is used to pass values and objects into the target function and must
+// match the signature defined by the compiled function. List ownership remains
+// with the caller.
+//
+// |out_invocation| must be released by the caller.
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_create(
     iree_vm_context_t* context, iree_vm_function_t function,
     const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
     iree_allocator_t allocator, iree_vm_invocation_t** out_invocation);
 
 // Retains the given |invocation| for the caller.
-IREE_API_EXPORT iree_status_t IREE_API_CALL
+IREE_API_EXPORT void IREE_API_CALL
 iree_vm_invocation_retain(iree_vm_invocation_t* invocation);
 
 // Releases the given |invocation| from the caller.
-IREE_API_EXPORT iree_status_t IREE_API_CALL
+// Any suspended frames of a pending invocation are torn down.
+IREE_API_EXPORT void IREE_API_CALL
 iree_vm_invocation_release(iree_vm_invocation_t* invocation);
 
 // Queries the completion status of the invocation.
@@ -80,10 +97,27 @@ iree_vm_invocation_query_status(iree_vm_invocation_t* invocation);
 IREE_API_EXPORT const iree_vm_list_t* IREE_API_CALL
 iree_vm_invocation_output(iree_vm_invocation_t* invocation);
 
+// Resumes a yielded |invocation| and runs it until it either yields again or
+// completes. A no-op if the invocation has already completed.
+//
+// Returns the same status as iree_vm_invocation_query_status after running:
+// IREE_STATUS_UNAVAILABLE indicates that the invocation yielded again and must
+// be resumed further.
+IREE_API_EXPORT iree_status_t IREE_API_CALL
+iree_vm_invocation_resume(iree_vm_invocation_t* invocation);
+
 // Blocks the caller until the invocation completes (successfully or otherwise).
 //
+// Pending invocations are resumed on the calling thread until they complete.
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if |deadline| elapses before the
 // invocation completes and otherwise returns iree_vm_invocation_query_status.
+// The deadline is only checked between yields.
+//
+// NOTE: this busy-spins: each yield is immediately resumed without sleeping or
+// waiting on whatever the invocation yielded for, so the calling thread stays
+// fully occupied until completion or the deadline. Callers that want to do
+// other work while an invocation is parked should schedule their own calls to
+// iree_vm_invocation_resume instead.
 IREE_API_EXPORT iree_status_t IREE_API_CALL iree_vm_invocation_await(
     iree_vm_invocation_t* invocation, iree_time_t deadline);
 
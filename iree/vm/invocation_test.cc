@@ -0,0 +1,247 @@
+// Copyright 2021 Google LLC
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//      https://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Tests for the iree_vm_invocation_t API: parking invocations that yield,
+// resuming them in any order, and aborting or awaiting them.
+
+#include "iree/vm/invocation.h"
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+#include "iree/vm/api.h"
+#include "iree/vm/bytecode_module.h"
+#include "iree/vm/invocation_test_module.h"
+
+namespace {
+
+// Consumes |status| and returns its code.
+static iree_status_code_t ConsumeCode(iree_status_t status) {
+  return iree_status_consume_code(status);
+}
+
+// Returns the current reference count of |list|.
+static int32_t ReadRefCount(iree_vm_list_t* list) {
+  return iree_atomic_load_int32(
+      (iree_atomic_ref_count_t*)(((uintptr_t)list) +
+                                 iree_vm_list_get_descriptor()
+                                     ->offsetof_counter),
+      iree_memory_order_seq_cst);
+}
+
+class VMInvocationTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_CHECK_OK(iree_vm_register_builtin_types());
+    IREE_CHECK_OK(iree_vm_instance_create(iree_allocator_system(), &instance_));
+
+    const auto* module_file_toc = iree::vm::invocation_test_module_create();
+    IREE_CHECK_OK(iree_vm_bytecode_module_create(
+        iree_const_byte_span_t{
+            reinterpret_cast<const uint8_t*>(module_file_toc->data),
+            module_file_toc->size},
+        iree_allocator_null(), iree_allocator_system(), &bytecode_module_))
+        << "Bytecode module failed to load";
+
+    iree_vm_module_t* modules[] = {bytecode_module_};
+    IREE_CHECK_OK(iree_vm_context_create_with_modules(
+        instance_, modules, IREE_ARRAYSIZE(modules), iree_allocator_system(),
+        &context_));
+  }
+
+  void TearDown() override {
+    iree_vm_module_release(bytecode_module_);
+    iree_vm_context_release(context_);
+    iree_vm_instance_release(instance_);
+  }
+
+  // Creates an invocation of |function_name| that runs until it first yields.
+  iree_vm_invocation_t* CreateInvocation(const char* function_name,
+                                         iree_vm_list_t* inputs) {
+    iree_vm_function_t function;
+    IREE_CHECK_OK(bytecode_module_->lookup_function(
+        bytecode_module_->self, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+        iree_make_cstring_view(function_name), &function))
+        << "Exported function '" << function_name << "' not found";
+    iree_vm_invocation_t* invocation = nullptr;
+    IREE_CHECK_OK(iree_vm_invocation_create(context_, function,
+                                            /*policy=*/nullptr, inputs,
+                                            iree_allocator_system(),
+                                            &invocation));
+    return invocation;
+  }
+
+  // Creates an invocation of yield_triple(|value|).
+  iree_vm_invocation_t* CreateTripleInvocation(int32_t value) {
+    iree_vm_list_t* inputs = nullptr;
+    IREE_CHECK_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                      iree_allocator_system(), &inputs));
+    iree_vm_value_t arg = iree_vm_value_make_i32(value);
+    IREE_CHECK_OK(iree_vm_list_push_value(inputs, &arg));
+    iree_vm_invocation_t* invocation = CreateInvocation("yield_triple", inputs);
+    iree_vm_list_release(inputs);
+    return invocation;
+  }
+
+  // Returns the i32 result of a completed yield_triple invocation.
+  int32_t ReadTripleOutput(iree_vm_invocation_t* invocation) {
+    const iree_vm_list_t* outputs = iree_vm_invocation_output(invocation);
+    EXPECT_NE(nullptr, outputs);
+    if (!outputs) return -1;
+    EXPECT_EQ(1, iree_vm_list_size(outputs));
+    iree_vm_value_t value;
+    IREE_CHECK_OK(iree_vm_list_get_value(outputs, 0, &value));
+    return value.i32;
+  }
+
+  iree_vm_instance_t* instance_ = nullptr;
+  iree_vm_context_t* context_ = nullptr;
+  iree_vm_module_t* bytecode_module_ = nullptr;
+};
+
+// Tests that two parked invocations can be resumed in an interleaved order
+// without disturbing each other's suspended frames.
+TEST_F(VMInvocationTest, InterleaveParkedInvocations) {
+  iree_vm_invocation_t* invocation_a = CreateTripleInvocation(2);
+  iree_vm_invocation_t* invocation_b = CreateTripleInvocation(5);
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            ConsumeCode(iree_vm_invocation_query_status(invocation_a)));
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            ConsumeCode(iree_vm_invocation_query_status(invocation_b)));
+  EXPECT_EQ(nullptr, iree_vm_invocation_output(invocation_a));
+
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            ConsumeCode(iree_vm_invocation_resume(invocation_b)));
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            ConsumeCode(iree_vm_invocation_resume(invocation_a)));
+  IREE_EXPECT_OK(iree_vm_invocation_resume(invocation_a));
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            ConsumeCode(iree_vm_invocation_query_status(invocation_b)));
+  EXPECT_EQ(6, ReadTripleOutput(invocation_a));
+  IREE_EXPECT_OK(iree_vm_invocation_resume(invocation_b));
+  EXPECT_EQ(15, ReadTripleOutput(invocation_b));
+
+  // Resuming a completed invocation is a no-op.
+  IREE_EXPECT_OK(iree_vm_invocation_resume(invocation_a));
+  EXPECT_EQ(6, ReadTripleOutput(invocation_a));
+
+  iree_vm_invocation_release(invocation_a);
+  iree_vm_invocation_release(invocation_b);
+}
+
+// Tests that aborting an invocation releases the refs held by its suspended
+// frames.
+TEST_F(VMInvocationTest, AbortReleasesSuspendedRefs) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(&element_type, 0, iree_allocator_system(),
+                                     &list));
+  iree_vm_list_t* inputs = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_ref_t list_ref = iree_vm_list_retain_ref(list);
+  IREE_ASSERT_OK(iree_vm_list_push_ref_move(inputs, &list_ref));
+  iree_vm_invocation_t* invocation = CreateInvocation("yield_ref", inputs);
+  iree_vm_list_release(inputs);
+  EXPECT_LT(1, ReadRefCount(list));
+
+  // Park the invocation with the ref passed down into the callee frame.
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            ConsumeCode(iree_vm_invocation_resume(invocation)));
+  EXPECT_LT(1, ReadRefCount(list));
+
+  IREE_EXPECT_OK(iree_vm_invocation_abort(invocation));
+  EXPECT_EQ(1, ReadRefCount(list));
+  EXPECT_EQ(IREE_STATUS_ABORTED,
+            ConsumeCode(iree_vm_invocation_query_status(invocation)));
+  EXPECT_EQ(nullptr, iree_vm_invocation_output(invocation));
+
+  // Aborted invocations stay aborted.
+  EXPECT_EQ(IREE_STATUS_ABORTED,
+            ConsumeCode(iree_vm_invocation_resume(invocation)));
+  IREE_EXPECT_OK(iree_vm_invocation_abort(invocation));
+
+  iree_vm_invocation_release(invocation);
+  iree_vm_list_release(list);
+}
+
+// Tests that the marshaled arguments are released when the invocation cannot
+// be allocated.
+TEST_F(VMInvocationTest, CreateFailureReleasesArguments) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(&element_type, 0, iree_allocator_system(),
+                                     &list));
+  iree_vm_list_t* inputs = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(/*element_type=*/nullptr, 1,
+                                     iree_allocator_system(), &inputs));
+  iree_vm_ref_t list_ref = iree_vm_list_retain_ref(list);
+  IREE_ASSERT_OK(iree_vm_list_push_ref_move(inputs, &list_ref));
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(bytecode_module_->lookup_function(
+      bytecode_module_->self, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      iree_make_cstring_view("yield_ref"), &function));
+  iree_vm_invocation_t* invocation = nullptr;
+  EXPECT_EQ(IREE_STATUS_INVALID_ARGUMENT,
+            ConsumeCode(iree_vm_invocation_create(
+                context_, function, /*policy=*/nullptr, inputs,
+                iree_allocator_null(), &invocation)));
+  EXPECT_EQ(nullptr, invocation);
+
+  // Only the inputs list still references |list|.
+  EXPECT_EQ(2, ReadRefCount(list));
+  iree_vm_list_release(inputs);
+  EXPECT_EQ(1, ReadRefCount(list));
+  iree_vm_list_release(list);
+}
+
+// Tests that await gives up once its deadline has elapsed and leaves the
+// invocation pending.
+TEST_F(VMInvocationTest, AwaitDeadlineExceeded) {
+  iree_vm_invocation_t* invocation = CreateInvocation("yield_forever", nullptr);
+
+  EXPECT_EQ(IREE_STATUS_DEADLINE_EXCEEDED,
+            ConsumeCode(iree_vm_invocation_await(invocation,
+                                                 IREE_TIME_INFINITE_PAST)));
+  EXPECT_EQ(IREE_STATUS_DEADLINE_EXCEEDED,
+            ConsumeCode(iree_vm_invocation_await(
+                invocation, iree_time_now() + 1000000 /* 1ms */)));
+  EXPECT_EQ(IREE_STATUS_UNAVAILABLE,
+            ConsumeCode(iree_vm_invocation_query_status(invocation)));
+
+  IREE_EXPECT_OK(iree_vm_invocation_abort(invocation));
+  iree_vm_invocation_release(invocation);
+}
+
+// Tests that await runs an invocation to completion and that its output stays
+// valid afterward.
+TEST_F(VMInvocationTest, AwaitOutputAfterCompletion) {
+  iree_vm_invocation_t* invocation = CreateTripleInvocation(4);
+
+  IREE_EXPECT_OK(
+      iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(12, ReadTripleOutput(invocation));
+
+  // Awaiting a completed invocation returns immediately, even if the deadline
+  // has already elapsed.
+  IREE_EXPECT_OK(iree_vm_invocation_await(invocation, IREE_TIME_INFINITE_PAST));
+  EXPECT_EQ(12, ReadTripleOutput(invocation));
+
+  iree_vm_invocation_release(invocation);
+}
+
+}  // namespace
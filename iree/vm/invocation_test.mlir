@@ -0,0 +1,33 @@
+vm.module @invocation_test {
+  // Returns 3 * |arg0|, yielding between each step.
+  vm.export @yield_triple
+  vm.func @yield_triple(%arg0 : i32) -> i32 {
+    %0 = vm.add.i32 %arg0, %arg0 : i32
+    vm.yield
+    %1 = vm.add.i32 %0, %arg0 : i32
+    vm.yield
+    vm.return %1 : i32
+  }
+
+  // Returns |arg0| after holding it in a suspended caller and callee frame.
+  vm.export @yield_ref
+  vm.func @yield_ref(%arg0 : !vm.list<i32>) -> !vm.list<i32> {
+    vm.yield
+    %0 = vm.call @yield_ref_callee(%arg0) : (!vm.list<i32>) -> !vm.list<i32>
+    vm.return %0 : !vm.list<i32>
+  }
+  vm.func @yield_ref_callee(%arg0 : !vm.list<i32>) -> !vm.list<i32>
+      attributes {noinline} {
+    vm.yield
+    vm.return %arg0 : !vm.list<i32>
+  }
+
+  // Yields forever and must be aborted.
+  vm.export @yield_forever
+  vm.func @yield_forever() {
+    vm.br ^loop
+  ^loop:
+    vm.yield
+    vm.br ^loop
+  }
+}
@@ -117,6 +117,35 @@ TEST_F(VMListTest, UsageI32) {
   iree_vm_list_release(list);
 }
 
+// Tests f32 element storage and widening to f64 on access.
+TEST_F(VMListTest, UsageF32) {
+  iree_vm_type_def_t element_type =
+      iree_vm_type_def_make_value_type(IREE_VM_VALUE_TYPE_F32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(&element_type, 5, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 5));
+
+  for (iree_host_size_t i = 0; i < 5; ++i) {
+    iree_vm_value_t value = iree_vm_value_make_f32(i + 0.5f);
+    IREE_ASSERT_OK(iree_vm_list_set_value(list, i, &value));
+  }
+
+  for (iree_host_size_t i = 0; i < 5; ++i) {
+    iree_vm_value_t value;
+    IREE_ASSERT_OK(
+        iree_vm_list_get_value_as(list, i, IREE_VM_VALUE_TYPE_F32, &value));
+    EXPECT_EQ(IREE_VM_VALUE_TYPE_F32, value.type);
+    EXPECT_EQ(i + 0.5f, value.f32);
+    IREE_ASSERT_OK(
+        iree_vm_list_get_value_as(list, i, IREE_VM_VALUE_TYPE_F64, &value));
+    EXPECT_EQ(IREE_VM_VALUE_TYPE_F64, value.type);
+    EXPECT_EQ(i + 0.5, value.f64);
+  }
+
+  iree_vm_list_release(list);
+}
+
 // Tests simple ref object list usage, mainly just for demonstration.
 // Stores ref object type A elements only, equivalent to `!vm.list<!vm.ref<A>>`.
 TEST_F(VMListTest, UsageRef) {
@@ -58,9 +58,11 @@ iree_vm_function_call_compute_cconv_fragment_size(
        ++i, ++seg_i) {
     switch (cconv_fragment.data[i]) {
       case IREE_VM_CCONV_TYPE_INT32:
+      case IREE_VM_CCONV_TYPE_FLOAT32:
         required_size += sizeof(int32_t);
         break;
       case IREE_VM_CCONV_TYPE_INT64:
+      case IREE_VM_CCONV_TYPE_FLOAT64:
         required_size += sizeof(int64_t);
         break;
       case IREE_VM_CCONV_TYPE_REF:
@@ -81,9 +83,11 @@ iree_vm_function_call_compute_cconv_fragment_size(
              ++i) {
           switch (cconv_fragment.data[i]) {
             case IREE_VM_CCONV_TYPE_INT32:
+            case IREE_VM_CCONV_TYPE_FLOAT32:
               span_size += sizeof(int32_t);
               break;
             case IREE_VM_CCONV_TYPE_INT64:
+            case IREE_VM_CCONV_TYPE_FLOAT64:
               span_size += sizeof(int64_t);
               break;
             case IREE_VM_CCONV_TYPE_REF:
@@ -110,7 +114,7 @@ iree_vm_function_call_compute_cconv_fragment_size(
 IREE_API_EXPORT void IREE_API_CALL
 iree_vm_function_call_release(iree_vm_function_call_t* call,
                               const iree_vm_function_signature_t* signature) {
-  if (!call->arguments.data_length || !call->results.data_length) {
+  if (!call->arguments.data_length && !call->results.data_length) {
     return;
   }
   iree_string_view_t cconv = signature->calling_convention;
@@ -124,9 +128,11 @@ iree_vm_function_call_release(iree_vm_function_call_t* call,
     }
     switch (c) {
       case IREE_VM_CCONV_TYPE_INT32:
+      case IREE_VM_CCONV_TYPE_FLOAT32:
         p += sizeof(int32_t);
         break;
       case IREE_VM_CCONV_TYPE_INT64:
+      case IREE_VM_CCONV_TYPE_FLOAT64:
         p += sizeof(int64_t);
         break;
       case IREE_VM_CCONV_TYPE_REF:
@@ -108,11 +108,13 @@ typedef struct {
   // - Zero or more arguments:
   //   - 'i': int32_t integer (i32)
   //   - 'I': int64_t integer (i64)
+  //   - 'f': IEEE 754 single-precision float (f32)
+  //   - 'F': IEEE 754 double-precision float (f64)
   //   - 'r': ref-counted type pointer (!vm.ref<?>)
   //   - '[' ... ']': variadic list of flattened tuples of a specified type
   // - EOL or '.'
   // - Zero or more results:
-  //   - 'i' or 'I'
+  //   - 'i', 'I', 'f', or 'F'
   //   - 'r'
   //
   // Examples:
@@ -209,6 +211,8 @@ typedef struct {
 
 #define IREE_VM_CCONV_TYPE_INT32 'i'
 #define IREE_VM_CCONV_TYPE_INT64 'I'
+#define IREE_VM_CCONV_TYPE_FLOAT32 'f'
+#define IREE_VM_CCONV_TYPE_FLOAT64 'F'
 #define IREE_VM_CCONV_TYPE_REF 'r'
 #define IREE_VM_CCONV_TYPE_SPAN_START '['
 #define IREE_VM_CCONV_TYPE_SPAN_END ']'
@@ -250,16 +254,31 @@ IREE_API_EXPORT void IREE_API_CALL
 iree_vm_function_call_release(iree_vm_function_call_t* call,
                               const iree_vm_function_signature_t* signature);
 
+// Bitfield describing how an execution returned control to its caller.
+enum iree_vm_execution_result_flag_e {
+  IREE_VM_EXECUTION_RESULT_FLAG_NONE = 0,
+  // Execution yielded (such as via a vm.yield instruction) before the call
+  // completed. The stack retains the suspended frames and the call must be
+  // continued with the module resume_call method until it completes without
+  // yielding. Call results are only available once the call completes.
+  IREE_VM_EXECUTION_RESULT_FLAG_YIELDED = 1u << 0,
+};
+typedef uint32_t iree_vm_execution_result_flags_t;
+
 // Results of an iree_vm_module_execute request.
 typedef struct {
-  // TODO(benvanik): yield information.
-  // Yield modes:
-  // - yield (yield instruction)
+  // TODO(benvanik): additional yield modes:
   // - await (with 1+ wait handles)
   // - break
-  int reserved;
+  iree_vm_execution_result_flags_t flags;
 } iree_vm_execution_result_t;
 
+// Returns true if the execution yielded and must be resumed to complete.
+static inline bool iree_vm_execution_result_is_yielded(
+    const iree_vm_execution_result_t* result) {
+  return (result->flags & IREE_VM_EXECUTION_RESULT_FLAG_YIELDED) != 0;
+}
+
 // Defines an interface that can be used to reflect and execute functions on a
 // module.
 //
@@ -321,6 +340,10 @@ typedef struct iree_vm_module {
       iree_vm_execution_result_t* out_result);
 
   // Resumes execution of a previously-yielded call.
+  // The suspended frames must be at the top of |stack| and execution continues
+  // until the call either yields again or completes, in which case the results
+  // are written to the results buffer of the original |call| passed to
+  // begin_call.
   iree_status_t(IREE_API_PTR* resume_call)(
       void* self, iree_vm_stack_t* stack,
       iree_vm_execution_result_t* out_result);
@@ -191,6 +191,15 @@ struct cconv_map<uint64_t> {
   static constexpr const auto conv_chars = literal("I");
 };
 
+template <>
+struct cconv_map<float> {
+  static constexpr const auto conv_chars = literal("f");
+};
+template <>
+struct cconv_map<double> {
+  static constexpr const auto conv_chars = literal("F");
+};
+
 template <>
 struct cconv_map<opaque_ref> {
   static constexpr const auto conv_chars = literal("r");
@@ -0,0 +1,217 @@
+vm.module @arithmetic_ops_f32 {
+
+  //===--------------------------------------------------------------------===//
+  // F32 Arithmetic
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_add_f32
+  vm.func @test_add_f32() {
+    %c1 = vm.const.f32 1.5 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.add.f32 %c1dno, %c1dno : f32
+    %c2 = vm.const.f32 3.0 : f32
+    vm.check.eq %v, %c2, "1.5+1.5=3" : f32
+    vm.return
+  }
+
+  vm.export @test_sub_f32
+  vm.func @test_sub_f32() {
+    %c1 = vm.const.f32 3.0 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %c2 = vm.const.f32 2.5 : f32
+    %c2dno = iree.do_not_optimize(%c2) : f32
+    %v = vm.sub.f32 %c1dno, %c2dno : f32
+    %c3 = vm.const.f32 0.5 : f32
+    vm.check.eq %v, %c3, "3.0-2.5=0.5" : f32
+    vm.return
+  }
+
+  vm.export @test_mul_f32
+  vm.func @test_mul_f32() {
+    %c1 = vm.const.f32 2.5 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.mul.f32 %c1dno, %c1dno : f32
+    %c2 = vm.const.f32 6.25 : f32
+    vm.check.eq %v, %c2, "2.5*2.5=6.25" : f32
+    vm.return
+  }
+
+  vm.export @test_div_f32
+  vm.func @test_div_f32() {
+    %c1 = vm.const.f32 4.0 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %c2 = vm.const.f32 -2.0 : f32
+    %c2dno = iree.do_not_optimize(%c2) : f32
+    %v = vm.div.f32 %c1dno, %c2dno : f32
+    %c3 = vm.const.f32 -2.0 : f32
+    vm.check.eq %v, %c3, "4.0/-2.0=-2.0" : f32
+    vm.return
+  }
+
+  vm.export @test_rem_f32
+  vm.func @test_rem_f32() {
+    %c1 = vm.const.f32 -3.0 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %c2 = vm.const.f32 -2.0 : f32
+    %c2dno = iree.do_not_optimize(%c2) : f32
+    %v = vm.rem.f32 %c1dno, %c2dno : f32
+    %c3 = vm.const.f32 -1.0 : f32
+    vm.check.eq %v, %c3, "-3.0%-2.0=-1.0" : f32
+    vm.return
+  }
+
+  vm.export @test_abs_f32
+  vm.func @test_abs_f32() {
+    %c1 = vm.const.f32 -1.5 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.abs.f32 %c1dno : f32
+    %c2 = vm.const.f32 1.5 : f32
+    vm.check.eq %v, %c2, "abs(-1.5)=1.5" : f32
+    vm.return
+  }
+
+  vm.export @test_neg_f32
+  vm.func @test_neg_f32() {
+    %c1 = vm.const.f32 1.5 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.neg.f32 %c1dno : f32
+    %c2 = vm.const.f32 -1.5 : f32
+    vm.check.eq %v, %c2, "neg(1.5)=-1.5" : f32
+    vm.return
+  }
+
+  vm.export @test_ceil_f32
+  vm.func @test_ceil_f32() {
+    %c1 = vm.const.f32 1.5 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.ceil.f32 %c1dno : f32
+    %c2 = vm.const.f32 2.0 : f32
+    vm.check.eq %v, %c2, "ceil(1.5)=2.0" : f32
+    vm.return
+  }
+
+  vm.export @test_floor_f32
+  vm.func @test_floor_f32() {
+    %c1 = vm.const.f32 -1.5 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.floor.f32 %c1dno : f32
+    %c2 = vm.const.f32 -2.0 : f32
+    vm.check.eq %v, %c2, "floor(-1.5)=-2.0" : f32
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // F32 Conversions
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cast_si32_f32
+  vm.func @test_cast_si32_f32() {
+    %c1 = vm.const.i32 -3 : i32
+    %c1dno = iree.do_not_optimize(%c1) : i32
+    %v = vm.cast.si32.f32 %c1dno : i32 -> f32
+    %c2 = vm.const.f32 -3.0 : f32
+    vm.check.eq %v, %c2, "cast(-3)=-3.0" : f32
+    vm.return
+  }
+
+  vm.export @test_cast_f32_si32
+  vm.func @test_cast_f32_si32() {
+    %c1 = vm.const.f32 -3.75 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.cast.f32.si32 %c1dno : f32 -> i32
+    %c2 = vm.const.i32 -3 : i32
+    vm.check.eq %v, %c2, "cast(-3.75)=-3" : i32
+    vm.return
+  }
+
+  vm.export @test_cast_f32_ui32
+  vm.func @test_cast_f32_ui32() {
+    %c1 = vm.const.f32 3.75 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.cast.f32.ui32 %c1dno : f32 -> i32
+    %c2 = vm.const.i32 3 : i32
+    vm.check.eq %v, %c2, "cast(3.75)=3" : i32
+    vm.return
+  }
+
+  vm.export @test_cast_f32_si32_saturate
+  vm.func @test_cast_f32_si32_saturate() {
+    %c1 = vm.const.f32 1.0e10 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v1 = vm.cast.f32.si32 %c1dno : f32 -> i32
+    %max = vm.const.i32 2147483647 : i32
+    vm.check.eq %v1, %max, "cast(1.0e10)=INT32_MAX" : i32
+    %c2 = vm.const.f32 -1.0e10 : f32
+    %c2dno = iree.do_not_optimize(%c2) : f32
+    %v2 = vm.cast.f32.si32 %c2dno : f32 -> i32
+    %min = vm.const.i32 -2147483648 : i32
+    vm.check.eq %v2, %min, "cast(-1.0e10)=INT32_MIN" : i32
+    %c3 = vm.const.f32 0x7FC00000 : f32
+    %c3dno = iree.do_not_optimize(%c3) : f32
+    %v3 = vm.cast.f32.si32 %c3dno : f32 -> i32
+    %zero = vm.const.i32.zero : i32
+    vm.check.eq %v3, %zero, "cast(NaN)=0" : i32
+    vm.return
+  }
+
+  vm.export @test_cast_f32_ui32_saturate
+  vm.func @test_cast_f32_ui32_saturate() {
+    %c1 = vm.const.f32 1.0e10 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v1 = vm.cast.f32.ui32 %c1dno : f32 -> i32
+    %max = vm.const.i32 -1 : i32
+    vm.check.eq %v1, %max, "cast(1.0e10)=UINT32_MAX" : i32
+    %c2 = vm.const.f32 -1.0 : f32
+    %c2dno = iree.do_not_optimize(%c2) : f32
+    %v2 = vm.cast.f32.ui32 %c2dno : f32 -> i32
+    %zero = vm.const.i32.zero : i32
+    vm.check.eq %v2, %zero, "cast(-1.0)=0" : i32
+    %c3 = vm.const.f32 0x7FC00000 : f32
+    %c3dno = iree.do_not_optimize(%c3) : f32
+    %v3 = vm.cast.f32.ui32 %c3dno : f32 -> i32
+    vm.check.eq %v3, %zero, "cast(NaN)=0" : i32
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // F32 Comparisons
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cmp_lt_f32
+  vm.func @test_cmp_lt_f32() {
+    %c1 = vm.const.f32 -1.0 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %c2 = vm.const.f32 1.0 : f32
+    %c2dno = iree.do_not_optimize(%c2) : f32
+    %v = vm.cmp.lt.f32 %c1dno, %c2dno : f32
+    %c3 = vm.const.i32 1 : i32
+    vm.check.eq %v, %c3, "-1.0<1.0" : i32
+    vm.return
+  }
+
+  vm.export @test_cmp_gte_f32
+  vm.func @test_cmp_gte_f32() {
+    %c1 = vm.const.f32 -1.0 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %c2 = vm.const.f32 1.0 : f32
+    %c2dno = iree.do_not_optimize(%c2) : f32
+    %v = vm.cmp.gte.f32 %c2dno, %c1dno : f32
+    %c3 = vm.const.i32 1 : i32
+    vm.check.eq %v, %c3, "1.0>=-1.0" : i32
+    vm.return
+  }
+
+  vm.export @test_cmp_nan_f32
+  vm.func @test_cmp_nan_f32() {
+    %c1 = vm.const.f32 0x7FC00000 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %eq = vm.cmp.eq.f32 %c1dno, %c1dno : f32
+    %zero = vm.const.i32.zero : i32
+    vm.check.eq %eq, %zero, "NaN==NaN is false" : i32
+    %ne = vm.cmp.ne.f32 %c1dno, %c1dno : f32
+    %one = vm.const.i32 1 : i32
+    vm.check.eq %ne, %one, "NaN!=NaN is true" : i32
+    vm.return
+  }
+
+}
@@ -0,0 +1,237 @@
+vm.module @arithmetic_ops_f64 {
+
+  //===--------------------------------------------------------------------===//
+  // F64 Arithmetic
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_add_f64
+  vm.func @test_add_f64() {
+    %c1 = vm.const.f64 1.5 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.add.f64 %c1dno, %c1dno : f64
+    %c2 = vm.const.f64 3.0 : f64
+    vm.check.eq %v, %c2, "1.5+1.5=3" : f64
+    vm.return
+  }
+
+  vm.export @test_sub_f64
+  vm.func @test_sub_f64() {
+    %c1 = vm.const.f64 3.0 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %c2 = vm.const.f64 2.5 : f64
+    %c2dno = iree.do_not_optimize(%c2) : f64
+    %v = vm.sub.f64 %c1dno, %c2dno : f64
+    %c3 = vm.const.f64 0.5 : f64
+    vm.check.eq %v, %c3, "3.0-2.5=0.5" : f64
+    vm.return
+  }
+
+  vm.export @test_mul_f64
+  vm.func @test_mul_f64() {
+    %c1 = vm.const.f64 2.5 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.mul.f64 %c1dno, %c1dno : f64
+    %c2 = vm.const.f64 6.25 : f64
+    vm.check.eq %v, %c2, "2.5*2.5=6.25" : f64
+    vm.return
+  }
+
+  vm.export @test_div_f64
+  vm.func @test_div_f64() {
+    %c1 = vm.const.f64 4.0 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %c2 = vm.const.f64 -2.0 : f64
+    %c2dno = iree.do_not_optimize(%c2) : f64
+    %v = vm.div.f64 %c1dno, %c2dno : f64
+    %c3 = vm.const.f64 -2.0 : f64
+    vm.check.eq %v, %c3, "4.0/-2.0=-2.0" : f64
+    vm.return
+  }
+
+  vm.export @test_rem_f64
+  vm.func @test_rem_f64() {
+    %c1 = vm.const.f64 -3.0 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %c2 = vm.const.f64 -2.0 : f64
+    %c2dno = iree.do_not_optimize(%c2) : f64
+    %v = vm.rem.f64 %c1dno, %c2dno : f64
+    %c3 = vm.const.f64 -1.0 : f64
+    vm.check.eq %v, %c3, "-3.0%-2.0=-1.0" : f64
+    vm.return
+  }
+
+  vm.export @test_abs_f64
+  vm.func @test_abs_f64() {
+    %c1 = vm.const.f64 -1.5 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.abs.f64 %c1dno : f64
+    %c2 = vm.const.f64 1.5 : f64
+    vm.check.eq %v, %c2, "abs(-1.5)=1.5" : f64
+    vm.return
+  }
+
+  vm.export @test_neg_f64
+  vm.func @test_neg_f64() {
+    %c1 = vm.const.f64 1.5 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.neg.f64 %c1dno : f64
+    %c2 = vm.const.f64 -1.5 : f64
+    vm.check.eq %v, %c2, "neg(1.5)=-1.5" : f64
+    vm.return
+  }
+
+  vm.export @test_ceil_f64
+  vm.func @test_ceil_f64() {
+    %c1 = vm.const.f64 1.5 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.ceil.f64 %c1dno : f64
+    %c2 = vm.const.f64 2.0 : f64
+    vm.check.eq %v, %c2, "ceil(1.5)=2.0" : f64
+    vm.return
+  }
+
+  vm.export @test_floor_f64
+  vm.func @test_floor_f64() {
+    %c1 = vm.const.f64 -1.5 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.floor.f64 %c1dno : f64
+    %c2 = vm.const.f64 -2.0 : f64
+    vm.check.eq %v, %c2, "floor(-1.5)=-2.0" : f64
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // F64 Conversions
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cast_si32_f64
+  vm.func @test_cast_si32_f64() {
+    %c1 = vm.const.i32 -3 : i32
+    %c1dno = iree.do_not_optimize(%c1) : i32
+    %v = vm.cast.si32.f64 %c1dno : i32 -> f64
+    %c2 = vm.const.f64 -3.0 : f64
+    vm.check.eq %v, %c2, "cast(-3)=-3.0" : f64
+    vm.return
+  }
+
+  vm.export @test_cast_f64_si32
+  vm.func @test_cast_f64_si32() {
+    %c1 = vm.const.f64 -3.75 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.cast.f64.si32 %c1dno : f64 -> i32
+    %c2 = vm.const.i32 -3 : i32
+    vm.check.eq %v, %c2, "cast(-3.75)=-3" : i32
+    vm.return
+  }
+
+  vm.export @test_cast_f64_ui32
+  vm.func @test_cast_f64_ui32() {
+    %c1 = vm.const.f64 3.75 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.cast.f64.ui32 %c1dno : f64 -> i32
+    %c2 = vm.const.i32 3 : i32
+    vm.check.eq %v, %c2, "cast(3.75)=3" : i32
+    vm.return
+  }
+
+  vm.export @test_cast_f64_si32_saturate
+  vm.func @test_cast_f64_si32_saturate() {
+    %c1 = vm.const.f64 1.0e10 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v1 = vm.cast.f64.si32 %c1dno : f64 -> i32
+    %max = vm.const.i32 2147483647 : i32
+    vm.check.eq %v1, %max, "cast(1.0e10)=INT32_MAX" : i32
+    %c2 = vm.const.f64 -1.0e10 : f64
+    %c2dno = iree.do_not_optimize(%c2) : f64
+    %v2 = vm.cast.f64.si32 %c2dno : f64 -> i32
+    %min = vm.const.i32 -2147483648 : i32
+    vm.check.eq %v2, %min, "cast(-1.0e10)=INT32_MIN" : i32
+    %c3 = vm.const.f64 0x7FF8000000000000 : f64
+    %c3dno = iree.do_not_optimize(%c3) : f64
+    %v3 = vm.cast.f64.si32 %c3dno : f64 -> i32
+    %zero = vm.const.i32.zero : i32
+    vm.check.eq %v3, %zero, "cast(NaN)=0" : i32
+    vm.return
+  }
+
+  vm.export @test_cast_f64_ui32_saturate
+  vm.func @test_cast_f64_ui32_saturate() {
+    %c1 = vm.const.f64 1.0e10 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v1 = vm.cast.f64.ui32 %c1dno : f64 -> i32
+    %max = vm.const.i32 -1 : i32
+    vm.check.eq %v1, %max, "cast(1.0e10)=UINT32_MAX" : i32
+    %c2 = vm.const.f64 -1.0 : f64
+    %c2dno = iree.do_not_optimize(%c2) : f64
+    %v2 = vm.cast.f64.ui32 %c2dno : f64 -> i32
+    %zero = vm.const.i32.zero : i32
+    vm.check.eq %v2, %zero, "cast(-1.0)=0" : i32
+    %c3 = vm.const.f64 0x7FF8000000000000 : f64
+    %c3dno = iree.do_not_optimize(%c3) : f64
+    %v3 = vm.cast.f64.ui32 %c3dno : f64 -> i32
+    vm.check.eq %v3, %zero, "cast(NaN)=0" : i32
+    vm.return
+  }
+
+  vm.export @test_ext_f32_f64
+  vm.func @test_ext_f32_f64() {
+    %c1 = vm.const.f32 1.5 : f32
+    %c1dno = iree.do_not_optimize(%c1) : f32
+    %v = vm.ext.f32.f64 %c1dno : f32 -> f64
+    %c2 = vm.const.f64 1.5 : f64
+    vm.check.eq %v, %c2, "ext(1.5)=1.5" : f64
+    vm.return
+  }
+
+  vm.export @test_trunc_f64_f32
+  vm.func @test_trunc_f64_f32() {
+    %c1 = vm.const.f64 -2.5 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %v = vm.trunc.f64.f32 %c1dno : f64 -> f32
+    %c2 = vm.const.f32 -2.5 : f32
+    vm.check.eq %v, %c2, "trunc(-2.5)=-2.5" : f32
+    vm.return
+  }
+
+  //===--------------------------------------------------------------------===//
+  // F64 Comparisons
+  //===--------------------------------------------------------------------===//
+
+  vm.export @test_cmp_lt_f64
+  vm.func @test_cmp_lt_f64() {
+    %c1 = vm.const.f64 -1.0 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %c2 = vm.const.f64 1.0 : f64
+    %c2dno = iree.do_not_optimize(%c2) : f64
+    %v = vm.cmp.lt.f64 %c1dno, %c2dno : f64
+    %c3 = vm.const.i32 1 : i32
+    vm.check.eq %v, %c3, "-1.0<1.0" : i32
+    vm.return
+  }
+
+  vm.export @test_cmp_gte_f64
+  vm.func @test_cmp_gte_f64() {
+    %c1 = vm.const.f64 -1.0 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %c2 = vm.const.f64 1.0 : f64
+    %c2dno = iree.do_not_optimize(%c2) : f64
+    %v = vm.cmp.gte.f64 %c2dno, %c1dno : f64
+    %c3 = vm.const.i32 1 : i32
+    vm.check.eq %v, %c3, "1.0>=-1.0" : i32
+    vm.return
+  }
+
+  vm.export @test_cmp_nan_f64
+  vm.func @test_cmp_nan_f64() {
+    %c1 = vm.const.f64 0x7FF8000000000000 : f64
+    %c1dno = iree.do_not_optimize(%c1) : f64
+    %eq = vm.cmp.eq.f64 %c1dno, %c1dno : f64
+    %zero = vm.const.i32.zero : i32
+    vm.check.eq %eq, %zero, "NaN==NaN is false" : i32
+    %ne = vm.cmp.ne.f64 %c1dno, %c1dno : f64
+    %one = vm.const.i32 1 : i32
+    vm.check.eq %ne, %one, "NaN!=NaN is true" : i32
+    vm.return
+  }
+
+}
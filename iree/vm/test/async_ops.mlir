@@ -0,0 +1,40 @@
+vm.module @async_ops {
+
+  //===--------------------------------------------------------------------===//
+  // vm.yield
+  //===--------------------------------------------------------------------===//
+
+  // Tests that registers are preserved across a yield and resume.
+  vm.export @test_yield_sequence
+  vm.func @test_yield_sequence() {
+    %c1 = vm.const.i32 1 : i32
+    %c1dno = iree.do_not_optimize(%c1) : i32
+    %y0 = vm.add.i32 %c1dno, %c1dno : i32
+    vm.yield
+    %y1 = vm.add.i32 %y0, %y0 : i32
+    vm.yield
+    %c4 = vm.const.i32 4 : i32
+    vm.check.eq %y1, %c4, "1+1+2=4" : i32
+    vm.return
+  }
+
+  // Tests yielding from a frame below the entry frame.
+  vm.export @test_yield_nested
+  vm.func @test_yield_nested() {
+    %c3 = vm.const.i32 3 : i32
+    %c3dno = iree.do_not_optimize(%c3) : i32
+    vm.yield
+    %v = vm.call @yield_double(%c3dno) : (i32) -> i32
+    %c6 = vm.const.i32 6 : i32
+    vm.check.eq %v, %c6, "3*2=6" : i32
+    vm.return
+  }
+
+  vm.func @yield_double(%arg0 : i32) -> i32 {
+    vm.yield
+    %0 = vm.add.i32 %arg0, %arg0 : i32
+    vm.yield
+    vm.return %0 : i32
+  }
+
+}
@@ -0,0 +1,306 @@
+#!/usr/bin/env python3
+
+# Copyright 2021 Google LLC
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#      https://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+"""Tunes the LLVM CPU tile sizes of the matmuls in a module on the local CPU.
+
+The module is first compiled for the host CPU to find its matmul dispatches and
+the tile sizes the compiler selects for them. Each distinct op shape is then
+compiled on its own into an executable benchmark module (see
+-iree-mlir-to-executable-benchmark-vm-module) once per candidate tile size
+configuration and timed with iree-benchmark-module. The fastest configuration
+for each shape is written to a tile size database that the compiler uses when
+given -iree-llvm-tile-size-database.
+
+Example usages:
+  # Tune the matmuls in a module and write the results to tile_sizes.txt:
+  python3 ./scripts/tune_llvm_tile_sizes.py \\
+    --input_file=iree/test/e2e/models/bert_encoder_unrolled_fake_weights.mlir \\
+    --database=/tmp/tile_sizes.txt
+
+  # Compile the module using the tuned tile sizes:
+  iree-translate -iree-mlir-to-vm-bytecode-module \\
+    -iree-hal-target-backends=dylib-llvm-aot -iree-llvm-target-cpu=host \\
+    -iree-llvm-tile-size-database=/tmp/tile_sizes.txt ...
+"""
+
+import itertools
+import json
+import os
+import re
+import subprocess
+import tempfile
+from typing import Dict, List, Optional, Sequence, Tuple
+
+from absl import app
+from absl import flags
+
+FLAGS = flags.FLAGS
+
+flags.DEFINE_string('input_file', None, 'MLIR module with the ops to tune.')
+flags.DEFINE_string(
+    'database', None,
+    'Tile size database to write the results to. Existing entries for other '
+    'CPUs, element types and op shapes are kept.')
+flags.DEFINE_string('build_dir', 'build',
+                    'Build directory containing iree/tools.')
+flags.DEFINE_list('workgroup_tile_sizes', ['16', '32', '64', '128', '256'],
+                  'Candidate workgroup tile sizes of the M and N dimensions.')
+flags.DEFINE_list('l1_tile_sizes', ['8', '16', '32', '64', '128'],
+                  'Candidate L1 tile sizes.')
+flags.DEFINE_list('vector_tile_sizes', ['4', '8', '16', '32'],
+                  'Candidate vector tile sizes.')
+flags.DEFINE_integer('benchmark_repetitions', 5,
+                     'Number of repetitions of each benchmark.')
+flags.DEFINE_bool('dry_run', False,
+                  'Print the candidates for each op without timing them.')
+flags.mark_flags_as_required(['input_file', 'database'])
+
+_TILE_SIZES_REMARK = re.compile(
+    r"remark: selected tile sizes for '([^']+)' (\w+): (\S+)")
+
+_TILE_SIZE_OVERRIDE_FLAG = (
+    '-iree-codegen-linalg-to-llvm-kernel-dispatch-tile-size-override')
+
+_TUNABLE_OP_NAMES = ('linalg.matmul', 'linalg.batch_matmul')
+
+
+class TunableOp:
+  """An op shape found in the input module along with its tile sizes."""
+
+  def __init__(self, cpu: str, element_type: str, tile_size_override: str):
+    self.cpu = cpu
+    self.element_type = element_type
+    key, tile_sizes = tile_size_override.split('=')
+    self.op_name, loop_ranges = key.split(':')
+    self.loop_ranges = [int(dim) for dim in loop_ranges.split('x')]
+    self.default_tile_sizes = tile_sizes
+
+  @property
+  def key(self) -> str:
+    return f'{self.op_name}:{"x".join(map(str, self.loop_ranges))}'
+
+  @property
+  def database_key(self) -> Tuple[str, str, str]:
+    return (self.cpu, self.element_type, self.key)
+
+
+def _tool_path(name: str) -> str:
+  return os.path.join(FLAGS.build_dir, 'iree', 'tools', name)
+
+
+def _run(command: Sequence[str]) -> subprocess.CompletedProcess:
+  # TODO(#4131) python>=3.7: Use capture_output=True and text=True.
+  return subprocess.run(command,
+                        stdout=subprocess.PIPE,
+                        stderr=subprocess.PIPE,
+                        universal_newlines=True,
+                        check=True)
+
+
+def _compile_flags() -> List[str]:
+  return [
+      '-iree-hal-target-backends=dylib-llvm-aot',
+      '-iree-llvm-target-cpu=host',
+      '-iree-llvm-target-cpu-features=host',
+  ]
+
+
+def find_tunable_ops(input_file: str) -> List[TunableOp]:
+  """Compiles |input_file| and returns its distinct static matmul shapes."""
+  process = _run([
+      _tool_path('iree-translate'), '-iree-mlir-to-vm-bytecode-module',
+      *_compile_flags(),
+      '-iree-codegen-linalg-to-llvm-kernel-dispatch-print-tile-sizes',
+      input_file, '-o', os.devnull
+  ])
+  ops = {}
+  for line in process.stderr.splitlines():
+    match = _TILE_SIZES_REMARK.search(line)
+    if not match:
+      continue
+    op = TunableOp(*match.groups())
+    if op.op_name not in _TUNABLE_OP_NAMES:
+      continue
+    ops.setdefault(op.database_key, op)
+  return list(ops.values())
+
+
+def _power_of_two_ceil(value: int) -> int:
+  return 1 << (value - 1).bit_length()
+
+
+def get_candidates(op: TunableOp) -> List[str]:
+  """Returns candidate tile sizes for |op| in the tile size override format."""
+  is_batch = op.op_name == 'linalg.batch_matmul'
+  m, n, k = op.loop_ranges[-3:]
+  max_parallel = _power_of_two_ceil(max(m, n))
+  max_k = _power_of_two_ceil(k)
+  candidates = [op.default_tile_sizes]
+  for workgroup, l1, vector in itertools.product(
+      map(int, FLAGS.workgroup_tile_sizes), map(int, FLAGS.l1_tile_sizes),
+      map(int, FLAGS.vector_tile_sizes)):
+    # Skip configurations that only differ by tiles larger than the problem or
+    # that aren't nested within the enclosing level.
+    if workgroup > max_parallel or l1 > workgroup or vector > l1:
+      continue
+    l1_k = min(l1, max_k)
+    vector_k = min(vector, l1_k)
+    levels = [[workgroup, workgroup], [l1, l1, l1_k],
+              [vector, vector, vector_k]]
+    if is_batch:
+      levels = [[1] + level for level in levels]
+    candidate = ':'.join('x'.join(map(str, level)) for level in levels)
+    if candidate not in candidates:
+      candidates.append(candidate)
+  return candidates
+
+
+def _create_benchmark_source(op: TunableOp) -> str:
+  """Returns an MHLO module containing only |op|."""
+  elem = op.element_type
+  if op.op_name == 'linalg.batch_matmul':
+    b, m, n, k = op.loop_ranges
+    lhs, rhs = f'tensor<{b}x{m}x{k}x{elem}>', f'tensor<{b}x{k}x{n}x{elem}>'
+    result = f'tensor<{b}x{m}x{n}x{elem}>'
+    body = f'''"mhlo.dot_general"(%lhs, %rhs) {{
+        dot_dimension_numbers = {{
+            lhs_batching_dimensions = dense<0> : tensor<1xi64>,
+            lhs_contracting_dimensions = dense<2> : tensor<1xi64>,
+            rhs_batching_dimensions = dense<0> : tensor<1xi64>,
+            rhs_contracting_dimensions = dense<1> : tensor<1xi64>
+        }}
+    }} : ({lhs}, {rhs}) -> {result}'''
+  else:
+    m, n, k = op.loop_ranges
+    lhs, rhs = f'tensor<{m}x{k}x{elem}>', f'tensor<{k}x{n}x{elem}>'
+    result = f'tensor<{m}x{n}x{elem}>'
+    body = f'"mhlo.dot"(%lhs, %rhs) : ({lhs}, {rhs}) -> {result}'
+  return f'''func @tune(%lhs: {lhs}, %rhs: {rhs}) -> {result}
+    attributes {{ iree.module.export }} {{
+  %0 = {body}
+  return %0 : {result}
+}}
+'''
+
+
+def time_candidate(op: TunableOp, source_file: str, tile_sizes: str,
+                   work_dir: str) -> Optional[float]:
+  """Returns the time in ms of the dispatches of |op| using |tile_sizes|."""
+  module_file = os.path.join(work_dir, 'benchmark.vmfb')
+  try:
+    _run([
+        _tool_path('iree-translate'),
+        '-iree-mlir-to-executable-benchmark-vm-module', *_compile_flags(),
+        f'{_TILE_SIZE_OVERRIDE_FLAG}={op.key}={tile_sizes}', source_file,
+        '-o', module_file
+    ])
+    process = _run([
+        _tool_path('iree-benchmark-module'), f'--module_file={module_file}',
+        '--driver=dylib', '--benchmark_format=json',
+        f'--benchmark_repetitions={FLAGS.benchmark_repetitions}'
+    ])
+  except subprocess.CalledProcessError as error:
+    print(f'  {tile_sizes}: failed\n{error.stderr}')
+    return None
+
+  # Sum the fastest repetition of each dispatch benchmark.
+  dispatch_times: Dict[str, float] = {}
+  time_unit_scales = {'ns': 1e-6, 'us': 1e-3, 'ms': 1.0, 's': 1e3}
+  for benchmark in json.loads(process.stdout)['benchmarks']:
+    name = benchmark['name']
+    if '_entry' not in name or benchmark.get('run_type') == 'aggregate':
+      continue
+    time = benchmark['real_time'] * time_unit_scales[benchmark['time_unit']]
+    dispatch_times[name] = min(time, dispatch_times.get(name, time))
+  return sum(dispatch_times.values()) if dispatch_times else None
+
+
+def tune_op(op: TunableOp, work_dir: str) -> Optional[Tuple[str, float]]:
+  """Returns the fastest tile sizes for |op| and their time in ms."""
+  candidates = get_candidates(op)
+  print(f'Tuning {op.key} ({op.element_type}) on {op.cpu} with '
+        f'{len(candidates)} candidates; default {op.default_tile_sizes}')
+  if FLAGS.dry_run:
+    for candidate in candidates:
+      print(f'  {candidate}')
+    return None
+
+  source_file = os.path.join(work_dir, 'benchmark.mlir')
+  with open(source_file, 'w') as f:
+    f.write(_create_benchmark_source(op))
+  best = None
+  for candidate in candidates:
+    time = time_candidate(op, source_file, candidate, work_dir)
+    if time is None:
+      continue
+    print(f'  {candidate}: {time:.4f} ms')
+    if best is None or time < best[1]:
+      best = (candidate, time)
+  return best
+
+
+def read_database(path: str) -> Dict[Tuple[str, str, str], str]:
+  """Returns the existing entries keyed by CPU, element type and op shape."""
+  entries = {}
+  if not os.path.exists(path):
+    return entries
+  with open(path) as f:
+    for line in f:
+      entry = line.split('#')[0].strip()
+      if not entry:
+        continue
+      cpu, element_type, tile_size_override = entry.split()
+      key = tile_size_override.split('=')[0]
+      entries[(cpu, element_type, key)] = line.rstrip('\n')
+  return entries
+
+
+def write_database(path: str, entries: Dict[Tuple[str, str, str], str]):
+  with open(path, 'w') as f:
+    f.write('# Tile sizes tuned by scripts/tune_llvm_tile_sizes.py.\n')
+    f.write('# <cpu> <element type> '
+            '<op>:<loop ranges>=<workgroup>:<L1>:<vector>\n')
+    for key in sorted(entries):
+      f.write(entries[key] + '\n')
+
+
+def main(argv):
+  del argv  # Unused.
+
+  ops = find_tunable_ops(FLAGS.input_file)
+  if not ops:
+    print(f'No tunable ops found in {FLAGS.input_file}')
+    return
+
+  entries = read_database(FLAGS.database)
+  with tempfile.TemporaryDirectory() as work_dir:
+    for op in ops:
+      best = tune_op(op, work_dir)
+      if best is None:
+        continue
+      tile_sizes, time = best
+      print(f'Selected {tile_sizes} for {op.key} ({op.element_type}) '
+            f'({time:.4f} ms)\n')
+      entries[op.database_key] = (
+          f'{op.cpu} {op.element_type} {op.key}={tile_sizes}'
+          f'  # {time:.4f} ms')
+
+  if not FLAGS.dry_run:
+    write_database(FLAGS.database, entries)
+    print(f'Wrote {len(entries)} entries to {FLAGS.database}')
+
+
+if __name__ == '__main__':
+  app.run(main)